@@ -90,6 +90,12 @@ recompute path. Also, it enables more complicated dependencies beyond trees.
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include "AutoTransaction.h"
 #include "Document.h"
@@ -191,8 +197,54 @@ struct DocumentP
 #endif //USE_OLD_DAG
     std::multimap<const App::DocumentObject*,
         std::unique_ptr<App::DocumentObjectExecReturn> > _RecomputeLog;
+    /// guards the undo transaction and the recompute log in a parallel recompute
+    QMutex recomputeMutex;
+    /// the file of a property in the archive that was last saved or restored
+    struct ArchiveFile {
+        long id;
+        std::string property;
+        std::string file;
+    };
+    typedef std::unordered_map<const Property*, ArchiveFile> ArchiveFiles;
+    /// the archive for an incremental save and the files of its unchanged properties
+    std::string archiveName;
+    Base::TimeInfo archiveTime;
+    unsigned int archiveSize;
+    ArchiveFiles archiveFiles;
+
+    /// returns the files of the document properties in an archive
+    template<typename FileEntry>
+    static ArchiveFiles getArchiveFiles(const Document* doc, const std::vector<FileEntry>& files) {
+        ArchiveFiles saved;
+        for (const auto& entry : files) {
+            if (!entry.Object->isDerivedFrom(Property::getClassTypeId()))
+                continue;
+            auto prop = static_cast<const Property*>(entry.Object);
+            auto obj = Base::freecad_dynamic_cast<const DocumentObject>(prop->getContainer());
+            if (obj && obj->getDocument() == doc && prop->getName()) {
+                ArchiveFile file = {obj->getID(), prop->getName(), entry.FileName};
+                saved[prop] = file;
+            }
+        }
+        return saved;
+    }
+    /// records the archive that has been saved or restored
+    void setArchive(const std::string& name, ArchiveFiles&& files) {
+        Base::FileInfo fi(name);
+        archiveName = name;
+        archiveTime = fi.lastModified();
+        archiveSize = fi.size();
+        archiveFiles = std::move(files);
+    }
+    /// checks that the archive hasn't been modified since it was recorded
+    bool isArchiveUnchanged() const {
+        if (archiveName.empty())
+            return false;
+        Base::FileInfo fi(archiveName);
+        return fi.exists() && fi.lastModified() == archiveTime && fi.size() == archiveSize;
+    }
 
-    DocumentP() {
+    DocumentP() : recomputeMutex(QMutex::Recursive), archiveSize(0) {
         static std::random_device _RD;
         static std::mt19937 _RGEN(_RD());
         static std::uniform_int_distribution<> _RDIST(0,5000);
@@ -228,6 +280,7 @@ struct DocumentP
             delete returnCode;
             return;
         }
+        QMutexLocker lock(&recomputeMutex);
         _RecomputeLog.emplace(returnCode->Which, std::unique_ptr<DocumentObjectExecReturn>(returnCode));
         returnCode->Which->setStatus(ObjectStatus::Error,true);
     }
@@ -1510,6 +1563,7 @@ void Document::onBeforeChangeProperty(const TransactionalObject *Who, const Prop
     if(Who->isDerivedFrom(App::DocumentObject::getClassTypeId()))
         signalBeforeChangeObject(*static_cast<const App::DocumentObject*>(Who), *What);
     if(!d->rollback && !_IsRelabeling) {
+        QMutexLocker lock(&d->recomputeMutex);
         _checkTransaction(0,What,__LINE__);
         if (d->activeUndoTransaction)
             d->activeUndoTransaction->addObjectChange(Who,What);
@@ -1518,6 +1572,8 @@ void Document::onBeforeChangeProperty(const TransactionalObject *Who, const Prop
 
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    // the property must be saved again
+    d->archiveFiles.erase(What);
     signalChangedObject(*Who, *What);
 }
 
@@ -2589,6 +2645,60 @@ private:
 };
 }
 
+namespace App {
+// Writer that copies the files of unchanged properties from the last saved archive
+class ArchiveWriter : public Base::ZipWriter {
+public:
+    ArchiveWriter(std::ostream& os, const DocumentP::ArchiveFiles& files)
+        : Base::ZipWriter(os), files(files)
+    {
+    }
+
+    /// sets the archive to copy the files of unchanged properties from
+    void setArchive(const std::shared_ptr<Base::ZipArchive>& archive) {
+        this->archive = archive;
+    }
+
+    const std::vector<FileEntry>& getFileList() const {
+        return FileList;
+    }
+
+protected:
+    bool copyFile(const std::string& name, const Base::Persistence *object,
+                  zipios::ZipCDirEntry& entry, std::string& data) override {
+        // the extension gives the format, e.g. PartShape.brp or PartShape.bin
+        std::string ext = Base::FileInfo(name).extension();
+
+        // a file that hasn't been read yet is copied from its archive
+        Base::LazyFile* lazy = object->getLazyFile();
+        if (lazy && lazy->isPending()) {
+            return ext == Base::FileInfo(lazy->getFileName()).extension()
+                && lazy->getArchive()->readRawEntry(lazy->getFileName(), entry, data);
+        }
+
+        if (!archive || !object->isDerivedFrom(Property::getClassTypeId()))
+            return false;
+        auto prop = static_cast<const Property*>(object);
+        auto it = files.find(prop);
+        if (it == files.end())
+            return false;
+
+        // the property may have been deleted and another one created at its address
+        auto obj = Base::freecad_dynamic_cast<const DocumentObject>(prop->getContainer());
+        if (!obj || obj->getID() != it->second.id || !prop->getName()
+                 || it->second.property != prop->getName())
+            return false;
+        if (ext != Base::FileInfo(it->second.file).extension())
+            return false;
+        return archive->readRawEntry(it->second.file, entry, data);
+    }
+
+private:
+    const DocumentP::ArchiveFiles& files;
+    std::shared_ptr<Base::ZipArchive> archive;
+};
+}
+
 bool Document::saveToFile(const char* filename) const
 {
     signalStartSave(*this, filename);
@@ -2611,10 +2721,29 @@ bool Document::saveToFile(const char* filename) const
     }
     Base::FileInfo tmp(fn);
 
+    // copy the files of unchanged properties from the last saved archive, which requires
+    // the backup policy because otherwise the archive may be overwritten while reading it
+    bool incremental = policy && hGrp->GetBool("IncrementalSave", false) && d->isArchiveUnchanged();
+    DocumentP::ArchiveFiles saved;
+    // the files that haven't been read yet and have been copied to the new archive
+    std::vector<std::pair<Base::LazyFile*, std::string> > lazyFiles;
+
+    // without the backup policy the archive of these files may be overwritten
+    if (!policy) {
+        for (auto obj : d->objectArray) {
+            std::vector<Property*> props;
+            obj->getPropertyList(props);
+            for (auto prop : props) {
+                if (Base::LazyFile* lazy = prop->getLazyFile())
+                    lazy->read();
+            }
+        }
+    }
+
     // open extra scope to close ZipWriter properly
     {
         Base::ofstream file(tmp, std::ios::out | std::ios::binary);
-        Base::ZipWriter writer(file);
+        ArchiveWriter writer(file, d->archiveFiles);
         if (!file.is_open()) {
             throw Base::FileException("Failed to open file", tmp);
         }
@@ -2625,6 +2754,11 @@ bool Document::saveToFile(const char* filename) const
 
         if (hGrp->GetBool("SaveBinaryBrep", false))
             writer.setMode("BinaryBrep");
+        // compress the files on worker threads
+        if (hGrp->GetBool("ParallelSave", false))
+            writer.setConcurrency(QThread::idealThreadCount());
+        if (incremental)
+            writer.setArchive(std::make_shared<Base::ZipArchive>(d->archiveName));
 
         writer.Stream() << "<?xml version='1.0' encoding='utf-8'?>" << endl
                         << "<!--" << endl
@@ -2642,6 +2776,12 @@ bool Document::saveToFile(const char* filename) const
             throw Base::FileException("Failed to write all data to file", tmp);
         }
 
+        saved = DocumentP::getArchiveFiles(this, writer.getFileList());
+        for (const auto& entry : writer.getFileList()) {
+            Base::LazyFile* lazy = entry.Object->getLazyFile();
+            if (lazy && lazy->isPending())
+                lazyFiles.emplace_back(lazy, entry.FileName);
+        }
         GetApplication().signalSaveDocument(*this);
     }
 
@@ -2672,6 +2812,18 @@ bool Document::saveToFile(const char* filename) const
         policy.apply(fn, filename);
     }
 
+    d->setArchive(filename, std::move(saved));
+
+    // read the files that haven't been read yet from the new archive because the
+    // old one may have been renamed or deleted
+    if (!lazyFiles.empty()) {
+        auto archive = std::make_shared<Base::ZipArchive>(filename);
+        if (archive->isValid()) {
+            for (auto& file : lazyFiles)
+                file.first->move(archive, file.second);
+        }
+    }
+
     signalFinishSave(*this, filename);
 
     return true;
@@ -2756,7 +2908,16 @@ void Document::restore (const char *filename,
     // Note: This file doesn't need to be available if the document has been created
     // without GUI. But if available then follow after all data files of the App document.
     signalRestoreDocument(reader);
+    // parse shapes, meshes etc. on worker threads
+    ParameterGrp::handle hGrp = GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Document");
+    if(hGrp->GetBool("ParallelRestore",false))
+        reader.setConcurrency(QThread::idealThreadCount());
+    // read shapes, meshes etc. only when they are accessed
+    if(hGrp->GetBool("LazyRestore",false))
+        reader.setLazyArchive(std::make_shared<Base::ZipArchive>(filename));
     reader.readFiles(zipstream);
+    d->setArchive(filename, DocumentP::getArchiveFiles(this, reader.FileList));
 
     if (reader.testStatus(Base::XMLReader::ReaderStatus::PartialRestore)) {
         setStatus(Document::PartialRestore, true);
@@ -3471,6 +3632,8 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
     ParameterGrp::handle hGrp = GetApplication().GetParameterGroupByPath(
             "User parameter:BaseApp/Preferences/Document");
     bool canAbort = hGrp->GetBool("CanAbortRecompute",true);
+    // execute independent thread-safe objects concurrently
+    bool parallel = hGrp->GetBool("ParallelRecompute",false);
 
     std::set<App::DocumentObject *> filter;
     size_t idx = 0;
@@ -3484,6 +3647,9 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
             if(canAbort)
                 seq.reset(new Base::SequencerLauncher("Recompute...", topoSortedObjects.size()));
             FC_LOG("Recompute pass " << passes);
+            // a parallel pass always ends at the last object, also if aborted
+            if(parallel && !_recomputeConcurrently(topoSortedObjects,idx,filter,seq.get(),hasError,objectCount))
+                passes = 2;
             for (;idx<topoSortedObjects.size();(seq?seq->next(true):true),++idx) {
                 auto obj = topoSortedObjects[idx];
                 if(!obj->getNameInDocument() || filter.find(obj)!=filter.end())
@@ -3561,6 +3727,245 @@ int Document::recompute(const std::vector<App::DocumentObject*> &objs, bool forc
 
 #endif // USE_OLD_DAG
 
+namespace {
+
+/*
+ * An object of a parallel recompute that is executed on a worker thread and the
+ * property notifications that are sent when it's committed on the main thread.
+ */
+struct RecomputeTask
+{
+    struct Notification {
+        const App::DocumentObject *obj;
+        const App::Property *prop;
+        int kind;
+    };
+
+    App::DocumentObject *obj;
+    int result;
+    bool done;
+    std::vector<Notification> notifications;
+};
+
+thread_local RecomputeTask *_RecomputeTask = 0;
+
+class RecomputeRunnable : public QRunnable
+{
+public:
+    explicit RecomputeRunnable(const std::function<void()> &func) : func(func) {}
+    void run() override {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+// expressions and Python extensions may call into the interpreter
+bool isConcurrent(App::DocumentObject *obj)
+{
+    if(!obj->canRecomputeConcurrently() || obj->ExpressionEngine.numExpressions())
+        return false;
+    for(auto it=obj->extensionBegin(); it!=obj->extensionEnd(); ++it) {
+        if(it->second->isPythonExtension())
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool Document::_deferSignal(const DocumentObject *Who, const Property *What, DeferredSignal kind)
+{
+    RecomputeTask *task = _RecomputeTask;
+    if(!task)
+        return false;
+
+    // the transaction is opened before the first worker is started
+    if(kind == DeferBeforeChange && !d->rollback && !_IsRelabeling) {
+        QMutexLocker lock(&d->recomputeMutex);
+        if (d->activeUndoTransaction)
+            d->activeUndoTransaction->addObjectChange(Who,What);
+    }
+
+    RecomputeTask::Notification notification = {Who, What, kind};
+    task->notifications.push_back(notification);
+    return true;
+}
+
+/*!
+  Executes the objects from \a idx on like the loop in recompute(), but objects that
+  can be recomputed concurrently are executed on a thread pool as soon as all their
+  dependencies in \a objs are committed. The main thread executes the other objects
+  and commits all objects in the order of \a objs: it sends the property notifications
+  deferred by the worker, handles the errors and signals signalRecomputedObject().
+  The size of the pool is given by the parameter RecomputeThreads, by default the
+  number of cores.
+ */
+bool Document::_recomputeConcurrently(const std::vector<App::DocumentObject*> &objs, size_t &idx,
+        std::set<App::DocumentObject*> &filter, Base::SequencerLauncher *seq,
+        bool *hasError, int &objectCount)
+{
+    ParameterGrp::handle hGrp = GetApplication().GetParameterGroupByPath(
+            "User parameter:BaseApp/Preferences/Document");
+    int threads = hGrp->GetInt("RecomputeThreads",0);
+    if(threads <= 0)
+        threads = QThread::idealThreadCount();
+
+    // the dependents of each object and the number of its uncommitted dependencies
+    const size_t count = objs.size();
+    std::unordered_map<const DocumentObject*, size_t> positions;
+    for(size_t i=idx; i<count; ++i)
+        positions[objs[i]] = i;
+    std::vector<std::vector<size_t> > dependents(count);
+    std::vector<int> pending(count,0);
+    for(size_t i=idx; i<count; ++i) {
+        for(auto dep : objs[i]->getOutList()) {
+            auto it = positions.find(dep);
+            if(it!=positions.end() && it->second!=i) {
+                dependents[it->second].push_back(i);
+                ++pending[i];
+            }
+        }
+    }
+
+    QMutex mutex;
+    QWaitCondition finished;
+    std::vector<std::unique_ptr<RecomputeTask> > tasks(count);
+    bool transactionChecked = false;
+    // the destructor of the pool waits for the workers
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    auto start = [&](size_t i) {
+        DocumentObject *obj = objs[i];
+        if(!obj->getNameInDocument() || filter.count(obj) || !isConcurrent(obj) || !obj->mustRecompute())
+            return;
+        if(!transactionChecked) {
+            // open a pending transaction before the workers change properties
+            QMutexLocker lock(&d->recomputeMutex);
+            _checkTransaction(0,0,__LINE__);
+            transactionChecked = true;
+        }
+        RecomputeTask *task = new RecomputeTask();
+        task->obj = obj;
+        task->result = 0;
+        task->done = false;
+        tasks[i].reset(task);
+        pool.start(new RecomputeRunnable([this,task,&mutex,&finished]() {
+            _RecomputeTask = task;
+            int res = _recomputeFeature(task->obj);
+            _RecomputeTask = 0;
+            QMutexLocker lock(&mutex);
+            task->result = res;
+            task->done = true;
+            finished.wakeAll();
+        }));
+    };
+
+    auto wait = [&](RecomputeTask *task) {
+        QMutexLocker lock(&mutex);
+        while(!task->done)
+            finished.wait(&mutex);
+    };
+
+    auto notify = [&](RecomputeTask *task) {
+        for(auto &n : task->notifications) {
+            auto obj = const_cast<DocumentObject*>(n.obj);
+            Document *doc = obj->getDocument();
+            if(!doc)
+                continue;
+            switch(n.kind) {
+            case DeferBeforeChange:
+                doc->signalBeforeChangeObject(*obj,*n.prop);
+                obj->signalBeforeChange(*obj,*n.prop);
+                break;
+            case DeferChange:
+                doc->onChangedProperty(obj,n.prop);
+                obj->signalChanged(*obj,*n.prop);
+                break;
+            case DeferStatusChange:
+                doc->signalChangePropertyEditor(*doc,*n.prop);
+                break;
+            }
+        }
+        task->notifications.clear();
+    };
+
+    // on abort the changes of the objects that are not committed are still notified
+    auto finish = [&]() {
+        pool.waitForDone();
+        for(auto &task : tasks) {
+            if(task)
+                notify(task.get());
+        }
+        idx = count;
+    };
+
+    for(size_t i=idx; i<count; ++i) {
+        if(!pending[i])
+            start(i);
+    }
+
+    try {
+        for (;idx<count;(seq?seq->next(true):true),++idx) {
+            auto obj = objs[idx];
+            RecomputeTask *task = tasks[idx].get();
+            bool doRecompute = false;
+            int res = 0;
+            if(task) {
+                wait(task);
+                notify(task);
+                if(!obj->getNameInDocument() || filter.find(obj)!=filter.end())
+                    continue;
+                doRecompute = true;
+                ++objectCount;
+                res = task->result;
+            }
+            else {
+                if(!obj->getNameInDocument() || filter.find(obj)!=filter.end())
+                    continue;
+                // ask the object if it should be recomputed
+                if (obj->mustRecompute()) {
+                    doRecompute = true;
+                    ++objectCount;
+                    res = _recomputeFeature(obj);
+                }
+            }
+            if(res) {
+                if(hasError)
+                    *hasError = true;
+                if(res < 0) {
+                    finish();
+                    return false;
+                }
+                // if something happened filter all object in its
+                // inListRecursive from the queue then proceed
+                obj->getInListEx(filter,true);
+                filter.insert(obj);
+                continue;
+            }
+            if(obj->isTouched() || doRecompute) {
+                signalRecomputedObject(*obj);
+                obj->purgeTouched();
+                // set all dependent object touched to force recompute
+                for (auto inObjIt : obj->getInList())
+                    inObjIt->enforceRecompute();
+            }
+            for(auto i : dependents[idx]) {
+                if(--pending[i] == 0)
+                    start(i);
+            }
+        }
+    }
+    catch(...) {
+        finish();
+        throw;
+    }
+
+    return true;
+}
+
 /*!
   Does almost the same as topologicalSort() until no object with an input degree of zero
   can be found. It then searches for objects with an output degree of zero until neither
@@ -41,6 +41,7 @@
 
 namespace Base {
     class Writer;
+    class SequencerLauncher;
 }
 
 namespace App
@@ -537,6 +538,23 @@ protected:
     /// helper which Recompute only this feature
     /// @return 0 if succeeded, 1 if failed, -1 if aborted by user.
     int _recomputeFeature(DocumentObject* Feat);
+    /// executes the objects from \a idx on, running the independent thread-safe ones concurrently
+    /// @return false if aborted by user.
+    bool _recomputeConcurrently(const std::vector<App::DocumentObject*> &objs, size_t &idx,
+            std::set<App::DocumentObject*> &filter, Base::SequencerLauncher *seq,
+            bool *hasError, int &objectCount);
+    /// the property notifications of the objects executed on worker threads
+    enum DeferredSignal {
+        DeferBeforeChange,
+        DeferChange,
+        DeferStatusChange
+    };
+    /** Called for the property notifications of an object. If the calling thread is a
+     *  worker of a parallel recompute, the property change is recorded for undo and the
+     *  notification is sent on the main thread when the object is committed.
+     *  @return true if the notification is deferred.
+     */
+    bool _deferSignal(const DocumentObject *Who, const Property *What, DeferredSignal kind);
     void _clearRedos();
 
     /// refresh the internal dependency graph
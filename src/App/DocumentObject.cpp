@@ -691,6 +691,10 @@ void DocumentObject::onBeforeChange(const Property* prop)
     if (prop == &Label)
         oldLabel = Label.getStrValue();
 
+    // the notifications of a parallel recompute are sent on the main thread
+    if (_pDoc && _pDoc->_deferSignal(this, prop, Document::DeferBeforeChange))
+        return;
+
     if (_pDoc)
         onBeforeChangeProperty(_pDoc, prop);
 
@@ -741,6 +745,9 @@ void DocumentObject::onChanged(const Property* prop)
     //call the parent for appropriate handling
     TransactionalObject::onChanged(prop);
 
+    if (_pDoc && _pDoc->_deferSignal(this, prop, Document::DeferChange))
+        return;
+
     // Now signal the view provider
     if (_pDoc)
         _pDoc->onChangedProperty(this,prop);
@@ -1215,6 +1222,7 @@ bool DocumentObject::redirectSubName(std::ostringstream &, DocumentObject *, Doc
 
 void DocumentObject::onPropertyStatusChanged(const Property &prop, unsigned long oldStatus) {
     (void)oldStatus;
-    if(!Document::isAnyRestoring() && getNameInDocument() && getDocument())
+    if(!Document::isAnyRestoring() && getNameInDocument() && getDocument()
+            && !getDocument()->_deferSignal(this, &prop, Document::DeferStatusChange))
         getDocument()->signalChangePropertyEditor(*getDocument(),prop);
 }
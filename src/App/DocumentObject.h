@@ -299,6 +299,17 @@ public:
      */
     virtual short mustExecute(void) const;
 
+    /** Returns true if the object may be executed on a worker thread
+     *
+     * If the parameter ParallelRecompute is set, the document executes such
+     * objects concurrently with the objects they don't depend on. execute()
+     * must then only read the properties of the object and its dependencies,
+     * only change the properties of the object itself and use neither Python
+     * nor the GUI. The change notifications are sent on the main thread when
+     * the object is committed in the order of the dependency list.
+     */
+    virtual bool canRecomputeConcurrently() const {return false;}
+
     /** Recompute only this feature
      *
      * @param recursive: set to true to recompute any dependent objects as well
@@ -199,6 +199,10 @@ public:
         }
         return DocumentObject::StdReturn;
     }
+    /// the Python implementation needs the interpreter lock
+    virtual bool canRecomputeConcurrently() const override {
+        return false;
+    }
     virtual const char* getViewProviderNameOverride(void) const override {
         viewProviderName = imp->getViewProviderName();
         if(viewProviderName.size())
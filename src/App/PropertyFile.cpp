@@ -423,7 +423,17 @@ void PropertyFileIncluded::Save (Base::Writer &writer) const
         // instead initiate an extra file 
         if (!_cValue.empty()) {
             Base::FileInfo file(_cValue.c_str());
-            std::string filename = writer.addFile(file.fileName().c_str(), this);
+            // compressing archives and images again gains nothing
+            static const char* compressed[] = {"7z","bz2","fcstd","gif","gz","jpeg","jpg",
+                                               "png","xz","zip",0};
+            bool compress = true;
+            for (const char** ext = compressed; *ext; ++ext) {
+                if (file.hasExtension(*ext)) {
+                    compress = false;
+                    break;
+                }
+            }
+            std::string filename = writer.addFile(file.fileName().c_str(), this, compress);
             filename = encodeAttribute(filename);
             writer.Stream() << writer.ind() << "<FileIncluded file=\""
                             << filename << "\"/>" << std::endl;
@@ -362,18 +362,14 @@ void PropertyVectorList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
+    static_assert(sizeof(Base::Vector3d) == 3 * sizeof(double), "Vector3d must consist of three doubles");
+    const double* data = reinterpret_cast<const double*>(_lValueList.data());
     if (!isSinglePrecision()) {
-        for (std::vector<Base::Vector3d>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            str << it->x << it->y << it->z;
-        }
+        str.write(data, 3 * _lValueList.size());
     }
     else {
-        for (std::vector<Base::Vector3d>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            float x = (float)it->x;
-            float y = (float)it->y;
-            float z = (float)it->z;
-            str << x << y << z;
-        }
+        std::vector<float> values(data, data + 3 * _lValueList.size());
+        str.write(values.data(), values.size());
     }
 }
 
@@ -383,17 +379,14 @@ void PropertyVectorList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3d> values(uCt);
+    double* data = reinterpret_cast<double*>(values.data());
     if (!isSinglePrecision()) {
-        for (std::vector<Base::Vector3d>::iterator it = values.begin(); it != values.end(); ++it) {
-            str >> it->x >> it->y >> it->z;
-        }
+        str.read(data, 3 * values.size());
     }
     else {
-        float x,y,z;
-        for (std::vector<Base::Vector3d>::iterator it = values.begin(); it != values.end(); ++it) {
-            str >> x >> y >> z;
-            it->Set(x, y, z);
-        }
+        std::vector<float> floats(3 * values.size());
+        str.read(floats.data(), floats.size());
+        std::copy(floats.begin(), floats.end(), data);
     }
     setValues(values);
 }
@@ -1283,15 +1283,11 @@ void PropertyFloatList::SaveDocFile (Base::Writer &writer) const
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
     if (!isSinglePrecision()) {
-        for (std::vector<double>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            str << *it;
-        }
+        str.write(_lValueList.data(), _lValueList.size());
     }
     else {
-        for (std::vector<double>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-            float v = (float)*it;
-            str << v;
-        }
+        std::vector<float> values(_lValueList.begin(), _lValueList.end());
+        str.write(values.data(), values.size());
     }
 }
 
@@ -1302,16 +1298,12 @@ void PropertyFloatList::RestoreDocFile(Base::Reader &reader)
     str >> uCt;
     std::vector<double> values(uCt);
     if (!isSinglePrecision()) {
-        for (std::vector<double>::iterator it = values.begin(); it != values.end(); ++it) {
-            str >> *it;
-        }
+        str.read(values.data(), values.size());
     }
     else {
-        for (std::vector<double>::iterator it = values.begin(); it != values.end(); ++it) {
-            float val;
-            str >> val;
-            (*it) = val;
-        }
+        std::vector<float> floats(uCt);
+        str.read(floats.data(), floats.size());
+        std::copy(floats.begin(), floats.end(), values.begin());
     }
     setValues(values);
 }
@@ -2507,9 +2499,12 @@ void PropertyColorList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
+    std::vector<uint32_t> values;
+    values.reserve(_lValueList.size());
     for (std::vector<App::Color>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->getPackedValue();
+        values.push_back(it->getPackedValue());
     }
+    str.write(values.data(), values.size());
 }
 
 void PropertyColorList::RestoreDocFile(Base::Reader &reader)
@@ -2518,10 +2513,10 @@ void PropertyColorList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Color> values(uCt);
-    uint32_t value; // must be 32 bit long
-    for (std::vector<App::Color>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> value;
-        it->setPackedValue(value);
+    std::vector<uint32_t> packed(uCt); // must be 32 bit long
+    str.read(packed.data(), packed.size());
+    for (std::size_t i = 0; i < packed.size(); i++) {
+        values[i].setPackedValue(packed[i]);
     }
     setValues(values);
 }
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <QFile>
+# include <QString>
+#endif
+
+#include "MappedFile.h"
+#include "FileInfo.h"
+
+using namespace Base;
+
+MappedFile::MappedFile()
+  : _file(nullptr), _data(nullptr), _size(0)
+{
+}
+
+MappedFile::MappedFile(const FileInfo& fi)
+  : _file(nullptr), _data(nullptr), _size(0)
+{
+    open(fi);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const FileInfo& fi)
+{
+    close();
+
+    std::string path = fi.filePath();
+    _file = new QFile(QString::fromUtf8(path.c_str()));
+    if (!_file->open(QIODevice::ReadOnly)) {
+        close();
+        return false;
+    }
+
+    qint64 len = _file->size();
+    if (len > 0) {
+        uchar* ptr = _file->map(0, len);
+        if (ptr) {
+            _data = reinterpret_cast<const char*>(ptr);
+        }
+        else {
+            _buffer.resize(static_cast<std::size_t>(len));
+            if (_file->read(&_buffer[0], len) != len) {
+                close();
+                return false;
+            }
+            _data = &_buffer[0];
+        }
+        _size = static_cast<std::size_t>(len);
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_file) {
+        if (_data && _buffer.empty())
+            _file->unmap(reinterpret_cast<uchar*>(const_cast<char*>(_data)));
+        _file->close();
+        delete _file;
+    }
+
+    std::vector<char>().swap(_buffer);
+    _file = nullptr;
+    _data = nullptr;
+    _size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return _file != nullptr;
+}
+
+const char* MappedFile::data() const
+{
+    return _data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return _size;
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef BASE_MAPPEDFILE_H
+#define BASE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <vector>
+
+class QFile;
+
+namespace Base
+{
+
+class FileInfo;
+
+/**
+ * The MappedFile class maps the content of a file read-only into memory.
+ * This is useful for readers of large files that parse the data directly
+ * from memory or that split it into chunks which are processed in parallel.
+ * If the file system doesn't support mapping the content is read into a
+ * buffer instead. The mapping is released when the object gets destroyed.
+ * \code
+ * Base::MappedFile file(fi);
+ * if (file.isOpen()) {
+ *     const char* data = file.data();
+ *     std::size_t size = file.size();
+ *     ...
+ * }
+ * \endcode
+ */
+class BaseExport MappedFile
+{
+public:
+    MappedFile();
+    /// Opens the file \a fi and maps its content into memory.
+    explicit MappedFile(const FileInfo& fi);
+    ~MappedFile();
+
+    /** Maps the content of the file \a fi into memory. An already opened
+     * file will be closed before. Returns true if the file could be read,
+     * false otherwise.
+     */
+    bool open(const FileInfo& fi);
+    /// Releases the mapping and closes the file.
+    void close();
+    /// Returns true if a file is mapped into memory.
+    bool isOpen() const;
+    /// Returns the start of the mapped memory block or null if the file is empty.
+    const char* data() const;
+    /// Returns the size of the mapped memory block.
+    std::size_t size() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    QFile* _file;
+    std::vector<char> _buffer;
+    const char* _data;
+    std::size_t _size;
+};
+
+} // namespace Base
+
+#endif // BASE_MAPPEDFILE_H
@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <exception>
+# include <memory>
+# include <QMutex>
+# include <QMutexLocker>
+# include <QRunnable>
+# include <QThread>
+# include <QThreadPool>
+# include <QWaitCondition>
+#endif
+
+#include "Parallel.h"
+#include "Exception.h"
+#include "Sequencer.h"
+
+using namespace Base;
+
+namespace {
+
+/*
+ * The state of a parallel loop that is shared by the calling thread and the workers.
+ * Workers that start after all tasks have been taken return immediately, therefore the
+ * calling thread only waits for the tasks and never for the workers.
+ */
+struct ParallelLoop
+{
+    ParallelLoop(std::size_t count, const std::function<void(std::size_t)>& func,
+                 SequencerLauncher* seq)
+      : count(count), func(func), seq(seq), next(0), failed(false), done(0)
+    {
+    }
+
+    // Runs tasks until none is left. The calling thread passes the progress after each task.
+    void work(bool caller)
+    {
+        for (;;) {
+            std::size_t task = next++;
+            if (task >= count)
+                return;
+            if (!failed && !(seq && seq->isAborted())) {
+                try {
+                    func(task);
+                }
+                catch (...) {
+                    QMutexLocker lock(&mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    failed = true;
+                }
+            }
+            {
+                QMutexLocker lock(&mutex);
+                if (++done == count)
+                    finished.wakeAll();
+            }
+            if (caller && seq)
+                seq->update(true);
+        }
+    }
+
+    // Waits until all tasks are finished
+    void wait()
+    {
+        QMutexLocker lock(&mutex);
+        while (done < count) {
+            if (seq) {
+                lock.unlock();
+                seq->update(true);
+                lock.relock();
+                finished.wait(&mutex, 10);
+            }
+            else {
+                finished.wait(&mutex);
+            }
+        }
+    }
+
+    const std::size_t count;
+    // only called while the calling thread waits
+    const std::function<void(std::size_t)>& func;
+    SequencerLauncher* seq;
+    std::atomic<std::size_t> next;
+    std::atomic<bool> failed;
+    QMutex mutex;
+    QWaitCondition finished;
+    std::size_t done;
+    std::exception_ptr error;
+};
+
+class ParallelRunnable : public QRunnable
+{
+public:
+    explicit ParallelRunnable(const std::shared_ptr<ParallelLoop>& loop) : loop(loop) {}
+    void run() override {
+        loop->work(false);
+    }
+
+private:
+    std::shared_ptr<ParallelLoop> loop;
+};
+
+void runTasks(std::size_t count, const std::function<void(std::size_t)>& func, SequencerLauncher* seq)
+{
+    if (count == 0)
+        return;
+
+    std::shared_ptr<ParallelLoop> loop = std::make_shared<ParallelLoop>(count, func, seq);
+    QThreadPool* pool = QThreadPool::globalInstance();
+    std::size_t workers = std::min<std::size_t>(count - 1, std::max(pool->maxThreadCount(), 1));
+    for (std::size_t i = 0; i < workers; i++)
+        pool->start(new ParallelRunnable(loop));
+
+    loop->work(true);
+    loop->wait();
+
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+    if (seq && seq->isAborted())
+        throw AbortException("User aborted");
+}
+
+void runBlocks(std::size_t count, std::size_t minBlock,
+               const std::function<void(std::size_t, std::size_t, std::size_t)>& func,
+               SequencerLauncher* seq)
+{
+    if (count == 0)
+        return;
+
+    std::size_t blocks = parallel_blocks(count, minBlock);
+    std::function<void(std::size_t)> task = [&](std::size_t block) {
+        std::size_t first = count * block / blocks;
+        std::size_t last = count * (block + 1) / blocks;
+        func(block, first, last);
+        if (seq)
+            seq->advance(last - first);
+    };
+    runTasks(blocks, task, seq);
+}
+
+}
+
+std::size_t Base::parallel_blocks(std::size_t count, std::size_t minBlock)
+{
+    std::size_t threads = static_cast<std::size_t>(std::max(1, QThread::idealThreadCount()));
+    return std::max<std::size_t>(1, std::min(4 * threads, count / std::max<std::size_t>(minBlock, 1)));
+}
+
+void Base::parallel_for(std::size_t count, const std::function<void(std::size_t)>& func)
+{
+    runTasks(count, func, nullptr);
+}
+
+void Base::parallel_for(std::size_t count, std::size_t minBlock,
+                        const std::function<void(std::size_t, std::size_t, std::size_t)>& func)
+{
+    runBlocks(count, minBlock, func, nullptr);
+}
+
+void Base::parallel_for(std::size_t count, const std::function<void(std::size_t)>& func,
+                        SequencerLauncher& seq)
+{
+    std::function<void(std::size_t)> task = [&](std::size_t i) {
+        func(i);
+        seq.advance();
+    };
+    runTasks(count, task, &seq);
+}
+
+void Base::parallel_for(std::size_t count, std::size_t minBlock,
+                        const std::function<void(std::size_t, std::size_t, std::size_t)>& func,
+                        SequencerLauncher& seq)
+{
+    runBlocks(count, minBlock, func, &seq);
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef BASE_PARALLEL_H
+#define BASE_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace Base
+{
+
+class SequencerLauncher;
+
+/** \name Parallel loops
+ * The loops run their tasks on the global thread pool and return once all of them are
+ * finished. The calling thread works on the tasks as well, so a loop may also be started
+ * from within a task of another loop. If a task throws an exception the pending tasks are
+ * skipped and the first exception is rethrown by the calling thread.
+ * \code
+ * std::vector<float> lengths(edges.size());
+ * Base::parallel_for(edges.size(), 4096, [&](std::size_t, std::size_t first, std::size_t last) {
+ *     for (std::size_t i = first; i < last; i++)
+ *         lengths[i] = edges[i].Length();
+ * });
+ * \endcode
+ */
+//@{
+/** Returns the number of blocks the range-based parallel_for() splits \a count items into.
+ * Each block has at least \a minBlock items and there are at most four blocks per thread
+ * so that blocks of different costs can be balanced.
+ */
+BaseExport std::size_t parallel_blocks(std::size_t count, std::size_t minBlock);
+/** Calls \a func(i) for each i in [0, count) as a separate task. This is meant for a
+ * small number of large work items, e.g. the parts of a file that are parsed in parallel.
+ */
+BaseExport void parallel_for(std::size_t count, const std::function<void(std::size_t)>& func);
+/** Splits [0, count) into parallel_blocks(count, minBlock) consecutive ranges and calls
+ * \a func(block, first, last) for each of them. The block with index b covers
+ * [count * b / blocks, count * (b + 1) / blocks), so results per block can be stored
+ * at the block index.
+ */
+BaseExport void parallel_for(std::size_t count, std::size_t minBlock,
+                             const std::function<void(std::size_t, std::size_t, std::size_t)>& func);
+/** Same as parallel_for() but with progress indication. For each finished item \a seq is
+ * advanced by one step and the calling thread passes the progress to the sequencer. If the
+ * user cancels the operation the pending tasks are skipped and an AbortException is thrown
+ * once the running tasks are finished.
+ */
+BaseExport void parallel_for(std::size_t count, const std::function<void(std::size_t)>& func,
+                             SequencerLauncher& seq);
+/** Same as the range-based parallel_for() but with progress indication. For each finished
+ * block \a seq is advanced by the number of its items.
+ */
+BaseExport void parallel_for(std::size_t count, std::size_t minBlock,
+                             const std::function<void(std::size_t, std::size_t, std::size_t)>& func,
+                             SequencerLauncher& seq);
+//@}
+
+} // namespace Base
+
+#endif // BASE_PARALLEL_H
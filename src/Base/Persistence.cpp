@@ -25,8 +25,10 @@
 #include "Writer.h"
 #include "Reader.h"
 #include "PyObjectBase.h"
+#include "Stream.h"
 
 #ifndef _PreComp_
+# include <iterator>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -68,10 +70,39 @@ void Persistence::SaveDocFile (Writer &/*writer*/) const
 {
 }
 
+bool Persistence::canSaveDocFileConcurrently(const Writer &/*writer*/) const
+{
+    return false;
+}
+
 void Persistence::RestoreDocFile(Reader &/*reader*/)
 {
 }
 
+std::function<void()> Persistence::parseDocFile(Reader &reader)
+{
+    std::shared_ptr<std::string> data = std::make_shared<std::string>
+        (std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
+    std::string name = reader.getFileName();
+    int version = reader.getFileVersion();
+    return [this, data, name, version]() {
+        Base::Streambuf buf(*data);
+        std::istream str(&buf);
+        Reader file(str, name, version);
+        RestoreDocFile(file);
+    };
+}
+
+bool Persistence::canParseDocFile() const
+{
+    return false;
+}
+
+LazyFile* Persistence::getLazyFile() const
+{
+    return 0;
+}
+
 std::string Persistence::encodeAttribute(const std::string& str)
 {
     std::string tmp;
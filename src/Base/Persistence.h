@@ -28,11 +28,13 @@
 
 
 #include <assert.h>
+#include <functional>
 
 #include "BaseClass.h"
 
 namespace Base
 {
+class LazyFile;
 class Reader;
 class Writer;
 class XMLReader;
@@ -116,6 +118,12 @@ public:
      * In this method you can simply stream your content to the file (Base::Writer inheriting from ostream).
      */
     virtual void SaveDocFile (Writer &/*writer*/) const;
+    /** Returns true if SaveDocFile() can run on a worker thread while other objects are
+     * saved, by default false. It then gets a writer of its own that has the modes of
+     * \a writer but doesn't accept further files.
+     * @see ZipWriter::setConcurrency()
+     */
+    virtual bool canSaveDocFileConcurrently(const Writer &writer) const;
     /** This method is used to restore large amounts of data from a file
      * In this method you simply stream in your SaveDocFile() saved data.
      * Again you have to apply for the call of this method in the Restore() call:
@@ -146,6 +154,32 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** This method is used to restore a file on a worker thread.
+     * If the files are restored concurrently (see XMLReader::setConcurrency()) it's called
+     * instead of RestoreDocFile() for all objects whose canParseDocFile() returns true.
+     * It must only parse the file without changing the object. The returned function
+     * is called on the main thread in the order of the files and sets the parsed data:
+     * \code
+     * std::function<void()> PropertyMeshKernel::parseDocFile(Base::Reader &reader)
+     * {
+     *     std::shared_ptr<MeshObject> mesh = std::make_shared<MeshObject>();
+     *     mesh->load(reader);
+     *     return [this, mesh]() {
+     *         swapMesh(mesh->getKernel());
+     *     };
+     * }
+     * \endcode
+     * The default implementation keeps the content of the file and calls RestoreDocFile()
+     * with it on the main thread.
+     */
+    virtual std::function<void()> parseDocFile(Reader &reader);
+    /// Returns true if parseDocFile() can run on a worker thread, by default false
+    virtual bool canParseDocFile() const;
+    /** Returns the file of this object whose reading can be deferred until its data is
+     * accessed, or null if the object doesn't support it, which is the default.
+     * @see XMLReader::setLazyArchive()
+     */
+    virtual LazyFile* getLazyFile() const;
     /// Encodes an attribute upon saving.
     static std::string encodeAttribute(const std::string&);
 
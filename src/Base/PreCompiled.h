@@ -63,6 +63,7 @@
 #include <set>
 #include <stack>
 #include <queue>
+#include <deque>
 #include <memory>
 #include <bitset>
 
@@ -122,8 +123,11 @@
 #include <QReadWriteLock>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QTime>
 #include <QUuid>
+#include <QWaitCondition>
 
 
 #endif //_PreComp_
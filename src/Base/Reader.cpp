@@ -28,6 +28,13 @@
 # include <xercesc/sax/SAXException.hpp>
 # include <xercesc/sax2/XMLReaderFactory.hpp>
 # include <xercesc/sax2/SAX2XMLReader.hpp>
+# include <deque>
+# include <iterator>
+# include <QMutex>
+# include <QMutexLocker>
+# include <QRunnable>
+# include <QThreadPool>
+# include <QWaitCondition>
 #endif
 
 #include <locale>
@@ -40,6 +47,7 @@
 #include "InputSource.h"
 #include "Console.h"
 #include "Sequencer.h"
+#include "Stream.h"
 
 #ifdef _MSC_VER
 #include <zipios++/zipios-config.h>
@@ -64,7 +72,7 @@ using namespace std;
 Base::XMLReader::XMLReader(const char* FileName, std::istream& str)
   : DocumentSchema(0), ProgramVersion(""), FileVersion(0), Level(0),
     CharacterCount(0), ReadType(None), _File(FileName), _valid(false),
-    _verbose(true)
+    _verbose(true), _concurrency(0)
 {
 #ifdef _MSC_VER
     str.imbue(std::locale::empty());
@@ -307,6 +315,35 @@ void Base::XMLReader::readBinFile(const char* filename)
     to.close();
 }
 
+namespace {
+
+class ParseRunnable : public QRunnable
+{
+public:
+    explicit ParseRunnable(const std::function<void()> &func) : func(func) {}
+    void run() override {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+/*
+ * An embedded file that is parsed on a worker thread and the function
+ * that sets its data on the main thread.
+ */
+struct ParsedFile
+{
+    std::string entry;
+    std::string data;
+    std::function<void()> commit;
+    bool done = false;
+    bool failed = false;
+};
+
+}
+
 void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
 {
     // It's possible that not all objects inside the document could be created, e.g. if a module
@@ -326,6 +363,37 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
         // project file was created without GUI
         return;
     }
+
+    // With concurrency the files whose objects support it are inflated here and parsed on
+    // worker threads. Their data is set in the order of the files, all files that follow
+    // are read after the pending files have been set.
+    QMutex mutex;
+    QWaitCondition parsed;
+    std::deque<std::shared_ptr<ParsedFile> > pending;
+    // the destructor of the pool waits for the workers
+    QThreadPool pool;
+    if (_concurrency > 0)
+        pool.setMaxThreadCount(_concurrency);
+
+    auto commit = [&]() {
+        std::shared_ptr<ParsedFile> file = pending.front();
+        pending.pop_front();
+        {
+            QMutexLocker lock(&mutex);
+            while (!file->done)
+                parsed.wait(&mutex);
+        }
+        try {
+            if (!file->failed && file->commit)
+                file->commit();
+        }
+        catch (...) {
+            file->failed = true;
+        }
+        if (file->failed)
+            Base::Console().Error("Reading failed from embedded file: %s\n", file->entry.c_str());
+    };
+
     std::vector<FileEntry>::const_iterator it = FileList.begin();
     Base::SequencerLauncher seq("Importing project files...", FileList.size());
     while (entry->isValid() && it != FileList.end()) {
@@ -336,7 +404,54 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
             ++jt;
         // If this condition is true both file names match and we can read-in the data, otherwise
         // no file name for the current entry in the zip was registered.
-        if (jt != FileList.end()) {
+        if (jt != FileList.end() && _lazyArchive && jt->Object->getLazyFile()
+                && _lazyArchive->hasEntry(jt->FileName)) {
+            // the file is read when the data of the object is accessed
+            jt->Object->getLazyFile()->defer(_lazyArchive, jt->FileName, FileVersion);
+            it = jt + 1;
+        }
+        else if (jt != FileList.end() && _concurrency > 0 && jt->Object->canParseDocFile()) {
+            std::shared_ptr<ParsedFile> file = std::make_shared<ParsedFile>();
+            file->entry = entry->toString();
+            try {
+                file->data.assign(std::istreambuf_iterator<char>(zipstream),
+                                  std::istreambuf_iterator<char>());
+            }
+            catch (...) {
+                file->failed = true;
+                file->done = true;
+            }
+
+            if (!file->done) {
+                Base::Persistence* object = jt->Object;
+                std::string name = jt->FileName;
+                int version = FileVersion;
+                pool.start(new ParseRunnable([file, object, name, version, &mutex, &parsed]() {
+                    try {
+                        Base::Streambuf buf(file->data);
+                        std::istream str(&buf);
+                        Base::Reader reader(str, name, version);
+                        file->commit = object->parseDocFile(reader);
+                    }
+                    catch (...) {
+                        file->failed = true;
+                    }
+                    std::string().swap(file->data);
+                    QMutexLocker lock(&mutex);
+                    file->done = true;
+                    parsed.wakeAll();
+                }));
+            }
+
+            pending.push_back(file);
+            // limit the memory of the inflated files
+            if (pending.size() > 2 * static_cast<std::size_t>(_concurrency))
+                commit();
+            it = jt + 1;
+        }
+        else if (jt != FileList.end()) {
+            while (!pending.empty())
+                commit();
             try {
                 Base::Reader reader(zipstream, jt->FileName, FileVersion);
                 jt->Object->RestoreDocFile(reader);
@@ -366,6 +481,9 @@ void Base::XMLReader::readFiles(zipios::ZipInputStream &zipstream) const
             break;
         }
     }
+
+    while (!pending.empty())
+        commit();
 }
 
 const char *Base::XMLReader::addFile(const char* Name, Base::Persistence *Object)
@@ -596,3 +714,165 @@ std::shared_ptr<Base::XMLReader> Base::Reader::getLocalReader() const
 {
     return(this->localreader);
 }
+
+// ----------------------------------------------------------------------------
+
+Base::ZipArchive::ZipArchive(const std::string& name)
+  : name(name), size(0)
+{
+    Base::FileInfo fi(name);
+    modified = fi.lastModified();
+    size = fi.size();
+    try {
+        zip.reset(new zipios::ZipFile(name));
+    }
+    catch (const std::exception&) {
+        // e.g. a file name that cannot be opened with std::ifstream
+    }
+}
+
+Base::ZipArchive::~ZipArchive()
+{
+}
+
+bool Base::ZipArchive::isValid() const
+{
+    return zip && zip->isValid();
+}
+
+bool Base::ZipArchive::isUnchanged() const
+{
+    Base::FileInfo fi(name);
+    return fi.exists() && fi.lastModified() == modified && fi.size() == size;
+}
+
+void Base::ZipArchive::checkUnchanged() const
+{
+    if (!isUnchanged())
+        throw Base::FileException("File has been changed since it was opened", Base::FileInfo(name));
+}
+
+bool Base::ZipArchive::hasEntry(const std::string& file) const
+{
+    return isValid() && zip->getEntry(file) != 0;
+}
+
+bool Base::ZipArchive::readEntry(const std::string& file, const std::function<void(std::istream&)>& func) const
+{
+    if (!isValid())
+        return false;
+    zipios::ConstEntryPointer entry = zip->getEntry(file);
+    if (!entry)
+        return false;
+    checkUnchanged();
+
+    // open the stream here because zipios doesn't support Unicode file names
+    Base::ifstream str(Base::FileInfo(name), std::ios::in | std::ios::binary);
+    if (!str)
+        return false;
+    zipios::ZipInputStream zipstream(str, static_cast<const zipios::ZipCDirEntry*>
+                                     (entry.get())->getLocalHeaderOffset());
+    func(zipstream);
+    return true;
+}
+
+bool Base::ZipArchive::readRawEntry(const std::string& file, zipios::ZipCDirEntry& entry, std::string& data) const
+{
+    if (!isValid())
+        return false;
+    zipios::ConstEntryPointer ent = zip->getEntry(file);
+    if (!ent)
+        return false;
+    const zipios::ZipCDirEntry* cdir = static_cast<const zipios::ZipCDirEntry*>(ent.get());
+    checkUnchanged();
+
+    Base::ifstream str(Base::FileInfo(name), std::ios::in | std::ios::binary);
+    // skip the local header whose name and extra field may differ from the central directory
+    unsigned char header[30];
+    str.seekg(cdir->getLocalHeaderOffset());
+    if (!str.read(reinterpret_cast<char*>(header), sizeof(header))
+            || header[0] != 'P' || header[1] != 'K' || header[2] != 3 || header[3] != 4)
+        return false;
+    int skip = (header[26] | header[27] << 8) + (header[28] | header[29] << 8);
+    str.seekg(skip, std::ios::cur);
+    data.resize(cdir->getCompressedSize());
+    if (!data.empty() && !str.read(&data[0], data.size()))
+        return false;
+
+    entry = *cdir;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace {
+// serializes the reading of deferred files, which may be accessed from several threads
+QMutex& lazyMutex()
+{
+    static QMutex mutex(QMutex::Recursive);
+    return mutex;
+}
+}
+
+Base::LazyFile::LazyFile(const std::function<void(Reader&)>& func)
+  : func(func), version(0), pending(false)
+{
+}
+
+Base::LazyFile::~LazyFile()
+{
+}
+
+void Base::LazyFile::defer(const std::shared_ptr<ZipArchive>& archive, const std::string& name, int version)
+{
+    QMutexLocker lock(&lazyMutex());
+    this->archive = archive;
+    this->name = name;
+    this->version = version;
+    this->pending = true;
+}
+
+void Base::LazyFile::move(const std::shared_ptr<ZipArchive>& archive, const std::string& name)
+{
+    QMutexLocker lock(&lazyMutex());
+    if (pending) {
+        this->archive = archive;
+        this->name = name;
+    }
+}
+
+void Base::LazyFile::read()
+{
+    if (!pending)
+        return;
+    QMutexLocker lock(&lazyMutex());
+    if (!pending)
+        return;
+
+    // the offsets of the central directory are useless if the project file has been
+    // replaced, so don't drop the data silently but let the caller know
+    if (!archive->isUnchanged())
+        throw Base::FileException("Project file has been changed since it was opened", Base::FileInfo(archive->getName()));
+
+    bool ok = false;
+    try {
+        ok = archive->readEntry(name, [this](std::istream& str) {
+            Base::Reader reader(str, name, version);
+            func(reader);
+        });
+    }
+    catch (...) {
+    }
+    if (!ok)
+        Base::Console().Error("Reading failed from embedded file: %s\n", name.c_str());
+
+    archive.reset();
+    pending = false;
+}
+
+void Base::LazyFile::reset()
+{
+    QMutexLocker lock(&lazyMutex());
+    archive.reset();
+    pending = false;
+}
@@ -28,6 +28,8 @@
 #include <map>
 #include <bitset>
 #include <memory>
+#include <atomic>
+#include <functional>
 
 #include <xercesc/framework/XMLPScanToken.hpp>
 #include <xercesc/sax2/Attributes.hpp>
@@ -47,6 +49,7 @@ XERCES_CPP_NAMESPACE_END
 
 namespace Base
 {
+class ZipArchive;
 
 
 /** The XML reader class
@@ -130,6 +133,18 @@ public:
     bool isValid() const { return _valid; }
     bool isVerbose() const { return _verbose; }
     void setVerbose(bool on) { _verbose = on; }
+    /** Sets the number of worker threads that parse the files in readFiles().
+     * With 0, the default, all files are read one after another.
+     * @see Base::Persistence::parseDocFile()
+     */
+    void setConcurrency(int threads) { _concurrency = threads; }
+    int getConcurrency() const { return _concurrency; }
+    /** Sets the archive that is read in readFiles(). The files of the objects that
+     * support it are then only read when their data is accessed.
+     * @see Base::Persistence::getLazyFile()
+     */
+    void setLazyArchive(const std::shared_ptr<ZipArchive>& archive) { _lazyArchive = archive; }
+    const std::shared_ptr<ZipArchive>& getLazyArchive() const { return _lazyArchive; }
 
     /** @name Parser handling */
     //@{
@@ -286,6 +301,8 @@ protected:
     XERCES_CPP_NAMESPACE_QUALIFIER XMLPScanToken token;
     bool _valid;
     bool _verbose;
+    int _concurrency;
+    std::shared_ptr<ZipArchive> _lazyArchive;
 
     std::vector<std::string> FileNames;
 
@@ -310,6 +327,80 @@ private:
     std::shared_ptr<Base::XMLReader> localreader;
 };
 
+/** Gives access to the entries of a zip archive on disk by their names, e.g. to read
+ * the files of a project when they are needed. The modification time and size of the
+ * file are recorded when it is opened, and reading an entry throws a FileException if
+ * the file has been changed since then, because the central directory would no longer
+ * match the data.
+ */
+class BaseExport ZipArchive
+{
+public:
+    /// reads the central directory of the archive, see isValid()
+    explicit ZipArchive(const std::string& name);
+    ~ZipArchive();
+
+    const std::string& getName() const { return name; }
+    bool isValid() const;
+    /// returns true if the file still has the modification time and size it had when opened
+    bool isUnchanged() const;
+    bool hasEntry(const std::string& file) const;
+    /// calls \a func with the inflated data of an entry, returns false if there is no such entry
+    bool readEntry(const std::string& file, const std::function<void(std::istream&)>& func) const;
+    /** Reads the central directory entry and the compressed data of an entry
+     * to copy it into another archive, see ZipWriter::copyFile().
+     */
+    bool readRawEntry(const std::string& file, zipios::ZipCDirEntry& entry, std::string& data) const;
+
+private:
+    void checkUnchanged() const;
+
+private:
+    std::string name;
+    std::unique_ptr<zipios::ZipFile> zip;
+    TimeInfo modified;
+    unsigned int size;
+};
+
+/** An embedded file of a project whose reading has been deferred until the data
+ * of its object is accessed, see XMLReader::setLazyArchive(). The object calls
+ * read() in all methods that access its data and reset() when its data is replaced.
+ */
+class BaseExport LazyFile
+{
+public:
+    /// \a func sets the data of the object from the file without notifying a change
+    explicit LazyFile(const std::function<void(Reader&)>& func);
+    ~LazyFile();
+
+    /// defers reading the file \a name of \a archive until read() is called
+    void defer(const std::shared_ptr<ZipArchive>& archive, const std::string& name, int version);
+    /// refers to the same file in another archive, e.g. after it has been copied there
+    void move(const std::shared_ptr<ZipArchive>& archive, const std::string& name);
+    /// returns true if the file hasn't been read yet
+    bool isPending() const { return pending; }
+    /** reads the file if it's still pending, this may be called from any thread. If the
+     * archive has been changed on disk meanwhile a FileException is thrown and the file
+     * stays pending.
+     */
+    void read();
+    /// forgets the file without reading it
+    void reset();
+
+    const std::shared_ptr<ZipArchive>& getArchive() const { return archive; }
+    const std::string& getFileName() const { return name; }
+
+private:
+    LazyFile(const LazyFile&);
+    LazyFile& operator=(const LazyFile&);
+
+    std::function<void(Reader&)> func;
+    std::shared_ptr<ZipArchive> archive;
+    std::string name;
+    int version;
+    std::atomic<bool> pending;
+};
+
 }
 
 
@@ -259,6 +259,7 @@ void ConsoleSequencer::resetData()
 // ---------------------------------------------------------
 
 SequencerLauncher::SequencerLauncher(const char* pszStr, size_t steps)
+  : _workerSteps(0), _aborted(false)
 {
     QMutexLocker locker(&SequencerP::mutex);
     // Have we already an instance of SequencerLauncher created?
@@ -309,6 +310,44 @@ bool SequencerLauncher::wasCanceled() const
     return SequencerBase::Instance().wasCanceled();
 }
 
+bool SequencerLauncher::advance(size_t steps)
+{
+    _workerSteps += steps;
+    return !_aborted;
+}
+
+bool SequencerLauncher::update(bool canAbort)
+{
+    QMutexLocker locker(&SequencerP::mutex);
+    if (_aborted)
+        return false;
+    if (SequencerP::_topLauncher != this)
+        return true; // ignore
+
+    SequencerBase& seq = SequencerBase::Instance();
+    try {
+        size_t steps = std::min<size_t>(_workerSteps, seq.nTotalSteps);
+        if (steps > seq.nProgress) {
+            // next() increments the counter by one
+            seq.nProgress = steps - 1;
+            seq.next(canAbort);
+        }
+        else if (canAbort) {
+            seq.checkAbort();
+        }
+    }
+    catch (const Base::AbortException&) {
+        _aborted = true;
+    }
+
+    return !_aborted;
+}
+
+bool SequencerLauncher::isAborted() const
+{
+    return _aborted;
+}
+
 // ---------------------------------------------------------
 
 void ProgressIndicatorPy::init_type()
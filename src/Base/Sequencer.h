@@ -24,6 +24,7 @@
 #ifndef BASE_SEQUENCER_H
 #define BASE_SEQUENCER_H
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <CXX/Extensions.hxx>
@@ -374,6 +375,31 @@ public:
     bool next(bool canAbort = false);
     void setProgress(size_t);
     bool wasCanceled() const;
+
+    /** @name Progress of worker threads
+     * The sequencer must only be accessed from the thread that created the launcher.
+     * Worker threads therefore report their progress with advance() while the creating
+     * thread waits for them and periodically calls update() to pass it to the sequencer.
+     */
+    //@{
+    /** Adds \a steps to the number of finished steps. This method is thread-safe.
+     * It returns false if update() has detected that the user canceled the operation
+     * and the worker should stop as soon as possible.
+     */
+    bool advance(size_t steps = 1);
+    /** Passes the steps reported with advance() to the sequencer. If \a canAbort is true
+     * and the user has canceled the operation false is returned. Contrary to next() no
+     * exception is thrown because the caller must still wait for its workers. Afterwards
+     * it can throw an AbortException if isAborted() returns true.
+     */
+    bool update(bool canAbort = false);
+    /// Returns true if update() has detected that the user canceled the operation.
+    bool isAborted() const;
+    //@}
+
+private:
+    std::atomic<size_t> _workerSteps;
+    std::atomic<bool> _aborted;
 };
 
 /** Access to the only SequencerBase instance */
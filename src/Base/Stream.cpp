@@ -28,6 +28,7 @@
 # include <QByteArray>
 # include <QDataStream>
 # include <QIODevice>
+# include <algorithm>
 # include <cstdlib>
 # include <string>
 # include <cstdio>
@@ -44,6 +45,46 @@
 
 using namespace Base;
 
+namespace {
+// number of values that are swapped at once when writing bulk data
+const std::size_t SwapBlockSize = 4096;
+
+template <typename T>
+void writeBlock(std::ostream& out, const T* data, std::size_t count, bool swap)
+{
+    if (count == 0)
+        return;
+    if (!swap) {
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        return;
+    }
+
+    T buffer[SwapBlockSize];
+    while (count > 0) {
+        std::size_t num = std::min(count, SwapBlockSize);
+        for (std::size_t i = 0; i < num; i++) {
+            buffer[i] = data[i];
+            SwapEndian<T>(buffer[i]);
+        }
+        out.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(num * sizeof(T)));
+        data += num;
+        count -= num;
+    }
+}
+
+template <typename T>
+void readBlock(std::istream& in, T* data, std::size_t count, bool swap)
+{
+    if (count == 0)
+        return;
+    in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+    if (swap) {
+        for (std::size_t i = 0; i < count; i++)
+            SwapEndian<T>(data[i]);
+    }
+}
+}
+
 Stream::Stream() : _swap(false)
 {
 }
@@ -144,6 +185,30 @@ OutputStream& OutputStream::operator << (double d)
     return *this;
 }
 
+OutputStream& OutputStream::write(const int32_t* data, std::size_t count)
+{
+    writeBlock(_out, data, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const uint32_t* data, std::size_t count)
+{
+    writeBlock(_out, data, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const float* data, std::size_t count)
+{
+    writeBlock(_out, data, count, _swap);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const double* data, std::size_t count)
+{
+    writeBlock(_out, data, count, _swap);
+    return *this;
+}
+
 InputStream::InputStream(std::istream &rin) : _in(rin)
 {
 }
@@ -226,6 +291,30 @@ InputStream& InputStream::operator >> (double& d)
     return *this;
 }
 
+InputStream& InputStream::read(int32_t* data, std::size_t count)
+{
+    readBlock(_in, data, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(uint32_t* data, std::size_t count)
+{
+    readBlock(_in, data, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(float* data, std::size_t count)
+{
+    readBlock(_in, data, count, _swap);
+    return *this;
+}
+
+InputStream& InputStream::read(double* data, std::size_t count)
+{
+    readBlock(_in, data, count, _swap);
+    return *this;
+}
+
 // ----------------------------------------------------------------------
 
 ByteArrayOStreambuf::ByteArrayOStreambuf(QByteArray& ba) : _buffer(new QBuffer(&ba))
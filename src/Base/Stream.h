@@ -81,6 +81,17 @@ public:
     OutputStream& operator << (float f);
     OutputStream& operator << (double d);
 
+    /** @name Bulk data
+     * Writes \a count values of \a data. Unless the byte order must be swapped this is a single
+     * write to the stream, otherwise the values are swapped block-wise in a small buffer.
+     */
+    //@{
+    OutputStream& write(const int32_t* data, std::size_t count);
+    OutputStream& write(const uint32_t* data, std::size_t count);
+    OutputStream& write(const float* data, std::size_t count);
+    OutputStream& write(const double* data, std::size_t count);
+    //@}
+
 private:
     OutputStream (const OutputStream&);
     void operator = (const OutputStream&);
@@ -111,6 +122,17 @@ public:
     InputStream& operator >> (float& f);
     InputStream& operator >> (double& d);
 
+    /** @name Bulk data
+     * Reads \a count values into \a data with a single read from the stream and swaps
+     * the byte order afterwards if needed.
+     */
+    //@{
+    InputStream& read(int32_t* data, std::size_t count);
+    InputStream& read(uint32_t* data, std::size_t count);
+    InputStream& read(float* data, std::size_t count);
+    InputStream& read(double* data, std::size_t count);
+    //@}
+
     operator bool() const
     {
         // test if _Ipfx succeeded
@@ -24,6 +24,13 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <deque>
+# include <exception>
+# include <QMutex>
+# include <QMutexLocker>
+# include <QRunnable>
+# include <QThreadPool>
+# include <QWaitCondition>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -38,6 +45,7 @@
 #include <algorithm>
 #include <locale>
 #include <limits>
+#include <zlib.h>
 
 using namespace Base;
 using namespace std;
@@ -162,7 +170,7 @@ std::vector<std::string> Writer::getErrors() const
     return Errors;
 }
 
-std::string Writer::addFile(const char* Name,const Base::Persistence *Object)
+std::string Writer::addFile(const char* Name,const Base::Persistence *Object, bool compress)
 {
     // always check isForceXML() before requesting a file!
     assert(isForceXML()==false);
@@ -170,6 +178,7 @@ std::string Writer::addFile(const char* Name,const Base::Persistence *Object)
     FileEntry temp;
     temp.FileName = getUniqueFileName(Name);
     temp.Object = Object;
+    temp.Compress = compress;
 
     FileList.push_back(temp);
 
@@ -240,41 +249,215 @@ void Writer::decInd(void)
 
 // ----------------------------------------------------------------------------
 
-ZipWriter::ZipWriter(const char* FileName)
-  : ZipStream(FileName)
+namespace {
+
+void initStream(std::ostream& str)
 {
 #ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
+    str.imbue(std::locale::empty());
 #else
-    ZipStream.imbue(std::locale::classic());
+    str.imbue(std::locale::classic());
 #endif
-    ZipStream.precision(std::numeric_limits<double>::digits10 + 1);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    str.precision(std::numeric_limits<double>::digits10 + 1);
+    str.setf(ios::fixed,ios::floatfield);
+}
+
+class ZipRunnable : public QRunnable
+{
+public:
+    explicit ZipRunnable(const std::function<void()> &func) : func(func) {}
+    void run() override {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+/*
+ * A file of the zip archive that is rendered and compressed into memory,
+ * possibly on a worker thread.
+ */
+struct CompressedFile
+{
+    std::string name;
+    std::string data;
+    std::vector<std::string> errors;
+    uLong crc = 0;
+    uLong size = 0;
+    bool deflate = true;
+    bool done = false;
+    std::exception_ptr error;
+};
+
+// deflates the data without zlib header as expected by the zip format
+void compressFile(CompressedFile& file, int level)
+{
+    const Bytef* data = reinterpret_cast<const Bytef*>(file.data.data());
+    file.size = static_cast<uLong>(file.data.size());
+    file.crc = crc32(crc32(0, Z_NULL, 0), data, file.size);
+    if (!file.deflate)
+        return;
+
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw Base::RuntimeError("Failed to initialize compression");
+
+    // with an output buffer of this size a single call compresses everything
+    std::string out(deflateBound(&zs, file.size), '\0');
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(file.size);
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int err = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    if (err != Z_STREAM_END)
+        throw Base::RuntimeError("Failed to compress file");
+    file.data.swap(out);
+}
+
+}
+
+ZipWriter::ZipWriter(const char* FileName)
+  : ZipStream(FileName), Buffer(0), Level(6), Concurrency(0)
+{
+    initStream(ZipStream);
 }
 
 ZipWriter::ZipWriter(std::ostream& os)
-  : ZipStream(os)
+  : ZipStream(os), Buffer(0), Level(6), Concurrency(0)
 {
-#ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
-#else
-    ZipStream.imbue(std::locale::classic());
-#endif
-    ZipStream.precision(std::numeric_limits<double>::digits10 + 1);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    initStream(ZipStream);
 }
 
 void ZipWriter::writeFiles(void)
 {
+    // Without concurrency the files are streamed into the archive except for the
+    // files that are stored uncompressed. With concurrency all files are rendered
+    // into buffers, either on this thread or on a worker, compressed on a worker
+    // and written in order.
+    QMutex mutex;
+    QWaitCondition finished;
+    std::deque<std::shared_ptr<CompressedFile> > pending;
+    // the destructor of the pool waits for the workers
+    QThreadPool pool;
+    if (Concurrency > 0)
+        pool.setMaxThreadCount(Concurrency);
+
+    auto write = [&]() {
+        std::shared_ptr<CompressedFile> file = pending.front();
+        pending.pop_front();
+        {
+            QMutexLocker lock(&mutex);
+            while (!file->done)
+                finished.wait(&mutex);
+        }
+        for (const auto& it : file->errors)
+            addError(it);
+        if (file->error)
+            std::rethrow_exception(file->error);
+
+        ZipCDirEntry entry(file->name);
+        entry.setMethod(file->deflate ? DEFLATED : STORED);
+        entry.setCrc(file->crc);
+        entry.setSize(file->size);
+        entry.setCompressedSize(static_cast<uint32>(file->data.size()));
+        ZipStream.putCompressedEntry(entry, file->data.data(), static_cast<uint32>(file->data.size()));
+    };
+
     // use a while loop because it is possible that while
     // processing the files new ones can be added
     size_t index = 0;
     while (index < FileList.size()) {
         FileEntry entry = FileList.begin()[index];
-        ZipStream.putNextEntry(entry.FileName);
-        entry.Object->SaveDocFile(*this);
+        ZipCDirEntry previous;
+        std::string data;
+        if (copyFile(entry.FileName, entry.Object, previous, data)) {
+            std::shared_ptr<CompressedFile> file = std::make_shared<CompressedFile>();
+            file->name = entry.FileName;
+            file->data.swap(data);
+            file->crc = previous.getCrc();
+            file->size = previous.getSize();
+            file->deflate = previous.getMethod() == DEFLATED;
+            file->done = true;
+            pending.push_back(file);
+        }
+        else if (Concurrency <= 0 && entry.Compress) {
+            ZipStream.putNextEntry(entry.FileName);
+            entry.Object->SaveDocFile(*this);
+        }
+        else {
+            std::shared_ptr<CompressedFile> file = std::make_shared<CompressedFile>();
+            file->name = entry.FileName;
+            file->deflate = entry.Compress;
+
+            // the other objects may add further files
+            bool render = Concurrency > 0 && entry.Object->canSaveDocFileConcurrently(*this);
+            if (!render) {
+                std::ostringstream str;
+                initStream(str);
+                Buffer = &str;
+                try {
+                    entry.Object->SaveDocFile(*this);
+                }
+                catch (...) {
+                    Buffer = 0;
+                    throw;
+                }
+                Buffer = 0;
+                file->data = str.str();
+            }
+
+            const Base::Persistence* object = entry.Object;
+            std::set<std::string> modes = Modes;
+            int version = fileVersion;
+            int level = Level;
+            auto func = [file, object, render, modes, version, level, &mutex, &finished]() {
+                try {
+                    if (render) {
+                        StringWriter writer;
+                        initStream(writer.Stream());
+                        writer.setModes(modes);
+                        writer.setFileVersion(version);
+                        object->SaveDocFile(writer);
+                        file->data = writer.getString();
+                        file->errors = writer.getErrors();
+                    }
+                    compressFile(*file, level);
+                }
+                catch (...) {
+                    file->error = std::current_exception();
+                }
+                QMutexLocker lock(&mutex);
+                file->done = true;
+                finished.wakeAll();
+            };
+
+            pending.push_back(file);
+            if (Concurrency > 0)
+                pool.start(new ZipRunnable(func));
+            else
+                func();
+        }
+
+        // limit the memory of the buffered files
+        if (pending.size() > 2 * static_cast<std::size_t>(std::max(Concurrency, 0)))
+            write();
         index++;
     }
+
+    while (!pending.empty())
+        write();
+}
+
+bool ZipWriter::copyFile(const std::string&, const Base::Persistence*,
+                         zipios::ZipCDirEntry&, std::string&)
+{
+    return false;
 }
 
 ZipWriter::~ZipWriter()
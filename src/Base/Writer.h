@@ -75,8 +75,11 @@ public:
 
     /** @name additional file writing */
     //@{
-    /// add a write request of a persistent object
-    std::string addFile(const char* Name, const Base::Persistence *Object);
+    /** add a write request of a persistent object
+     * Set \a compress to false for data that is already compressed, e.g. images,
+     * the ZipWriter then stores it as it is.
+     */
+    std::string addFile(const char* Name, const Base::Persistence *Object, bool compress=true);
     /// process the requested file storing
     virtual void writeFiles(void)=0;
     /// get all registered file names
@@ -123,6 +126,7 @@ protected:
     struct FileEntry {
         std::string FileName;
         const Base::Persistence *Object;
+        bool Compress;
     };
     std::vector<FileEntry> FileList;
     std::vector<std::string> FileNames;
@@ -152,14 +156,34 @@ public:
 
     virtual void writeFiles(void);
 
-    virtual std::ostream &Stream(void){return ZipStream;}
+    virtual std::ostream &Stream(void){return Buffer ? *Buffer : ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){ZipStream.setLevel( level ); Level = level;}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
+    /** Sets the number of worker threads of writeFiles().
+     * With threads the files are rendered into buffers, compressed on the
+     * workers and written in order. Objects whose canSaveDocFileConcurrently()
+     * returns true are also rendered on the workers. With 0, the default,
+     * the files are written one after another.
+     */
+    void setConcurrency(int threads){Concurrency = threads;}
+    int getConcurrency() const {return Concurrency;}
+
+protected:
+    /** This method can be re-implemented in sub-classes to take the file of an
+     * unchanged object from another archive instead of saving it again. It returns
+     * true and the header and compressed data of the entry in \a entry and \a data,
+     * which are written as they are. The default implementation returns false.
+     */
+    virtual bool copyFile(const std::string& name, const Base::Persistence *object,
+                          zipios::ZipCDirEntry& entry, std::string& data);
 
 private:
     zipios::ZipOutputStream ZipStream;
+    std::ostream* Buffer;
+    int Level;
+    int Concurrency;
 };
 
 /** The StringWriter class
@@ -37,6 +37,7 @@
 #include "AutoSaver.h"
 #include <Base/Console.h>
 #include <Base/FileInfo.h>
+#include <Base/Reader.h>
 #include <Base/Stream.h>
 #include <Base/Tools.h>
 #include <Base/Writer.h>
@@ -363,6 +364,23 @@ private:
 
 }
 
+bool RecoveryWriter::extractFile(const std::string& name, const Base::Persistence *object)
+{
+    // The format must be the same, e.g. shapes are always written as binary files
+    Base::LazyFile* lazy = object->getLazyFile();
+    if (!lazy || !lazy->isPending() ||
+        Base::FileInfo(name).extension() != Base::FileInfo(lazy->getFileName()).extension())
+        return false;
+
+    std::string fileName = DirName + "/" + name;
+    this->FileStream.open(fileName.c_str(), std::ios::out | std::ios::binary);
+    bool ok = lazy->getArchive()->readEntry(lazy->getFileName(), [this](std::istream& str) {
+        this->FileStream << str.rdbuf();
+    });
+    this->FileStream.close();
+    return ok;
+}
+
 void RecoveryWriter::writeFiles(void)
 {
 #if 0
@@ -385,8 +403,11 @@ void RecoveryWriter::writeFiles(void)
                 fi.createDirectory();
             }
 
+            if (extractFile(entry.FileName, entry.Object)) {
+                // the file hasn't been read yet
+            }
             // For properties a copy can be created and then this can be written to disk in a thread
-            if (entry.Object->isDerivedFrom(App::Property::getClassTypeId())) {
+            else if (entry.Object->isDerivedFrom(App::Property::getClassTypeId())) {
                 const App::Property* prop = static_cast<const App::Property*>(entry.Object);
                 QThreadPool::globalInstance()->start(new RecoveryRunnable(getModes(), DirName.c_str(), entry.FileName.c_str(), prop));
             }
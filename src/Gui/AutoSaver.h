@@ -111,6 +111,10 @@ public:
     virtual bool shouldWrite(const std::string&, const Base::Persistence *) const;
     virtual void writeFiles(void);
 
+private:
+    /// Copies the file of an object that hasn't been read yet from its archive
+    bool extractFile(const std::string&, const Base::Persistence *);
+
 private:
     AutoSaveProperty& saver;
 };
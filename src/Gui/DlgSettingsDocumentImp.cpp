@@ -94,6 +94,11 @@ void DlgSettingsDocumentImp::saveSettings()
     ui->prefAutoSaveEnabled->onSave();
     ui->prefAutoSaveTimeout->onSave();
     ui->prefCanAbortRecompute->onSave();
+    ui->prefParallelRecompute->onSave();
+    ui->prefParallelRestore->onSave();
+    ui->prefParallelSave->onSave();
+    ui->prefIncrementalSave->onSave();
+    ui->prefLazyRestore->onSave();
 
     int timeout = ui->prefAutoSaveTimeout->value();
     if (!ui->prefAutoSaveEnabled->isChecked())
@@ -128,6 +133,11 @@ void DlgSettingsDocumentImp::loadSettings()
     ui->prefAutoSaveEnabled->onRestore();
     ui->prefAutoSaveTimeout->onRestore();
     ui->prefCanAbortRecompute->onRestore();
+    ui->prefParallelRecompute->onRestore();
+    ui->prefParallelRestore->onRestore();
+    ui->prefParallelSave->onRestore();
+    ui->prefIncrementalSave->onRestore();
+    ui->prefLazyRestore->onRestore();
 }
 
 /**
@@ -22,13 +22,18 @@
 
 
 #include "PreCompiled.h"
+#include <climits>
 #include <numeric>
 #include <gp_Pnt.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepClass3d_SolidClassifier.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
 #include <TopoDS_Vertex.hxx>
 
 #include <QEventLoop>
@@ -39,8 +44,10 @@
 #include <boost_bind_bind.hpp>
 
 #include <Base/Console.h>
+#include <Base/Converter.h>
 #include <Base/Exception.h>
 #include <Base/FutureWatcherProgress.h>
+#include <Base/Parallel.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -48,11 +55,12 @@
 #include <Mod/Mesh/App/Mesh.h>
 #include <Mod/Mesh/App/MeshFeature.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
+#include <Mod/Mesh/App/Core/BVH.h>
 #include <Mod/Mesh/App/Core/Grid.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
-#include <Mod/Points/App/PointsGrid.h>
+#include <Mod/Points/App/PointsKDTree.h>
 #include <Mod/Part/App/PartFeature.h>
 
 #include "InspectionFeature.h"
@@ -183,15 +191,19 @@ namespace Inspection {
             assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
         }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
+        void GetElementCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const
         {
+            MeshCore::MeshGeomFacet clFacet = _pclMesh->GetFacet(ulIndex);
+            for (int i = 0; i < 3; i++)
+                clFacet._aclPoints[i] = _transform * clFacet._aclPoints[i];
+
             unsigned long ulX, ulY, ulZ;
             unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
 
             Base::BoundBox3f clBB;
-            clBB.Add(rclFacet._aclPoints[0]);
-            clBB.Add(rclFacet._aclPoints[1]);
-            clBB.Add(rclFacet._aclPoints[2]);
+            clBB.Add(clFacet._aclPoints[0]);
+            clBB.Add(clFacet._aclPoints[1]);
+            clBB.Add(clFacet._aclPoints[2]);
 
             Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
             Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
@@ -201,20 +213,18 @@ namespace Inspection {
                 for (ulX = ulX1; ulX <= ulX2; ulX++) {
                     for (ulY = ulY1; ulY <= ulY2; ulY++) {
                         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
-                            if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                            if (clFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
+                                raulCells.push_back(CellIndex(ulX, ulY, ulZ));
                         }
                     }
                 }
             }
             else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
+                raulCells.push_back(CellIndex(ulX1, ulY1, ulZ1));
         }
 
         void InitGrid (void)
         {
-            unsigned long i, j;
-
             Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
             float fLengthX = clBBMesh.LengthX(); 
@@ -230,26 +240,15 @@ namespace Inspection {
             _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
             _fMinZ = clBBMesh.MinZ - 0.5f;
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+            _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+            _aulGridElements.clear();
         }
 
         void RebuildGrid (void)
         {
             _ulCtElements = _pclMesh->CountFacets();
             InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
-            }
+            FillGrid(_ulCtElements);
         }
 
     private:
@@ -403,37 +402,25 @@ float InspectNominalFastMesh::getDistance(const Base::Vector3f& point) const
 
 // ----------------------------------------------------------------
 
-InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float /*offset*/)
+InspectNominalPoints::InspectNominalPoints(const Points::PointKernel& Kernel, float offset)
   : _rKernel(Kernel)
+  , _fRadius(offset)
 {
-    int uGridPerAxis = 50; // totally 125.000 grid elements 
-    this->_pGrid = new Points::PointsGrid (Kernel, uGridPerAxis);
+    this->_pTree = new Points::PointsKDTree(Kernel);
 }
 
 InspectNominalPoints::~InspectNominalPoints()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 float InspectNominalPoints::getDistance(const Base::Vector3f& point) const
 {
-    //TODO: Make faster
-    std::set<unsigned long> indices;
-    unsigned long x,y,z;
-    Base::Vector3d pointd(point.x,point.y,point.z);
-    _pGrid->Position(pointd, x, y, z);
-    _pGrid->GetElements(x,y,z,indices);
-
-    double fMinDist=DBL_MAX;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        Base::Vector3d pt = _rKernel.getPoint(*it);
-        double fDist = Base::Distance(pointd, pt);
-        if (fDist < fMinDist) {
-            fMinDist = fDist;
-        }
-    }
-
-    return (float)fMinDist;
+    // points further away than the search radius are rejected by the caller anyway
+    float fMinDist;
+    if (_pTree->FindNearest(point, _fRadius, fMinDist) == ULONG_MAX)
+        return FLT_MAX;
+    return fMinDist;
 }
 
 // ----------------------------------------------------------------
@@ -464,6 +451,30 @@ InspectNominalShape::~InspectNominalShape()
     delete distss;
 }
 
+namespace {
+/** Returns -1 if the first solution of \a distss lies in a face whose normal points away
+ * from \a pnt3d, 1 if the normal points towards it and 0 if no solution lies in a face.
+ */
+int faceSide(const BRepExtrema_DistShapeShape& distss, const gp_Pnt& pnt3d)
+{
+    for (Standard_Integer index = 1; index <= distss.NbSolution(); index++) {
+        if (distss.SupportTypeShape1(index) == BRepExtrema_IsInFace) {
+            TopoDS_Shape face = distss.SupportOnShape1(index);
+            Standard_Real u, v;
+            distss.ParOnFaceS1(index, u, v);
+            BRepGProp_Face props(TopoDS::Face(face));
+            gp_Vec normal;
+            gp_Pnt center;
+            props.Normal(u, v, center, normal);
+            gp_Vec dir(center, pnt3d);
+            Standard_Real scalar = normal.Dot(dir);
+            return scalar < 0 ? -1 : 1;
+        }
+    }
+    return 0;
+}
+}
+
 float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 {
     gp_Pnt pnt3d(point.x,point.y,point.z);
@@ -485,23 +496,8 @@ float InspectNominalShape::getDistance(const Base::Vector3f& point) const
         }
         else if (fMinDist > 0) {
             // check if the distance was compued from a face
-            for (Standard_Integer index = 1; index <= distss->NbSolution(); index++) {
-                if (distss->SupportTypeShape1(index) == BRepExtrema_IsInFace) {
-                    TopoDS_Shape face = distss->SupportOnShape1(index);
-                    Standard_Real u, v;
-                    distss->ParOnFaceS1(index, u, v);
-                    //gp_Pnt pnt = distss->PointOnShape1(index);
-                    BRepGProp_Face props(TopoDS::Face(face));
-                    gp_Vec normal;
-                    gp_Pnt center;
-                    props.Normal(u, v, center, normal);
-                    gp_Vec dir(center, pnt3d);
-                    Standard_Real scalar = normal.Dot(dir);
-                    if (scalar < 0) {
-                        fMinDist = -fMinDist;
-                    }
-                    break;
-                }
+            if (faceSide(*distss, pnt3d) < 0) {
+                fMinDist = -fMinDist;
             }
         }
     }
@@ -510,9 +506,152 @@ float InspectNominalShape::getDistance(const Base::Vector3f& point) const
 
 // ----------------------------------------------------------------
 
+namespace Inspection {
+/**
+ * The tessellation of a shape without its placement. The triangles know the face they belong to.
+ * A bounding volume hierarchy over the placed triangles is built on demand and kept until the
+ * placement changes, so that moving a nominal doesn't require a new tessellation.
+ */
+class InspectShapeTessellation
+{
+public:
+    InspectShapeTessellation(const TopoDS_Shape& shape, float deflection)
+        : _shape(shape.Located(TopLoc_Location()))
+        , _deflection(deflection)
+    {
+        BRepMesh_IncrementalMesh aMesh(_shape, deflection,
+                                       /*isRelative*/ Standard_False,
+                                       /*theAngDeflection*/ 0.5,
+                                       /*isInParallel*/ Standard_True);
+        std::vector<Data::ComplexGeoData::Domain> domains;
+        Part::TopoShape(_shape).getDomains(domains);
+
+        // the domains are in the order of the explorer
+        for (TopExp_Explorer xp(_shape, TopAbs_FACE); xp.More(); xp.Next())
+            _faces.push_back(TopoDS::Face(xp.Current()));
+
+        MeshCore::MeshPointArray points;
+        MeshCore::MeshFacetArray facets;
+        for (std::size_t i = 0; i < domains.size(); i++) {
+            const Data::ComplexGeoData::Domain& domain = domains[i];
+            unsigned long offset = points.size();
+            for (std::vector<Base::Vector3d>::const_iterator it = domain.points.begin(); it != domain.points.end(); ++it)
+                points.push_back(Base::convertTo<Base::Vector3f>(*it));
+            for (std::vector<Data::ComplexGeoData::Facet>::const_iterator it = domain.facets.begin(); it != domain.facets.end(); ++it) {
+                facets.push_back(MeshCore::MeshFacet(offset + it->I1, offset + it->I2, offset + it->I3));
+                _facetFaces.push_back(static_cast<int>(i));
+            }
+        }
+
+        _mesh.Adopt(points, facets, false);
+    }
+
+    /// Checks whether this is the tessellation of \a shape, regardless of its placement
+    bool isTessellationOf(const TopoDS_Shape& shape, float deflection) const
+    {
+        return _deflection == deflection && _shape.IsEqual(shape.Located(TopLoc_Location()));
+    }
+    float getDeflection() const
+    {
+        return _deflection;
+    }
+    const MeshCore::MeshKernel& getKernel() const
+    {
+        return _mesh;
+    }
+    /**
+     * Returns the hierarchy over the triangles placed with \a mat. The last hierarchy is reused for
+     * the same placement while the nominals of other placements keep their own one alive.
+     */
+    std::shared_ptr<const MeshCore::MeshFacetBVH> getBVH(const Base::Matrix4D& mat)
+    {
+        if (!_bvh || _bvhMatrix != mat) {
+            _bvh = std::make_shared<const MeshCore::MeshFacetBVH>(_mesh, mat);
+            _bvhMatrix = mat;
+        }
+        return _bvh;
+    }
+
+    /**
+     * Computes the distance of \a pnt to the face of \a facet. The point must be given in the
+     * coordinate system of the tessellation. If the exact computation fails \a approx is returned.
+     */
+    float getDistance(unsigned long facet, const Base::Vector3d& pnt, float approx) const
+    {
+        gp_Pnt pnt3d(pnt.x, pnt.y, pnt.z);
+        BRepBuilderAPI_MakeVertex mkVert(pnt3d);
+        BRepExtrema_DistShapeShape distss(_faces[_facetFaces[facet]], mkVert.Vertex());
+        if (!distss.IsDone() || distss.NbSolution() == 0)
+            return approx;
+
+        // keep the sign of the tessellation if the solution lies on the boundary of the face
+        float fDist = static_cast<float>(distss.Value());
+        int side = faceSide(distss, pnt3d);
+        if (side < 0 || (side == 0 && approx < 0))
+            fDist = -fDist;
+        return fDist;
+    }
+
+private:
+    TopoDS_Shape _shape;
+    float _deflection;
+    std::vector<TopoDS_Face> _faces;
+    std::vector<int> _facetFaces;
+    MeshCore::MeshKernel _mesh;
+    std::shared_ptr<const MeshCore::MeshFacetBVH> _bvh;
+    Base::Matrix4D _bvhMatrix;
+};
+}
+
+InspectNominalFastShape::InspectNominalFastShape(const TopoDS_Shape& shape,
+                                                 const std::shared_ptr<InspectShapeTessellation>& tessellation,
+                                                 float offset, float band)
+  : _tessellation(tessellation)
+  , _bvh(tessellation->getBVH(Part::TopoShape(shape).getTransform()))
+  , _fMaxDist(offset + tessellation->getDeflection())
+  , _fBand(band + tessellation->getDeflection())
+{
+    Base::Matrix4D tmp;
+    _clTrf = Part::TopoShape(shape).getTransform();
+    _bApply = _clTrf != tmp;
+    _clInv = _clTrf;
+    _clInv.inverse();
+}
+
+InspectNominalFastShape::~InspectNominalFastShape()
+{
+}
+
+float InspectNominalFastShape::getDistance(const Base::Vector3f& point) const
+{
+    // the tessellation deviates from the surface by at most the deflection
+    unsigned long facet;
+    Base::Vector3f foot;
+    float fMinDist;
+    if (!_bvh->NearestFacetToPoint(point, facet, foot, fMinDist, _fMaxDist))
+        return FLT_MAX;
+
+    MeshCore::MeshGeomFacet geomFace = _tessellation->getKernel().GetFacet(facet);
+    if (_bApply)
+        geomFace.Transform(_clTrf);
+    if (point.DistanceToPlane(geomFace._aclPoints[0], geomFace.GetNormal()) < 0)
+        fMinDist = -fMinDist;
+
+    if (fabs(fMinDist) > _fBand)
+        return fMinDist;
+
+    Base::Vector3d pnt = Base::convertTo<Base::Vector3d>(point);
+    if (_bApply)
+        pnt = _clInv * pnt;
+    return _tessellation->getDistance(facet, pnt, fMinDist);
+}
+
+// ----------------------------------------------------------------
+
 TYPESYSTEM_SOURCE(Inspection::PropertyDistanceList, App::PropertyLists)
 
 PropertyDistanceList::PropertyDistanceList()
+  : _rangeFirst(0), _rangeLast(-1)
 {
 
 }
@@ -547,6 +686,34 @@ void PropertyDistanceList::setValues(const std::vector<float>& values)
     hasSetValue();
 }
 
+void PropertyDistanceList::setRange(int first, const std::vector<float>& values)
+{
+    if (first < 0 || first + static_cast<int>(values.size()) > getSize())
+        throw Base::IndexError("Range of distances out of bounds");
+
+    aboutToSetValue();
+    std::copy(values.begin(), values.end(), _lValueList.begin() + first);
+    // the range is only valid while the observers get notified
+    _rangeFirst = first;
+    _rangeLast = first + static_cast<int>(values.size());
+    try {
+        hasSetValue();
+    }
+    catch (...) {
+        _rangeFirst = 0;
+        _rangeLast = -1;
+        throw;
+    }
+    _rangeFirst = 0;
+    _rangeLast = -1;
+}
+
+void PropertyDistanceList::getChangedRange(int& first, int& last) const
+{
+    first = _rangeFirst;
+    last = _rangeLast < 0 ? getSize() : _rangeLast;
+}
+
 PyObject *PropertyDistanceList::getPyObject(void)
 {
     PyObject* list = PyList_New(getSize());
@@ -710,6 +877,8 @@ public:
 
 PROPERTY_SOURCE(Inspection::Feature, App::DocumentObject)
 
+const char* Feature::ShapeDistanceEnums[]= {"Exact","Tessellated",NULL};
+
 Feature::Feature()
 {
     ADD_PROPERTY(SearchRadius,(0.05));
@@ -717,6 +886,18 @@ Feature::Feature()
     ADD_PROPERTY(Actual,(0));
     ADD_PROPERTY(Nominals,(0));
     ADD_PROPERTY(Distances,(0.0));
+    ADD_PROPERTY_TYPE(ShapeDistance,(long(Exact)),"Base",App::Prop_None,
+        "Exact: distances to the shape surfaces.\n"
+        "Tessellated: distances to a tessellation, refined for points inside the refine band.");
+    ShapeDistance.setEnums(ShapeDistanceEnums);
+    ADD_PROPERTY_TYPE(ShapeDeflection,(0.0),"Base",App::Prop_None,
+        "Maximum deviation of the tessellation of nominal shapes. If 0 it's computed from the size of the shape.");
+    ADD_PROPERTY_TYPE(RefineBand,(0.0),"Base",App::Prop_None,
+        "Points whose distance to the tessellation is inside this band are refined against\n"
+        "the exact surface. If 0 the search radius is used.");
+    ADD_PROPERTY_TYPE(ChunkSize,(0),"Base",App::Prop_None,
+        "Number of points inspected at once. The distances of each chunk are shown as soon as\n"
+        "it's finished and the inspection can be canceled. If 0 all points are inspected at once.");
 }
 
 Feature::~Feature()
@@ -733,9 +914,29 @@ short Feature::mustExecute() const
         return 1;
     if (Nominals.isTouched())
         return 1;
+    if (ShapeDistance.isTouched())
+        return 1;
+    if (ShapeDeflection.isTouched())
+        return 1;
+    if (RefineBand.isTouched())
+        return 1;
+    if (ChunkSize.isTouched())
+        return 1;
     return 0;
 }
 
+std::shared_ptr<InspectShapeTessellation> Feature::getTessellation(const TopoDS_Shape& shape, float deflection)
+{
+    for (std::vector<std::shared_ptr<InspectShapeTessellation> >::iterator it = _tessellations.begin(); it != _tessellations.end(); ++it) {
+        if ((*it)->isTessellationOf(shape, deflection))
+            return *it;
+    }
+
+    std::shared_ptr<InspectShapeTessellation> tessellation(new InspectShapeTessellation(shape, deflection));
+    _tessellations.push_back(tessellation);
+    return tessellation;
+}
+
 App::DocumentObjectExecReturn* Feature::execute(void)
 {
     bool useMultithreading = true;
@@ -764,6 +965,7 @@ App::DocumentObjectExecReturn* Feature::execute(void)
 
     // get a list of nominals
     std::vector<InspectNominalGeometry*> inspectNominal;
+    std::vector<std::shared_ptr<InspectShapeTessellation> > tessellations;
     const std::vector<App::DocumentObject*>& nominals = Nominals.getValues();
     for (std::vector<App::DocumentObject*>::const_iterator it = nominals.begin(); it != nominals.end(); ++it) {
         InspectNominalGeometry* nominal = 0;
@@ -776,15 +978,39 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             nominal = new InspectNominalPoints(pts->Points.getValue(), this->SearchRadius.getValue());
         }
         else if ((*it)->getTypeId().isDerivedFrom(Part::Feature::getClassTypeId())) {
-            useMultithreading = false;
             Part::Feature* part = static_cast<Part::Feature*>(*it);
-            nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
+            const TopoDS_Shape& shape = part->Shape.getValue();
+            if (ShapeDistance.getValue() == Tessellated && !shape.IsNull()) {
+                // the tessellation doesn't share any state between the threads
+                float deflection = static_cast<float>(ShapeDeflection.getValue());
+                if (deflection <= 0) {
+                    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+                        ("User parameter:BaseApp/Preferences/Mod/Part");
+                    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
+                    Base::BoundBox3d bbox = part->Shape.getBoundingBox();
+                    deflection = (bbox.LengthX() + bbox.LengthY() + bbox.LengthZ())/300.0 * deviation;
+                }
+                float band = static_cast<float>(RefineBand.getValue());
+                if (band <= 0)
+                    band = static_cast<float>(SearchRadius.getValue());
+
+                std::shared_ptr<InspectShapeTessellation> tessellation = getTessellation(shape, deflection);
+                tessellations.push_back(tessellation);
+                nominal = new InspectNominalFastShape(shape, tessellation, this->SearchRadius.getValue(), band);
+            }
+            else {
+                useMultithreading = false;
+                nominal = new InspectNominalShape(shape, this->SearchRadius.getValue());
+            }
         }
 
         if (nominal)
             inspectNominal.push_back(nominal);
     }
 
+    // forget the tessellations of shapes that are no nominals any more
+    _tessellations.swap(tessellations);
+
 #if 0
 #if 1 // test with some huge data sets
     std::vector<unsigned long> index(actual->countPoints());
@@ -870,8 +1096,49 @@ App::DocumentObjectExecReturn* Feature::execute(void)
     };
 
     DistanceInspectionRMS res;
+    unsigned long chunkSize = static_cast<unsigned long>(std::max<long>(ChunkSize.getValue(), 0));
+
+    if (chunkSize > 0) {
+        // Points that are not inspected yet are shown as outside of the search radius.
+        // Each chunk is published as soon as it's finished so that the view provider
+        // can update its colours while the inspection is running.
+        std::fill(vals.begin(), vals.end(), FLT_MAX);
+        Distances.setValues(vals);
 
-    if (useMultithreading) {
+        std::stringstream str;
+        str << "Inspecting " << this->Label.getValue() << "...";
+        Base::SequencerLauncher seq(str.str().c_str(), count);
+
+        try {
+            for (unsigned long first = 0; first < count; first += chunkSize) {
+                unsigned long size = std::min<unsigned long>(chunkSize, count - first);
+                if (useMultithreading) {
+                    // each block of the chunk sums up the squares of its distances
+                    std::vector<DistanceInspectionRMS> sums(Base::parallel_blocks(size, 256));
+                    Base::parallel_for(size, 256, [&](std::size_t block, std::size_t begin, std::size_t end) {
+                        for (std::size_t i = begin; i < end; i++)
+                            sums[block] += fMap(static_cast<unsigned int>(first + i));
+                    }, seq);
+                    for (std::vector<DistanceInspectionRMS>::iterator it = sums.begin(); it != sums.end(); ++it)
+                        res += *it;
+                }
+                else {
+                    for (unsigned long i = first; i < first + size; i++) {
+                        res += fMap(i);
+                        seq.next(true);
+                    }
+                }
+                Distances.setRange(static_cast<int>(first), std::vector<float>(vals.begin() + first, vals.begin() + first + size));
+            }
+        }
+        catch (const Base::AbortException&) {
+            delete actual;
+            for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
+                delete *it;
+            return new App::DocumentObjectExecReturn("Inspection aborted by user");
+        }
+    }
+    else if (useMultithreading) {
         // Build vector of increasing indices
         std::vector<unsigned long> index(count);
         std::iota(index.begin(), index.end(), 0);
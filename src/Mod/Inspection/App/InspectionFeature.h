@@ -24,6 +24,7 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <memory>
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -37,10 +38,11 @@ class BRepExtrema_DistShapeShape;
 namespace MeshCore {
 class MeshKernel;
 class MeshGrid;
+class MeshFacetBVH;
 }
 
 namespace Mesh   { class MeshObject; }
-namespace Points { class PointsGrid; }
+namespace Points { class PointsKDTree; }
 namespace Part   { class TopoShape;  }
 
 namespace Inspection
@@ -143,7 +145,8 @@ public:
 
 private:
     const Points::PointKernel& _rKernel;
-    Points::PointsGrid* _pGrid;
+    Points::PointsKDTree* _pTree;
+    float _fRadius;
 };
 
 class InspectionExport InspectNominalShape : public InspectNominalGeometry
@@ -159,6 +162,32 @@ private:
     bool isSolid;
 };
 
+class InspectShapeTessellation;
+
+/**
+ * This algorithm computes the distance to a tessellation of the shape with a bounding volume
+ * hierarchy over its triangles. It is by factors faster than InspectNominalShape but the result
+ * has the accuracy of the tessellation. Therefore the points whose approximate distance is inside
+ * a tolerance band are refined against the exact surface of the face the nearest triangle belongs to.
+ */
+class InspectionExport InspectNominalFastShape : public InspectNominalGeometry
+{
+public:
+    InspectNominalFastShape(const TopoDS_Shape&, const std::shared_ptr<InspectShapeTessellation>&,
+                            float offset, float band);
+    ~InspectNominalFastShape();
+    virtual float getDistance(const Base::Vector3f&) const;
+
+private:
+    std::shared_ptr<InspectShapeTessellation> _tessellation;
+    std::shared_ptr<const MeshCore::MeshFacetBVH> _bvh;
+    float _fMaxDist;
+    float _fBand;
+    bool _bApply;
+    Base::Matrix4D _clTrf;
+    Base::Matrix4D _clInv;
+};
+
 class InspectionExport PropertyDistanceList: public App::PropertyLists
 {
     TYPESYSTEM_HEADER();
@@ -189,6 +218,14 @@ public:
     
     void set1Value (const int idx, float value){_lValueList.operator[] (idx) = value;}
     void setValues (const std::vector<float>& values);
+    /** Replaces the values starting at \a first with \a values and notifies the observers.
+     * This way the results of a running inspection can be shown before it has finished.
+     */
+    void setRange (int first, const std::vector<float>& values);
+    /** Returns the range [first, last) of the values changed by the current notification.
+     * Outside of a notification by setRange() this is the whole list.
+     */
+    void getChangedRange (int& first, int& last) const;
     
     const std::vector<float> &getValues(void) const{return _lValueList;}
     
@@ -207,6 +244,7 @@ public:
 
 private:
     std::vector<float> _lValueList;
+    int _rangeFirst, _rangeLast;
 };
 
 // ----------------------------------------------------------------
@@ -219,6 +257,12 @@ class InspectionExport Feature : public App::DocumentObject
     PROPERTY_HEADER(Inspection::Feature);
 
 public:
+    /// The values of ShapeDistance
+    enum ShapeDistanceMode {
+        Exact = 0,      /**< distance to the exact surface */
+        Tessellated = 1 /**< distance to a tessellation, refined near the surface */
+    };
+
     /// Constructor
     Feature(void);
     virtual ~Feature();
@@ -230,6 +274,10 @@ public:
     App::PropertyLink      Actual;
     App::PropertyLinkList  Nominals;
     PropertyDistanceList   Distances;
+    App::PropertyEnumeration ShapeDistance;
+    App::PropertyFloat     ShapeDeflection;
+    App::PropertyFloat     RefineBand;
+    App::PropertyInteger   ChunkSize;
     //@}
 
     /** @name Actions */
@@ -242,6 +290,14 @@ public:
     /// returns the type name of the ViewProvider
     const char* getViewProviderName(void) const 
     { return "InspectionGui::ViewProviderInspection"; }
+
+private:
+    std::shared_ptr<InspectShapeTessellation> getTessellation(const TopoDS_Shape&, float deflection);
+
+private:
+    static const char* ShapeDistanceEnums[];
+    /// tessellations of the nominal shapes, kept across recomputes
+    std::vector<std::shared_ptr<InspectShapeTessellation> > _tessellations;
 };
 
 class InspectionExport Group : public App::DocumentObjectGroup
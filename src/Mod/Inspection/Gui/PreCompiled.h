@@ -54,6 +54,7 @@
 // standard
 #include <cstdio>
 #include <cassert>
+#include <climits>
 
 // STL
 #include <algorithm>
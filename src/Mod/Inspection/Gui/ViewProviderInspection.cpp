@@ -24,6 +24,7 @@
 #include "PreCompiled.h"
 
 #ifndef _PreComp_
+# include <climits>
 # include <QMenu>
 # include <QMessageBox>
 #endif
@@ -279,6 +280,15 @@ void ViewProviderInspection::updateData(const App::Property* prop)
         }
     }
     else if (prop->getTypeId() == Inspection::PropertyDistanceList::getClassTypeId()) {
+        // a running inspection has published a part of its distances
+        const Inspection::PropertyDistanceList* dist = static_cast<const Inspection::PropertyDistanceList*>(prop);
+        int first, last;
+        dist->getChangedRange(first, last);
+        if (first > 0 || last < dist->getSize()) {
+            setDistances(first, last);
+            return;
+        }
+
         // force an update of the Inventor data nodes
         if (this->pcObject) {
             App::Property* link = this->pcObject->getPropertyByName("Actual");
@@ -303,6 +313,11 @@ SoSeparator* ViewProviderInspection::getFrontRoot(void) const
 }
 
 void ViewProviderInspection::setDistances()
+{
+    setDistances(0, INT_MAX);
+}
+
+void ViewProviderInspection::setDistances(int first, int last)
 {
     if (!pcObject)
         return;
@@ -325,19 +340,25 @@ void ViewProviderInspection::setDistances()
         return;
     }
 
-    if (pcColorMat->diffuseColor.getNum() != static_cast<int>(fValues.size()))
+    // only a part of the colours is updated if the material already has the right size
+    if (pcColorMat->diffuseColor.getNum() != static_cast<int>(fValues.size()) ||
+        pcColorMat->transparency.getNum() != static_cast<int>(fValues.size())) {
         pcColorMat->diffuseColor.setNum(static_cast<int>(fValues.size()));
-    if (pcColorMat->transparency.getNum() != static_cast<int>(fValues.size()))
         pcColorMat->transparency.setNum(static_cast<int>(fValues.size()));
+        first = 0;
+        last = INT_MAX;
+    }
+    first = std::max<int>(first, 0);
+    last = std::min<int>(last, static_cast<int>(fValues.size()));
 
     SbColor * cols = pcColorMat->diffuseColor.startEditing();
     float   * tran = pcColorMat->transparency.startEditing();
 
-    unsigned long j=0;
-    for (std::vector<float>::const_iterator jt = fValues.begin(); jt != fValues.end(); ++jt, j++) {
-        App::Color col = pcColorBar->getColor(*jt);
+    for (int j = first; j < last; j++) {
+        float value = fValues[j];
+        App::Color col = pcColorBar->getColor(value);
         cols[j] = SbColor(col.r, col.g, col.b);
-        if (pcColorBar->isVisible(*jt)) {
+        if (pcColorBar->isVisible(value)) {
             tran[j] = 0.0f;
         }
         else {
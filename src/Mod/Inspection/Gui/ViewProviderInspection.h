@@ -80,6 +80,7 @@ public:
 protected:
     void onChanged(const App::Property* prop);
     void setDistances();
+    void setDistances(int first, int last);
     QString inspectDistance(const SoPickedPoint* pp) const;
 
 protected:
@@ -35,6 +35,7 @@
 #include "Triangulation.h"
 
 #include <Base/Console.h>
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
 
 using namespace MeshCore;
@@ -2016,29 +2017,70 @@ MeshRefEdgeToFacets::operator[] (const MeshEdge& edge) const
 
 //----------------------------------------------------------------------------
 
+void MeshRefPointToCorners::Rebuild (void)
+{
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
+    unsigned long ulCtPoints = _rclMesh.CountPoints();
+
+    // counting sort of the corners by their point index
+    _aulOffsets.assign(ulCtPoints + 1, 0);
+    for (MeshFacetArray::_TConstIterator pF = rFacets.begin(); pF != rFacets.end(); ++pF) {
+        for (int i = 0; i < 3; i++)
+            _aulOffsets[pF->_aulPoints[i] + 1]++;
+    }
+    for (unsigned long i = 0; i < ulCtPoints; i++)
+        _aulOffsets[i + 1] += _aulOffsets[i];
+
+    std::vector<unsigned long> aulPos(_aulOffsets.begin(), _aulOffsets.end() - 1);
+    _aulCorners.resize(3 * rFacets.size());
+    unsigned long ulCorner = 0;
+    for (MeshFacetArray::_TConstIterator pF = rFacets.begin(); pF != rFacets.end(); ++pF) {
+        for (int i = 0; i < 3; i++)
+            _aulCorners[aulPos[pF->_aulPoints[i]]++] = ulCorner++;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
 void MeshRefNormalToPoints::Rebuild (void)
 {
     _norm.clear();
 
     const MeshPointArray& rPoints = _rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
     _norm.resize(rPoints.size());
 
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    for (MeshFacetArray::_TConstIterator pF = rFacets.begin(); pF != rFacets.end(); ++pF) {
-        const MeshPoint &p0 = rPoints[pF->_aulPoints[0]];
-        const MeshPoint &p1 = rPoints[pF->_aulPoints[1]];
-        const MeshPoint &p2 = rPoints[pF->_aulPoints[2]];
-        float l2p01 = Base::DistanceP2(p0,p1);
-        float l2p12 = Base::DistanceP2(p1,p2);
-        float l2p20 = Base::DistanceP2(p2,p0);
-
-        Base::Vector3f facenormal = _rclMesh.GetFacet(*pF).GetNormal();
-        _norm[pF->_aulPoints[0]] += facenormal * (1.0f / (l2p01 * l2p20));
-        _norm[pF->_aulPoints[1]] += facenormal * (1.0f / (l2p12 * l2p01));
-        _norm[pF->_aulPoints[2]] += facenormal * (1.0f / (l2p20 * l2p12));
-    }
-    for (std::vector<Base::Vector3f>::iterator it = _norm.begin(); it != _norm.end(); ++it)
-        it->Normalize();
+    // The weighted facet normal of each corner is computed per facet and then
+    // summed up per point in the order of the facets. So, the result doesn't
+    // depend on the number of threads.
+    std::vector<Base::Vector3f> aCornerNormals(3 * rFacets.size());
+    Base::parallel_for(rFacets.size(), 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (std::size_t i = ulBegin; i < ulEnd; i++) {
+            const MeshFacet& rFacet = rFacets[i];
+            const MeshPoint &p0 = rPoints[rFacet._aulPoints[0]];
+            const MeshPoint &p1 = rPoints[rFacet._aulPoints[1]];
+            const MeshPoint &p2 = rPoints[rFacet._aulPoints[2]];
+            float l2p01 = Base::DistanceP2(p0,p1);
+            float l2p12 = Base::DistanceP2(p1,p2);
+            float l2p20 = Base::DistanceP2(p2,p0);
+
+            Base::Vector3f facenormal = _rclMesh.GetFacet(rFacet).GetNormal();
+            aCornerNormals[3 * i    ] = facenormal * (1.0f / (l2p01 * l2p20));
+            aCornerNormals[3 * i + 1] = facenormal * (1.0f / (l2p12 * l2p01));
+            aCornerNormals[3 * i + 2] = facenormal * (1.0f / (l2p20 * l2p12));
+        }
+    });
+
+    MeshRefPointToCorners corners(_rclMesh);
+    Base::parallel_for(_norm.size(), 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (std::size_t i = ulBegin; i < ulEnd; i++) {
+            Base::Vector3f& normal = _norm[i];
+            std::vector<unsigned long>::const_iterator it;
+            for (it = corners.CornerBegin(i); it != corners.CornerEnd(i); ++it)
+                normal += aCornerNormals[*it];
+            normal.Normalize();
+        }
+    });
 }
 
 const Base::Vector3f&
@@ -499,6 +499,40 @@ protected:
     std::map<MeshEdge, MeshFacetPair, EdgeOrder> _map;
 };
 
+/**
+ * The MeshRefPointToCorners stores for each point the facet corners that refer to it.
+ * A corner is encoded as 3 * facet index + position of the point in the facet, and the
+ * corners of a point are sorted in ascending order. Contrary to MeshRefPointToFacets the
+ * data is kept in two flat arrays, so it is cheap to build and can be used to gather
+ * per-vertex values from the adjacent facets in a deterministic order.
+ * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
+ * be rebuilt.
+ */
+class MeshExport MeshRefPointToCorners
+{
+public:
+    /// Construction
+    MeshRefPointToCorners (const MeshKernel &rclM) : _rclMesh(rclM)
+    { Rebuild(); }
+    /// Destruction
+    ~MeshRefPointToCorners (void)
+    { }
+
+    /// Rebuilds up data structure
+    void Rebuild (void);
+    /// Returns the first corner of point \a ulPoint.
+    std::vector<unsigned long>::const_iterator CornerBegin (unsigned long ulPoint) const
+    { return _aulCorners.begin() + _aulOffsets[ulPoint]; }
+    /// Returns the end of the corners of point \a ulPoint.
+    std::vector<unsigned long>::const_iterator CornerEnd (unsigned long ulPoint) const
+    { return _aulCorners.begin() + _aulOffsets[ulPoint + 1]; }
+
+protected:
+    const MeshKernel  &_rclMesh; /**< The mesh kernel. */
+    std::vector<unsigned long> _aulOffsets; /**< Start of the corners of each point. */
+    std::vector<unsigned long> _aulCorners; /**< Corners of all points. */
+};
+
 /**
  * The MeshRefNormalToPoints builds up a structure to have access to the normal of a vertex.
  * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
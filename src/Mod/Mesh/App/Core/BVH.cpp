@@ -0,0 +1,765 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <atomic>
+# include <cfloat>
+# include <climits>
+# include <cmath>
+# include <functional>
+#endif
+
+#include <QThread>
+#include <Base/Exception.h>
+#include <Base/Parallel.h>
+
+#include "BVH.h"
+#include "MeshKernel.h"
+#include "Functional.h"
+
+using namespace MeshCore;
+
+namespace {
+const uint32_t MaxLeafSize = 4;     // leaves up to this size are created without split test
+const uint32_t MaxForcedLeaf = 16;  // larger leaves are split even if SAH doesn't gain anything
+const int NumBins = 16;             // bins per axis of the SAH evaluation
+const int MaxSAHDepth = 64;         // below this depth the facets are split at the median
+const int StackSize = 128;          // enough for MaxSAHDepth plus 32 median splits
+
+inline float boxArea(const float bmin[3], const float bmax[3])
+{
+    float dx = bmax[0] - bmin[0], dy = bmax[1] - bmin[1], dz = bmax[2] - bmin[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+inline void boxReset(float bmin[3], float bmax[3])
+{
+    bmin[0] = bmin[1] = bmin[2] =  FLOAT_MAX;
+    bmax[0] = bmax[1] = bmax[2] = -FLOAT_MAX;
+}
+
+inline bool boxOverlap(const float amin[3], const float amax[3], const float bmin[3], const float bmax[3])
+{
+    return amin[0] <= bmax[0] && bmin[0] <= amax[0] &&
+           amin[1] <= bmax[1] && bmin[1] <= amax[1] &&
+           amin[2] <= bmax[2] && bmin[2] <= amax[2];
+}
+
+inline void boxAdd(float bmin[3], float bmax[3], const float amin[3], const float amax[3])
+{
+    for (int i = 0; i < 3; i++) {
+        bmin[i] = std::min(bmin[i], amin[i]);
+        bmax[i] = std::max(bmax[i], amax[i]);
+    }
+}
+
+// Entry distance of the ray into the box or FLOAT_MAX if it misses the box within [0, tmax]
+inline float rayBox(const float bmin[3], const float bmax[3], const float org[3], const float inv[3], float tmax)
+{
+    float t0 = 0.0f, t1 = tmax;
+    for (int i = 0; i < 3; i++) {
+        float tn = (bmin[i] - org[i]) * inv[i];
+        float tf = (bmax[i] - org[i]) * inv[i];
+        t0 = std::max(t0, std::min(tn, tf));
+        t1 = std::min(t1, std::max(tn, tf));
+    }
+    return t0 <= t1 ? t0 : FLOAT_MAX;
+}
+
+// Squared distance of the point to the box, zero if the point is inside
+inline float pointBox(const float bmin[3], const float bmax[3], const float pt[3])
+{
+    float d2 = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float d = std::max(std::max(bmin[i] - pt[i], pt[i] - bmax[i]), 0.0f);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+// Nearest point to p on the triangle with corner a and edges ab, ac
+// (see Ericson, Real-Time Collision Detection, 5.1.5)
+inline Base::Vector3f closestPoint(const Base::Vector3f& p, const Base::Vector3f& a,
+                                   const Base::Vector3f& ab, const Base::Vector3f& ac)
+{
+    Base::Vector3f ap = p - a;
+    float d1 = ab * ap;
+    float d2 = ac * ap;
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+
+    Base::Vector3f bp = ap - ab;
+    float d3 = ab * bp;
+    float d4 = ac * bp;
+    if (d3 >= 0.0f && d4 <= d3)
+        return a + ab;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+
+    Base::Vector3f cp = ap - ac;
+    float d5 = ab * cp;
+    float d6 = ac * cp;
+    if (d6 >= 0.0f && d5 <= d6)
+        return a + ac;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float sum = va + vb + vc;
+    if (sum <= 0.0f) // degenerated triangle
+        return a;
+    return a + ab * (vb / sum) + ac * (vc / sum);
+}
+}
+
+struct MeshFacetBVH::BuildFacet
+{
+    float bmin[3];
+    float bmax[3];
+    float center[3];
+    uint32_t index;
+};
+
+MeshFacetBVH::MeshFacetBVH()
+{
+}
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel &rclMesh)
+{
+    Build(rclMesh, 0);
+}
+
+MeshFacetBVH::MeshFacetBVH(const MeshKernel &rclMesh, const Base::Matrix4D &rclMat)
+{
+    Build(rclMesh, &rclMat);
+}
+
+MeshFacetBVH::~MeshFacetBVH()
+{
+}
+
+void MeshFacetBVH::Build(const MeshKernel &rclMesh)
+{
+    Build(rclMesh, 0);
+}
+
+void MeshFacetBVH::Build(const MeshKernel &rclMesh, const Base::Matrix4D &rclMat)
+{
+    Build(rclMesh, &rclMat);
+}
+
+void MeshFacetBVH::Clear()
+{
+    std::vector<Node>().swap(_aclNodes);
+    std::vector<unsigned long>().swap(_aulFacets);
+    for (int i = 0; i < 9; i++)
+        std::vector<float>().swap(_afTriangles[i]);
+}
+
+bool MeshFacetBVH::IsBuiltFor(const MeshKernel &rclMesh) const
+{
+    unsigned long ulCtFacets = rclMesh.CountFacets();
+    if (ulCtFacets != _aulFacets.size())
+        return false;
+
+    // compare the stored triangles with the facets of the mesh in the same way as
+    // Build() computes them, so a match is exact and not within a tolerance
+    const MeshPointArray& rPoints = rclMesh.GetPoints();
+    const MeshFacetArray& rFacets = rclMesh.GetFacets();
+    std::atomic<bool> same(true);
+    Base::parallel_for(ulCtFacets, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (std::size_t i = ulBegin; i < ulEnd && same.load(std::memory_order_relaxed); i++) {
+            const MeshFacet& rFacet = rFacets[_aulFacets[i]];
+            const Base::Vector3f& p0 = rPoints[rFacet._aulPoints[0]];
+            Base::Vector3f e1 = rPoints[rFacet._aulPoints[1]] - p0;
+            Base::Vector3f e2 = rPoints[rFacet._aulPoints[2]] - p0;
+            if (_afTriangles[0][i] != p0.x || _afTriangles[1][i] != p0.y || _afTriangles[2][i] != p0.z ||
+                _afTriangles[3][i] != e1.x || _afTriangles[4][i] != e1.y || _afTriangles[5][i] != e1.z ||
+                _afTriangles[6][i] != e2.x || _afTriangles[7][i] != e2.y || _afTriangles[8][i] != e2.z)
+                same.store(false, std::memory_order_relaxed);
+        }
+    });
+
+    return same.load();
+}
+
+void MeshFacetBVH::Build(const MeshKernel &rclMesh, const Base::Matrix4D *pclMat)
+{
+    Clear();
+
+    unsigned long ulCtFacets = rclMesh.CountFacets();
+    if (ulCtFacets == 0)
+        return;
+    if (ulCtFacets > 0x7fffffffUL)
+        throw Base::ValueError("Too many facets for a bounding volume hierarchy");
+
+    // get the (transformed) triangles and their bounding boxes
+    std::vector<Base::Vector3f> corners(3 * ulCtFacets);
+    std::vector<BuildFacet> facets(ulCtFacets);
+    Base::parallel_for(ulCtFacets, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (unsigned long i = static_cast<unsigned long>(ulBegin); i < ulEnd; i++) {
+            MeshGeomFacet clFacet = rclMesh.GetFacet(i);
+            BuildFacet& facet = facets[i];
+            boxReset(facet.bmin, facet.bmax);
+            for (int j = 0; j < 3; j++) {
+                Base::Vector3f& p = corners[3 * i + j];
+                p = pclMat ? (*pclMat) * clFacet._aclPoints[j] : clFacet._aclPoints[j];
+                facet.bmin[0] = std::min(facet.bmin[0], p.x); facet.bmax[0] = std::max(facet.bmax[0], p.x);
+                facet.bmin[1] = std::min(facet.bmin[1], p.y); facet.bmax[1] = std::max(facet.bmax[1], p.y);
+                facet.bmin[2] = std::min(facet.bmin[2], p.z); facet.bmax[2] = std::max(facet.bmax[2], p.z);
+            }
+            for (int k = 0; k < 3; k++)
+                facet.center[k] = 0.5f * (facet.bmin[k] + facet.bmax[k]);
+            facet.index = static_cast<uint32_t>(i);
+        }
+    });
+
+    _aclNodes.reserve(2 * ulCtFacets / MaxLeafSize + 1);
+    BuildNode(facets, 0, static_cast<uint32_t>(ulCtFacets), 0);
+
+    // store the triangles in the order of the leaves
+    _aulFacets.resize(ulCtFacets);
+    for (int i = 0; i < 9; i++)
+        _afTriangles[i].resize(ulCtFacets);
+    for (unsigned long i = 0; i < ulCtFacets; i++) {
+        uint32_t index = facets[i].index;
+        const Base::Vector3f& p0 = corners[3 * index];
+        Base::Vector3f e1 = corners[3 * index + 1] - p0;
+        Base::Vector3f e2 = corners[3 * index + 2] - p0;
+        _aulFacets[i] = index;
+        _afTriangles[0][i] = p0.x; _afTriangles[1][i] = p0.y; _afTriangles[2][i] = p0.z;
+        _afTriangles[3][i] = e1.x; _afTriangles[4][i] = e1.y; _afTriangles[5][i] = e1.z;
+        _afTriangles[6][i] = e2.x; _afTriangles[7][i] = e2.y; _afTriangles[8][i] = e2.z;
+    }
+}
+
+uint32_t MeshFacetBVH::BuildNode(std::vector<BuildFacet> &facets, uint32_t first, uint32_t count, int depth)
+{
+    uint32_t nodeIndex = static_cast<uint32_t>(_aclNodes.size());
+    _aclNodes.push_back(Node());
+
+    float bmin[3], bmax[3], cmin[3], cmax[3];
+    boxReset(bmin, bmax);
+    boxReset(cmin, cmax);
+    for (uint32_t i = first; i < first + count; i++) {
+        boxAdd(bmin, bmax, facets[i].bmin, facets[i].bmax);
+        boxAdd(cmin, cmax, facets[i].center, facets[i].center);
+    }
+
+    Node& node = _aclNodes[nodeIndex];
+    std::copy(bmin, bmin + 3, node.bmin);
+    std::copy(bmax, bmax + 3, node.bmax);
+    node.first = first;
+    node.count = count;
+    if (count <= MaxLeafSize)
+        return nodeIndex;
+
+    // split along the axis with the largest extent of the facet centers
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (cmax[i] - cmin[i] > cmax[axis] - cmin[axis])
+            axis = i;
+    }
+    float extent = cmax[axis] - cmin[axis];
+
+    uint32_t mid = first + count / 2;
+    bool median = true;
+    if (extent > 0.0f && depth < MaxSAHDepth) {
+        // evaluate the surface area heuristic at the bin borders
+        uint32_t binCount[NumBins] = {0};
+        float binMin[NumBins][3], binMax[NumBins][3];
+        for (int b = 0; b < NumBins; b++)
+            boxReset(binMin[b], binMax[b]);
+
+        float scale = float(NumBins) / extent;
+        for (uint32_t i = first; i < first + count; i++) {
+            int b = std::min(NumBins - 1, int((facets[i].center[axis] - cmin[axis]) * scale));
+            binCount[b]++;
+            boxAdd(binMin[b], binMax[b], facets[i].bmin, facets[i].bmax);
+        }
+
+        float rightArea[NumBins];
+        uint32_t rightCount[NumBins];
+        float amin[3], amax[3];
+        boxReset(amin, amax);
+        uint32_t n = 0;
+        for (int b = NumBins - 1; b > 0; b--) {
+            n += binCount[b];
+            if (binCount[b] > 0)
+                boxAdd(amin, amax, binMin[b], binMax[b]);
+            rightCount[b] = n;
+            rightArea[b] = n > 0 ? boxArea(amin, amax) : 0.0f;
+        }
+
+        int bestBin = -1;
+        float bestCost = FLOAT_MAX;
+        boxReset(amin, amax);
+        n = 0;
+        for (int b = 1; b < NumBins; b++) {
+            n += binCount[b - 1];
+            if (binCount[b - 1] > 0)
+                boxAdd(amin, amax, binMin[b - 1], binMax[b - 1]);
+            if (n == 0 || rightCount[b] == 0)
+                continue;
+            float cost = boxArea(amin, amax) * float(n) + rightArea[b] * float(rightCount[b]);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+
+        if (bestBin > 0) {
+            // relative costs with a traversal step costing as much as a triangle test
+            float area = boxArea(bmin, bmax);
+            float splitCost = 1.0f + (area > 0.0f ? bestCost / area : float(count));
+            if (splitCost >= float(count) && count <= MaxForcedLeaf)
+                return nodeIndex;
+
+            BuildFacet* split = std::partition(&facets[first], &facets[first] + count, [&](const BuildFacet& f) {
+                return std::min(NumBins - 1, int((f.center[axis] - cmin[axis]) * scale)) < bestBin;
+            });
+            mid = static_cast<uint32_t>(split - &facets[0]);
+            median = (mid == first || mid == first + count);
+        }
+    }
+
+    if (median) {
+        mid = first + count / 2;
+        std::nth_element(facets.begin() + first, facets.begin() + mid, facets.begin() + first + count,
+            [axis](const BuildFacet& a, const BuildFacet& b) {
+            return a.center[axis] < b.center[axis];
+        });
+    }
+
+    BuildNode(facets, first, mid - first, depth + 1);
+    uint32_t right = BuildNode(facets, mid, first + count - mid, depth + 1);
+    _aclNodes[nodeIndex].first = right;
+    _aclNodes[nodeIndex].count = 0;
+    return nodeIndex;
+}
+
+Base::BoundBox3f MeshFacetBVH::GetBoundBox() const
+{
+    if (_aclNodes.empty())
+        return Base::BoundBox3f();
+    const Node& root = _aclNodes.front();
+    return Base::BoundBox3f(root.bmin[0], root.bmin[1], root.bmin[2],
+                            root.bmax[0], root.bmax[1], root.bmax[2]);
+}
+
+std::size_t MeshFacetBVH::GetMemSize() const
+{
+    return _aclNodes.capacity() * sizeof(Node) +
+           _aulFacets.capacity() * sizeof(unsigned long) +
+           9 * _afTriangles[0].capacity() * sizeof(float);
+}
+
+inline bool MeshFacetBVH::RayLeaf(const Node &node, const float org[3], const float dir[3],
+                                  float &tmax, uint32_t &facet) const
+{
+    // Moeller-Trumbore test of all triangles of the leaf
+    const float* px = &_afTriangles[0][0], *py = &_afTriangles[1][0], *pz = &_afTriangles[2][0];
+    const float* ax = &_afTriangles[3][0], *ay = &_afTriangles[4][0], *az = &_afTriangles[5][0];
+    const float* bx = &_afTriangles[6][0], *by = &_afTriangles[7][0], *bz = &_afTriangles[8][0];
+
+    bool hit = false;
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        float hx = dir[1] * bz[i] - dir[2] * by[i];
+        float hy = dir[2] * bx[i] - dir[0] * bz[i];
+        float hz = dir[0] * by[i] - dir[1] * bx[i];
+        float det = ax[i] * hx + ay[i] * hy + az[i] * hz;
+        float inv = 1.0f / det;
+        float sx = org[0] - px[i], sy = org[1] - py[i], sz = org[2] - pz[i];
+        float u = (sx * hx + sy * hy + sz * hz) * inv;
+        float qx = sy * az[i] - sz * ay[i];
+        float qy = sz * ax[i] - sx * az[i];
+        float qz = sx * ay[i] - sy * ax[i];
+        float v = (dir[0] * qx + dir[1] * qy + dir[2] * qz) * inv;
+        float t = (bx[i] * qx + by[i] * qy + bz[i] * qz) * inv;
+        bool ok = (det != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (t >= 0.0f) & (t < tmax);
+        if (ok) {
+            tmax = t;
+            facet = i;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+inline bool MeshFacetBVH::PointLeaf(const Node &node, const float pt[3], float &dist2, uint32_t &facet, float foot[3]) const
+{
+    Base::Vector3f p(pt[0], pt[1], pt[2]);
+    bool hit = false;
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        Base::Vector3f a(_afTriangles[0][i], _afTriangles[1][i], _afTriangles[2][i]);
+        Base::Vector3f ab(_afTriangles[3][i], _afTriangles[4][i], _afTriangles[5][i]);
+        Base::Vector3f ac(_afTriangles[6][i], _afTriangles[7][i], _afTriangles[8][i]);
+        Base::Vector3f c = closestPoint(p, a, ab, ac);
+        float d2 = Base::DistanceP2(c, p);
+        if (d2 < dist2) {
+            dist2 = d2;
+            facet = i;
+            foot[0] = c.x; foot[1] = c.y; foot[2] = c.z;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+bool MeshFacetBVH::NearestFacetOnRay(const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, Base::Vector3f &rclRes,
+                                     unsigned long &rulFacet, float fMaxDist) const
+{
+    float len = rclDir.Length();
+    if (_aclNodes.empty() || len == 0.0f)
+        return false;
+
+    // with a normalized direction the ray parameter is the distance
+    const float org[3] = {rclPt.x, rclPt.y, rclPt.z};
+    const float dir[3] = {rclDir.x / len, rclDir.y / len, rclDir.z / len};
+    const float inv[3] = {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+
+    struct Entry { uint32_t node; float t; };
+    Entry stack[StackSize];
+    int top = 0;
+
+    float tmax = fMaxDist;
+    uint32_t facet = 0;
+    bool hit = false;
+
+    const Node& root = _aclNodes.front();
+    float t = rayBox(root.bmin, root.bmax, org, inv, tmax);
+    if (t == FLOAT_MAX)
+        return false;
+    stack[top].node = 0;
+    stack[top].t = t;
+    top++;
+
+    while (top > 0) {
+        top--;
+        if (stack[top].t > tmax)
+            continue; // a nearer intersection was found meanwhile
+        const Node* node = &_aclNodes[stack[top].node];
+        while (node->count == 0) {
+            uint32_t left = static_cast<uint32_t>(node - &_aclNodes[0]) + 1;
+            uint32_t right = node->first;
+            float tl = rayBox(_aclNodes[left].bmin, _aclNodes[left].bmax, org, inv, tmax);
+            float tr = rayBox(_aclNodes[right].bmin, _aclNodes[right].bmax, org, inv, tmax);
+            if (tl == FLOAT_MAX && tr == FLOAT_MAX) {
+                node = 0;
+                break;
+            }
+            if (tl == FLOAT_MAX) {
+                node = &_aclNodes[right];
+            }
+            else if (tr == FLOAT_MAX) {
+                node = &_aclNodes[left];
+            }
+            else if (tl <= tr) {
+                stack[top].node = right;
+                stack[top].t = tr;
+                top++;
+                node = &_aclNodes[left];
+            }
+            else {
+                stack[top].node = left;
+                stack[top].t = tl;
+                top++;
+                node = &_aclNodes[right];
+            }
+        }
+
+        if (node && RayLeaf(*node, org, dir, tmax, facet))
+            hit = true;
+    }
+
+    if (hit) {
+        rclRes.Set(org[0] + tmax * dir[0], org[1] + tmax * dir[1], org[2] + tmax * dir[2]);
+        rulFacet = _aulFacets[facet];
+    }
+
+    return hit;
+}
+
+bool MeshFacetBVH::NearestFacetToPoint(const Base::Vector3f &rclPt, unsigned long &rulFacet, Base::Vector3f &rclFoot,
+                                       float &rfDist, float fMaxDist) const
+{
+    if (_aclNodes.empty())
+        return false;
+
+    const float pt[3] = {rclPt.x, rclPt.y, rclPt.z};
+    float dist2 = fMaxDist < FLOAT_MAX ? fMaxDist * fMaxDist : FLOAT_MAX;
+    float foot[3];
+    uint32_t facet = 0;
+    bool hit = false;
+
+    struct Entry { uint32_t node; float d2; };
+    Entry stack[StackSize];
+    int top = 0;
+
+    const Node& root = _aclNodes.front();
+    float d2 = pointBox(root.bmin, root.bmax, pt);
+    if (d2 > dist2)
+        return false;
+    stack[top].node = 0;
+    stack[top].d2 = d2;
+    top++;
+
+    while (top > 0) {
+        top--;
+        if (stack[top].d2 > dist2)
+            continue;
+        const Node* node = &_aclNodes[stack[top].node];
+        while (node->count == 0) {
+            uint32_t left = static_cast<uint32_t>(node - &_aclNodes[0]) + 1;
+            uint32_t right = node->first;
+            float dl = pointBox(_aclNodes[left].bmin, _aclNodes[left].bmax, pt);
+            float dr = pointBox(_aclNodes[right].bmin, _aclNodes[right].bmax, pt);
+            if (dl > dist2 && dr > dist2) {
+                node = 0;
+                break;
+            }
+            if (dl > dist2) {
+                node = &_aclNodes[right];
+            }
+            else if (dr > dist2) {
+                node = &_aclNodes[left];
+            }
+            else if (dl <= dr) {
+                stack[top].node = right;
+                stack[top].d2 = dr;
+                top++;
+                node = &_aclNodes[left];
+            }
+            else {
+                stack[top].node = left;
+                stack[top].d2 = dl;
+                top++;
+                node = &_aclNodes[right];
+            }
+        }
+
+        if (node && PointLeaf(*node, pt, dist2, facet, foot))
+            hit = true;
+    }
+
+    if (hit) {
+        rulFacet = _aulFacets[facet];
+        rclFoot.Set(foot[0], foot[1], foot[2]);
+        rfDist = std::sqrt(dist2);
+    }
+
+    return hit;
+}
+
+unsigned long MeshFacetBVH::SearchNearestFromPoint(const Base::Vector3f &rclPt, float fMaxDist) const
+{
+    unsigned long ulFacet;
+    Base::Vector3f clFoot;
+    float fDist;
+    if (NearestFacetToPoint(rclPt, ulFacet, clFoot, fDist, fMaxDist))
+        return ulFacet;
+    return ULONG_MAX;
+}
+
+void MeshFacetBVH::NearestFacetsOnRays(const std::vector<Base::Vector3f> &raclPts, const std::vector<Base::Vector3f> &raclDirs,
+                                       std::vector<unsigned long> &raulFacets, std::vector<Base::Vector3f> &raclRes,
+                                       float fMaxDist) const
+{
+    std::size_t count = std::min(raclPts.size(), raclDirs.size());
+    raulFacets.resize(count);
+    raclRes.resize(count);
+
+    Base::parallel_for(count, 256, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            if (!NearestFacetOnRay(raclPts[i], raclDirs[i], raclRes[i], raulFacets[i], fMaxDist)) {
+                raulFacets[i] = ULONG_MAX;
+                raclRes[i] = raclPts[i];
+            }
+        }
+    });
+}
+
+inline void MeshFacetBVH::TriangleBox(uint32_t tri, float bmin[3], float bmax[3]) const
+{
+    for (int k = 0; k < 3; k++) {
+        float v0 = _afTriangles[k][tri];
+        float v1 = v0 + _afTriangles[3 + k][tri];
+        float v2 = v0 + _afTriangles[6 + k][tri];
+        // the corners are restored from the edges so widen the box by their rounding error
+        float eps = (std::fabs(v0) + std::fabs(v1) + std::fabs(v2)) * FLT_EPSILON;
+        bmin[k] = std::min(v0, std::min(v1, v2)) - eps;
+        bmax[k] = std::max(v0, std::max(v1, v2)) + eps;
+    }
+}
+
+// Appends the pairs of child nodes to be tested next and returns 1. If the nodes don't overlap
+// 0 is returned and 2 for a pair of leaves.
+int MeshFacetBVH::SplitNodes(const MeshFacetBVH &rclOther, bool self, const NodePair &pair,
+                             std::vector<NodePair> &raclPairs) const
+{
+    const Node& a = _aclNodes[pair.first];
+    const Node& b = rclOther._aclNodes[pair.second];
+    if (self && pair.first == pair.second) {
+        // a subtree against itself: both halves against themselves and against each other
+        if (a.count > 0)
+            return 2;
+        raclPairs.emplace_back(pair.first + 1, pair.first + 1);
+        raclPairs.emplace_back(a.first, a.first);
+        raclPairs.emplace_back(pair.first + 1, a.first);
+        return 1;
+    }
+
+    if (!boxOverlap(a.bmin, a.bmax, b.bmin, b.bmax))
+        return 0;
+    if (a.count > 0 && b.count > 0)
+        return 2;
+
+    // descend into the larger of both inner nodes
+    if (b.count > 0 || (a.count == 0 && boxArea(a.bmin, a.bmax) >= boxArea(b.bmin, b.bmax))) {
+        raclPairs.emplace_back(pair.first + 1, pair.second);
+        raclPairs.emplace_back(a.first, pair.second);
+    }
+    else {
+        raclPairs.emplace_back(pair.first, pair.second + 1);
+        raclPairs.emplace_back(pair.first, b.first);
+    }
+    return 1;
+}
+
+void MeshFacetBVH::OverlapNodes(const MeshFacetBVH &rclOther, bool self, const NodePair &pair,
+                                std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const
+{
+    std::vector<NodePair> stack;
+    stack.push_back(pair);
+
+    float amin[3], amax[3], bmin[3], bmax[3];
+    while (!stack.empty()) {
+        NodePair top = stack.back();
+        stack.pop_back();
+        if (SplitNodes(rclOther, self, top, stack) != 2)
+            continue;
+
+        const Node& a = _aclNodes[top.first];
+        const Node& b = rclOther._aclNodes[top.second];
+        bool sameLeaf = self && top.first == top.second;
+        for (uint32_t i = a.first; i < a.first + a.count; i++) {
+            TriangleBox(i, amin, amax);
+            if (!boxOverlap(amin, amax, b.bmin, b.bmax))
+                continue;
+            for (uint32_t j = sameLeaf ? i + 1 : b.first; j < b.first + b.count; j++) {
+                rclOther.TriangleBox(j, bmin, bmax);
+                if (!boxOverlap(amin, amax, bmin, bmax))
+                    continue;
+                unsigned long facet0 = _aulFacets[i];
+                unsigned long facet1 = rclOther._aulFacets[j];
+                if (self && facet0 > facet1)
+                    std::swap(facet0, facet1);
+                raulPairs.emplace_back(facet0, facet1);
+            }
+        }
+    }
+}
+
+void MeshFacetBVH::SearchOverlappingFacets(const MeshFacetBVH &rclOther, bool self,
+                                           std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const
+{
+    raulPairs.clear();
+    if (_aclNodes.empty() || rclOther._aclNodes.empty())
+        return;
+
+    // Expand the node pairs breadth-first until there are enough independent sub-traversals
+    // to keep all threads busy. Pairs of leaves are kept as they are.
+    std::vector<NodePair> tasks(1, NodePair(0, 0));
+    std::size_t wanted = 16 * static_cast<std::size_t>(QThread::idealThreadCount());
+    bool split = true;
+    while (split && tasks.size() < wanted) {
+        split = false;
+        std::vector<NodePair> next;
+        next.reserve(3 * tasks.size());
+        for (std::vector<NodePair>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+            int ret = SplitNodes(rclOther, self, *it, next);
+            if (ret == 1)
+                split = true;
+            else if (ret == 2)
+                next.push_back(*it);
+        }
+        tasks.swap(next);
+    }
+
+    std::vector<std::vector<std::pair<unsigned long, unsigned long> > > results(tasks.size());
+    Base::parallel_for(tasks.size(), [&](std::size_t i) {
+        OverlapNodes(rclOther, self, tasks[i], results[i]);
+    });
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < results.size(); i++)
+        count += results[i].size();
+    raulPairs.reserve(count);
+    for (std::size_t i = 0; i < results.size(); i++)
+        raulPairs.insert(raulPairs.end(), results[i].begin(), results[i].end());
+
+    parallel_sort(raulPairs.begin(), raulPairs.end(), std::less<std::pair<unsigned long, unsigned long> >(),
+                  QThread::idealThreadCount());
+}
+
+void MeshFacetBVH::SearchOverlappingFacets(const MeshFacetBVH &rclOther,
+                                           std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const
+{
+    SearchOverlappingFacets(rclOther, false, raulPairs);
+}
+
+void MeshFacetBVH::SearchOverlappingFacets(std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const
+{
+    SearchOverlappingFacets(*this, true, raulPairs);
+}
+
+void MeshFacetBVH::NearestFacetsToPoints(const std::vector<Base::Vector3f> &raclPts, std::vector<unsigned long> &raulFacets,
+                                         std::vector<float> &rafDist, float fMaxDist) const
+{
+    std::size_t count = raclPts.size();
+    raulFacets.resize(count);
+    rafDist.resize(count);
+
+    Base::parallel_for(count, 256, [&](std::size_t, std::size_t first, std::size_t last) {
+        Base::Vector3f clFoot;
+        for (std::size_t i = first; i < last; i++) {
+            if (!NearestFacetToPoint(raclPts[i], raulFacets[i], clFoot, rafDist[i], fMaxDist)) {
+                raulFacets[i] = ULONG_MAX;
+                rafDist[i] = FLOAT_MAX;
+            }
+        }
+    });
+}
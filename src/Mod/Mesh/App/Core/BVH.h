@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+#include "Definitions.h"
+
+namespace MeshCore
+{
+
+class MeshKernel;
+
+/**
+ * The MeshFacetBVH class is a bounding volume hierarchy over the facets of a mesh.
+ *
+ * The hierarchy is built with the surface area heuristic (SAH) and thus adapts to
+ * the distribution of the facets. Unlike MeshFacetGrid whose cells all have the same
+ * size it stays efficient for meshes where facet sizes vary a lot, e.g. tessellations
+ * of CAD models with large planar faces next to finely resolved fillets.
+ *
+ * The hierarchy keeps its own copy of the triangles in a struct-of-arrays layout so
+ * that the ray and distance tests of a leaf run over contiguous memory. Therefore the
+ * mesh is not needed after Build() but the hierarchy must be rebuilt when the mesh
+ * changes, see IsBuiltFor(). All queries are const and can be used from several threads at once; the
+ * batched queries distribute their work over the global thread pool.
+ */
+class MeshExport MeshFacetBVH
+{
+public:
+  /// Construction
+  MeshFacetBVH ();
+  /// Construction
+  explicit MeshFacetBVH (const MeshKernel &rclMesh);
+  /// Construction with the facets transformed by \a rclMat
+  MeshFacetBVH (const MeshKernel &rclMesh, const Base::Matrix4D &rclMat);
+  /// Destruction
+  ~MeshFacetBVH ();
+
+  /** @name Construction */
+  //@{
+  /** Builds the hierarchy over all facets of \a rclMesh. An already built hierarchy is replaced. */
+  void Build (const MeshKernel &rclMesh);
+  /** Builds the hierarchy over all facets of \a rclMesh transformed by \a rclMat. */
+  void Build (const MeshKernel &rclMesh, const Base::Matrix4D &rclMat);
+  /** Removes all data. */
+  void Clear ();
+  //@}
+
+  /** @name Information */
+  //@{
+  /** Returns the number of facets in the hierarchy. */
+  unsigned long CountFacets () const
+  { return static_cast<unsigned long>(_aulFacets.size()); }
+  /** Returns the number of nodes of the hierarchy. */
+  unsigned long CountNodes () const
+  { return static_cast<unsigned long>(_aclNodes.size()); }
+  /** Returns the bounding box of all facets. */
+  Base::BoundBox3f GetBoundBox () const;
+  /** Returns the memory used by the hierarchy in bytes. */
+  std::size_t GetMemSize () const;
+  /**
+   * Checks whether the hierarchy was built over exactly the facets of \a rclMesh without a
+   * transformation, i.e. whether it is still up-to-date for the mesh. This runs in linear
+   * time and is thus much cheaper than a rebuild.
+   */
+  bool IsBuiltFor (const MeshKernel &rclMesh) const;
+  //@}
+
+  /** @name Search */
+  //@{
+  /**
+   * Searches for the nearest facet hit by the ray (\a rclPt, \a rclDir). Only intersections
+   * in direction of \a rclDir with a distance to \a rclPt of at most \a fMaxDist are taken
+   * into account. Returns true if a facet is found in which case \a rclRes is the intersection
+   * point and \a rulFacet the index of the facet.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, Base::Vector3f &rclRes,
+                          unsigned long &rulFacet, float fMaxDist = FLOAT_MAX) const;
+  /**
+   * Searches for the facet with the shortest distance to \a rclPt, not farther away than
+   * \a fMaxDist. Returns true if a facet is found in which case \a rulFacet is its index,
+   * \a rclFoot the nearest point on the facet and \a rfDist the distance.
+   */
+  bool NearestFacetToPoint (const Base::Vector3f &rclPt, unsigned long &rulFacet, Base::Vector3f &rclFoot,
+                            float &rfDist, float fMaxDist = FLOAT_MAX) const;
+  /**
+   * Returns the index of the facet with the shortest distance to \a rclPt, not farther away
+   * than \a fMaxDist, or ULONG_MAX if there is no such facet.
+   */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist = FLOAT_MAX) const;
+  //@}
+
+  /** @name Batched search */
+  //@{
+  /**
+   * Does the same as NearestFacetOnRay() for each pair of \a raclPts and \a raclDirs in parallel.
+   * For rays without an intersection the facet index is ULONG_MAX and the point is the start point.
+   */
+  void NearestFacetsOnRays (const std::vector<Base::Vector3f> &raclPts, const std::vector<Base::Vector3f> &raclDirs,
+                            std::vector<unsigned long> &raulFacets, std::vector<Base::Vector3f> &raclRes,
+                            float fMaxDist = FLOAT_MAX) const;
+  /**
+   * Does the same as NearestFacetToPoint() for each point of \a raclPts in parallel. For points
+   * without a facet in the search radius the facet index is ULONG_MAX and the distance FLOAT_MAX.
+   */
+  void NearestFacetsToPoints (const std::vector<Base::Vector3f> &raclPts, std::vector<unsigned long> &raulFacets,
+                              std::vector<float> &rafDist, float fMaxDist = FLOAT_MAX) const;
+  /**
+   * Searches for all pairs of a facet of this hierarchy and a facet of \a rclOther whose bounding
+   * boxes overlap. Both hierarchies are traversed simultaneously and the pairs of subtrees are
+   * processed in parallel. The first element of a pair is the facet index of this mesh, the second
+   * one of the other mesh. The pairs are sorted so that the result doesn't depend on the number of
+   * threads.
+   */
+  void SearchOverlappingFacets (const MeshFacetBVH &rclOther,
+                                std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const;
+  /**
+   * Searches for all pairs of different facets of this hierarchy whose bounding boxes overlap.
+   * Each pair is reported once with the lower facet index first. The pairs are sorted.
+   */
+  void SearchOverlappingFacets (std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const;
+  //@}
+
+private:
+  /** A node covers the facets [first, first+count) if it is a leaf, otherwise its children are
+   * the next node and the node \a first. */
+  struct Node
+  {
+    float bmin[3];
+    float bmax[3];
+    uint32_t first;
+    uint32_t count;
+  };
+  struct BuildFacet;
+  typedef std::pair<uint32_t, uint32_t> NodePair;
+
+  void Build (const MeshKernel &rclMesh, const Base::Matrix4D *pclMat);
+  uint32_t BuildNode (std::vector<BuildFacet> &facets, uint32_t first, uint32_t count, int depth);
+  inline bool RayLeaf (const Node &node, const float org[3], const float dir[3], float &tmax, uint32_t &facet) const;
+  inline bool PointLeaf (const Node &node, const float pt[3], float &dist2, uint32_t &facet, float foot[3]) const;
+  inline void TriangleBox (uint32_t tri, float bmin[3], float bmax[3]) const;
+  int SplitNodes (const MeshFacetBVH &rclOther, bool self, const NodePair &pair, std::vector<NodePair> &raclPairs) const;
+  void OverlapNodes (const MeshFacetBVH &rclOther, bool self, const NodePair &pair,
+                     std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const;
+  void SearchOverlappingFacets (const MeshFacetBVH &rclOther, bool self,
+                                std::vector<std::pair<unsigned long, unsigned long> > &raulPairs) const;
+
+  std::vector<Node> _aclNodes;           /**< Nodes in depth-first order, the root is the first node. */
+  std::vector<unsigned long> _aulFacets; /**< Facet index of the mesh for each triangle. */
+  std::vector<float> _afTriangles[9];    /**< Corner, first and second edge of the triangles as x,y,z arrays. */
+};
+
+} // namespace MeshCore
+
+
+#endif // MESH_BVH_H
@@ -25,15 +25,19 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cstring>
+# include <limits>
 #endif
 
 #include <Base/Sequencer.h>
 #include <Base/Exception.h>
+#include <Base/Parallel.h>
+#include <Base/Swap.h>
 
 #include "Builder.h"
 #include "MeshKernel.h"
 #include "Functional.h"
-#include <QVector>
+#include <QThread>
 
 using namespace MeshCore;
 
@@ -267,7 +271,9 @@ struct MeshFastBuilder::Private {
         Vertex(float x, float y, float z) : x(x), y(y), z(z), i(0) {}
 
         float x, y, z;
-        size_type i;
+        // keep the vertex at 16 bytes, a 32-bit index is sufficient for
+        // more than a billion facets
+        uint32_t i;
 
         bool operator!=(const Vertex& rhs) const
         {
@@ -282,8 +288,35 @@ struct MeshFastBuilder::Private {
         }
     };
 
-    // Hint: Using a QVector instead of std::vector is a bit faster
-    QVector<Vertex> verts;
+    // Hint: A QVector would be a bit faster but is limited to 2GB of data
+    // which is reached by meshes of ~45 million facets
+    std::vector<Vertex> verts;
+
+    static void decodeFacets(const char* data, std::size_t stride,
+                             Vertex* verts, std::size_t count, bool swap)
+    {
+        float coords[9];
+        for (std::size_t i = 0; i < count; i++) {
+            std::memcpy(coords, data, sizeof(coords));
+            if (swap) {
+                for (int j = 0; j < 9; j++)
+                    Base::SwapEndian<float>(coords[j]);
+            }
+            for (int j = 0; j < 3; j++) {
+                verts->x = coords[3*j];
+                verts->y = coords[3*j+1];
+                verts->z = coords[3*j+2];
+                ++verts;
+            }
+            data += stride;
+        }
+    }
+
+    static void setIndices(Vertex* verts, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+            verts[i].i = static_cast<uint32_t>(i);
+    }
 };
 
 MeshFastBuilder::MeshFastBuilder(MeshKernel &rclM) : _meshKernel(rclM), p(new Private)
@@ -322,44 +355,57 @@ void MeshFastBuilder::AddFacet (const MeshGeomFacet& facetPoints)
     }
 }
 
+void MeshFastBuilder::AddFacets (const char* data, size_type stride, size_type ctFacets, bool littleEndian)
+{
+    if (ctFacets == 0)
+        return;
+
+    std::vector<Private::Vertex>& verts = p->verts;
+    size_type offset = verts.size();
+    if (offset + 3 * ctFacets > std::numeric_limits<uint32_t>::max())
+        throw Base::ValueError("Too many facets for the mesh builder");
+    verts.resize(offset + 3 * ctFacets);
+    bool swap = littleEndian && Base::SwapOrder() == HIGH_ENDIAN;
+
+    // Each block of facet records is decoded into its own range of the vertex array
+    Base::parallel_for(ctFacets, 4096, [&](std::size_t, std::size_t first, std::size_t last) {
+        Private::decodeFacets(data + first * stride, stride, &verts[offset + 3 * first], last - first, swap);
+    });
+}
+
 void MeshFastBuilder::Finish ()
 {
-    typedef QVector<Private::Vertex>::size_type size_type;
-    QVector<Private::Vertex>& verts = p->verts;
+    std::vector<Private::Vertex>& verts = p->verts;
     size_type ulCtPts = verts.size();
-    for (size_type i=0; i < ulCtPts; ++i) {
-        verts[i].i = i;
-    }
+    size_type ulCt = ulCtPts/3;
+
+    Base::parallel_for(ulCtPts, 4096, [&](std::size_t, std::size_t first, std::size_t last) {
+        Private::setIndices(verts.data(), first, last);
+    });
 
-    //std::sort(verts.begin(), verts.end());
     int threads = std::max(1, QThread::idealThreadCount());
     MeshCore::parallel_sort(verts.begin(), verts.end(), std::less<Private::Vertex>(), threads);
 
-    QVector<unsigned long> indices(ulCtPts);
-
+    // write the point indices directly into the facets to avoid an
+    // additional index array
+    MeshFacetArray rFacets(ulCt);
     size_type vertex_count = 0;
-    for (QVector<Private::Vertex>::iterator v = verts.begin(); v != verts.end(); ++v) {
+    for (std::vector<Private::Vertex>::iterator v = verts.begin(); v != verts.end(); ++v) {
         if (!vertex_count || *v != verts[vertex_count-1])
             verts[vertex_count++] = *v;
 
-        indices[v->i] = static_cast<unsigned long>(vertex_count - 1);
-    }
-
-    size_type ulCt = verts.size()/3;
-    MeshFacetArray rFacets(static_cast<unsigned long>(ulCt));
-    for (size_type i=0; i < ulCt; ++i) {
-        rFacets[static_cast<size_t>(i)]._aulPoints[0] = indices[3*i];
-        rFacets[static_cast<size_t>(i)]._aulPoints[1] = indices[3*i + 1];
-        rFacets[static_cast<size_t>(i)]._aulPoints[2] = indices[3*i + 2];
+        rFacets[v->i / 3]._aulPoints[v->i % 3] = static_cast<unsigned long>(vertex_count - 1);
     }
 
-    verts.resize(vertex_count);
-
     MeshPointArray rPoints;
-    rPoints.reserve(static_cast<size_t>(vertex_count));
-    for (QVector<Private::Vertex>::iterator v = verts.begin(); v != verts.end(); ++v) {
-        rPoints.push_back(MeshPoint(v->x, v->y, v->z));
+    rPoints.reserve(vertex_count);
+    for (size_type i = 0; i < vertex_count; ++i) {
+        const Private::Vertex& v = verts[i];
+        rPoints.push_back(MeshPoint(v.x, v.y, v.z));
     }
 
+    // release the memory of the vertex array before building up the topology
+    std::vector<Private::Vertex>().swap(verts);
+
     _meshKernel.Adopt(rPoints, rFacets, true);
 }
@@ -187,7 +187,7 @@ private:
     MeshKernel& _meshKernel;
 
 public:
-    typedef int size_type;
+    typedef std::size_t size_type;
     MeshFastBuilder(MeshKernel &rclM);
     ~MeshFastBuilder(void);
 
@@ -201,6 +201,15 @@ public:
     /** Add new facet
      */
     void AddFacet (const MeshGeomFacet& facetPoints);
+    /** Add \a ctFacets new facets from a memory block.
+     * Each facet record must start with the nine coordinates of its three points
+     * as float values. Two consecutive records are \a stride bytes apart. This
+     * makes it possible to pass e.g. the records of a binary STL file directly.
+     * If \a littleEndian is true the coordinates are stored in little-endian byte
+     * order, as in binary STL files, and are swapped on big-endian machines.
+     * The records are decoded in parallel.
+     */
+    void AddFacets (const char* data, size_type stride, size_type ctFacets, bool littleEndian=false);
 
     /** Finishes building up the mesh structure. Must be done after adding facets.
      */
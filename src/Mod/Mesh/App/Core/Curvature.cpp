@@ -35,7 +35,8 @@
 #include <Eigen/Eigenvalues>
 #else
 #include <Mod/Mesh/App/WildMagic4/Wm4Vector3.h>
-#include <Mod/Mesh/App/WildMagic4/Wm4MeshCurvature.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix2.h>
+#include <Mod/Mesh/App/WildMagic4/Wm4Matrix3.h>
 #endif
 
 #include "Curvature.h"
@@ -44,6 +45,7 @@
 #include "MeshKernel.h"
 #include "Iterator.h"
 #include "Tools.h"
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
 
@@ -293,47 +295,140 @@ void MeshCurvature::ComputePerVertex()
 {
     myCurvature.clear();
 
-    // get all points
-    std::vector< Wm4::Vector3<double> > aPnts;
-    aPnts.reserve(myKernel.CountPoints());
-    MeshPointIterator cPIt(myKernel);
-    for (cPIt.Init(); cPIt.More(); cPIt.Next()) {
-        Wm4::Vector3<double> cP(cPIt->x, cPIt->y, cPIt->z);
-        aPnts.push_back(cP);
-    }
-
-    // get all point connections
-    std::vector<int> aIdx;
-    aIdx.reserve(3*myKernel.CountFacets());
-    const MeshFacetArray& raFts = myKernel.GetFacets();
-    for (MeshFacetArray::const_iterator jt = raFts.begin(); jt != raFts.end(); ++jt) {
-        for (int i=0; i<3; i++) {
-            aIdx.push_back((int)jt->_aulPoints[i]);
-        }
-    }
-
     // in case of an empty mesh no curvature can be calculated
     if (myKernel.CountPoints() == 0 || myKernel.CountFacets() == 0)
         return;
 
-    // compute vertex based curvatures
-    Wm4::MeshCurvature<double> meshCurv(myKernel.CountPoints(), &(aPnts[0]), myKernel.CountFacets(), &(aIdx[0]));
+    // This is the algorithm of Wm4::MeshCurvature but instead of scattering the
+    // contributions of a facet to its vertexes each vertex gathers them from its
+    // adjacent facets. As the facets are visited in the same order the results
+    // are identical to the serial version and don't depend on the number of threads.
+    const MeshPointArray& rPoints = myKernel.GetPoints();
+    const MeshFacetArray& rFacets = myKernel.GetFacets();
+    MeshRefPointToCorners corners(myKernel);
+    unsigned long ulCtPoints = myKernel.CountPoints();
+    auto vertex = [&rPoints](unsigned long index) {
+        const MeshPoint& p = rPoints[index];
+        return Wm4::Vector3<double>(p.x, p.y, p.z);
+    };
+
+    std::vector< Wm4::Vector3<double> > akNormal(ulCtPoints);
+    myCurvature.resize(ulCtPoints);
+
+    Base::SequencerLauncher seq("Curvature estimation", 2 * ulCtPoints);
+
+    // compute normal vectors (length provides a weighted sum)
+    Base::parallel_for(ulCtPoints, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (unsigned long i = ulBegin; i < ulEnd; i++) {
+            Wm4::Vector3<double> kNormal(0.0, 0.0, 0.0);
+            std::vector<unsigned long>::const_iterator it;
+            for (it = corners.CornerBegin(i); it != corners.CornerEnd(i); ++it) {
+                const MeshFacet& rFacet = rFacets[*it / 3];
+                Wm4::Vector3<double> kVertex0 = vertex(rFacet._aulPoints[0]);
+                Wm4::Vector3<double> kEdge1 = vertex(rFacet._aulPoints[1]) - kVertex0;
+                Wm4::Vector3<double> kEdge2 = vertex(rFacet._aulPoints[2]) - kVertex0;
+                kNormal += kEdge1.Cross(kEdge2);
+            }
+            kNormal.Normalize();
+            akNormal[i] = kNormal;
+        }
+    }, seq);
+
+    Base::parallel_for(ulCtPoints, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (unsigned long i = ulBegin; i < ulEnd; i++) {
+            // compute the matrix of normal derivatives
+            Wm4::Matrix3<double> kWWTrn(true);
+            Wm4::Matrix3<double> kDWTrn(true);
+            const Wm4::Vector3<double>& kN = akNormal[i];
+            Wm4::Vector3<double> kV0 = vertex(i);
+
+            std::vector<unsigned long>::const_iterator it;
+            for (it = corners.CornerBegin(i); it != corners.CornerEnd(i); ++it) {
+                const MeshFacet& rFacet = rFacets[*it / 3];
+                unsigned long j = *it % 3;
+                unsigned long aulAdj[2] = {
+                    rFacet._aulPoints[(j + 1) % 3],
+                    rFacet._aulPoints[(j + 2) % 3]
+                };
+
+                // Compute edge from V0 to the adjacent vertex, project to tangent
+                // plane of vertex, and compute difference of adjacent normals.
+                for (int k = 0; k < 2; k++) {
+                    Wm4::Vector3<double> kE = vertex(aulAdj[k]) - kV0;
+                    Wm4::Vector3<double> kW = kE - (kE.Dot(kN))*kN;
+                    Wm4::Vector3<double> kD = akNormal[aulAdj[k]] - kN;
+                    for (int iRow = 0; iRow < 3; iRow++) {
+                        for (int iCol = 0; iCol < 3; iCol++) {
+                            kWWTrn[iRow][iCol] += kW[iRow]*kW[iCol];
+                            kDWTrn[iRow][iCol] += kD[iRow]*kW[iCol];
+                        }
+                    }
+                }
+            }
+
+            // Add in N*N^T to W*W^T for numerical stability.
+            for (int iRow = 0; iRow < 3; iRow++) {
+                for (int iCol = 0; iCol < 3; iCol++) {
+                    kWWTrn[iRow][iCol] = 0.5*kWWTrn[iRow][iCol] + kN[iRow]*kN[iCol];
+                    kDWTrn[iRow][iCol] *= 0.5;
+                }
+            }
 
-    // get curvature information now
-    const Wm4::Vector3<double>* aMaxCurvDir = meshCurv.GetMaxDirections();
-    const Wm4::Vector3<double>* aMinCurvDir = meshCurv.GetMinDirections();
-    const double* aMaxCurv = meshCurv.GetMaxCurvatures();
-    const double* aMinCurv = meshCurv.GetMinCurvatures();
+            Wm4::Matrix3<double> kDNormal = kDWTrn*kWWTrn.Inverse();
+
+            // compute U and V given N
+            Wm4::Vector3<double> kU, kV;
+            Wm4::Vector3<double>::GenerateComplementBasis(kU,kV,kN);
+
+            // Compute S = J^T * dN/dX * J and make sure it is symmetric
+            double fS01 = kU.Dot(kDNormal*kV);
+            double fS10 = kV.Dot(kDNormal*kU);
+            double fSAvr = 0.5*(fS01+fS10);
+            Wm4::Matrix2<double> kS
+            (
+                kU.Dot(kDNormal*kU), fSAvr,
+                fSAvr, kV.Dot(kDNormal*kV)
+            );
+
+            // compute the eigenvalues of S (min and max curvatures)
+            double fTrace = kS[0][0] + kS[1][1];
+            double fDet = kS[0][0]*kS[1][1] - kS[0][1]*kS[1][0];
+            double fDiscr = fTrace*fTrace - 4.0*fDet;
+            double fRootDiscr = sqrt(fabs(fDiscr));
+            double fMinCurvature = 0.5*(fTrace - fRootDiscr);
+            double fMaxCurvature = 0.5*(fTrace + fRootDiscr);
+
+            // compute the eigenvectors of S
+            Wm4::Vector3<double> kMinDirection, kMaxDirection;
+            Wm4::Vector2<double> kW0(kS[0][1],fMinCurvature-kS[0][0]);
+            Wm4::Vector2<double> kW1(fMinCurvature-kS[1][1],kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMinDirection = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMinDirection = kW1.X()*kU + kW1.Y()*kV;
+            }
 
-    myCurvature.reserve(myKernel.CountPoints());
-    for (unsigned long i=0; i<myKernel.CountPoints(); i++) {
-        CurvatureInfo ci;
-        ci.cMaxCurvDir = Base::Vector3f((float)aMaxCurvDir[i].X(), (float)aMaxCurvDir[i].Y(), (float)aMaxCurvDir[i].Z());
-        ci.cMinCurvDir = Base::Vector3f((float)aMinCurvDir[i].X(), (float)aMinCurvDir[i].Y(), (float)aMinCurvDir[i].Z());
-        ci.fMaxCurvature = (float)aMaxCurv[i];
-        ci.fMinCurvature = (float)aMinCurv[i];
-        myCurvature.push_back(ci);
-    }
+            kW0 = Wm4::Vector2<double>(kS[0][1],fMaxCurvature-kS[0][0]);
+            kW1 = Wm4::Vector2<double>(fMaxCurvature-kS[1][1],kS[1][0]);
+            if (kW0.SquaredLength() >= kW1.SquaredLength()) {
+                kW0.Normalize();
+                kMaxDirection = kW0.X()*kU + kW0.Y()*kV;
+            }
+            else {
+                kW1.Normalize();
+                kMaxDirection = kW1.X()*kU + kW1.Y()*kV;
+            }
+
+            CurvatureInfo& ci = myCurvature[i];
+            ci.cMaxCurvDir = Base::Vector3f((float)kMaxDirection.X(), (float)kMaxDirection.Y(), (float)kMaxDirection.Z());
+            ci.cMinCurvDir = Base::Vector3f((float)kMinDirection.X(), (float)kMinDirection.Y(), (float)kMinDirection.Z());
+            ci.fMaxCurvature = (float)fMaxCurvature;
+            ci.fMinCurvature = (float)fMinCurvature;
+        }
+    }, seq);
 }
 #endif // OPTIMIZE_CURVATURE
 
@@ -23,19 +23,58 @@
 
 #include "PreCompiled.h"
 #ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
 #endif
 
+#include <QThread>
 #include "Decimation.h"
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Iterator.h"
 #include "TopoAlgorithm.h"
+#include <Base/BoundBox.h>
+#include <Base/Parallel.h>
 #include <Base/Tools.h>
 #include "Simplify.h"
 
 
 using namespace MeshCore;
 
+namespace {
+typedef std::vector<unsigned long>::iterator FacetIterator;
+
+// Splits the facets into \a parts spatially compact groups of about the same size
+// by recursively halving the bounding box of the facet centers at its longest side.
+void splitFacets(FacetIterator begin, FacetIterator end, std::size_t parts,
+                 const std::vector<Base::Vector3f>& centers,
+                 std::vector< std::pair<FacetIterator, FacetIterator> >& ranges)
+{
+    if (parts < 2 || end - begin < 2) {
+        ranges.push_back(std::make_pair(begin, end));
+        return;
+    }
+
+    Base::BoundBox3f box;
+    for (FacetIterator it = begin; it != end; ++it)
+        box.Add(centers[*it]);
+    unsigned short axis = 0;
+    if (box.LengthY() > box.LengthX())
+        axis = 1;
+    if (box.LengthZ() > std::max(box.LengthX(), box.LengthY()))
+        axis = 2;
+
+    std::size_t left = parts / 2;
+    FacetIterator mid = begin + (end - begin) * left / parts;
+    std::nth_element(begin, mid, end, [&centers, axis](unsigned long f1, unsigned long f2) {
+        return centers[f1][axis] < centers[f2][axis];
+    });
+
+    splitFacets(begin, mid, left, centers, ranges);
+    splitFacets(mid, end, parts - left, centers, ranges);
+}
+}
+
 MeshSimplify::MeshSimplify(MeshKernel& mesh)
   : myKernel(mesh)
 {
@@ -45,7 +84,26 @@ MeshSimplify::~MeshSimplify()
 {
 }
 
-void MeshSimplify::simplify(float tolerance, float reduction)
+void MeshSimplify::simplify(float tolerance, float reduction, bool parallel)
+{
+    const MeshFacetArray& facets = myKernel.GetFacets();
+    int target_count = static_cast<int>(static_cast<float>(facets.size()) * (1.0f-reduction));
+
+    if (parallel)
+        simplifyParallel(target_count, tolerance);
+    else
+        simplifySerial(target_count, tolerance);
+}
+
+void MeshSimplify::simplify(int targetSize, bool parallel)
+{
+    if (parallel)
+        simplifyParallel(targetSize, FLT_MAX);
+    else
+        simplifySerial(targetSize, FLT_MAX);
+}
+
+void MeshSimplify::simplifySerial(int targetSize, float tolerance)
 {
     Simplify alg;
 
@@ -64,61 +122,157 @@ void MeshSimplify::simplify(float tolerance, float reduction)
         alg.triangles.push_back(t);
     }
 
-    int target_count = static_cast<int>(static_cast<float>(facets.size()) * (1.0f-reduction));
-
     // Simplification starts
-    alg.simplify_mesh(target_count, tolerance);
+    alg.simplify_mesh(targetSize, tolerance);
 
     // Simplification done
-    MeshPointArray new_points;
-    new_points.reserve(alg.vertices.size());
-    for (std::size_t i = 0; i < alg.vertices.size(); i++) {
-        new_points.push_back(alg.vertices[i].p);
-    }
+    adopt(alg);
+}
 
-    std::size_t numFacets = 0;
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted)
-            numFacets++;
+void MeshSimplify::simplifyParallel(int targetSize, float tolerance)
+{
+    const MeshPointArray& points = myKernel.GetPoints();
+    const MeshFacetArray& facets = myKernel.GetFacets();
+
+    // for small meshes the border pass would dominate
+    std::size_t numParts = std::min<std::size_t>(QThread::idealThreadCount(), facets.size() / 50000);
+    if (numParts < 2) {
+        simplifySerial(targetSize, tolerance);
+        return;
     }
-    MeshFacetArray new_facets;
-    new_facets.reserve(numFacets);
-    for (std::size_t i = 0; i < alg.triangles.size(); i++) {
-        if (!alg.triangles[i].deleted) {
-            MeshFacet face;
-            face._aulPoints[0] = alg.triangles[i].v[0];
-            face._aulPoints[1] = alg.triangles[i].v[1];
-            face._aulPoints[2] = alg.triangles[i].v[2];
-            new_facets.push_back(face);
+
+    // The quadrics of the original mesh are computed once for all vertices. Each vertex
+    // sums up the planes of its adjacent facets in the same order as Simplify does.
+    std::vector<SymmetricMatrix> planes(facets.size());
+    std::vector<Base::Vector3f> centers(facets.size());
+    Base::parallel_for(facets.size(), 4096, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            const MeshFacet& face = facets[i];
+            vec3f p0 = points[face._aulPoints[0]];
+            vec3f p1 = points[face._aulPoints[1]];
+            vec3f p2 = points[face._aulPoints[2]];
+            vec3f n = (p1 - p0).Cross(p2 - p0);
+            n.Normalize();
+            planes[i] = SymmetricMatrix(n.x, n.y, n.z, -n.Dot(p0));
+            centers[i] = (p0 + p1 + p2) / 3.0f;
+        }
+    });
+
+    std::vector<SymmetricMatrix> quadrics(points.size());
+    MeshRefPointToCorners corners(myKernel);
+    Base::parallel_for(points.size(), 4096, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            SymmetricMatrix q(0.0);
+            std::vector<unsigned long>::const_iterator it;
+            for (it = corners.CornerBegin(i); it != corners.CornerEnd(i); ++it)
+                q = q + planes[*it / 3];
+            quadrics[i] = q;
+        }
+    });
+    std::vector<SymmetricMatrix>().swap(planes);
+
+    // split the mesh into spatial partitions
+    std::vector<unsigned long> order(facets.size());
+    std::generate(order.begin(), order.end(), Base::iotaGen<unsigned long>(0));
+    std::vector< std::pair<FacetIterator, FacetIterator> > ranges;
+    splitFacets(order.begin(), order.end(), numParts, centers, ranges);
+    std::vector<Base::Vector3f>().swap(centers);
+
+    // vertices used by more than one partition are locked
+    const int Unused = -1, Locked = -2;
+    std::vector<int> vertexPart(points.size(), Unused);
+    for (std::size_t part = 0; part < ranges.size(); part++) {
+        for (FacetIterator it = ranges[part].first; it != ranges[part].second; ++it) {
+            for (int j = 0; j < 3; j++) {
+                int& owner = vertexPart[facets[*it]._aulPoints[j]];
+                if (owner == Unused)
+                    owner = static_cast<int>(part);
+                else if (owner != static_cast<int>(part))
+                    owner = Locked;
+            }
         }
     }
 
-    myKernel.Adopt(new_points, new_facets, true);
-}
+    // Simplify the partitions independently. A vertex that is not locked has all its
+    // facets in one partition, so its quadric, border flag and the flip test are the
+    // same as for the whole mesh.
+    std::vector<Simplify> algs(ranges.size());
+    std::vector< std::vector<unsigned long> > vertexIds(ranges.size());
+    Base::parallel_for(ranges.size(), [&](std::size_t part) {
+        Simplify& alg = algs[part];
+        std::vector<unsigned long>& ids = vertexIds[part];
+        FacetIterator begin = ranges[part].first, end = ranges[part].second;
 
-void MeshSimplify::simplify(int targetSize)
-{
+        ids.reserve(3 * (end - begin));
+        for (FacetIterator it = begin; it != end; ++it) {
+            for (int j = 0; j < 3; j++)
+                ids.push_back(facets[*it]._aulPoints[j]);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        alg.vertices.resize(ids.size());
+        for (std::size_t i = 0; i < ids.size(); i++) {
+            Simplify::Vertex& v = alg.vertices[i];
+            v.p = points[ids[i]];
+            v.q = quadrics[ids[i]];
+            v.locked = (vertexPart[ids[i]] == Locked);
+        }
+
+        alg.triangles.resize(end - begin);
+        for (FacetIterator it = begin; it != end; ++it) {
+            Simplify::Triangle& t = alg.triangles[it - begin];
+            for (int j = 0; j < 3; j++) {
+                unsigned long id = facets[*it]._aulPoints[j];
+                t.v[j] = static_cast<int>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+            }
+        }
+
+        int target = static_cast<int>(static_cast<double>(targetSize) * (end - begin) / facets.size());
+        alg.init_quadrics = false;
+        alg.compact = false;
+        alg.simplify_mesh(target, tolerance);
+    });
+
+    // Merge the partitions, the locked vertices are shared
     Simplify alg;
+    alg.init_quadrics = false;
+    std::vector<int> mergedIndex(points.size(), -1);
+    for (std::size_t part = 0; part < algs.size(); part++) {
+        const std::vector<unsigned long>& ids = vertexIds[part];
+        for (std::vector<Simplify::Triangle>::iterator it = algs[part].triangles.begin();
+             it != algs[part].triangles.end(); ++it) {
+            if (it->deleted)
+                continue;
+            Simplify::Triangle t;
+            for (int j = 0; j < 3; j++) {
+                int& index = mergedIndex[ids[it->v[j]]];
+                if (index < 0) {
+                    Simplify::Vertex v;
+                    v.p = algs[part].vertices[it->v[j]].p;
+                    v.q = algs[part].vertices[it->v[j]].q;
+                    index = static_cast<int>(alg.vertices.size());
+                    alg.vertices.push_back(v);
+                }
+                t.v[j] = index;
+            }
+            alg.triangles.push_back(t);
+        }
 
-    const MeshPointArray& points = myKernel.GetPoints();
-    for (std::size_t i = 0; i < points.size(); i++) {
-        Simplify::Vertex v;
-        v.p = points[i];
-        alg.vertices.push_back(v);
+        std::vector<Simplify::Triangle>().swap(algs[part].triangles);
+        std::vector<Simplify::Vertex>().swap(algs[part].vertices);
     }
 
-    const MeshFacetArray& facets = myKernel.GetFacets();
-    for (std::size_t i = 0; i < facets.size(); i++) {
-        Simplify::Triangle t;
-        for (int j = 0; j < 3; j++)
-            t.v[j] = facets[i]._aulPoints[j];
-        alg.triangles.push_back(t);
-    }
+    // Final pass over the merged mesh with the accumulated quadrics. As the edges
+    // with the lowest error are collapsed first it mainly works along the former
+    // partition borders.
+    alg.simplify_mesh(targetSize, tolerance);
 
-    // Simplification starts
-    alg.simplify_mesh(targetSize, FLT_MAX);
+    adopt(alg);
+}
 
-    // Simplification done
+void MeshSimplify::adopt(Simplify& alg)
+{
     MeshPointArray new_points;
     new_points.reserve(alg.vertices.size());
     for (std::size_t i = 0; i < alg.vertices.size(); i++) {
@@ -25,6 +25,8 @@
 #define MESH_DECIMATION_H
 
 
+class Simplify;
+
 namespace MeshCore
 {
 class MeshKernel;
@@ -34,8 +36,20 @@ class MeshExport MeshSimplify
 public:
     MeshSimplify(MeshKernel&);
     ~MeshSimplify();
-    void simplify(float tolerance, float reduction);
-    void simplify(int targetSize);
+    /** Reduces the number of facets by up to \a reduction (in [0,1]) as long as the
+     * quadric error stays below \a tolerance.
+     * If \a parallel is true the mesh is split into spatial partitions that are decimated
+     * in parallel with their common vertices locked, followed by a final pass over the
+     * merged result. The error metric is the same as for the serial algorithm.
+     */
+    void simplify(float tolerance, float reduction, bool parallel = false);
+    /** Reduces the number of facets to \a targetSize. */
+    void simplify(int targetSize, bool parallel = false);
+
+private:
+    void simplifySerial(int targetSize, float tolerance);
+    void simplifyParallel(int targetSize, float tolerance);
+    void adopt(Simplify&);
 
 private:
     MeshKernel& myKernel;
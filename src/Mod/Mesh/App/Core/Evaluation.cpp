@@ -25,6 +25,9 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <atomic>
+# include <climits>
+# include <cstdint>
 # include <vector>
 #endif
 
@@ -39,8 +42,10 @@
 #include "Helpers.h"
 #include "Grid.h"
 #include "TopoAlgorithm.h"
+#include "BVH.h"
 #include "Functional.h"
 #include <Base/Matrix.h>
+#include <Base/Parallel.h>
 
 #include <Base/Sequencer.h>
 
@@ -593,169 +598,102 @@ bool MeshFixSingleFacet::Fixup ()
 
 // ----------------------------------------------------------------
 
-bool MeshEvalSelfIntersection::Evaluate ()
+namespace {
+/**
+ * Collects the pairs of facets whose bounding boxes overlap. Facets sharing a common vertex are
+ * skipped because they could but usually do not intersect each other and the exact test would
+ * detect false-positives, otherwise.
+ */
+void SelfIntersectionCandidates(const MeshKernel& rclMesh, std::vector<std::pair<unsigned long, unsigned long> >& pairs)
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
+    MeshFacetBVH bvh(rclMesh);
+    bvh.SearchOverlappingFacets(pairs);
+
+    const MeshFacetArray& rFaces = rclMesh.GetFacets();
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+        [&rFaces](const std::pair<unsigned long, unsigned long>& pair) {
+            const MeshFacet& rface1 = rFaces[pair.first];
+            const MeshFacet& rface2 = rFaces[pair.second];
+            for (int i = 0; i < 3; i++) {
+                if (rface1._aulPoints[i] == rface2._aulPoints[0] ||
+                    rface1._aulPoints[i] == rface2._aulPoints[1] ||
+                    rface1._aulPoints[i] == rface2._aulPoints[2])
+                    return true;
+            }
+            return false;
+        }), pairs.end());
+}
 
-    MeshFacetIterator cMFI(_rclMesh);
-    for (cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
+inline bool SelfIntersection(const MeshKernel& rclMesh, const std::pair<unsigned long, unsigned long>& pair,
+                             Base::Vector3f& pt1, Base::Vector3f& pt2)
+{
+    MeshGeomFacet facet1 = rclMesh.GetFacet(pair.first);
+    MeshGeomFacet facet2 = rclMesh.GetFacet(pair.second);
+    return facet1.IntersectWithFacet(facet2, pt1, pt2) == 2;
+}
 
-    // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
+// minimum number of facet pairs tested by one task
+const std::size_t SelfIntersectionBlock = 1024;
+}
 
-        seq.next();
-        if (aulGridElements.size()==0)
-            continue;
+bool MeshEvalSelfIntersection::Evaluate ()
+{
+    std::vector<std::pair<unsigned long, unsigned long> > pairs;
+    SelfIntersectionCandidates(_rclMesh, pairs);
 
-        MeshGeomFacet facet1, facet2;
+    // abort after the first detected self-intersection
+    std::atomic<bool> found(false);
+    Base::SequencerLauncher seq("Checking for self-intersections...", pairs.size());
+    Base::parallel_for(pairs.size(), SelfIntersectionBlock, [&](std::size_t, std::size_t first, std::size_t last) {
         Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        // abort after the first detected self-intersection
-                        return false;
-                    }
-                }
-            }
+        for (std::size_t i = first; i < last && !found; i++) {
+            if (SelfIntersection(_rclMesh, pairs[i], pt1, pt2))
+                found = true;
         }
-    }
+    }, seq);
 
-    return true;
+    return !found;
 }
 
 void MeshEvalSelfIntersection::GetIntersections(const std::vector<std::pair<unsigned long, unsigned long> >& indices,
                                                 std::vector<std::pair<Base::Vector3f, Base::Vector3f> >& intersection) const
 {
-    intersection.reserve(indices.size());
-    MeshFacetIterator cMF1(_rclMesh);
-    MeshFacetIterator cMF2(_rclMesh);
-
-    Base::Vector3f pt1, pt2;
-    std::vector<std::pair<unsigned long, unsigned long> >::const_iterator it;
-    for (it = indices.begin(); it != indices.end(); ++it) {
-        cMF1.Set(it->first);
-        cMF2.Set(it->second);
-
-        Base::BoundBox3f box1 = cMF1->GetBoundBox();
-        Base::BoundBox3f box2 = cMF2->GetBoundBox();
-        if (box1 && box2) {
-            int ret = cMF1->IntersectWithFacet(*cMF2, pt1, pt2);
-            if (ret == 2) {
-                intersection.emplace_back(pt1, pt2);
-            }
+    std::size_t count = indices.size();
+    std::vector<char> hits(count);
+    std::vector<std::pair<Base::Vector3f, Base::Vector3f> > lines(count);
+    Base::parallel_for(count, SelfIntersectionBlock, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            hits[i] = SelfIntersection(_rclMesh, indices[i], lines[i].first, lines[i].second);
         }
+    });
+
+    intersection.reserve(intersection.size() + count);
+    for (std::size_t i = 0; i < count; i++) {
+        if (hits[i])
+            intersection.push_back(lines[i]);
     }
 }
 
 void MeshEvalSelfIntersection::GetIntersections(std::vector<std::pair<unsigned long, unsigned long> >& intersection) const
 {
-    // Contains bounding boxes for every facet 
-    std::vector<Base::BoundBox3f> boxes;
-    //intersection.clear();
-
-    // Splits the mesh using grid for speeding up the calculation
-    MeshFacetGrid cMeshFacetGrid(_rclMesh);
-    const MeshFacetArray& rFaces = _rclMesh.GetFacets();
-    MeshGridIterator clGridIter(cMeshFacetGrid);
-    unsigned long ulGridX, ulGridY, ulGridZ;
-    cMeshFacetGrid.GetCtGrids(ulGridX, ulGridY, ulGridZ);
-
-    MeshFacetIterator cMFI(_rclMesh);
-    for(cMFI.Begin(); cMFI.More(); cMFI.Next()) {
-        boxes.push_back((*cMFI).GetBoundBox());
-    }
+    std::vector<std::pair<unsigned long, unsigned long> > pairs;
+    SelfIntersectionCandidates(_rclMesh, pairs);
 
     // Calculates the intersections
-    Base::SequencerLauncher seq("Checking for self-intersections...", ulGridX*ulGridY*ulGridZ);
-    for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
-        //Get the facet indices, belonging to the current grid unit
-        std::vector<unsigned long> aulGridElements;
-        clGridIter.GetElements(aulGridElements);
-
-        seq.next(true);
-        if (aulGridElements.size()==0)
-            continue;
-
-        MeshGeomFacet facet1, facet2;
+    std::size_t count = pairs.size();
+    std::vector<char> hits(count);
+    Base::SequencerLauncher seq("Checking for self-intersections...", count);
+    Base::parallel_for(count, SelfIntersectionBlock, [&](std::size_t, std::size_t first, std::size_t last) {
         Base::Vector3f pt1, pt2;
-        for (std::vector<unsigned long>::iterator it = aulGridElements.begin(); it != aulGridElements.end(); ++it) {
-            const Base::BoundBox3f& box1 = boxes[*it];
-            cMFI.Set(*it);
-            facet1 = *cMFI;
-            const MeshFacet& rface1 = rFaces[*it];
-            for (std::vector<unsigned long>::iterator jt = it; jt != aulGridElements.end(); ++jt) {
-                if (jt == it) // the identical facet
-                    continue;
-                // If the facets share a common vertex we do not check for self-intersections because they 
-                // could but usually do not intersect each other and the algorithm below would detect false-positives,
-                // otherwise
-                const MeshFacet& rface2 = rFaces[*jt];
-                if (rface1._aulPoints[0] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[0] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[0] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[1] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[1] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[1] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-                if (rface1._aulPoints[2] == rface2._aulPoints[0] || 
-                    rface1._aulPoints[2] == rface2._aulPoints[1] ||
-                    rface1._aulPoints[2] == rface2._aulPoints[2])
-                    continue; // ignore facets sharing a common vertex
-
-                const Base::BoundBox3f& box2 = boxes[*jt];
-                if (box1 && box2) {
-                    cMFI.Set(*jt);
-                    facet2 = *cMFI;
-                    int ret = facet1.IntersectWithFacet(facet2, pt1, pt2);
-                    if (ret == 2) {
-                        intersection.emplace_back (*it,*jt);
-                    }
-                }
-            }
+        for (std::size_t i = first; i < last; i++) {
+            hits[i] = SelfIntersection(_rclMesh, pairs[i], pt1, pt2);
         }
+    }, seq);
+
+    // the candidates are sorted, so the result doesn't depend on the number of threads
+    for (std::size_t i = 0; i < count; i++) {
+        if (hits[i])
+            intersection.push_back(pairs[i]);
     }
 }
 
@@ -950,77 +888,137 @@ bool MeshFixNeighbourhood::Fixup()
     return true;
 }
 
-void MeshKernel::RebuildNeighbours (unsigned long index)
+namespace MeshCore {
+namespace {
+/**
+ * Sets the neighbour indices of the facets returned by \a facetAt(i), i in [0, count).
+ * The edges are packed into 64-bit keys of the two sorted point indices, so that a
+ * radix sort groups the facets that share an edge. If \a flags is given only the
+ * edges whose both points are flagged are updated because only for them it is known
+ * that all adjacent facets are part of the input.
+ */
+template <class Index, class Func>
+void ConnectFacets(MeshFacetArray& rFacets, unsigned long ulCtPoints, std::size_t count,
+                   Func facetAt, const std::vector<char>* flags)
 {
-    std::vector<Edge_Index> edges;
-    edges.reserve(3 * (this->_aclFacetArray.size() - index));
+    // number of bits needed for a point index
+    int bits = 1;
+    while (bits < 32 && (uint64_t(1) << bits) < ulCtPoints)
+        bits++;
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+
+    std::size_t ulCtEdges = 3 * count;
+    std::vector<uint64_t> keys(ulCtEdges);
+    std::vector<Index> corners(ulCtEdges);
 
     // build up an array of edges
-    MeshFacetArray::_TConstIterator pI;
-    MeshFacetArray::_TConstIterator pB = this->_aclFacetArray.begin();
-    for (pI = pB + index; pI != this->_aclFacetArray.end(); ++pI) {
-        for (int i = 0; i < 3; i++) {
-            Edge_Index item;
-            item.p0 = std::min<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.p1 = std::max<unsigned long>(pI->_aulPoints[i], pI->_aulPoints[(i+1)%3]);
-            item.f  = pI - pB;
-            edges.push_back(item);
+    Base::parallel_for(count, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        for (std::size_t i = ulBegin; i < ulEnd; i++) {
+            unsigned long ulFacet = facetAt(i);
+            const MeshFacet& rFace = rFacets[ulFacet];
+            for (int j = 0; j < 3; j++) {
+                uint64_t p0 = rFace._aulPoints[j];
+                uint64_t p1 = rFace._aulPoints[(j+1)%3];
+                if (p0 > p1)
+                    std::swap(p0, p1);
+                keys[3*i+j] = (p0 << bits) | p1;
+                // the corner of the facet where the edge starts
+                corners[3*i+j] = static_cast<Index>(3 * ulFacet + j);
+            }
         }
-    }
+    });
 
     // sort the edges
-    //std::sort(edges.begin(), edges.end(), Edge_Less());
-    int threads = std::max(1, QThread::idealThreadCount());
-    MeshCore::parallel_sort(edges.begin(), edges.end(), Edge_Less(), threads);
+    MeshCore::parallel_radix_sort(keys, corners, 2 * bits);
+
+    Base::parallel_for(ulCtEdges, 4096, [&](std::size_t, std::size_t ulBegin, std::size_t ulEnd) {
+        // a group of equal edges is handled by the block where it starts
+        while (ulBegin > 0 && ulBegin < ulEnd && keys[ulBegin] == keys[ulBegin-1])
+            ulBegin++;
+
+        std::size_t ulNext;
+        for (std::size_t i = ulBegin; i < ulEnd; i = ulNext) {
+            ulNext = i + 1;
+            while (ulNext < ulCtEdges && keys[ulNext] == keys[i])
+                ulNext++;
+            if (flags && !((*flags)[keys[i] >> bits] && (*flags)[keys[i] & mask]))
+                continue;
 
-    unsigned long p0 = ULONG_MAX, p1 = ULONG_MAX;
-    unsigned long f0 = ULONG_MAX, f1 = ULONG_MAX;
-    int count = 0;
-    std::vector<Edge_Index>::iterator pE;
-    for (pE = edges.begin(); pE != edges.end(); ++pE) {
-        if (p0 == pE->p0 && p1 == pE->p1) {
-            f1 = pE->f;
-            count++;
-        }
-        else {
             // we handle only the cases for 1 and 2, for all higher
             // values we have a non-manifold that is ignored here
-            if (count == 2) {
-                MeshFacet& rFace0 = this->_aclFacetArray[f0];
-                MeshFacet& rFace1 = this->_aclFacetArray[f1];
-                unsigned short side0 = rFace0.Side(p0,p1);
-                unsigned short side1 = rFace1.Side(p0,p1);
-                rFace0._aulNeighbours[side0] = f1;
-                rFace1._aulNeighbours[side1] = f0;
+            if (ulNext - i == 2) {
+                uint64_t c0 = corners[i];
+                uint64_t c1 = corners[i+1];
+                rFacets[c0 / 3]._aulNeighbours[c0 % 3] = static_cast<unsigned long>(c1 / 3);
+                rFacets[c1 / 3]._aulNeighbours[c1 % 3] = static_cast<unsigned long>(c0 / 3);
             }
-            else if (count == 1) {
-                MeshFacet& rFace = this->_aclFacetArray[f0];
-                unsigned short side = rFace.Side(p0,p1);
-                rFace._aulNeighbours[side] = ULONG_MAX;
+            else if (ulNext - i == 1) {
+                uint64_t c0 = corners[i];
+                rFacets[c0 / 3]._aulNeighbours[c0 % 3] = ULONG_MAX;
             }
+        }
+    });
+}
 
-            p0 = pE->p0;
-            p1 = pE->p1;
-            f0 = pE->f;
-            count = 1;
+template <class Func>
+void ConnectFacets(MeshFacetArray& rFacets, unsigned long ulCtPoints, std::size_t count,
+                   Func facetAt, const std::vector<char>* flags)
+{
+    // use 32-bit corner indices if possible to save memory and bandwidth
+    if (3 * uint64_t(rFacets.size()) <= UINT32_MAX)
+        ConnectFacets<uint32_t>(rFacets, ulCtPoints, count, facetAt, flags);
+    else
+        ConnectFacets<uint64_t>(rFacets, ulCtPoints, count, facetAt, flags);
+}
+}
+}
+
+void MeshKernel::RebuildNeighbours (unsigned long index)
+{
+    if (index >= this->_aclFacetArray.size())
+        return;
+    ConnectFacets(this->_aclFacetArray, CountPoints(), this->_aclFacetArray.size() - index,
+                  [index](std::size_t i) { return static_cast<unsigned long>(index + i); }, nullptr);
+}
+
+void MeshKernel::RebuildNeighbours (const std::vector<unsigned long>& raulFacets)
+{
+    // mark the points of the given facets and of their old neighbours because
+    // a modified facet may no longer share an edge with a former neighbour
+    const unsigned long ulCtFacets = CountFacets();
+    std::vector<char> flags(CountPoints(), 0);
+    for (std::vector<unsigned long>::const_iterator it = raulFacets.begin(); it != raulFacets.end(); ++it) {
+        if (*it >= ulCtFacets)
+            continue;
+        const MeshFacet& rFace = this->_aclFacetArray[*it];
+        for (int i = 0; i < 3; i++) {
+            flags[rFace._aulPoints[i]] = 1;
+            unsigned long ulNeighbour = rFace._aulNeighbours[i];
+            if (ulNeighbour < ulCtFacets) {
+                const MeshFacet& rNeighbour = this->_aclFacetArray[ulNeighbour];
+                for (int j = 0; j < 3; j++)
+                    flags[rNeighbour._aulPoints[j]] = 1;
+            }
         }
     }
 
-    // we handle only the cases for 1 and 2, for all higher
-    // values we have a non-manifold that is ignored here
-    if (count == 2) {
-        MeshFacet& rFace0 = this->_aclFacetArray[f0];
-        MeshFacet& rFace1 = this->_aclFacetArray[f1];
-        unsigned short side0 = rFace0.Side(p0,p1);
-        unsigned short side1 = rFace1.Side(p0,p1);
-        rFace0._aulNeighbours[side0] = f1;
-        rFace1._aulNeighbours[side1] = f0;
-    }
-    else if (count == 1) {
-        MeshFacet& rFace = this->_aclFacetArray[f0];
-        unsigned short side = rFace.Side(p0,p1);
-        rFace._aulNeighbours[side] = ULONG_MAX;
-    }
+    // collect all facets that share a point with them
+    const MeshFacetArray& rFacets = this->_aclFacetArray;
+    std::vector< std::vector<unsigned long> > blocks(Base::parallel_blocks(rFacets.size(), 4096));
+    Base::parallel_for(rFacets.size(), 4096, [&](std::size_t block, std::size_t ulBegin, std::size_t ulEnd) {
+        for (std::size_t i = ulBegin; i < ulEnd; i++) {
+            const MeshFacet& rFace = rFacets[i];
+            if (flags[rFace._aulPoints[0]] || flags[rFace._aulPoints[1]] || flags[rFace._aulPoints[2]])
+                blocks[block].push_back(static_cast<unsigned long>(i));
+        }
+    });
+
+    std::vector<unsigned long> facets;
+    for (std::vector< std::vector<unsigned long> >::iterator it = blocks.begin(); it != blocks.end(); ++it)
+        facets.insert(facets.end(), it->begin(), it->end());
+
+    ConnectFacets(this->_aclFacetArray, CountPoints(), facets.size(),
+                  [&facets](std::size_t i) { return facets[i]; }, &flags);
 }
 
 void MeshKernel::RebuildNeighbours (void)
@@ -25,9 +25,12 @@
 #define MESH_FUNCTIONAL_H
 
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 #include <QtConcurrentRun>
 #include <QFuture>
 #include <QThread>
+#include <Base/Parallel.h>
 
 namespace MeshCore
 {
@@ -58,6 +61,63 @@ namespace MeshCore
         }
     }
 
+    /** Sorts \a keys in ascending order and applies the same permutation to \a values.
+     * Only the lowest \a bits bits of the unsigned integer keys are considered. This is a
+     * stable LSD radix sort whose counting and scatter passes are split into blocks
+     * that are processed in parallel. Passes where all keys have the same digit are skipped.
+     */
+    template <class Key, class Value>
+    static void parallel_radix_sort(std::vector<Key>& keys, std::vector<Value>& values, int bits)
+    {
+        const int radix = 11;
+        const std::size_t buckets = std::size_t(1) << radix;
+        const std::size_t minBlock = 65536;
+        std::size_t count = keys.size();
+        std::size_t blocks = Base::parallel_blocks(count, minBlock);
+
+        std::vector<Key> tmpKeys(count);
+        std::vector<Value> tmpValues(count);
+        std::vector<std::size_t> offsets(blocks * buckets);
+        for (int shift = 0; shift < bits; shift += radix) {
+            // histogram of the digits of each block
+            Base::parallel_for(count, minBlock, [&](std::size_t block, std::size_t first, std::size_t last) {
+                std::size_t* hist = &offsets[block * buckets];
+                std::fill(hist, hist + buckets, 0);
+                for (std::size_t i = first; i < last; i++)
+                    hist[(keys[i] >> shift) & (buckets - 1)]++;
+            });
+
+            // exclusive prefix sum in digit order, blocks of the same digit keep their order
+            std::size_t sum = 0;
+            bool skip = false;
+            for (std::size_t digit = 0; digit < buckets && !skip; digit++) {
+                std::size_t total = 0;
+                for (std::size_t block = 0; block < blocks; block++) {
+                    std::size_t& pos = offsets[block * buckets + digit];
+                    std::size_t num = pos;
+                    pos = sum;
+                    sum += num;
+                    total += num;
+                }
+                skip = (total == count);
+            }
+            if (skip)
+                continue;
+
+            Base::parallel_for(count, minBlock, [&](std::size_t block, std::size_t first, std::size_t last) {
+                std::size_t* pos = &offsets[block * buckets];
+                for (std::size_t i = first; i < last; i++) {
+                    std::size_t index = pos[(keys[i] >> shift) & (buckets - 1)]++;
+                    tmpKeys[index] = keys[i];
+                    tmpValues[index] = values[i];
+                }
+            });
+
+            keys.swap(tmpKeys);
+            values.swap(tmpValues);
+        }
+    }
+
 } // namespace MeshCore
 
 
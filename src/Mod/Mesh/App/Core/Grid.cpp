@@ -33,6 +33,7 @@
 #include "MeshKernel.h"
 #include "Algorithm.h"
 #include "Tools.h"
+#include <Base/Parallel.h>
 
 using namespace MeshCore;
 
@@ -62,7 +63,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  std::vector<unsigned long>().swap(_aulGridOffsets);
+  std::vector<unsigned long>().swap(_aulGridElements);
   _pclMesh = NULL;  
 }
 
@@ -93,8 +95,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsY == 0) || (_ulCtGridsZ == 0))
@@ -127,15 +127,72 @@ void MeshGrid::InitGrid (void)
   }
   }
 
-  // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
-  {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+  // Daten-Struktur anlegen, gefuellt wird sie mit FillGrid()
+  _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  _aulGridElements.clear();
+}
+
+void MeshGrid::FillGrid (unsigned long ulCtElements)
+{
+  typedef std::vector<std::pair<unsigned long, unsigned long> > CellList;
+
+  const unsigned long ulMinBlockSize = 4096;
+  std::size_t ulCtCells = _ulCtGridsX * _ulCtGridsY * _ulCtGridsZ;
+  std::size_t ulCtBlocks = Base::parallel_blocks(ulCtElements, ulMinBlockSize);
+
+  // Collect the (grid, element) pairs of consecutive blocks of elements in parallel.
+  // This includes the intersection tests and is the expensive part of the build.
+  std::vector<CellList> blocks(ulCtBlocks);
+  Base::parallel_for(ulCtElements, ulMinBlockSize, [&](std::size_t block, std::size_t ulBegin, std::size_t ulEnd) {
+    CellList& pairs = blocks[block];
+    pairs.reserve(ulEnd - ulBegin);
+    std::vector<unsigned long> cells;
+    for (unsigned long ulIndex = ulBegin; ulIndex < ulEnd; ulIndex++) {
+      cells.clear();
+      GetElementCells(ulIndex, cells);
+      for (std::vector<unsigned long>::iterator it = cells.begin(); it != cells.end(); ++it)
+        pairs.push_back(std::make_pair(*it, ulIndex));
+    }
+  });
+
+  // Counting sort of the pairs by grid index. Each block gets its own histogram as long as
+  // that is cheaper than the pairs themselves, otherwise a single histogram is used. Because
+  // the blocks are handled in order the element indices of each grid stay sorted.
+  std::size_t ulCtPairs = 0;
+  for (std::vector<CellList>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+    ulCtPairs += it->size();
+  std::size_t ulCtGroups = (ulCtCells * ulCtBlocks <= ulCtPairs) ? ulCtBlocks : 1;
+
+  std::vector<std::vector<unsigned long> > counts(ulCtGroups);
+  Base::parallel_for(ulCtGroups, [&](std::size_t group) {
+    std::vector<unsigned long>& count = counts[group];
+    count.resize(ulCtCells, 0);
+    for (std::size_t block = group * ulCtBlocks / ulCtGroups; block < (group + 1) * ulCtBlocks / ulCtGroups; block++) {
+      for (CellList::const_iterator it = blocks[block].begin(); it != blocks[block].end(); ++it)
+        count[it->first]++;
+    }
+  });
+
+  _aulGridOffsets.resize(ulCtCells + 1);
+  unsigned long ulPos = 0;
+  for (std::size_t cell = 0; cell < ulCtCells; cell++) {
+    _aulGridOffsets[cell] = ulPos;
+    for (std::size_t group = 0; group < ulCtGroups; group++) {
+      unsigned long ulCount = counts[group][cell];
+      counts[group][cell] = ulPos;
+      ulPos += ulCount;
+    }
   }
+  _aulGridOffsets[ulCtCells] = ulPos;
+  _aulGridElements.resize(ulPos);
+
+  Base::parallel_for(ulCtGroups, [&](std::size_t group) {
+    std::vector<unsigned long>& pos = counts[group];
+    for (std::size_t block = group * ulCtBlocks / ulCtGroups; block < (group + 1) * ulCtBlocks / ulCtGroups; block++) {
+      for (CellList::const_iterator it = blocks[block].begin(); it != blocks[block].end(); ++it)
+        _aulGridElements[pos[it->first]++] = it->second;
+    }
+  });
 }
 
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements,
@@ -155,7 +212,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(raulElements.end(), CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -190,7 +247,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).GetCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -221,7 +278,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
     {
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+        raulElements.insert(CellBegin(i, j, k), CellEnd(i, j, k));
       }
     }
   }  
@@ -478,7 +535,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(CellBegin(nX, i, j), CellEnd(nX, i, j));
           }
           nX++;
         }
@@ -492,7 +549,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(CellBegin(nX, i, j), CellEnd(nX, i, j));
           }
           nX++;
         }
@@ -506,7 +563,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(CellBegin(i, nY, j), CellEnd(i, nY, j));
           }
           nY++;
         }
@@ -520,7 +577,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(CellBegin(i, nY, j), CellEnd(i, nY, j));
           }
           nY--;
         }
@@ -534,7 +591,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(CellBegin(i, j, nZ), CellEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -548,7 +605,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(CellBegin(i, j, nZ), CellEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -644,14 +701,8 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
-  {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
-  }
-
-  return 0;
+  raclInd.insert(CellBegin(ulX, ulY, ulZ), CellEnd(ulX, ulY, ulZ));
+  return GetCtElements(ulX, ulY, ulZ);
 }
 
 unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<unsigned long>& aulFacets) const
@@ -660,9 +711,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(CellBegin(ulX, ulY, ulZ), CellEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -767,15 +816,12 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
-  {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
-  }
+  FillGrid(_ulCtElements);
+}
 
+void MeshFacetGrid::GetElementCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const
+{
+  GetFacetCells(_pclMesh->GetFacet(ulIndex), raulCells);
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -1006,8 +1052,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); ++pI)
+  std::vector<unsigned long>::const_iterator pE = CellEnd(ulX, ulY, ulZ);
+  for (std::vector<unsigned long>::const_iterator pI = CellBegin(ulX, ulY, ulZ); pI != pE; ++pI)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -1052,13 +1098,12 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>(static_cast<unsigned long>(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::GetElementCells (unsigned long ulIndex, std::vector<unsigned long> &raulCells) const
 {
-  (void)fEpsilon;
   unsigned long ulX, ulY, ulZ;
-  Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
+  Pos(_pclMesh->GetPoint(ulIndex), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raulCells.push_back(CellIndex(ulX, ulY, ulZ));
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1109,14 +1154,7 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  FillGrid(_ulCtElements);
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1178,7 +1216,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1191,7 +1229,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1242,7 +1280,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.CellBegin(_ulX, _ulY, _ulZ), _rclGrid.CellEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
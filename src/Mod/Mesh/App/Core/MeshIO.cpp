@@ -29,6 +29,7 @@
 #include "MeshIO.h"
 #include "Algorithm.h"
 #include "Builder.h"
+#include "Tokenizer.h"
 
 #include <Base/Builder3D.h>
 #include <Base/Console.h>
@@ -36,8 +37,11 @@
 #include <Base/Reader.h>
 #include <Base/Writer.h>
 #include <Base/FileInfo.h>
+#include <Base/MappedFile.h>
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <Base/Placement.h>
 #include <Base/Tools.h>
 #include <zipios++/gzipoutputstream.h>
@@ -49,6 +53,7 @@
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <QThread>
 
 
 using namespace MeshCore;
@@ -112,6 +117,78 @@ int numDigits(int number)
     return digits;
 }
 
+/* Checks the upper-case buffer for keywords that only appear in ASCII STL files. */
+bool hasAsciiSTLKeywords(const char* szBuf)
+{
+    return (strstr(szBuf, "SOLID") != NULL)  || (strstr(szBuf, "FACET") != NULL)    || (strstr(szBuf, "NORMAL") != NULL) ||
+           (strstr(szBuf, "VERTEX") != NULL) || (strstr(szBuf, "ENDFACET") != NULL) || (strstr(szBuf, "ENDLOOP") != NULL);
+}
+
+/* Reads the little-endian facet count of a binary STL file. */
+uint32_t readFacetCount(const char* data)
+{
+    uint32_t ulCt;
+    std::memcpy(&ulCt, data + 80, sizeof(ulCt));
+    if (Base::SwapOrder() == HIGH_ENDIAN)
+        Base::SwapEndian<uint32_t>(ulCt);
+    return ulCt;
+}
+
+/* Checks if the memory block has the bytes that MeshInput::LoadSTL() reads to decide on the format. */
+bool hasSTLProbe(const char* data, std::size_t size)
+{
+    if (size < 84)
+        return false;
+    std::size_t ulBytes = readFacetCount(data) > 1 ? 100 : 50;
+    return size >= 84 + ulBytes;
+}
+
+/* Same check as in MeshInput::LoadSTL() but for a memory block. The block must pass hasSTLProbe(). */
+bool isBinarySTL(const char* data)
+{
+    std::size_t ulBytes = readFacetCount(data) > 1 ? 100 : 50;
+    char szBuf[200];
+    std::memcpy(szBuf, data + 84, ulBytes);
+    szBuf[ulBytes] = 0;
+    upper(szBuf);
+    return !hasAsciiSTLKeywords(szBuf);
+}
+
+/* Checks for the 'solid' keyword, case-insensitive. */
+bool hasSolidKeyword(const char* data, std::size_t size)
+{
+    const char keyword[] = "solid";
+    const char* end = data + size;
+    return std::search(data, end, keyword, keyword + 5, [](char c1, char c2) {
+        return tolower(static_cast<unsigned char>(c1)) == c2;
+    }) != end;
+}
+
+/* Reads the remaining content of the stream into the buffer. */
+bool readStream(std::istream& str, std::vector<char>& buffer)
+{
+    std::streambuf* buf = str.rdbuf();
+    if (!buf)
+        return false;
+
+    // for file streams the size is known in advance
+    std::streamoff pos = buf->pubseekoff(0, std::ios::cur, std::ios::in);
+    std::streamoff end = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    if (pos >= 0 && end >= pos && buf->pubseekoff(pos, std::ios::beg, std::ios::in) == pos) {
+        buffer.resize(static_cast<std::size_t>(end - pos));
+        if (!buffer.empty())
+            str.read(buffer.data(), buffer.size());
+        buffer.resize(static_cast<std::size_t>(str.gcount()));
+    }
+    else {
+        char block[0x10000];
+        while (str.read(block, sizeof(block)) || str.gcount() > 0)
+            buffer.insert(buffer.end(), block, block + str.gcount());
+    }
+
+    return true;
+}
+
 /* Usage by CMeshNastran, CMeshCadmouldFE. Added by Sergey Sukhov (26.04.2002)*/
 struct NODE {float x, y, z;};
 struct TRIA {int iV[3];};
@@ -170,7 +247,17 @@ bool MeshInput::LoadAny(const char* FileName)
         // read file
         bool ok = false;
         if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
-            ok = LoadSTL(str);
+            // binary STL files are decoded directly from the mapped memory
+            Base::MappedFile file(fi);
+            if (!file.isOpen())
+                ok = LoadSTL(str);
+            // Either it's really an invalid STL file or it's just empty. In this case the number of facets must be 0.
+            else if (!hasSTLProbe(file.data(), file.size()))
+                ok = file.size() >= 84 && readFacetCount(file.data()) == 0;
+            else if (isBinarySTL(file.data()))
+                ok = LoadBinarySTL(file.data(), file.size());
+            else
+                ok = LoadAsciiSTL(file.data(), file.size());
         }
         else if (fi.hasExtension("iv")) {
             ok = LoadInventor( str );
@@ -181,7 +268,11 @@ bool MeshInput::LoadAny(const char* FileName)
             ok = LoadNastran( str );
         }
         else if (fi.hasExtension("obj")) {
-            ok = LoadOBJ( str );
+            Base::MappedFile file(fi);
+            if (file.isOpen())
+                ok = LoadOBJ(file.data(), file.size());
+            else
+                ok = LoadOBJ( str );
         }
         else if (fi.hasExtension("smf")) {
             ok = LoadSMF( str );
@@ -258,8 +349,7 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
     upper(szBuf);
 
     try {
-        if ((strstr(szBuf, "SOLID") == NULL)  && (strstr(szBuf, "FACET") == NULL)    && (strstr(szBuf, "NORMAL") == NULL) &&
-            (strstr(szBuf, "VERTEX") == NULL) && (strstr(szBuf, "ENDFACET") == NULL) && (strstr(szBuf, "ENDLOOP") == NULL)) {
+        if (!hasAsciiSTLKeywords(szBuf)) {
             // probably binary STL
             buf->pubseekoff(0, std::ios::beg, std::ios::in);
             return LoadBinarySTL(rstrIn);
@@ -293,132 +383,186 @@ bool MeshInput::LoadSTL (std::istream &rstrIn)
 /** Loads an OBJ file. */
 bool MeshInput::LoadOBJ (std::istream &rstrIn)
 {
-    boost::regex rx_m("^mtllib\\s+([\\x21-\\x7E]+)\\s*$");
-    boost::regex rx_u("^usemtl\\s+([\\x21-\\x7E]+)\\s*$");
-    boost::regex rx_g("^g\\s+([\\x21-\\x7E]+)\\s*$");
-    boost::regex rx_p("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_c("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+(\\d{1,3})\\s+(\\d{1,3})\\s+(\\d{1,3})\\s*$");
-    boost::regex rx_t("^v\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                        "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f3("^f\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*\\s*$");
-    boost::regex rx_f4("^f\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*"
-                         "\\s+([-+]?[0-9]+)/?[-+]?[0-9]*/?[-+]?[0-9]*\\s*$");
-    boost::cmatch what;
+    if (!rstrIn || rstrIn.bad() == true)
+        return false;
+
+    std::vector<char> buffer;
+    if (!readStream(rstrIn, buffer))
+        return false;
+
+    return LoadOBJ(buffer.data(), buffer.size());
+}
+
+namespace MeshCore {
+namespace Obj {
+    // a face whose vertices may be relative to the points of its chunk
+    struct Face
+    {
+        long index[4];
+        int count;
+        bool relative[4];
+    };
+    // group or material statements that must be replayed in order
+    struct Statement
+    {
+        enum Type { Group, Library, Material };
+        Type type;
+        std::size_t face;
+        std::string name;
+    };
+    struct Chunk
+    {
+        std::vector<MeshPoint> points;
+        std::vector<Face> faces;
+        std::vector<Statement> statements;
+        bool colors = false;
+    };
+
+    std::string toLower(std::string str)
+    {
+        for (std::string::iterator it = str.begin(); it != str.end(); ++it)
+            *it = tolower(*it);
+        return str;
+    }
+
+    void parseChunk(const Tokenizer::Range& range, Chunk& chunk)
+    {
+        Tokenizer tok(range);
+        for (; !tok.atEnd(); tok.nextLine()) {
+            if (tok.keyword("v")) {
+                Base::Vector3f pt;
+                if (!tok.readFloat(pt.x) || !tok.readFloat(pt.y) || !tok.readFloat(pt.z))
+                    continue;
+                chunk.points.push_back(MeshPoint(pt));
+
+                // optional vertex color either as integers in [0,255] or as floats
+                if (!tok.atEndOfLine()) {
+                    const char* start = tok.position();
+                    float rgb[3];
+                    if (!tok.readFloat(rgb[0]) || !tok.readFloat(rgb[1]) || !tok.readFloat(rgb[2]))
+                        continue;
+                    bool integer = std::find_if(start, tok.position(), [](char c) {
+                        return c == '.' || c == 'e' || c == 'E';
+                    }) == tok.position();
+                    if (integer) {
+                        for (int i=0; i<3; i++)
+                            rgb[i] = std::min<int>(static_cast<int>(rgb[i]), 255) / 255.0f;
+                    }
+
+                    App::Color c(rgb[0], rgb[1], rgb[2]);
+                    unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
+                    chunk.points.back().SetProperty(prop);
+                    chunk.colors = true;
+                }
+            }
+            else if (tok.keyword("f")) {
+                Face face;
+                face.count = 0;
+                long index;
+                while (face.count < 5 && tok.readInt(index)) {
+                    // ignore texture and normal indices
+                    tok.skipToken();
+                    if (face.count < 4) {
+                        face.relative[face.count] = index <= 0;
+                        face.index[face.count] = index > 0 ? index-1 : index+static_cast<long>(chunk.points.size());
+                    }
+                    face.count++;
+                }
+
+                // only triangles and quads are supported
+                if (face.count == 3 || face.count == 4)
+                    chunk.faces.push_back(face);
+            }
+            else if (tok.keyword("g")) {
+                Statement st;
+                st.type = Statement::Group;
+                st.face = chunk.faces.size();
+                st.name = tok.readToken();
+                if (!st.name.empty())
+                    chunk.statements.push_back(st);
+            }
+            else if (tok.keyword("mtllib")) {
+                Statement st;
+                st.type = Statement::Library;
+                st.face = chunk.faces.size();
+                st.name = toLower(tok.readToken());
+                if (!st.name.empty())
+                    chunk.statements.push_back(st);
+            }
+            else if (tok.keyword("usemtl")) {
+                Statement st;
+                st.type = Statement::Material;
+                st.face = chunk.faces.size();
+                st.name = toLower(tok.readToken());
+                if (!st.name.empty())
+                    chunk.statements.push_back(st);
+            }
+        }
+    }
+}
+}
+
+/** Loads an OBJ file from a memory block. The points and faces are parsed in parallel. */
+bool MeshInput::LoadOBJ (const char* data, std::size_t size)
+{
+    int threads = std::max(1, QThread::idealThreadCount());
+    std::vector<Tokenizer::Range> ranges = Tokenizer::split(data, data + size, threads);
+    std::vector<Obj::Chunk> chunks(ranges.size());
+    Base::parallel_for(ranges.size(), [&](std::size_t i) {
+        Obj::parseChunk(ranges[i], chunks[i]);
+    });
+
+    std::size_t numPoints = 0, numFaces = 0;
+    for (std::vector<Obj::Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        numPoints += it->points.size();
+        numFaces += it->faces.size();
+    }
 
     unsigned long segment=0;
     MeshPointArray meshPoints;
     MeshFacetArray meshFacets;
-
-    std::string line;
-    float fX, fY, fZ;
-    int  i1=1,i2=1,i3=1,i4=1;
+    meshPoints.reserve(numPoints);
+    meshFacets.reserve(numFaces);
     MeshFacet item;
 
-    if (!rstrIn || rstrIn.bad() == true)
-        return false;
-
-    std::streambuf* buf = rstrIn.rdbuf();
-    if (!buf)
-        return false;
-
     MeshIO::Binding rgb_value = MeshIO::OVERALL;
     bool new_segment = true;
     std::string groupName;
     std::string materialName;
     unsigned long countMaterialFacets = 0;
 
-    while (std::getline(rstrIn, line)) {
-        // when a group name comes don't make it lower case
-        if (!line.empty() && line[0] != 'g') {
-            for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-                *it = tolower(*it);
-        }
-        if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_c)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            float r = std::min<int>(std::atof(what[10].first),255) / 255.0f;
-            float g = std::min<int>(std::atof(what[11].first),255) / 255.0f;
-            float b = std::min<int>(std::atof(what[12].first),255) / 255.0f;
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
-
-            App::Color c(r,g,b);
-            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
-            meshPoints.back().SetProperty(prop);
+    // merge the chunks in the order of the file
+    for (std::vector<Obj::Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        long offset = static_cast<long>(meshPoints.size());
+        meshPoints.insert(meshPoints.end(), it->points.begin(), it->points.end());
+        if (it->colors)
             rgb_value = MeshIO::PER_VERTEX;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_t)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            float r = static_cast<float>(std::atof(what[10].first));
-            float g = static_cast<float>(std::atof(what[13].first));
-            float b = static_cast<float>(std::atof(what[16].first));
-            meshPoints.push_back(MeshPoint(Base::Vector3f(fX, fY, fZ)));
 
-            App::Color c(r,g,b);
-            unsigned long prop = static_cast<uint32_t>(c.getPackedValue());
-            meshPoints.back().SetProperty(prop);
-            rgb_value = MeshIO::PER_VERTEX;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_g)) {
-            new_segment = true;
-            groupName = Base::Tools::escapedUnicodeToUtf8(what[1].first);
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_m)) {
-            if (_material)
-                _material->library = Base::Tools::escapedUnicodeToUtf8(what[1].first);
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_u)) {
-            if (!materialName.empty()) {
-                _materialNames.emplace_back(materialName, countMaterialFacets);
-            }
-            materialName = Base::Tools::escapedUnicodeToUtf8(what[1].first);
-            countMaterialFacets = 0;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f3)) {
-            // starts a new segment
-            if (new_segment) {
-                if (!groupName.empty()) {
-                    _groupNames.push_back(groupName);
-                    groupName.clear();
+        std::vector<Obj::Statement>::iterator st = it->statements.begin();
+        for (std::size_t i = 0; i <= it->faces.size(); i++) {
+            for (; st != it->statements.end() && st->face == i; ++st) {
+                switch (st->type) {
+                case Obj::Statement::Group:
+                    new_segment = true;
+                    groupName = Base::Tools::escapedUnicodeToUtf8(st->name);
+                    break;
+                case Obj::Statement::Library:
+                    if (_material)
+                        _material->library = Base::Tools::escapedUnicodeToUtf8(st->name);
+                    break;
+                case Obj::Statement::Material:
+                    if (!materialName.empty()) {
+                        _materialNames.emplace_back(materialName, countMaterialFacets);
+                    }
+                    materialName = Base::Tools::escapedUnicodeToUtf8(st->name);
+                    countMaterialFacets = 0;
+                    break;
                 }
-                new_segment = false;
-                segment++;
             }
 
-            // 3-vertex face
-            i1 = std::atoi(what[1].first);
-            i1 = i1 > 0 ? i1-1 : i1+static_cast<int>(meshPoints.size());
-            i2 = std::atoi(what[2].first);
-            i2 = i2 > 0 ? i2-1 : i2+static_cast<int>(meshPoints.size());
-            i3 = std::atoi(what[3].first);
-            i3 = i3 > 0 ? i3-1 : i3+static_cast<int>(meshPoints.size());
-            item.SetVertices(i1,i2,i3);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
-            countMaterialFacets++;
-        }
-        else if (boost::regex_match(line.c_str(), what, rx_f4)) {
+            if (i == it->faces.size())
+                break;
+
             // starts a new segment
             if (new_segment) {
                 if (!groupName.empty()) {
@@ -429,28 +573,28 @@ bool MeshInput::LoadOBJ (std::istream &rstrIn)
                 segment++;
             }
 
-            // 4-vertex face
-            i1 = std::atoi(what[1].first);
-            i1 = i1 > 0 ? i1-1 : i1+static_cast<int>(meshPoints.size());
-            i2 = std::atoi(what[2].first);
-            i2 = i2 > 0 ? i2-1 : i2+static_cast<int>(meshPoints.size());
-            i3 = std::atoi(what[3].first);
-            i3 = i3 > 0 ? i3-1 : i3+static_cast<int>(meshPoints.size());
-            i4 = std::atoi(what[4].first);
-            i4 = i4 > 0 ? i4-1 : i4+static_cast<int>(meshPoints.size());
+            const Obj::Face& face = it->faces[i];
+            long index[4];
+            for (int j=0; j<face.count; j++)
+                index[j] = face.relative[j] ? face.index[j] + offset : face.index[j];
 
-            item.SetVertices(i1,i2,i3);
+            item.SetVertices(index[0],index[1],index[2]);
             item.SetProperty(segment);
             meshFacets.push_back(item);
             countMaterialFacets++;
 
-            item.SetVertices(i3,i4,i1);
-            item.SetProperty(segment);
-            meshFacets.push_back(item);
-            countMaterialFacets++;
+            // 4-vertex face
+            if (face.count == 4) {
+                item.SetVertices(index[2],index[3],index[0]);
+                item.SetProperty(segment);
+                meshFacets.push_back(item);
+                countMaterialFacets++;
+            }
         }
     }
 
+    chunks.clear();
+
     // Add the last added material name
     if (!materialName.empty()) {
         _materialNames.emplace_back(materialName, countMaterialFacets);
@@ -1038,86 +1182,89 @@ bool MeshInput::LoadPLY (std::istream &inp)
     }
 
     if (format == ascii) {
-        boost::regex rx_d("(([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?))\\s*");
-        boost::regex rx_s("\\b([-+]?[0-9]+)\\s*");
-        boost::regex rx_u("\\b([0-9]+)\\s*");
-        boost::regex rx_f("^\\s*3\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*");
-        boost::smatch what;
+        std::vector<char> buffer;
+        if (!readStream(inp, buffer))
+            return false;
+
+        // position of the used vertex properties
+        std::vector<std::pair<std::string, Number> >::const_iterator begin = vertex_props.begin();
+        std::vector<std::pair<std::string, Number> >::const_iterator end = vertex_props.end();
+        auto index = [begin, end](const char* name) {
+            return std::find_if(begin, end, [name](const std::pair<std::string, Number>& p) {
+                return p.first == name;
+            }) - begin;
+        };
+        std::ptrdiff_t num_props = end - begin;
+        std::ptrdiff_t px = index("x"), py = index("y"), pz = index("z");
+        std::ptrdiff_t pr = index("red"), pg = index("green"), pb = index("blue");
+        if (px == num_props || py == num_props || pz == num_props)
+            return false;
+        // colors are only read if all of their components are given
+        bool colors = _material && (rgb_value == MeshIO::PER_VERTEX) &&
+                      pr < num_props && pg < num_props && pb < num_props;
+
+        // the vertices are followed by the faces, each one on a separate line
+        const char* data = buffer.data();
+        const char* face_data = Tokenizer::skipLines(data, data + buffer.size(), v_count);
+        int threads = std::max(1, QThread::idealThreadCount());
+
+        std::vector<Tokenizer::Range> ranges = Tokenizer::split(data, face_data, threads);
+        std::vector<MeshPointArray> points(ranges.size());
+        std::vector< std::vector<App::Color> > diffuseColors(ranges.size());
+        std::vector<char> valid(ranges.size(), 1);
+        Base::parallel_for(ranges.size(), [&](std::size_t i) {
+            std::vector<double> values(vertex_props.size());
+            for (Tokenizer tok(ranges[i]); !tok.atEnd(); tok.nextLine()) {
+                for (std::vector<double>::iterator it = values.begin(); it != values.end(); ++it) {
+                    if (!tok.readDouble(*it)) {
+                        valid[i] = 0;
+                        return;
+                    }
+                }
 
-        for (std::size_t i = 0; i < v_count && std::getline(inp, line); i++) {
-            // go through the vertex properties
-            std::map<std::string, float> prop_values;
-            for (std::vector<std::pair<std::string, Number> >::iterator it = vertex_props.begin(); it != vertex_props.end(); ++it) {
-                switch (it->second) {
-                case int8:
-                case int16:
-                case int32:
-                    {
-                        if (boost::regex_search(line, what, rx_s)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                case uint8:
-                case uint16:
-                case uint32:
-                    {
-                        if (boost::regex_search(line, what, rx_u)) {
-                            int v;
-                            v = boost::lexical_cast<int>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                case float32:
-                case float64:
-                    {
-                        if (boost::regex_search(line, what, rx_d)) {
-                            double v;
-                            v = boost::lexical_cast<double>(what[1]);
-                            prop_values[it->first] = static_cast<float>(v);
-                            line = line.substr(what[0].length());
-                        }
-                        else {
-                            return false;
-                        }
-                    } break;
-                default:
-                    return false;
+                points[i].push_back(MeshPoint(static_cast<float>(values[px]),
+                                              static_cast<float>(values[py]),
+                                              static_cast<float>(values[pz])));
+                if (colors) {
+                    float r = static_cast<float>(values[pr]) / 255.0f;
+                    float g = static_cast<float>(values[pg]) / 255.0f;
+                    float b = static_cast<float>(values[pb]) / 255.0f;
+                    diffuseColors[i].emplace_back(r, g, b);
                 }
             }
-
-            Base::Vector3f pt;
-            pt.x = (prop_values["x"]);
-            pt.y = (prop_values["y"]);
-            pt.z = (prop_values["z"]);
-            meshPoints.push_back(pt);
-
-            if (_material && (rgb_value == MeshIO::PER_VERTEX)) {
-                float r = (prop_values["red"]) / 255.0f;
-                float g = (prop_values["green"]) / 255.0f;
-                float b = (prop_values["blue"]) / 255.0f;
-                _material->diffuseColor.emplace_back(r, g, b);
+        });
+
+        if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+            return false;
+        for (std::size_t i = 0; i < ranges.size(); i++) {
+            meshPoints.insert(meshPoints.end(), points[i].begin(), points[i].end());
+            if (colors) {
+                _material->diffuseColor.insert(_material->diffuseColor.end(),
+                    diffuseColors[i].begin(), diffuseColors[i].end());
             }
         }
+        points.clear();
+        diffuseColors.clear();
 
-        int f1, f2, f3;
-        for (std::size_t i = 0; i < f_count && std::getline(inp, line); i++) {
-            if (boost::regex_search(line, what, rx_f)) {
-                f1 = boost::lexical_cast<int>(what[1]);
-                f2 = boost::lexical_cast<int>(what[2]);
-                f3 = boost::lexical_cast<int>(what[3]);
-                meshFacets.push_back(MeshFacet(f1,f2,f3));
+        const char* face_end = Tokenizer::skipLines(face_data, data + buffer.size(), f_count);
+        ranges = Tokenizer::split(face_data, face_end, threads);
+        std::vector<MeshFacetArray> facets(ranges.size());
+        long num_points = static_cast<long>(v_count);
+        auto valid_index = [num_points](long f) {
+            return f >= 0 && f < num_points;
+        };
+        Base::parallel_for(ranges.size(), [&](std::size_t i) {
+            long n, f1, f2, f3;
+            for (Tokenizer tok(ranges[i]); !tok.atEnd(); tok.nextLine()) {
+                if (tok.readInt(n) && n == 3 && tok.readInt(f1) && tok.readInt(f2) && tok.readInt(f3)) {
+                    if (valid_index(f1) && valid_index(f2) && valid_index(f3))
+                        facets[i].push_back(MeshFacet(f1,f2,f3));
+                }
             }
-        }
+        });
+
+        for (std::size_t i = 0; i < ranges.size(); i++)
+            meshFacets.insert(meshFacets.end(), facets[i].begin(), facets[i].end());
     }
     // binary
     else {
@@ -1318,73 +1465,57 @@ bool MeshInput::LoadMeshNode (std::istream &rstrIn)
 /** Loads an ASCII STL file. */
 bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
 {
-    boost::regex rx_p("^\\s*VERTEX\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::regex rx_f("^\\s*FACET\\s+NORMAL\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    boost::cmatch what;
-
-    std::string line;
-    float fX, fY, fZ;
-    unsigned long ulVertexCt, ulFacetCt=0;
-    MeshGeomFacet clFacet;
-
     if (!rstrIn || rstrIn.bad() == true)
         return false;
 
-    std::streamoff ulSize = 0;
-    std::streambuf* buf = rstrIn.rdbuf();
-    ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
-    ulSize -= 20;
-
-    // count facets
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (line.find("ENDFACET") != std::string::npos)
-            ulFacetCt++;
-        // prevent from reading EOF (as I don't know how to reread the file then)
-        if (rstrIn.tellg() > ulSize)
-            break;
-        else if (line.find("ENDSOLID") != std::string::npos)
-            break;
-    }
-
-    // restart from the beginning
-    buf->pubseekoff(0, std::ios::beg, std::ios::in);
+    std::vector<char> buffer;
+    if (!readStream(rstrIn, buffer))
+        return false;
 
-#if 0
-    MeshBuilder builder(this->_rclMesh);
-#else
-    MeshFastBuilder builder(this->_rclMesh);
-#endif
-    builder.Initialize(ulFacetCt);
+    return LoadAsciiSTL(buffer.data(), buffer.size());
+}
 
-    ulVertexCt = 0;
-    while (std::getline(rstrIn, line)) {
-        for (std::string::iterator it = line.begin(); it != line.end(); ++it)
-            *it = toupper(*it);
-        if (boost::regex_match(line.c_str(), what, rx_f)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet.SetNormal(Base::Vector3f(fX, fY, fZ));
+/** Loads an ASCII STL file from a memory block. The vertices are parsed in parallel. */
+bool MeshInput::LoadAsciiSTL (const char* data, std::size_t size)
+{
+    int threads = std::max(1, QThread::idealThreadCount());
+    std::vector<Tokenizer::Range> ranges = Tokenizer::split(data, data + size, threads);
+    std::vector< std::vector<Base::Vector3f> > chunks(ranges.size());
+    Base::parallel_for(ranges.size(), [&](std::size_t i) {
+        std::vector<Base::Vector3f>& points = chunks[i];
+        Base::Vector3f pt;
+        for (Tokenizer tok(ranges[i]); !tok.atEnd(); tok.nextLine()) {
+            if (tok.keyword("vertex") && tok.readFloat(pt.x) && tok.readFloat(pt.y) && tok.readFloat(pt.z))
+                points.push_back(pt);
         }
-        else if (boost::regex_match(line.c_str(), what, rx_p)) {
-            fX = (float)std::atof(what[1].first);
-            fY = (float)std::atof(what[4].first);
-            fZ = (float)std::atof(what[7].first);
-            clFacet._aclPoints[ulVertexCt++].Set(fX, fY, fZ);
-            if (ulVertexCt == 3) {
-                ulVertexCt = 0;
-                builder.AddFacet(clFacet);
-            }
+    });
+
+    // a facet may be split over two chunks
+    std::vector<Base::Vector3f> points;
+    if (chunks.size() == 1) {
+        points.swap(chunks.front());
+    }
+    else {
+        std::size_t numPoints = 0;
+        for (std::vector< std::vector<Base::Vector3f> >::iterator it = chunks.begin(); it != chunks.end(); ++it)
+            numPoints += it->size();
+        points.reserve(numPoints);
+        for (std::vector< std::vector<Base::Vector3f> >::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            points.insert(points.end(), it->begin(), it->end());
+            std::vector<Base::Vector3f>().swap(*it);
         }
     }
 
+    std::size_t ulFacetCt = points.size() / 3;
+    // no facets and no solid is not an STL file
+    if (ulFacetCt == 0 && !hasSolidKeyword(data, size))
+        return false;
+
+    MeshFastBuilder builder(this->_rclMesh);
+    builder.Initialize(ulFacetCt);
+    if (ulFacetCt > 0)
+        builder.AddFacets(reinterpret_cast<const char*>(&points[0]), 3 * sizeof(Base::Vector3f), ulFacetCt);
+    std::vector<Base::Vector3f>().swap(points);
     builder.Finish();
 
     return true;
@@ -1394,8 +1525,6 @@ bool MeshInput::LoadAsciiSTL (std::istream &rstrIn)
 bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
 {
     char szInfo[80];
-    Base::Vector3f clVects[4];
-    uint16_t usAtt = 0;
     uint32_t ulCt = 0;
 
     if (!rstrIn || rstrIn.bad() == true)
@@ -1408,6 +1537,8 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     rstrIn.read((char*)&ulCt, sizeof(ulCt));
     if (rstrIn.bad() == true)
         return false;
+    if (Base::SwapOrder() == HIGH_ENDIAN)
+        Base::SwapEndian<uint32_t>(ulCt);
 
     // get file size and calculate the number of facets
     std::streamoff ulSize = 0;
@@ -1432,15 +1563,14 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
 #endif
     builder.Initialize(ulCt);
 
-    for (uint32_t i = 0; i < ulCt; i++) {
-        // read normal, points
-        rstrIn.read((char*)&clVects, sizeof(clVects));
-
-        std::swap(clVects[0], clVects[3]);
-        builder.AddFacet(clVects);
-
-        // overread 2 bytes attribute
-        rstrIn.read((char*)&usAtt, sizeof(usAtt));
+    // read the facet records block-wise and skip the normals
+    const uint32_t ulBlock = 0x10000;
+    std::vector<char> records(ulBlock * 50);
+    for (uint32_t i = 0; i < ulCt; i += ulBlock) {
+        uint32_t ulNum = std::min(ulBlock, ulCt - i);
+        if (!rstrIn.read(&records[0], ulNum * 50))
+            return false;
+        builder.AddFacets(&records[12], 50, ulNum, true);
     }
 
     builder.Finish();
@@ -1448,6 +1578,33 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     return true;
 }
 
+bool MeshInput::LoadBinarySTL (const char* data, std::size_t size)
+{
+    if (size < 80 + sizeof(uint32_t))
+        return false;
+
+    uint32_t ulCt = readFacetCount(data);
+
+    // compare the calculated with the read value
+    std::size_t ulFac = (size - (80 + sizeof(uint32_t))) / 50;
+    if (ulCt > ulFac)
+        return false;// not a valid STL file
+
+    try {
+        // 80 bytes header, 4 bytes facet count and 12 bytes normal
+        MeshFastBuilder builder(this->_rclMesh);
+        builder.Initialize(ulCt);
+        builder.AddFacets(data + 96, 50, ulCt, true);
+        builder.Finish();
+    }
+    catch (...) {
+        _rclMesh.Clear();
+        throw;
+    }
+
+    return true;
+}
+
 /** Loads the mesh object from an XML file. */
 void MeshInput::LoadXML (Base::XMLReader &reader)
 {
@@ -109,10 +109,22 @@ public:
     bool LoadSTL (std::istream &rstrIn);
     /** Loads an ASCII STL file. */
     bool LoadAsciiSTL (std::istream &rstrIn);
+    /** Loads an ASCII STL file from a memory block, e.g. a memory-mapped file.
+     * The file is split into chunks which are parsed in parallel.
+     */
+    bool LoadAsciiSTL (const char* data, std::size_t size);
     /** Loads a binary STL file. */
     bool LoadBinarySTL (std::istream &rstrIn);
+    /** Loads a binary STL file from a memory block, e.g. a memory-mapped file.
+     * The facet records are decoded in parallel.
+     */
+    bool LoadBinarySTL (const char* data, std::size_t size);
     /** Loads an OBJ Mesh file. */
     bool LoadOBJ (std::istream &rstrIn);
+    /** Loads an OBJ Mesh file from a memory block, e.g. a memory-mapped file.
+     * The file is split into chunks which are parsed in parallel.
+     */
+    bool LoadOBJ (const char* data, std::size_t size);
     /** Loads the materials of an OBJ file. */
     bool LoadMTL (std::istream &rstrIn);
     /** Loads an SMF Mesh file. */
@@ -840,19 +840,36 @@ void MeshKernel::Write (std::ostream &rclOut) const
     // write the number of points and facets
     str << static_cast<uint32_t>(CountPoints()) << static_cast<uint32_t>(CountFacets());
 
-    // write the data
+    // write the data block-wise to keep the number of stream calls low
+    const std::size_t blockSize = 4096;
+    std::vector<float> coords;
+    coords.reserve(3 * blockSize);
     for (MeshPointArray::_TConstIterator it = _aclPointArray.begin(); it != _aclPointArray.end(); ++it) {
-        str << it->x << it->y << it->z;
+        coords.push_back(it->x);
+        coords.push_back(it->y);
+        coords.push_back(it->z);
+        if (coords.size() == 3 * blockSize) {
+            str.write(coords.data(), coords.size());
+            coords.clear();
+        }
     }
+    str.write(coords.data(), coords.size());
 
+    std::vector<uint32_t> indices;
+    indices.reserve(6 * blockSize);
     for (MeshFacetArray::_TConstIterator it = _aclFacetArray.begin(); it != _aclFacetArray.end(); ++it) {
-        str << static_cast<uint32_t>(it->_aulPoints[0])
-            << static_cast<uint32_t>(it->_aulPoints[1])
-            << static_cast<uint32_t>(it->_aulPoints[2]);
-        str << static_cast<uint32_t>(it->_aulNeighbours[0])
-            << static_cast<uint32_t>(it->_aulNeighbours[1])
-            << static_cast<uint32_t>(it->_aulNeighbours[2]);
+        indices.push_back(static_cast<uint32_t>(it->_aulPoints[0]));
+        indices.push_back(static_cast<uint32_t>(it->_aulPoints[1]));
+        indices.push_back(static_cast<uint32_t>(it->_aulPoints[2]));
+        indices.push_back(static_cast<uint32_t>(it->_aulNeighbours[0]));
+        indices.push_back(static_cast<uint32_t>(it->_aulNeighbours[1]));
+        indices.push_back(static_cast<uint32_t>(it->_aulNeighbours[2]));
+        if (indices.size() == 6 * blockSize) {
+            str.write(indices.data(), indices.size());
+            indices.clear();
+        }
     }
+    str.write(indices.data(), indices.size());
 
     str << _clBoundBox.MinX << _clBoundBox.MaxX;
     str << _clBoundBox.MinY << _clBoundBox.MaxY;
@@ -893,19 +910,38 @@ void MeshKernel::Read (std::istream &rclIn)
         str >> uCtPts >> uCtFts;
 
         try {
-            // read the data
+            // read the data block-wise
+            const std::size_t blockSize = 4096;
             MeshPointArray pointArray;
             pointArray.resize(uCtPts);
-            for (MeshPointArray::_TIterator it = pointArray.begin(); it != pointArray.end(); ++it) {
-                str >> it->x >> it->y >> it->z;
+            std::vector<float> coords(3 * blockSize);
+            for (std::size_t first = 0; first < uCtPts; first += blockSize) {
+                std::size_t num = std::min<std::size_t>(blockSize, uCtPts - first);
+                str.read(coords.data(), 3 * num);
+                for (std::size_t i = 0; i < num; i++) {
+                    MeshPoint& pnt = pointArray[first + i];
+                    pnt.x = coords[3 * i];
+                    pnt.y = coords[3 * i + 1];
+                    pnt.z = coords[3 * i + 2];
+                }
             }
           
             MeshFacetArray facetArray;
             facetArray.resize(uCtFts);
 
+            std::vector<uint32_t> indices(6 * blockSize);
+            std::size_t index = 6 * blockSize;
             uint32_t v1, v2, v3;
             for (MeshFacetArray::_TIterator it = facetArray.begin(); it != facetArray.end(); ++it) {
-                str >> v1 >> v2 >> v3;
+                if (index == 6 * blockSize) {
+                    std::size_t num = std::min<std::size_t>(blockSize, facetArray.end() - it);
+                    str.read(indices.data(), 6 * num);
+                    index = 0;
+                }
+
+                v1 = indices[index++];
+                v2 = indices[index++];
+                v3 = indices[index++];
 
                 // make sure to have valid indices
                 if (v1 >= uCtPts || v2 >= uCtPts || v3 >= uCtPts)
@@ -919,7 +955,9 @@ void MeshKernel::Read (std::istream &rclIn)
                 // the empty neighbour must be explicitly set to 'ULONG_MAX'
                 // because in algorithms this value is always used to check
                 // for open edges.
-                str >> v1 >> v2 >> v3;
+                v1 = indices[index++];
+                v2 = indices[index++];
+                v3 = indices[index++];
 
                 // make sure to have valid indices
                 if (v1 >= uCtFts && v1 < open_edge)
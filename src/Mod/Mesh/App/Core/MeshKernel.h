@@ -375,6 +375,12 @@ public:
     void RemoveInvalids ();
     /** Rebuilds the neighbour indices for all facets. */
     void RebuildNeighbours (void);
+    /** Rebuilds the neighbour indices of the given facets, of all facets sharing an
+     * edge with them and of their former neighbours. If only a few facets were added or
+     * modified this is much cheaper than a complete rebuild. Indices out of range are
+     * ignored.
+     */
+    void RebuildNeighbours (const std::vector<unsigned long> &raulFacets);
     /** Removes unreferenced points or facets with invalid indices from the mesh. */
     void Cleanup();
     /** Clears the whole data structure. */
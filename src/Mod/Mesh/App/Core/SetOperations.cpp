@@ -41,7 +41,9 @@
 #include "Evaluation.h"
 #include "Definitions.h"
 #include "Triangulation.h"
+#include "BVH.h"
 
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
 #include <Base/Builder3D.h>
 #include <Base/Tools2D.h>
@@ -108,16 +110,25 @@ void SetOperations::Do ()
     return;
   }
 
+  std::set<unsigned long>::iterator it;
+  std::vector<bool> cut0(_cutMesh0.CountFacets()), cut1(_cutMesh1.CountFacets());
+  for (it = facetsCuttingEdge0.begin(); it != facetsCuttingEdge0.end(); ++it)
+    cut0[*it] = true;
+  for (it = facetsCuttingEdge1.begin(); it != facetsCuttingEdge1.end(); ++it)
+    cut1[*it] = true;
+
   unsigned long i;
+  _newMeshFacets[0].reserve(_cutMesh0.CountFacets());
   for (i = 0; i < _cutMesh0.CountFacets(); i++)
   {
-    if (facetsCuttingEdge0.find(i) == facetsCuttingEdge0.end())
+    if (!cut0[i])
       _newMeshFacets[0].push_back(_cutMesh0.GetFacet(i));
   }
 
+  _newMeshFacets[1].reserve(_cutMesh1.CountFacets());
   for (i = 0; i < _cutMesh1.CountFacets(); i++)
   {
-    if (facetsCuttingEdge1.find(i) == facetsCuttingEdge1.end())
+    if (!cut1[i])
       _newMeshFacets[1].push_back(_cutMesh1.GetFacet(i));
   }
 
@@ -172,145 +183,143 @@ void SetOperations::Do ()
 
 void SetOperations::Cut (std::set<unsigned long>& facetsCuttingEdge0, std::set<unsigned long>& facetsCuttingEdge1)
 {
-  MeshFacetGrid grid1(_cutMesh0, 20);
-  MeshFacetGrid grid2(_cutMesh1, 20);
-
-  unsigned long ctGx1, ctGy1, ctGz1;
-  grid1.GetCtGrids(ctGx1, ctGy1, ctGz1);
+  // broad phase: traverse the hierarchies of both meshes for facets with overlapping bounding boxes
+  MeshFacetBVH bvh0, bvh1;
+  Base::parallel_for(2, [&](std::size_t side) {
+    if (side == 0)
+      bvh0.Build(_cutMesh0);
+    else
+      bvh1.Build(_cutMesh1);
+  });
+
+  std::vector<std::pair<unsigned long, unsigned long> > pairs;
+  bvh0.SearchOverlappingFacets(bvh1, pairs);
+
+  // narrow phase: intersect the facet pairs in parallel
+  std::size_t count = pairs.size();
+  std::vector<int> cuts(count);
+  std::vector<MeshPoint> cutPoints(2 * count);
+  Base::parallel_for(count, 256, [&](std::size_t, std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; i++)
+    {
+      MeshGeomFacet f1 = _cutMesh0.GetFacet(pairs[i].first);
+      MeshGeomFacet f2 = _cutMesh1.GetFacet(pairs[i].second);
+      cuts[i] = CutFacets(f1, f2, cutPoints[2 * i], cutPoints[2 * i + 1]);
+    }
+  });
 
-  unsigned long gx1;
-  for (gx1 = 0; gx1 < ctGx1; gx1++)  
+  // merge the cut lines in the order of the facet pairs
+  for (std::size_t i = 0; i < count; i++)
   {
-    unsigned long gy1;
-    for (gy1 = 0; gy1 < ctGy1; gy1++)
+    if (cuts[i] == 0)
+      continue;
+
+    unsigned long fidx1 = pairs[i].first;
+    unsigned long fidx2 = pairs[i].second;
+    const MeshPoint& mp0 = cutPoints[2 * i];
+    const MeshPoint& mp1 = cutPoints[2 * i + 1];
+
+    if (cuts[i] == 1)
     {
-      unsigned long gz1;
-      for (gz1 = 0; gz1 < ctGz1; gz1++)
+      facetsCuttingEdge0.insert(fidx1);
+      facetsCuttingEdge1.insert(fidx2);
+
+      std::pair<std::set<MeshPoint>::iterator, bool> pit0 = _cutPoints.insert(mp0);
+      std::pair<std::set<MeshPoint>::iterator, bool> pit1 = _cutPoints.insert(mp1);
+
+      _edges[Edge(mp0, mp1)] = EdgeInfo();
+
+      _facet2points[0][fidx1].push_back(pit0.first);
+      _facet2points[0][fidx1].push_back(pit1.first);
+      _facet2points[1][fidx2].push_back(pit0.first);
+      _facet2points[1][fidx2].push_back(pit1.first);
+    }
+    else
+    {
+      std::pair<std::set<MeshPoint>::iterator, bool> pit = _cutPoints.insert(mp0);
+
+      // do not insert a facet when only one corner point cuts the edge
+      // if (!((mp0 == f1._aclPoints[0]) || (mp0 == f1._aclPoints[1]) || (mp0 == f1._aclPoints[2])))
       {
-        if (grid1.GetCtElements(gx1, gy1, gz1) > 0)
-        {
-          std::vector<unsigned long> vecFacets2;
-          grid2.Inside(grid1.GetBoundBox(gx1, gy1, gz1), vecFacets2);
-      
-          if (vecFacets2.size() > 0)
-          {
-            std::set<unsigned long> vecFacets1;
-            grid1.GetElements(gx1, gy1, gz1, vecFacets1);
-            
-            std::set<unsigned long>::iterator it1;
-            for (it1 = vecFacets1.begin(); it1 != vecFacets1.end(); ++it1)
-            {
-              unsigned long fidx1 = *it1;
-              MeshGeomFacet f1 = _cutMesh0.GetFacet(*it1);
-              
-              std::vector<unsigned long>::iterator it2;
-              for (it2 = vecFacets2.begin(); it2 != vecFacets2.end(); ++it2)
-              {
-                unsigned long fidx2 = *it2;
-                MeshGeomFacet f2 = _cutMesh1.GetFacet(fidx2);
-
-                MeshPoint p0, p1;
-
-                int isect = f1.IntersectWithFacet(f2, p0, p1);
-                if (isect > 0)
-                { 
-                   // optimize cut line if distance to nearest point is too small
-                  float minDist1 = _minDistanceToPoint, minDist2 = _minDistanceToPoint;
-                  MeshPoint np0 = p0, np1 = p1;
-                  int i;
-                  for (i = 0; i < 3; i++)
-                  {
-                    float d1 = (f1._aclPoints[i] - p0).Length();
-                    float d2 = (f1._aclPoints[i] - p1).Length();
-                    if (d1 < minDist1)
-                    {
-                      minDist1 = d1;
-                      np0 = f1._aclPoints[i];
-                    }
-                    if (d2 < minDist2)
-                    {
-                      minDist2 = d2;
-                      p1 = f1._aclPoints[i];
-                    }
-                  } // for (int i = 0; i < 3; i++)
-
-                  // optimize cut line if distance to nearest point is too small
-                  for (i = 0; i < 3; i++)
-                  {
-                    float d1 = (f2._aclPoints[i] - p0).Length();
-                    float d2 = (f2._aclPoints[i] - p1).Length();
-                    if (d1 < minDist1)
-                    {
-                      minDist1 = d1;
-                      np0 = f2._aclPoints[i];
-                    }
-                    if (d2 < minDist2)
-                    {
-                      minDist2 = d2;
-                      np1 = f2._aclPoints[i];
-                    }
-                  } // for (int i = 0; i < 3; i++)
-
-                  MeshPoint mp0 = np0;
-                  MeshPoint mp1 = np1;
-
-                  if (mp0 != mp1)
-                  {
-                    facetsCuttingEdge0.insert(fidx1);
-                    facetsCuttingEdge1.insert(fidx2);
-
-                    _cutPoints.insert(mp0);
-                    _cutPoints.insert(mp1);
-
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit0 = _cutPoints.insert(mp0);
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit1 = _cutPoints.insert(mp1);
-
-                    _edges[Edge(mp0, mp1)] = EdgeInfo();
-
-                    _facet2points[0][fidx1].push_back(pit0.first);
-                    _facet2points[0][fidx1].push_back(pit1.first);
-                    _facet2points[1][fidx2].push_back(pit0.first);
-                    _facet2points[1][fidx2].push_back(pit1.first);
-
-                  }
-                  else
-                  {
-                    std::pair<std::set<MeshPoint>::iterator, bool> pit = _cutPoints.insert(mp0);
-
-                    // do not insert a facet when only one corner point cuts the edge
-                    // if (!((mp0 == f1._aclPoints[0]) || (mp0 == f1._aclPoints[1]) || (mp0 == f1._aclPoints[2])))
-                    {
-                      facetsCuttingEdge0.insert(fidx1);
-                      _facet2points[0][fidx1].push_back(pit.first);
-                    }
-
-                    // if (!((mp0 == f2._aclPoints[0]) || (mp0 == f2._aclPoints[1]) || (mp0 == f2._aclPoints[2])))
-                    {
-                      facetsCuttingEdge1.insert(fidx2);
-                      _facet2points[1][fidx2].push_back(pit.first);
-                    }
-                  }
-
-                 } // if (f1.IntersectWithFacet(f2, p0, p1))
-              } // for (it2 = vecFacets2.begin(); it2 != vecFacets2.end(); ++it2)
-            } // for (it1 = vecFacets1.begin(); it1 != vecFacets1.end(); ++it1)
-          } // if (vecFacets2.size() > 0)
-        } // if (grid1.GetCtElements(gx1, gy1, gz1) > 0)
-      } // for (gz1 = 0; gz1 < ctGz1; gz1++)
-    } // for (gy1 = 0; gy1 < ctGy1; gy1++)
-  } // for (gx1 = 0; gx1 < ctGx1; gx1++)  
+        facetsCuttingEdge0.insert(fidx1);
+        _facet2points[0][fidx1].push_back(pit.first);
+      }
+
+      // if (!((mp0 == f2._aclPoints[0]) || (mp0 == f2._aclPoints[1]) || (mp0 == f2._aclPoints[2])))
+      {
+        facetsCuttingEdge1.insert(fidx2);
+        _facet2points[1][fidx2].push_back(pit.first);
+      }
+    }
+  }
+}
+
+int SetOperations::CutFacets (const MeshGeomFacet& f1, const MeshGeomFacet& f2, MeshPoint& mp0, MeshPoint& mp1) const
+{
+  MeshPoint p0, p1;
+
+  int isect = f1.IntersectWithFacet(f2, p0, p1);
+  if (isect <= 0)
+    return 0;
+
+  // optimize cut line if distance to nearest point is too small
+  float minDist1 = _minDistanceToPoint, minDist2 = _minDistanceToPoint;
+  MeshPoint np0 = p0, np1 = p1;
+  int i;
+  for (i = 0; i < 3; i++)
+  {
+    float d1 = (f1._aclPoints[i] - p0).Length();
+    float d2 = (f1._aclPoints[i] - p1).Length();
+    if (d1 < minDist1)
+    {
+      minDist1 = d1;
+      np0 = f1._aclPoints[i];
+    }
+    if (d2 < minDist2)
+    {
+      minDist2 = d2;
+      p1 = f1._aclPoints[i];
+    }
+  } // for (int i = 0; i < 3; i++)
+
+  // optimize cut line if distance to nearest point is too small
+  for (i = 0; i < 3; i++)
+  {
+    float d1 = (f2._aclPoints[i] - p0).Length();
+    float d2 = (f2._aclPoints[i] - p1).Length();
+    if (d1 < minDist1)
+    {
+      minDist1 = d1;
+      np0 = f2._aclPoints[i];
+    }
+    if (d2 < minDist2)
+    {
+      minDist2 = d2;
+      np1 = f2._aclPoints[i];
+    }
+  } // for (int i = 0; i < 3; i++)
+
+  mp0 = np0;
+  mp1 = np1;
+  return (mp0 != mp1) ? 1 : 2;
 }
 
 void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
 {
   // Triangulate Mesh 
+  std::vector<std::map<unsigned long, std::list<std::set<MeshPoint>::iterator> >::iterator> cutFacets;
   std::map<unsigned long, std::list<std::set<MeshPoint>::iterator> >::iterator it1;
   for (it1 = _facet2points[side].begin(); it1 != _facet2points[side].end(); ++it1)
+    cutFacets.push_back(it1);
+
+  // the facets are triangulated in parallel and registered at the cut edges afterwards
+  std::vector<std::vector<MeshGeomFacet> > triangles(cutFacets.size());
+  auto triangulate = [&](std::size_t index)
   {
     std::vector<Vector3f> points;
     std::set<MeshPoint>   pointsSet;
 
-    unsigned long fidx = it1->first;
+    unsigned long fidx = cutFacets[index]->first;
     MeshGeomFacet f = cutMesh.GetFacet(fidx);
 
     //if (side == 1)
@@ -327,7 +336,7 @@ void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
     
     // triangulated facets
     std::list<std::set<MeshPoint>::iterator>::iterator it2;
-    for (it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
+    for (it2 = cutFacets[index]->second.begin(); it2 != cutFacets[index]->second.end(); ++it2)
     {
       if (pointsSet.find(*(*it2)) == pointsSet.end())
       {
@@ -409,6 +418,23 @@ void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
          facet.CalcNormal();
       }
 
+      triangles[index].push_back(facet);
+
+    } // for (i = 0; i < (out->numberoftriangles * 3); i += 3)
+  };
+
+  Base::parallel_for(cutFacets.size(), 64, [&](std::size_t, std::size_t first, std::size_t last) {
+    for (std::size_t index = first; index < last; index++)
+      triangulate(index);
+  });
+
+  for (std::size_t index = 0; index < cutFacets.size(); index++)
+  {
+    unsigned long fidx = cutFacets[index]->first;
+    std::vector<MeshGeomFacet>::iterator it;
+    for (it = triangles[index].begin(); it != triangles[index].end(); ++it)
+    {
+      MeshGeomFacet& facet = *it;
 
       int j;
       for (j = 0; j < 3; j++)
@@ -433,9 +459,8 @@ void SetOperations::TriangulateMesh (const MeshKernel &cutMesh, int side)
       }
 
       _newMeshFacets[side].push_back(facet);
-
-    } // for (i = 0; i < (out->numberoftriangles * 3); i += 3)
-  } // for (it1 = _facet2points[side].begin(); it1 != _facet2points[side].end(); ++it1)
+    }
+  }
 }
 
 void SetOperations::CollectFacets (int side, float mult)
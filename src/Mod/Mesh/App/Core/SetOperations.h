@@ -172,6 +172,10 @@ private:
 
   /** Cut mesh 1 with mesh 2 */
   void Cut (std::set<unsigned long>& facetsNotCuttingEdge0, std::set<unsigned long>& facetsCuttingEdge1);
+  /** Intersects two facets and moves the end points of the cut line to nearby corner points.
+   * Returns 0 if the facets don't intersect, 1 for a cut line and 2 if the cut line degenerates to a point.
+   */
+  int CutFacets (const MeshGeomFacet& f1, const MeshGeomFacet& f2, MeshPoint& mp0, MeshPoint& mp1) const;
   /** Trianglute each facets cut with its cutting points */
   void TriangulateMesh (const MeshKernel &cutMesh, int side);
   /** search facets for adding (with region growing) */
@@ -9,6 +9,8 @@
 // * Comment out printf statements
 // * Fix compiler warnings
 // * Remove macros loop,i,j,k
+// * Allow to lock vertices, to pass precomputed quadrics and to skip the final compaction
+//   so that the algorithm can be run on parts of a mesh
 
 #include <vector>
 #include <Base/Vector3D.h>
@@ -84,11 +86,15 @@ class Simplify
 {
 public:
     struct Triangle { int v[3];double err[4];int deleted,dirty;vec3f n; };
-    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;};
+    struct Vertex { vec3f p;int tstart,tcount;SymmetricMatrix q;int border;int locked=0;};
     struct Ref { int tid,tvertex; }; 
     std::vector<Triangle> triangles;
     std::vector<Vertex> vertices;
     std::vector<Ref> refs;
+    // if false the quadrics of the vertices must be set by the caller
+    bool init_quadrics = true;
+    // if false the deleted triangles and unused vertices are kept at the end
+    bool compact = true;
 
     void simplify_mesh(int target_count, double tolerance, double aggressiveness=7);
 
@@ -198,6 +204,10 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
                     if (v0.border != v1.border)
                         continue;
 
+                    // Locked vertices must not be moved or removed
+                    if (v0.locked || v1.locked)
+                        continue;
+
                     // Compute vertex to collapse to
                     vec3f p;
                     calculate_error(i0,i1,p);
@@ -245,7 +255,8 @@ void Simplify::simplify_mesh(int target_count, double tolerance, double aggressi
     }
 
     // clean up mesh
-    compact_mesh();
+    if (compact)
+        compact_mesh();
 
     // ready
     //int timeEnd=timeGetTime();
@@ -347,8 +358,11 @@ void Simplify::update_mesh(int iteration)
     //
     if (iteration == 0)
     {
-        for (std::size_t i=0;i<vertices.size();++i)
-            vertices[i].q=SymmetricMatrix(0.0);
+        if (init_quadrics)
+        {
+            for (std::size_t i=0;i<vertices.size();++i)
+                vertices[i].q=SymmetricMatrix(0.0);
+        }
 
         for (std::size_t i=0;i<triangles.size();++i)
         {
@@ -359,6 +373,8 @@ void Simplify::update_mesh(int iteration)
             n = (p[1]-p[0]).Cross(p[2]-p[0]);
             n.Normalize();
             t.n=n;
+            if (!init_quadrics)
+                continue;
             for (std::size_t j=0;j<3;++j)
                 vertices[t.v[j]].q = vertices[t.v[j]].q+SymmetricMatrix(n.x,n.y,n.z,-n.Dot(p[0]));
         }
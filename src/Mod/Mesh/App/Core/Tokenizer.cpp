@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cstdlib>
+# include <cstring>
+# include <string>
+#endif
+
+#include "Tokenizer.h"
+
+using namespace MeshCore;
+
+namespace {
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline char toLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// exactly representable powers of ten
+const double pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// the largest mantissa that is exactly representable as double
+const unsigned long long maxExactMantissa = 1ULL << 53;
+
+/* Parses the number at the start of [begin, end) with strtod. This is slower but correctly
+ * rounded for all numbers and also accepts nan and inf. Returns the end of the number or
+ * null on failure.
+ */
+const char* parseWithStrtod(const char* begin, const char* end, double& value)
+{
+    const char* stop = begin;
+    while (stop != end && !isBlank(*stop) && *stop != '\n')
+        ++stop;
+    std::string token(begin, stop);
+    char* next = nullptr;
+    double v = std::strtod(token.c_str(), &next);
+    if (next == token.c_str())
+        return nullptr;
+    value = v;
+    return begin + (next - token.c_str());
+}
+}
+
+Tokenizer::Tokenizer(const char* begin, const char* end)
+  : _cur(begin), _end(end)
+{
+}
+
+Tokenizer::Tokenizer(const Range& range)
+  : _cur(range.first), _end(range.second)
+{
+}
+
+bool Tokenizer::atEndOfLine()
+{
+    skipBlanks();
+    return _cur == _end || *_cur == '\n';
+}
+
+void Tokenizer::nextLine()
+{
+    const char* eol = static_cast<const char*>(std::memchr(_cur, '\n', _end - _cur));
+    _cur = eol ? eol + 1 : _end;
+}
+
+void Tokenizer::skipBlanks()
+{
+    while (_cur != _end && isBlank(*_cur))
+        ++_cur;
+}
+
+void Tokenizer::skipToken()
+{
+    skipBlanks();
+    while (_cur != _end && !isBlank(*_cur) && *_cur != '\n')
+        ++_cur;
+}
+
+bool Tokenizer::keyword(const char* keyword)
+{
+    skipBlanks();
+    const char* p = _cur;
+    for (; *keyword; ++keyword, ++p) {
+        if (p == _end || toLower(*p) != toLower(*keyword))
+            return false;
+    }
+
+    // the keyword must be followed by a blank or the end of the line
+    if (p != _end && !isBlank(*p) && *p != '\n')
+        return false;
+    _cur = p;
+    return true;
+}
+
+bool Tokenizer::readDouble(double& value)
+{
+    skipBlanks();
+    const char* start = _cur;
+    const char* p = _cur;
+    bool negative = false;
+    if (p != _end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    // collect up to 19 significant digits, more don't fit into 64 bit
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool valid = false;
+    bool truncated = false;
+    for (; p != _end && isDigit(*p); ++p) {
+        valid = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > 0)
+                ++digits;
+        }
+        else {
+            ++exponent;
+            truncated = truncated || *p != '0';
+        }
+    }
+    if (p != _end && *p == '.') {
+        for (++p; p != _end && isDigit(*p); ++p) {
+            valid = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa > 0)
+                    ++digits;
+                --exponent;
+            }
+            else {
+                truncated = truncated || *p != '0';
+            }
+        }
+    }
+
+    // e.g. nan or inf
+    if (!valid) {
+        p = parseWithStrtod(start, _end, value);
+        if (!p)
+            return false;
+        _cur = p;
+        return true;
+    }
+
+    if (p != _end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negexp = false;
+        if (q != _end && (*q == '+' || *q == '-')) {
+            negexp = (*q == '-');
+            ++q;
+        }
+        if (q != _end && isDigit(*q)) {
+            int e = 0;
+            for (; q != _end && isDigit(*q); ++q) {
+                if (e < 10000)
+                    e = e * 10 + (*q - '0');
+            }
+            exponent += negexp ? -e : e;
+            p = q;
+        }
+    }
+
+    // The product or quotient of an exact mantissa and an exact power of ten is correctly
+    // rounded, all other numbers are left to strtod
+    if (mantissa != 0 && (truncated || mantissa > maxExactMantissa || exponent < -22 || exponent > 22)) {
+        const char* q = parseWithStrtod(start, _end, value);
+        if (!q)
+            return false;
+        _cur = q;
+        return true;
+    }
+
+    double v = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent > 0)
+        v *= pow10[exponent];
+    else if (mantissa != 0 && exponent < 0)
+        v /= pow10[-exponent];
+
+    value = negative ? -v : v;
+    _cur = p;
+    return true;
+}
+
+bool Tokenizer::readFloat(float& value)
+{
+    double v;
+    if (!readDouble(v))
+        return false;
+    value = static_cast<float>(v);
+    return true;
+}
+
+bool Tokenizer::readInt(long& value)
+{
+    skipBlanks();
+    const char* p = _cur;
+    bool negative = false;
+    if (p != _end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    if (p == _end || !isDigit(*p))
+        return false;
+
+    long v = 0;
+    for (; p != _end && isDigit(*p); ++p)
+        v = v * 10 + (*p - '0');
+
+    value = negative ? -v : v;
+    _cur = p;
+    return true;
+}
+
+std::string Tokenizer::readToken()
+{
+    skipBlanks();
+    const char* start = _cur;
+    skipToken();
+    return std::string(start, _cur);
+}
+
+std::vector<Tokenizer::Range> Tokenizer::split(const char* begin, const char* end, std::size_t parts)
+{
+    std::vector<Range> chunks;
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    std::size_t step = parts > 1 ? size / parts : size;
+    // avoid too small chunks
+    step = std::max<std::size_t>(step, 0x10000);
+    const char* start = begin;
+    while (start != end) {
+        const char* stop = end;
+        if (static_cast<std::size_t>(end - start) > step + step / 2) {
+            stop = static_cast<const char*>(std::memchr(start + step, '\n', end - start - step));
+            stop = stop ? stop + 1 : end;
+        }
+
+        chunks.emplace_back(start, stop);
+        start = stop;
+    }
+
+    return chunks;
+}
+
+const char* Tokenizer::skipLines(const char* begin, const char* end, std::size_t count)
+{
+    for (std::size_t i = 0; i < count && begin != end; i++) {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        begin = eol ? eol + 1 : end;
+    }
+
+    return begin;
+}
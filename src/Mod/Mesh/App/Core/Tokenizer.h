@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_TOKENIZER_H
+#define MESH_TOKENIZER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MeshCore
+{
+
+/**
+ * The Tokenizer class parses ASCII data from a memory block, e.g. a memory-mapped
+ * file. Unlike stream extraction or std::atof the number parsing doesn't depend on
+ * the locale and doesn't need a null-terminated string.
+ * A memory block can be split into chunks at line boundaries which can be parsed
+ * in parallel, each chunk with its own tokenizer.
+ * \code
+ * Tokenizer tok(begin, end);
+ * while (!tok.atEnd()) {
+ *     float x, y, z;
+ *     if (tok.keyword("v") && tok.readFloat(x) && tok.readFloat(y) && tok.readFloat(z))
+ *         ...
+ *     tok.nextLine();
+ * }
+ * \endcode
+ */
+class MeshExport Tokenizer
+{
+public:
+    typedef std::pair<const char*, const char*> Range;
+
+    Tokenizer(const char* begin, const char* end);
+    Tokenizer(const Range& range);
+
+    /// Returns true if the end of the memory block is reached.
+    bool atEnd() const
+    { return _cur == _end; }
+    /// Returns true if the rest of the current line only consists of blanks.
+    bool atEndOfLine();
+    /// Moves to the beginning of the next line.
+    void nextLine();
+    /// Skips spaces and tabs but not line breaks.
+    void skipBlanks();
+    /// Skips the next token of non-blank characters.
+    void skipToken();
+    /** Checks case-insensitively whether the next token is \a keyword. In this
+     * case the token will be consumed and true is returned. Otherwise the
+     * position is left unchanged.
+     */
+    bool keyword(const char* keyword);
+    /// Reads a floating point number and returns true on success.
+    bool readFloat(float& value);
+    /// Reads a floating point number and returns true on success.
+    bool readDouble(double& value);
+    /// Reads an integer and returns true on success.
+    bool readInt(long& value);
+    /// Reads the next token of non-blank characters.
+    std::string readToken();
+    /// Returns the current position.
+    const char* position() const
+    { return _cur; }
+
+    /** Splits the memory block into at most \a parts chunks of about the same size.
+     * Each chunk starts at the beginning of a line.
+     */
+    static std::vector<Range> split(const char* begin, const char* end, std::size_t parts);
+    /** Returns the start of the line that follows \a count lines starting at \a begin.
+     */
+    static const char* skipLines(const char* begin, const char* end, std::size_t count);
+
+private:
+    const char* _cur;
+    const char* _end;
+};
+
+} // namespace MeshCore
+
+#endif  // MESH_TOKENIZER_H
@@ -39,6 +39,7 @@
 #include <Base/ViewProj.h>
 
 #include "Core/Builder.h"
+#include "Core/BVH.h"
 #include "Core/MeshKernel.h"
 #include "Core/Grid.h"
 #include "Core/Iterator.h"
@@ -80,7 +81,7 @@ MeshObject::MeshObject(const MeshCore::MeshKernel& Kernel, const Base::Matrix4D
 }
 
 MeshObject::MeshObject(const MeshObject& mesh)
-  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel)
+  : _Mtrx(mesh._Mtrx),_kernel(mesh._kernel),_bvh(std::atomic_load(&mesh._bvh))
 {
     // copy the mesh structure
     copySegments(mesh);
@@ -195,6 +196,7 @@ void MeshObject::setKernel(const MeshCore::MeshKernel& m)
 {
     this->_kernel = m;
     this->_segments.clear();
+    this->_bvh.reset();
 }
 
 void MeshObject::swap(MeshCore::MeshKernel& Kernel)
@@ -203,17 +205,32 @@ void MeshObject::swap(MeshCore::MeshKernel& Kernel)
     // clear the segments because we don't know how the new
     // topology looks like
     this->_segments.clear();
+    this->_bvh.reset();
 }
 
 void MeshObject::swap(MeshObject& mesh)
 {
     this->_kernel.Swap(mesh._kernel);
+    this->_bvh.swap(mesh._bvh);
     swapSegments(mesh);
     Base::Matrix4D tmp=this->_Mtrx;
     this->_Mtrx = mesh._Mtrx;
     mesh._Mtrx = tmp;
 }
 
+std::shared_ptr<const MeshCore::MeshFacetBVH> MeshObject::getBVH() const
+{
+    // The kernel can be modified through too many ways, including the reference
+    // returned by getKernel(), to reset the hierarchy in all of them. So, compare
+    // the cached hierarchy with the kernel which is much cheaper than a rebuild.
+    std::shared_ptr<const MeshCore::MeshFacetBVH> bvh = std::atomic_load(&_bvh);
+    if (!bvh || !bvh->IsBuiltFor(_kernel)) {
+        bvh = std::make_shared<const MeshCore::MeshFacetBVH>(_kernel);
+        std::atomic_store(&_bvh, bvh);
+    }
+    return bvh;
+}
+
 std::string MeshObject::representation() const
 {
     std::stringstream str;
@@ -464,6 +481,7 @@ void MeshObject::swapKernel(MeshCore::MeshKernel& kernel,
                             const std::vector<std::string>& g)
 {
     _kernel.Swap(kernel);
+    _bvh.reset();
     // Some file formats define several objects per file (e.g. OBJ).
     // Now we mark each object as an own segment so that we can break
     // the object into its original objects again.
@@ -985,16 +1003,16 @@ void MeshObject::smooth(int iterations, float d_max)
     _kernel.Smooth(iterations, d_max);
 }
 
-void MeshObject::decimate(float fTolerance, float fReduction)
+void MeshObject::decimate(float fTolerance, float fReduction, bool parallel)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
-    dm.simplify(fTolerance, fReduction);
+    dm.simplify(fTolerance, fReduction, parallel);
 }
 
-void MeshObject::decimate(int targetSize)
+void MeshObject::decimate(int targetSize, bool parallel)
 {
     MeshCore::MeshSimplify dm(this->_kernel);
-    dm.simplify(targetSize);
+    dm.simplify(targetSize, parallel);
 }
 
 Base::Vector3d MeshObject::getPointNormal(unsigned long index) const
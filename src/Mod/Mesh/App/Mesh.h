@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 #include <map>
@@ -56,6 +57,7 @@ namespace Base {
 
 namespace MeshCore {
 class AbstractPolygonTriangulator;
+class MeshFacetBVH;
 }
 
 namespace Mesh
@@ -141,6 +143,11 @@ public:
     { return _kernel; }
     const MeshCore::MeshKernel& getKernel(void) const
     { return _kernel; }
+    /**
+     * Returns a bounding volume hierarchy over the facets in local coordinates. It is
+     * kept between calls and only rebuilt if the mesh has changed in the meantime.
+     */
+    std::shared_ptr<const MeshCore::MeshFacetBVH> getBVH() const;
 
     virtual Base::BoundBox3d getBoundBox(void)const;
 
@@ -216,8 +223,8 @@ public:
     void movePoint(unsigned long, const Base::Vector3d& v);
     void setPoint(unsigned long, const Base::Vector3d& v);
     void smooth(int iterations, float d_max);
-    void decimate(float fTolerance, float fReduction);
-    void decimate(int targetSize);
+    void decimate(float fTolerance, float fReduction, bool parallel = false);
+    void decimate(int targetSize, bool parallel = false);
     Base::Vector3d getPointNormal(unsigned long) const;
     std::vector<Base::Vector3d> getPointNormals() const;
     void crossSections(const std::vector<TPlane>&, std::vector<TPolylines> &sections,
@@ -394,6 +401,7 @@ private:
     Base::Matrix4D _Mtrx;
     MeshCore::MeshKernel _kernel;
     std::vector<Segment> _segments;
+    mutable std::shared_ptr<const MeshCore::MeshFacetBVH> _bvh;
     static float Epsilon;
 };
 
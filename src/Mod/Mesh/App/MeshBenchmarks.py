@@ -0,0 +1,263 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2021 FreeCAD Developers
+#  LGPL
+
+"""
+Benchmarks for the mesh module.
+
+They are not part of the unit tests because they need large data sets.
+Run them from the FreeCAD Python console or with FreeCADCmd, e.g.
+
+    import MeshBenchmarks
+    MeshBenchmarks.benchmarkLoadSTL("/path/to/scan.stl")
+
+If no file is given a synthetic data set is created in the temp directory.
+"""
+
+import FreeCAD, Mesh
+import os, random, struct, sys, tempfile, time
+
+
+def peakMemory():
+    """Returns the peak resident set size of the process in MB or None if unknown"""
+    try:
+        import resource
+    except ImportError:
+        return None
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Linux reports kilobytes, macOS bytes
+    if sys.platform == "darwin":
+        return rss / (1024.0 * 1024.0)
+    return rss / 1024.0
+
+
+def report(title, count, unit, seconds):
+    """Prints the throughput and the peak memory usage of a benchmark"""
+    rate = count / seconds if seconds > 0 else float("inf")
+    msg = "{}: {} {} in {:.3f} s ({:.0f} {}/s)".format(title, count, unit, seconds, rate, unit)
+    mem = peakMemory()
+    if mem is not None:
+        msg += ", peak RSS {:.1f} MB".format(mem)
+    FreeCAD.Console.PrintMessage(msg + "\n")
+
+
+def writeGridSTL(name, size):
+    """Writes a binary STL file of a regular grid with 2*size*size triangles"""
+    with open(name, "wb") as f:
+        f.write(b"\0" * 80)
+        f.write(struct.pack("<I", 2 * size * size))
+        for i in range(size):
+            row = []
+            for j in range(size):
+                row.append(struct.pack("<12fH", 0, 0, 1, i, j, 0, i+1, j, 0, i+1, j+1, 0, 0))
+                row.append(struct.pack("<12fH", 0, 0, 1, i, j, 0, i+1, j+1, 0, i, j+1, 0, 0))
+            f.write(b"".join(row))
+
+
+def benchmarkLoadSTL(name=None, size=1000):
+    """Loads a binary STL file and reports triangles per second and the peak RSS.
+    Without a file name a grid of 2*size*size triangles is used."""
+    remove = False
+    if name is None:
+        name = tempfile.gettempdir() + os.sep + "benchmark_{}.stl".format(size)
+        writeGridSTL(name, size)
+        remove = True
+
+    start = time.time()
+    mesh = Mesh.Mesh(name)
+    report("Load STL", mesh.CountFacets, "triangles", time.time() - start)
+
+    if remove:
+        os.remove(name)
+    return mesh
+
+
+def benchmarkLoadASCII(fmt="OBJ", size=1000):
+    """Writes a grid of 2*size*size triangles in an ASCII format (AST, OBJ or APLY)
+    and reports triangles per second and the peak RSS of loading it."""
+    ext = {"AST": "ast", "OBJ": "obj", "APLY": "ply"}
+    grid = tempfile.gettempdir() + os.sep + "benchmark_{}.stl".format(size)
+    writeGridSTL(grid, size)
+    mesh = Mesh.Mesh(grid)
+    os.remove(grid)
+
+    name = tempfile.gettempdir() + os.sep + "benchmark_{}.{}".format(size, ext[fmt])
+    mesh.write(name, fmt)
+    del mesh
+
+    start = time.time()
+    mesh = Mesh.Mesh(name)
+    report("Load " + fmt, mesh.CountFacets, "triangles", time.time() - start)
+
+    os.remove(name)
+    return mesh
+
+
+def benchmarkNearestFacets(size=500, count=100000):
+    """Compares the bounding volume hierarchy with the facet grid for ray and nearest
+    facet queries. The mesh has very different facet sizes: a large box with a finely
+    tessellated sphere inside. The build time of the search structure is included."""
+    mesh = Mesh.createBox(100.0, 100.0, 100.0)
+    box = mesh.BoundBox
+    sphere = Mesh.createSphere(5.0, size)
+    sphere.translate(box.Center.x, box.Center.y, box.Center.z)
+    mesh.addMesh(sphere)
+
+    rnd = random.Random(0)
+    def point():
+        return FreeCAD.Vector(rnd.uniform(box.XMin, box.XMax),
+                              rnd.uniform(box.YMin, box.YMax),
+                              rnd.uniform(box.ZMin, box.ZMax))
+    pnts = [point() for i in range(count)]
+    # aim at the sphere so that most rays have to search the fine part of the mesh
+    dirs = [box.Center - p for p in pnts]
+
+    for grid, title in ((False, "BVH"), (True, "Grid")):
+        start = time.time()
+        mesh.nearestFacetsOnRays(pnts, dirs, grid)
+        report("Rays ({}, {} triangles)".format(title, mesh.CountFacets), count, "rays", time.time() - start)
+
+        start = time.time()
+        mesh.nearestFacetsToPoints(pnts, grid)
+        report("Nearest facet ({}, {} triangles)".format(title, mesh.CountFacets), count, "points", time.time() - start)
+
+
+def benchmarkRebuildNeighbours(size=2237, count=1000):
+    """Reports the time to rebuild the neighbourhood of a grid with 2*size*size triangles,
+    once for all triangles and once for count random triangles. The default size gives
+    about 10 million triangles, use e.g. size=7072 for 100 million."""
+    grid = tempfile.gettempdir() + os.sep + "benchmark_{}.stl".format(size)
+    writeGridSTL(grid, size)
+    mesh = Mesh.Mesh(grid)
+    os.remove(grid)
+
+    start = time.time()
+    mesh.rebuildNeighbourHood()
+    report("Rebuild neighbours", mesh.CountFacets, "triangles", time.time() - start)
+
+    rnd = random.Random(0)
+    facets = [rnd.randrange(mesh.CountFacets) for i in range(count)]
+    start = time.time()
+    mesh.rebuildNeighbourHood(facets)
+    report("Rebuild neighbours ({} triangles)".format(mesh.CountFacets), count, "changed triangles", time.time() - start)
+
+
+def hausdorffDistance(mesh1, mesh2, count=100000):
+    """Estimates the symmetric Hausdorff distance of two meshes with up to count
+    vertices of each mesh"""
+    rnd = random.Random(0)
+    def maxDistance(mesh, other):
+        pnts = [p.Vector for p in mesh.Points]
+        if len(pnts) > count:
+            pnts = rnd.sample(pnts, count)
+        return max(d for i, d in other.nearestFacetsToPoints(pnts))
+    return max(maxDistance(mesh1, mesh2), maxDistance(mesh2, mesh1))
+
+
+def benchmarkDecimate(size=2000, target=100000):
+    """Decimates a sphere with about 2*size*size triangles to target triangles with the
+    serial and the parallel algorithm and reports the time and the Hausdorff distance
+    of the results to the original mesh"""
+    mesh = Mesh.createSphere(10.0, size)
+    for parallel, title in ((False, "serial"), (True, "parallel")):
+        result = mesh.copy()
+        start = time.time()
+        result.decimate(target, parallel)
+        report("Decimate ({}, {} triangles left)".format(title, result.CountFacets),
+               mesh.CountFacets, "triangles", time.time() - start)
+        FreeCAD.Console.PrintMessage("Hausdorff distance ({}): {:.6f}\n".format(
+            title, hausdorffDistance(mesh, result)))
+
+
+def benchmarkBoolean(size=700):
+    """Runs the boolean operations on two overlapping spheres with about 2*size*size
+    triangles each"""
+    mesh1 = Mesh.createSphere(10.0, size)
+    mesh2 = Mesh.createSphere(10.0, size)
+    mesh2.translate(5.0, 2.0, 1.0)
+    count = mesh1.CountFacets + mesh2.CountFacets
+    for name in ("unite", "intersect", "difference"):
+        start = time.time()
+        result = getattr(mesh1, name)(mesh2)
+        report("Boolean {} ({} triangles left)".format(name, result.CountFacets),
+               count, "triangles", time.time() - start)
+
+def benchmarkSelfIntersections(size=700):
+    """Searches the self-intersections of two overlapping spheres with about 2*size*size
+    triangles each that are merged into one mesh"""
+    mesh = Mesh.createSphere(10.0, size)
+    other = Mesh.createSphere(10.0, size)
+    other.translate(5.0, 2.0, 1.0)
+    mesh.addMesh(other)
+    start = time.time()
+    pairs = mesh.getSelfIntersections()
+    report("Self-intersections ({} pairs)".format(len(pairs)),
+           mesh.CountFacets, "triangles", time.time() - start)
+
+def benchmarkSaveLoad(size=1000):
+    """Saves and reopens a document with a sphere of about 2*size*size triangles and
+    its curvature information"""
+    doc = FreeCAD.newDocument("MeshBenchmark")
+    feature = doc.addObject("Mesh::Feature", "Sphere")
+    feature.Mesh = Mesh.createSphere(10.0, size)
+    curvature = doc.addObject("Mesh::Curvature", "Curvature")
+    curvature.Source = feature
+    doc.recompute()
+    count = feature.Mesh.CountPoints
+
+    fileName = os.path.join(tempfile.gettempdir(), "MeshBenchmark.FCStd")
+    start = time.time()
+    doc.saveAs(fileName)
+    report("Save document ({} bytes)".format(os.path.getsize(fileName)), count, "points", time.time() - start)
+    FreeCAD.closeDocument(doc.Name)
+
+    start = time.time()
+    doc = FreeCAD.openDocument(fileName)
+    report("Load document", count, "points", time.time() - start)
+    FreeCAD.closeDocument(doc.Name)
+    os.remove(fileName)
+
+def benchmarkParallelSave(count=8, size=500):
+    """Saves and reopens a document with count spheres of about 2*size*size triangles
+    each, once serially and once with the parallel save and restore"""
+    doc = FreeCAD.newDocument("MeshBenchmark")
+    for i in range(count):
+        feature = doc.addObject("Mesh::Feature", "Sphere")
+        feature.Mesh = Mesh.createSphere(10.0 + i, size)
+    triangles = sum(obj.Mesh.CountFacets for obj in doc.Objects)
+
+    param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    save = param.GetBool("ParallelSave", False)
+    restore = param.GetBool("ParallelRestore", False)
+    fileName = os.path.join(tempfile.gettempdir(), "MeshBenchmark.FCStd")
+    try:
+        for parallel, title in ((False, "serial"), (True, "parallel")):
+            param.SetBool("ParallelSave", parallel)
+            param.SetBool("ParallelRestore", parallel)
+            start = time.time()
+            doc.saveAs(fileName)
+            report("Save document ({}, {} bytes)".format(title, os.path.getsize(fileName)),
+                   triangles, "triangles", time.time() - start)
+
+            start = time.time()
+            other = FreeCAD.openDocument(fileName)
+            report("Load document ({})".format(title), triangles, "triangles", time.time() - start)
+            FreeCAD.closeDocument(other.Name)
+    finally:
+        param.SetBool("ParallelSave", save)
+        param.SetBool("ParallelRestore", restore)
+    FreeCAD.closeDocument(doc.Name)
+    os.remove(fileName)
+
+if __name__ == "__main__":
+    benchmarkLoadSTL()
+    for fmt in ("AST", "OBJ", "APLY"):
+        benchmarkLoadASCII(fmt)
+    benchmarkNearestFacets()
+    benchmarkRebuildNeighbours()
+    benchmarkDecimate()
+    benchmarkBoolean()
+    benchmarkSelfIntersections()
+    benchmarkSaveLoad()
+    benchmarkParallelSave()
@@ -157,9 +157,8 @@ void PropertyNormalList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<Base::Vector3f>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->x << it->y << it->z;
-    }
+    static_assert(sizeof(Base::Vector3f) == 3 * sizeof(float), "Vector3f must consist of three floats");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 3 * _lValueList.size());
 }
 
 void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
@@ -168,9 +167,7 @@ void PropertyNormalList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3f> values(uCt);
-    for (std::vector<Base::Vector3f>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->x >> it->y >> it->z;
-    }
+    str.read(reinterpret_cast<float*>(values.data()), 3 * values.size());
     setValues(values);
 }
 
@@ -360,11 +357,8 @@ void PropertyCurvatureList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<CurvatureInfo>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->fMaxCurvature << it->fMinCurvature;
-        str << it->cMaxCurvDir.x << it->cMaxCurvDir.y << it->cMaxCurvDir.z;
-        str << it->cMinCurvDir.x << it->cMinCurvDir.y << it->cMinCurvDir.z;
-    }
+    static_assert(sizeof(CurvatureInfo) == 8 * sizeof(float), "CurvatureInfo must consist of eight floats");
+    str.write(reinterpret_cast<const float*>(_lValueList.data()), 8 * _lValueList.size());
 }
 
 void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
@@ -373,11 +367,7 @@ void PropertyCurvatureList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<CurvatureInfo> values(uCt);
-    for (std::vector<CurvatureInfo>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->fMaxCurvature >> it->fMinCurvature;
-        str >> it->cMaxCurvDir.x >> it->cMaxCurvDir.y >> it->cMaxCurvDir.z;
-        str >> it->cMinCurvDir.x >> it->cMinCurvDir.y >> it->cMinCurvDir.z;
-    }
+    str.read(reinterpret_cast<float*>(values.data()), 8 * values.size());
 
     setValues(values);
 }
@@ -428,6 +418,9 @@ void PropertyCurvatureList::Paste(const App::Property &from)
 
 PropertyMeshKernel::PropertyMeshKernel()
   : _meshObject(new MeshObject()), meshPyObject(0)
+  , lazyFile([this](Base::Reader &reader) {
+        _meshObject->load(reader);
+    })
 {
     // Note: Normally this property is a member of a document object, i.e. the setValue()
     // method gets called in the constructor of a sublcass of DocumentObject, e.g. Mesh::Feature.
@@ -451,6 +444,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
+    lazyFile.reset();
     _meshObject = mesh;
     hasSetValue();
 }
@@ -458,6 +452,7 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
+    lazyFile.reset();
     *_meshObject = mesh;
     hasSetValue();
 }
@@ -465,12 +460,14 @@ void PropertyMeshKernel::setValue(const MeshObject& mesh)
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    lazyFile.reset();
     _meshObject->setKernel(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
+    lazyFile.read();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -478,6 +475,7 @@ void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
+    lazyFile.read();
     aboutToSetValue();
     _meshObject->swap(mesh);
     hasSetValue();
@@ -485,26 +483,31 @@ void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
+    lazyFile.read();
     return *_meshObject;
 }
 
 const MeshObject* PropertyMeshKernel::getValuePtr(void)const 
 {
+    lazyFile.read();
     return (MeshObject*)_meshObject;
 }
 
 const Data::ComplexGeoData* PropertyMeshKernel::getComplexData() const
 {
+    lazyFile.read();
     return (MeshObject*)_meshObject;
 }
 
 Base::BoundBox3d PropertyMeshKernel::getBoundingBox() const
 {
+    lazyFile.read();
     return _meshObject->getBoundBox();
 }
 
 unsigned int PropertyMeshKernel::getMemSize (void) const
 {
+    lazyFile.read();
     unsigned int size = 0;
     size += _meshObject->getMemSize();
     
@@ -513,6 +516,7 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 
 MeshObject* PropertyMeshKernel::startEditing()
 {
+    lazyFile.read();
     aboutToSetValue();
     return (MeshObject*)_meshObject;
 }
@@ -524,6 +528,7 @@ void PropertyMeshKernel::finishEditing()
 
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    lazyFile.read();
     aboutToSetValue();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
@@ -531,6 +536,7 @@ void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
+    lazyFile.read();
     aboutToSetValue();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
@@ -540,6 +546,7 @@ void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned lo
 
 PyObject *PropertyMeshKernel::getPyObject(void)
 {
+    lazyFile.read();
     if (!meshPyObject) {
         meshPyObject = new MeshPy(&*_meshObject);
         meshPyObject->setConst(); // set immutable
@@ -576,6 +583,7 @@ void PropertyMeshKernel::setPyObject(PyObject *value)
 void PropertyMeshKernel::Save (Base::Writer &writer) const
 {
     if (writer.isForceXML()) {
+        lazyFile.read();
         writer.Stream() << writer.ind() << "<Mesh>" << std::endl;
         MeshCore::MeshOutput saver(_meshObject->getKernel());
         saver.SaveXML(writer);
@@ -614,19 +622,47 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
 
 void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 {
+    lazyFile.read();
     _meshObject->save(writer.Stream());
 }
 
+bool PropertyMeshKernel::canSaveDocFileConcurrently(const Base::Writer &) const
+{
+    return true;
+}
+
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    lazyFile.reset();
     _meshObject->load(reader);
     hasSetValue();
 }
 
+std::function<void()> PropertyMeshKernel::parseDocFile(Base::Reader &reader)
+{
+    // the placement of the mesh object is kept
+    std::shared_ptr<MeshObject> mesh = std::make_shared<MeshObject>();
+    mesh->load(reader);
+    return [this, mesh]() {
+        swapMesh(mesh->getKernel());
+    };
+}
+
+bool PropertyMeshKernel::canParseDocFile() const
+{
+    return true;
+}
+
+Base::LazyFile* PropertyMeshKernel::getLazyFile() const
+{
+    return &lazyFile;
+}
+
 App::Property *PropertyMeshKernel::Copy(void) const
 {
     // Note: Copy the content, do NOT reference the same mesh object
+    lazyFile.read();
     PropertyMeshKernel *prop = new PropertyMeshKernel();
     *(prop->_meshObject) = *(this->_meshObject);
     return prop;
@@ -636,7 +672,8 @@ void PropertyMeshKernel::Paste(const App::Property &from)
 {
     // Note: Copy the content, do NOT reference the same mesh object
     aboutToSetValue();
+    lazyFile.reset();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
-    *(this->_meshObject) = *(prop._meshObject);
+    *(this->_meshObject) = prop.getValue();
     hasSetValue();
 }
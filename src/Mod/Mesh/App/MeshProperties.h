@@ -32,6 +32,7 @@
 
 #include <Base/Handle.h>
 #include <Base/Matrix.h>
+#include <Base/Reader.h>
 #include <Base/Vector3D.h>
 
 #include <App/PropertyStandard.h>
@@ -243,7 +244,11 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileConcurrently(const Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    std::function<void()> parseDocFile(Base::Reader &reader);
+    bool canParseDocFile() const;
+    Base::LazyFile* getLazyFile() const;
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -252,6 +257,7 @@ public:
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
+    mutable Base::LazyFile lazyFile;
 };
 
 } // namespace Mesh
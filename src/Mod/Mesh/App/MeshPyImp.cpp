@@ -38,6 +38,7 @@
 #include "MeshPy.cpp"
 #include "MeshProperties.h"
 #include "Core/Algorithm.h"
+#include "Core/BVH.h"
 #include "Core/Triangulation.h"
 #include "Core/Iterator.h"
 #include "Core/Degeneration.h"
@@ -788,11 +789,33 @@ PyObject* MeshPy::getInternalFacets(PyObject *args)
 
 PyObject* MeshPy::rebuildNeighbourHood(PyObject *args)
 {
-    if (!PyArg_ParseTuple(args, ""))
+    PyObject* list = 0;
+    if (!PyArg_ParseTuple(args, "|O", &list))
         return 0;
 
     MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
-    kernel.RebuildNeighbours();
+    if (!list) {
+        kernel.RebuildNeighbours();
+        Py_Return;
+    }
+
+    std::vector<unsigned long> indices;
+    Py::Sequence ary(list);
+    for (Py::Sequence::iterator it = ary.begin(); it != ary.end(); ++it) {
+#if PY_MAJOR_VERSION >= 3
+        Py::Long f(*it);
+#else
+        Py::Int f(*it);
+#endif
+        long index = (long)f;
+        if (index < 0 || index >= (long)kernel.CountFacets()) {
+            PyErr_SetString(PyExc_IndexError, "Facet index out of range");
+            return 0;
+        }
+        indices.push_back(index);
+    }
+
+    kernel.RebuildNeighbours(indices);
     Py_Return;
 }
 
@@ -1730,9 +1753,10 @@ PyObject*  MeshPy::smooth(PyObject *args, PyObject *kwds)
 PyObject*  MeshPy::decimate(PyObject *args)
 {
     float fTol, fRed;
-    if (PyArg_ParseTuple(args, "ff", &fTol,&fRed)) {
+    PyObject* parallel = Py_False;
+    if (PyArg_ParseTuple(args, "ff|O!", &fTol,&fRed, &PyBool_Type, &parallel)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(fTol, fRed);
+            getMeshObjectPtr()->decimate(fTol, fRed, PyObject_IsTrue(parallel) ? true : false);
         } PY_CATCH;
 
         Py_Return;
@@ -1740,15 +1764,15 @@ PyObject*  MeshPy::decimate(PyObject *args)
 
     PyErr_Clear();
     int targetSize;
-    if (PyArg_ParseTuple(args, "i", &targetSize)) {
+    if (PyArg_ParseTuple(args, "i|O!", &targetSize, &PyBool_Type, &parallel)) {
         PY_TRY {
-            getMeshObjectPtr()->decimate(targetSize);
+            getMeshObjectPtr()->decimate(targetSize, PyObject_IsTrue(parallel) ? true : false);
         } PY_CATCH;
 
         Py_Return;
     }
 
-    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float) or decimate(targetSize=int)");
+    PyErr_SetString(PyExc_ValueError, "decimate(tolerance=float, reduction=float, [parallel=bool]) or decimate(targetSize=int, [parallel=bool])");
     return nullptr;
 }
 
@@ -1819,6 +1843,118 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
     }
 }
 
+PyObject* MeshPy::nearestFacetsOnRays(PyObject *args)
+{
+    PyObject* pnts_p;
+    PyObject* dirs_p;
+    PyObject* grid_p = Py_False;
+    if (!PyArg_ParseTuple(args, "OO|O!", &pnts_p, &dirs_p, &PyBool_Type, &grid_p))
+        return NULL;
+
+    try {
+        Py::Sequence pnts_s(pnts_p);
+        Py::Sequence dirs_s(dirs_p);
+        if (pnts_s.size() != dirs_s.size()) {
+            PyErr_SetString(PyExc_ValueError, "Number of points and directions differ");
+            return NULL;
+        }
+
+        std::vector<Base::Vector3f> pnts, dirs;
+        pnts.reserve(pnts_s.size());
+        dirs.reserve(dirs_s.size());
+        for (Py::Sequence::size_type i = 0; i < pnts_s.size(); i++) {
+            pnts.push_back(Base::convertTo<Base::Vector3f>(Py::Vector(pnts_s[i]).toVector()));
+            dirs.push_back(Base::convertTo<Base::Vector3f>(Py::Vector(dirs_s[i]).toVector()));
+        }
+
+        const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+        std::vector<unsigned long> indices;
+        std::vector<Base::Vector3f> results;
+        if (PyObject_IsTrue(grid_p)) {
+            MeshCore::MeshFacetGrid grid(kernel);
+            MeshCore::MeshAlgorithm alg(kernel);
+            indices.resize(pnts.size(), ULONG_MAX);
+            results.resize(pnts.size());
+            for (std::size_t i = 0; i < pnts.size(); i++) {
+                if (!alg.NearestFacetOnRay(pnts[i], dirs[i], grid, results[i], indices[i]))
+                    indices[i] = ULONG_MAX;
+            }
+        }
+        else {
+            getMeshObjectPtr()->getBVH()->NearestFacetsOnRays(pnts, dirs, indices, results);
+        }
+
+        Py::Tuple tuple(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            if (indices[i] == ULONG_MAX) {
+                tuple.setItem(i, Py::None());
+            }
+            else {
+                Py::Tuple item(2);
+                item.setItem(0, Py::Long(indices[i]));
+                item.setItem(1, Py::Vector(results[i]));
+                tuple.setItem(i, item);
+            }
+        }
+
+        return Py::new_reference_to(tuple);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
+PyObject* MeshPy::nearestFacetsToPoints(PyObject *args)
+{
+    PyObject* pnts_p;
+    PyObject* grid_p = Py_False;
+    if (!PyArg_ParseTuple(args, "O|O!", &pnts_p, &PyBool_Type, &grid_p))
+        return NULL;
+
+    try {
+        Py::Sequence pnts_s(pnts_p);
+        std::vector<Base::Vector3f> pnts;
+        pnts.reserve(pnts_s.size());
+        for (Py::Sequence::iterator it = pnts_s.begin(); it != pnts_s.end(); ++it)
+            pnts.push_back(Base::convertTo<Base::Vector3f>(Py::Vector(*it).toVector()));
+
+        const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+        std::vector<unsigned long> indices;
+        std::vector<float> distances;
+        if (PyObject_IsTrue(grid_p)) {
+            MeshCore::MeshFacetGrid grid(kernel);
+            indices.resize(pnts.size());
+            distances.resize(pnts.size());
+            for (std::size_t i = 0; i < pnts.size(); i++) {
+                indices[i] = grid.SearchNearestFromPoint(pnts[i]);
+                if (indices[i] != ULONG_MAX)
+                    distances[i] = kernel.GetFacet(indices[i]).DistanceToPoint(pnts[i]);
+            }
+        }
+        else {
+            getMeshObjectPtr()->getBVH()->NearestFacetsToPoints(pnts, indices, distances);
+        }
+
+        Py::Tuple tuple(indices.size());
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            if (indices[i] == ULONG_MAX) {
+                tuple.setItem(i, Py::None());
+            }
+            else {
+                Py::Tuple item(2);
+                item.setItem(0, Py::Long(indices[i]));
+                item.setItem(1, Py::Float(distances[i]));
+                tuple.setItem(i, item);
+            }
+        }
+
+        return Py::new_reference_to(tuple);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::getPlanarSegments(PyObject *args)
 {
     float dev;
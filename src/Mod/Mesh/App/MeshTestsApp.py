@@ -5,7 +5,7 @@
 #  LGPL
 
 import FreeCAD, os, sys, unittest, Mesh
-import time, tempfile, math
+import time, tempfile, math, io, struct
 # http://python-kurs.eu/threads.php
 try:
     import _thread as thread
@@ -173,6 +173,283 @@ class LoadMeshInThreadsCases(unittest.TestCase):
         pass
 
 
+class MeshIOTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 50)
+
+    def testBinarySTL(self):
+        name = tempfile.gettempdir() + os.sep + "mesh_binary.stl"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh(name)
+        os.remove(name)
+        self.assertEqual(mesh.CountPoints, self.mesh.CountPoints)
+        self.assertEqual(mesh.CountFacets, self.mesh.CountFacets)
+        self.assertAlmostEqual(mesh.Area, self.mesh.Area, 3)
+
+    def testAsciiSTL(self):
+        name = tempfile.gettempdir() + os.sep + "mesh_ascii.ast"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh(name)
+        os.remove(name)
+        self.assertEqual(mesh.CountPoints, self.mesh.CountPoints)
+        self.assertEqual(mesh.CountFacets, self.mesh.CountFacets)
+
+    def testInvalidSTL(self):
+        # a truncated binary file and a text without facets and solid aren't meshes
+        name = tempfile.gettempdir() + os.sep + "mesh_invalid.stl"
+        truncated = b"\0" * 80 + struct.pack("<I", 5) + b"\0" * 20
+        text = b"this facet is not a mesh\n" * 10
+        empty = b"\0" * 84
+        for data, valid in ((truncated, False), (text, False), (empty, True)):
+            with open(name, "wb") as f:
+                f.write(data)
+            docs = len(FreeCAD.listDocuments())
+            Mesh.open(name)
+            self.assertEqual(len(FreeCAD.listDocuments()), docs + 1 if valid else docs)
+            if valid:
+                FreeCAD.closeDocument(FreeCAD.ActiveDocument.Name)
+        os.remove(name)
+
+    def testOBJ(self):
+        name = tempfile.gettempdir() + os.sep + "mesh.obj"
+        self.mesh.write(name)
+        mesh = Mesh.Mesh(name)
+        os.remove(name)
+        self.assertEqual(mesh.CountPoints, self.mesh.CountPoints)
+        self.assertEqual(mesh.CountFacets, self.mesh.CountFacets)
+
+    def testOBJStream(self):
+        data = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 0 0\ng quad\nf 1/1 2/2 3/3 4/4\nf -1 -3 -4\n"
+        mesh = Mesh.Mesh()
+        mesh.read(Stream=io.BytesIO(data.encode()), Format="OBJ")
+        self.assertEqual(mesh.CountPoints, 5)
+        self.assertEqual(mesh.CountFacets, 3)
+
+    def testAsciiPLY(self):
+        name = tempfile.gettempdir() + os.sep + "mesh_ascii.ply"
+        self.mesh.write(name, "APLY")
+        mesh = Mesh.Mesh(name)
+        os.remove(name)
+        self.assertEqual(mesh.CountPoints, self.mesh.CountPoints)
+        self.assertEqual(mesh.CountFacets, self.mesh.CountFacets)
+
+    def testAsciiPLYStream(self):
+        header = ("ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\n{}"
+                  "element face 2\nproperty list uchar int vertex_indices\nend_header\n")
+        # the second face refers to a missing point
+        data = header.format("property float z\n") + "0 0 0\n1 0 0\n0 1 0\n3 0 1 2\n3 0 1 5\n"
+        mesh = Mesh.Mesh()
+        mesh.read(Stream=io.BytesIO(data.encode()), Format="PLY")
+        self.assertEqual(mesh.CountPoints, 3)
+        self.assertEqual(mesh.CountFacets, 1)
+
+        # points without z coordinate are rejected
+        data = header.format("") + "0 0\n1 0\n0 1\n3 0 1 2\n3 0 1 2\n"
+        mesh = Mesh.Mesh()
+        mesh.read(Stream=io.BytesIO(data.encode()), Format="PLY")
+        self.assertEqual(mesh.CountPoints, 0)
+
+    def tearDown(self):
+        pass
+
+
+class MeshGridTestCases(unittest.TestCase):
+    def setUp(self):
+        # large enough to fill the grid from several threads
+        self.mesh = Mesh.createSphere(10.0, 100)
+
+    def testCrossSection(self):
+        sections = self.mesh.crossSections([((0, 0, 0), (0, 0, 1))])
+        self.assertEqual(len(sections), 1)
+        self.assertGreater(len(sections[0]), 0)
+        for polyline in sections[0]:
+            for point in polyline:
+                self.assertAlmostEqual(point.Length, 10.0, 1)
+                self.assertAlmostEqual(point.z, 0.0, 3)
+
+    def testSelfIntersections(self):
+        self.assertFalse(self.mesh.hasSelfIntersections())
+        other = Mesh.createSphere(10.0, 100)
+        other.translate(5, 0, 0)
+        mesh = self.mesh.copy()
+        mesh.addMesh(other)
+        self.assertTrue(mesh.hasSelfIntersections())
+
+    def testGetSelfIntersections(self):
+        other = Mesh.createSphere(10.0, 100)
+        other.translate(5, 0, 0)
+        mesh = self.mesh.copy()
+        mesh.addMesh(other)
+        pairs = [(i[0], i[1]) for i in mesh.getSelfIntersections()]
+        self.assertGreater(len(pairs), 0)
+        # each pair is reported once and the result doesn't depend on the threads
+        self.assertEqual(pairs, sorted(set(pairs)))
+        count = self.mesh.CountFacets
+        for first, second in pairs:
+            self.assertLess(first, count)
+            self.assertGreaterEqual(second, count)
+        mesh.fixSelfIntersections()
+        self.assertFalse(mesh.hasSelfIntersections())
+
+    def tearDown(self):
+        pass
+
+
+class MeshBVHTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = Mesh.createSphere(10.0, 50)
+
+    def testNearestFacetsOnRays(self):
+        pnts = [FreeCAD.Vector(0.1, 0.2, 20), FreeCAD.Vector(0.1, 0.2, 20), FreeCAD.Vector(0, 0.1, 0.2)]
+        dirs = [FreeCAD.Vector(0, 0, -1), FreeCAD.Vector(0, 0, 1), FreeCAD.Vector(1, 0, 0)]
+        res = self.mesh.nearestFacetsOnRays(pnts, dirs)
+        self.assertEqual(len(res), 3)
+        self.assertAlmostEqual(res[0][1].z, 10.0, 1)
+        self.assertIsNone(res[1])
+        self.assertAlmostEqual(res[2][1].x, 10.0, 1)
+
+        grid = self.mesh.nearestFacetsOnRays(pnts[0:1], dirs[0:1], True)
+        self.assertAlmostEqual((grid[0][1] - res[0][1]).Length, 0.0, 4)
+
+    def testNearestFacetsToPoints(self):
+        pnts = [FreeCAD.Vector(0, 0, 15), FreeCAD.Vector(3, 4, 0), FreeCAD.Vector(-8, 1, 2)]
+        res = self.mesh.nearestFacetsToPoints(pnts)
+        grid = self.mesh.nearestFacetsToPoints(pnts, True)
+        self.assertAlmostEqual(res[0][1], 5.0, 1)
+        self.assertAlmostEqual(res[1][1], 5.0, 1)
+        for i, j in zip(res, grid):
+            self.assertAlmostEqual(i[1], j[1], 4)
+
+    def testModifiedMesh(self):
+        # the hierarchy is kept between calls but must follow changes of the mesh
+        pnts = [FreeCAD.Vector(0, 0, 15)]
+        self.assertAlmostEqual(self.mesh.nearestFacetsToPoints(pnts)[0][1], 5.0, 1)
+        self.mesh.translate(0, 0, 5)
+        self.assertAlmostEqual(self.mesh.nearestFacetsToPoints(pnts)[0][1], 0.0, 1)
+        copy = self.mesh.copy()
+        self.assertAlmostEqual(copy.nearestFacetsToPoints(pnts)[0][1], 0.0, 1)
+        self.mesh.removeFacets(list(range(self.mesh.CountFacets // 2)))
+        res = self.mesh.nearestFacetsToPoints(pnts)
+        self.assertLess(res[0][0], self.mesh.CountFacets)
+        self.assertEqual(res, self.mesh.nearestFacetsToPoints(pnts))
+
+    def tearDown(self):
+        pass
+
+
+class MeshNeighbourhoodTestCases(unittest.TestCase):
+    def setUp(self):
+        # large enough to build the edge table from several threads
+        self.mesh = Mesh.createSphere(10.0, 100)
+        self.neighbours = [f.NeighbourIndices for f in self.mesh.Facets]
+
+    def testRebuild(self):
+        self.mesh.rebuildNeighbourHood()
+        self.assertEqual([f.NeighbourIndices for f in self.mesh.Facets], self.neighbours)
+        self.assertTrue(self.mesh.isSolid())
+
+    def testRebuildSubset(self):
+        self.mesh.rebuildNeighbourHood([0, 17, self.mesh.CountFacets - 1])
+        self.assertEqual([f.NeighbourIndices for f in self.mesh.Facets], self.neighbours)
+        with self.assertRaises(IndexError):
+            self.mesh.rebuildNeighbourHood([self.mesh.CountFacets])
+
+    def tearDown(self):
+        pass
+
+
+class MeshDecimateTestCases(unittest.TestCase):
+    def setUp(self):
+        # large enough to be split into several partitions
+        self.mesh = Mesh.createSphere(10.0, 250)
+
+    def testParallel(self):
+        serial = self.mesh.copy()
+        serial.decimate(5000)
+        parallel = self.mesh.copy()
+        parallel.decimate(5000, True)
+        self.assertLessEqual(parallel.CountFacets, self.mesh.CountFacets // 10)
+        self.assertAlmostEqual(parallel.CountFacets, serial.CountFacets, delta=500)
+        for point in parallel.Points:
+            self.assertAlmostEqual(point.Vector.Length, 10.0, delta=0.5)
+
+    def testParallelTolerance(self):
+        mesh = self.mesh.copy()
+        mesh.decimate(0.5, 0.9, True)
+        self.assertLess(mesh.CountFacets, self.mesh.CountFacets)
+
+    def tearDown(self):
+        pass
+
+
+class MeshBooleanTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh1 = Mesh.createSphere(2.0, 50)
+        self.mesh2 = Mesh.createSphere(2.0, 50)
+        self.mesh2.translate(1.0, 0.0, 0.0)
+
+    def testUnite(self):
+        result = self.mesh1.unite(self.mesh2)
+        box = result.BoundBox
+        self.assertAlmostEqual(box.XMin, -2.0, delta=0.1)
+        self.assertAlmostEqual(box.XMax,  3.0, delta=0.1)
+
+    def testIntersect(self):
+        result = self.mesh1.intersect(self.mesh2)
+        box = result.BoundBox
+        self.assertAlmostEqual(box.XMin, -1.0, delta=0.1)
+        self.assertAlmostEqual(box.XMax,  2.0, delta=0.1)
+
+    def testDifference(self):
+        result = self.mesh1.difference(self.mesh2)
+        box = result.BoundBox
+        self.assertAlmostEqual(box.XMin, -2.0, delta=0.1)
+        self.assertLess(box.XMax, 1.0)
+
+    def testDeterministic(self):
+        # the result must not depend on the scheduling of the threads
+        result1 = self.mesh1.unite(self.mesh2)
+        result2 = self.mesh1.unite(self.mesh2)
+        self.assertEqual(result1.Topology, result2.Topology)
+
+    def tearDown(self):
+        pass
+
+
+class MeshVertexCurvatureTestCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshVertexCurvature")
+        self.mesh = Mesh.createSphere(2.0, 100)
+
+    def testPointNormals(self):
+        normals = self.mesh.getPointNormals()
+        self.assertEqual(len(normals), self.mesh.CountPoints)
+        for point, normal in zip(self.mesh.Points, normals):
+            self.assertAlmostEqual(normal.dot(point.Vector) / 2.0, 1.0, 2)
+
+    def testCurvaturePerVertex(self):
+        feature = self.doc.addObject("Mesh::Feature", "Sphere")
+        feature.Mesh = self.mesh
+        curvature = self.doc.addObject("Mesh::Curvature", "Curvature")
+        curvature.Source = feature
+        self.doc.recompute()
+        info = curvature.CurvInfo
+        self.assertEqual(len(info), self.mesh.CountPoints)
+        # the curvature of a sphere is the inverse of its radius
+        maxCurvature = sum(value[0] for value in info) / len(info)
+        minCurvature = sum(value[1] for value in info) / len(info)
+        self.assertAlmostEqual(maxCurvature, 0.5, 1)
+        self.assertAlmostEqual(minCurvature, 0.5, 1)
+
+        # the result must not depend on the scheduling of the threads
+        curvature.touch()
+        self.doc.recompute()
+        self.assertEqual(curvature.CurvInfo, info)
+
+    def tearDown(self):
+        FreeCAD.closeDocument(self.doc.Name)
+
+
 class PolynomialFitCases(unittest.TestCase):
     def setUp(self):
         pass
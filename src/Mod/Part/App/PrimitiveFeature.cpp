@@ -101,6 +101,14 @@ short Primitive::mustExecute(void) const
     return Feature::mustExecute();
 }
 
+bool Primitive::canRecomputeConcurrently() const
+{
+    // An unattached primitive only reads its own properties. The attacher instead reads the
+    // shapes of the support which may go through the shape cache of Part::Feature, and that
+    // isn't safe to use from several threads.
+    return Support.getValues().empty();
+}
+
 App::DocumentObjectExecReturn* Primitive::execute(void) {
     return Part::Feature::execute();
 }
@@ -44,6 +44,8 @@ public:
     /// recalculate the feature
     App::DocumentObjectExecReturn *execute(void) override;
     short mustExecute() const override;
+    /// true unless the primitive is attached, see the implementation
+    bool canRecomputeConcurrently() const override;
     PyObject* getPyObject() override;
     //@}
 
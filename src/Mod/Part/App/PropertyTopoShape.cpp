@@ -75,6 +75,7 @@ using namespace Part;
 TYPESYSTEM_SOURCE(Part::PropertyPartShape , App::PropertyComplexGeoData)
 
 PropertyPartShape::PropertyPartShape()
+  : _LazyFile([this](Base::Reader &reader) { restoreLazyFile(reader); })
 {
 }
 
@@ -85,6 +86,7 @@ PropertyPartShape::~PropertyPartShape()
 void PropertyPartShape::setValue(const TopoShape& sh)
 {
     aboutToSetValue();
+    _LazyFile.reset();
     _Shape = sh;
     hasSetValue();
 }
@@ -92,27 +94,32 @@ void PropertyPartShape::setValue(const TopoShape& sh)
 void PropertyPartShape::setValue(const TopoDS_Shape& sh)
 {
     aboutToSetValue();
+    _LazyFile.reset();
     _Shape.setShape(sh);
     hasSetValue();
 }
 
 const TopoDS_Shape& PropertyPartShape::getValue(void)const
 {
+    _LazyFile.read();
     return _Shape.getShape();
 }
 
 const TopoShape& PropertyPartShape::getShape() const
 {
+    _LazyFile.read();
     return this->_Shape;
 }
 
 const Data::ComplexGeoData* PropertyPartShape::getComplexData() const
 {
+    _LazyFile.read();
     return &(this->_Shape);
 }
 
 Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 {
+    _LazyFile.read();
     Base::BoundBox3d box;
     if (_Shape.getShape().IsNull())
         return box;
@@ -139,6 +146,7 @@ Base::BoundBox3d PropertyPartShape::getBoundingBox() const
 
 void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 {
+    _LazyFile.read();
     aboutToSetValue();
     _Shape.transformGeometry(rclTrf);
     hasSetValue();
@@ -146,6 +154,7 @@ void PropertyPartShape::transformGeometry(const Base::Matrix4D &rclTrf)
 
 PyObject *PropertyPartShape::getPyObject(void)
 {
+    _LazyFile.read();
     Base::PyObjectBase* prop = static_cast<Base::PyObjectBase*>(_Shape.getPyObject());
     if (prop)
         prop->setConst();
@@ -167,6 +176,7 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    _LazyFile.read();
     PropertyPartShape *prop = new PropertyPartShape();
     prop->_Shape = this->_Shape;
     if (!_Shape.getShape().IsNull()) {
@@ -180,12 +190,14 @@ App::Property *PropertyPartShape::Copy(void) const
 void PropertyPartShape::Paste(const App::Property &from)
 {
     aboutToSetValue();
-    _Shape = dynamic_cast<const PropertyPartShape&>(from)._Shape;
+    _LazyFile.reset();
+    _Shape = dynamic_cast<const PropertyPartShape&>(from).getShape();
     hasSetValue();
 }
 
 unsigned int PropertyPartShape::getMemSize (void) const
 {
+    _LazyFile.read();
     return _Shape.getMemSize();
 }
 
@@ -279,6 +291,7 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
 {
     // If the shape is empty we simply store nothing. The file size will be 0 which
     // can be checked when reading in the data.
+    _LazyFile.read();
     if (_Shape.getShape().IsNull())
         return;
     TopoDS_Shape myShape = _Shape.getShape();
@@ -344,6 +357,12 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     }
 }
 
+bool PropertyPartShape::canSaveDocFileConcurrently(const Base::Writer &writer) const
+{
+    // writing the ASCII format is not reentrant
+    return writer.getMode("BinaryBrep");
+}
+
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 {
     Base::FileInfo brep(reader.getFileName());
@@ -405,6 +424,58 @@ void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
     }
 }
 
+std::function<void()> PropertyPartShape::parseDocFile(Base::Reader &reader)
+{
+    Base::FileInfo brep(reader.getFileName());
+    if (brep.hasExtension("bin")) {
+        std::shared_ptr<TopoShape> shape = std::make_shared<TopoShape>();
+        shape->importBinary(reader);
+        return [this, shape]() {
+            setValue(*shape);
+        };
+    }
+    else {
+        BRep_Builder builder;
+        std::shared_ptr<TopoDS_Shape> shape = std::make_shared<TopoDS_Shape>();
+        BRepTools::Read(*shape, reader, builder);
+        return [this, shape]() {
+            setValue(*shape);
+        };
+    }
+}
+
+bool PropertyPartShape::canParseDocFile() const
+{
+    // the shapes are parsed from the stream, see RestoreDocFile()
+    return App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("DirectAccess", true);
+}
+
+Base::LazyFile* PropertyPartShape::getLazyFile() const
+{
+    // the shapes are read from the stream like in parseDocFile()
+    if (_LazyFile.isPending() || canParseDocFile())
+        return &_LazyFile;
+    return 0;
+}
+
+void PropertyPartShape::restoreLazyFile(Base::Reader &reader)
+{
+    // the shape is set as it had been restored with the document
+    Base::FileInfo brep(reader.getFileName());
+    if (brep.hasExtension("bin")) {
+        TopoShape shape;
+        shape.importBinary(reader);
+        _Shape = shape;
+    }
+    else {
+        BRep_Builder builder;
+        TopoDS_Shape shape;
+        BRepTools::Read(shape, reader, builder);
+        _Shape.setShape(shape);
+    }
+}
+
 // -------------------------------------------------------------------------
 
 TYPESYSTEM_SOURCE(Part::PropertyShapeHistory , App::PropertyLists)
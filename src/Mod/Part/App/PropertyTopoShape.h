@@ -28,6 +28,7 @@
 #include <TopAbs_ShapeEnum.hxx>
 #include <App/DocumentObject.h>
 #include <App/PropertyGeo.h>
+#include <Base/Reader.h>
 #include <map>
 #include <vector>
 
@@ -81,7 +82,11 @@ public:
     void Restore(Base::XMLReader &reader);
 
     void SaveDocFile (Base::Writer &writer) const;
+    bool canSaveDocFileConcurrently(const Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    std::function<void()> parseDocFile(Base::Reader &reader);
+    bool canParseDocFile() const;
+    Base::LazyFile* getLazyFile() const;
 
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
@@ -91,8 +96,12 @@ public:
     /// Get valid paths for this property; used by auto completer
     virtual void getPaths(std::vector<App::ObjectIdentifier> & paths) const;
 
+private:
+    void restoreLazyFile(Base::Reader &reader);
+
 private:
     TopoShape _Shape;
+    mutable Base::LazyFile _LazyFile;
 };
 
 struct PartExport ShapeHistory {
@@ -59,6 +59,66 @@ class PartTestCases(unittest.TestCase):
         FreeCAD.closeDocument("PartTest")
         #print ("omit closing document for debugging")
 
+class PartTestParallelRecompute(unittest.TestCase):
+    def setUp(self):
+        self.Doc = FreeCAD.newDocument("ParallelRecompute")
+        self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+        self.Parallel = self.Param.GetBool("ParallelRecompute", False)
+
+    def build(self):
+        # unattached primitives run on the worker threads, the attached ones and the
+        # booleans on the main thread
+        for i in range(20):
+            pl = App.Placement(App.Vector(10.0 * i, i, 0.0), App.Rotation(App.Vector(0, 0, 1), 7.0 * i))
+            box = self.Doc.addObject("Part::Box", "Box")
+            box.Length = 1.0 + i
+            box.Placement = pl
+            cyl = self.Doc.addObject("Part::Cylinder", "Cylinder")
+            cyl.Radius = 0.5 + 0.1 * i
+            cyl.Placement = pl
+            sph = self.Doc.addObject("Part::Sphere", "Sphere")
+            sph.Radius = 1.0 + 0.05 * i
+            sph.Placement = pl.multiply(App.Placement(App.Vector(0, 0, 10), App.Rotation()))
+            cone = self.Doc.addObject("Part::Cone", "Cone")
+            cone.Support = [(box, "Face6")]
+            cone.MapMode = "FlatFace"
+            cut = self.Doc.addObject("Part::Cut", "Cut")
+            cut.Base = box
+            cut.Tool = cyl
+
+    def shapes(self):
+        result = []
+        for obj in self.Doc.Objects:
+            pl = obj.Placement
+            box = obj.Shape.BoundBox
+            result.append((obj.Name, obj.isValid(), tuple(pl.Base), pl.Rotation.Q,
+                           obj.Shape.Volume, obj.Shape.Area, len(obj.Shape.Faces),
+                           (box.XMin, box.YMin, box.ZMin, box.XMax, box.YMax, box.ZMax)))
+        return result
+
+    def recompute(self, parallel):
+        self.Param.SetBool("ParallelRecompute", parallel)
+        for obj in self.Doc.Objects:
+            obj.touch()
+        self.Doc.recompute()
+        return self.shapes()
+
+    def testParallelRecompute(self):
+        self.build()
+        serial = self.recompute(False)
+        parallel = self.recompute(True)
+        self.assertEqual(len(serial), len(parallel))
+        for s, p in zip(serial, parallel):
+            self.assertEqual(s[0], p[0])
+            self.assertTrue(p[1], p[0])
+            self.assertEqual(s[6], p[6])
+            for v1, v2 in zip(s[2] + s[3] + s[4:6] + s[7], p[2] + p[3] + p[4:6] + p[7]):
+                self.assertAlmostEqual(v1, v2, places=6, msg=s[0])
+
+    def tearDown(self):
+        self.Param.SetBool("ParallelRecompute", self.Parallel)
+        FreeCAD.closeDocument("ParallelRecompute")
+
 class PartTestBSplineCurve(unittest.TestCase):
     def setUp(self):
         self.Doc = FreeCAD.newDocument("PartTest")
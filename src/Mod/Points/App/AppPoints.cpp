@@ -31,6 +31,7 @@
 
 #include "Points.h"
 #include "PointsPy.h"
+#include "PointStorePy.h"
 #include "Properties.h"
 #include "PropertyPointKernel.h"
 #include "Structured.h"
@@ -47,6 +48,7 @@ PyMOD_INIT_FUNC(Points)
 
     // add python types
     Base::Interpreter().addType(&Points::PointsPy::Type, pointsModule, "Points");
+    Base::Interpreter().addType(&Points::PointStorePy::Type, pointsModule, "PointStore");
 
     // add properties
     Points::PropertyGreyValue     ::init();
@@ -43,6 +43,7 @@
 #include "Points.h"
 #include "PointsPy.h"
 #include "PointsAlgos.h"
+#include "PointStore.h"
 #include "Structured.h"
 #include "Properties.h"
 
@@ -58,6 +59,10 @@ public:
         );
         add_varargs_method("export",&Module::exporter
         );
+        add_varargs_method("readLevelOfDetail",&Module::readLevelOfDetail,
+            "readLevelOfDetail(string,int) -- Stream a point cloud file through a temporary out-of-core store\n"
+            "and return a subsample of at most the given number of points evenly spread over the cloud."
+        );
         add_varargs_method("show",&Module::show,
             "show(points,[string]) -- Add the points to the active document or create one if no document exists."
         );
@@ -370,6 +375,46 @@ private:
         return Py::None();
     }
 
+    Py::Object readLevelOfDetail(const Py::Tuple& args)
+    {
+        char* Name;
+        unsigned long maxPoints;
+        if (!PyArg_ParseTuple(args.ptr(), "etk","utf-8",&Name,&maxPoints))
+            throw Py::Exception();
+        std::string EncodedName = std::string(Name);
+        PyMem_Free(Name);
+
+        try {
+            Base::FileInfo file(EncodedName.c_str());
+
+            std::unique_ptr<Reader> reader;
+            if (file.hasExtension("asc")) {
+                reader.reset(new AscReader);
+            }
+            else if (file.hasExtension("ply")) {
+                reader.reset(new PlyReader);
+            }
+            else if (file.hasExtension("pcd")) {
+                reader.reset(new PcdReader);
+            }
+            else {
+                throw Py::RuntimeError("Unsupported file extension");
+            }
+
+            PointStore store;
+            reader->read(EncodedName, store);
+
+            std::vector<Base::Vector3f> pnts;
+            store.getLevelOfDetail(maxPoints, pnts);
+            std::unique_ptr<PointKernel> kernel(new PointKernel);
+            kernel->swap(pnts);
+            return Py::asObject(new PointsPy(kernel.release()));
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
+        }
+    }
+
     Py::Object show(const Py::Tuple& args)
     {
         PyObject *pcObj;
@@ -0,0 +1,379 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cmath>
+# include <sstream>
+#endif
+
+#include <QMutexLocker>
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/MappedFile.h>
+#include <Base/Stream.h>
+
+#include "PointStore.h"
+#include "Points.h"
+
+using namespace Points;
+
+namespace {
+const std::size_t SampleSize = 4096; // points per tile kept in memory for the level of detail
+}
+
+struct PointStore::Tile
+{
+    Base::BoundBox3f box;
+    std::size_t count;                      /**< points in the chunk file */
+    std::vector<value_type> buffer;         /**< points not yet written to the chunk file */
+    std::vector<value_type> sample;         /**< random sample of all points of the tile */
+    std::size_t seen;
+    uint32_t random;
+
+    Tile() : count(0), seen(0), random(0)
+    {
+    }
+    std::size_t size() const
+    {
+        return count + buffer.size();
+    }
+};
+
+class PointStore::MappedPage : public PointStore::Page
+{
+public:
+    MappedPage(const std::string& fileName, std::size_t count)
+    {
+        if (count == 0)
+            return;
+        if (!_file.open(Base::FileInfo(fileName)) || _file.size() < count * sizeof(value_type))
+            throw Base::FileException("Cannot map chunk file", fileName);
+        _data = reinterpret_cast<const value_type*>(_file.data());
+        _size = count;
+    }
+
+private:
+    Base::MappedFile _file;
+};
+
+PointStore::PointStore(const std::string& directory, std::size_t memoryBudget)
+  : _directory(directory)
+  , _ownDirectory(false)
+  , _memoryBudget(memoryBudget)
+  , _tileSize(1000.0f)
+  , _numPoints(0)
+  , _bufferedPoints(0)
+  , _mappedPoints(0)
+  , _offsetsValid(false)
+  , _mutex(QMutex::Recursive)
+{
+    if (_directory.empty()) {
+        _directory = Base::FileInfo::getTempFileName("PointStore");
+        _ownDirectory = true;
+    }
+
+    Base::FileInfo di(_directory);
+    if (!di.exists() && !di.createDirectory())
+        throw Base::FileException("Cannot create directory", _directory);
+}
+
+PointStore::~PointStore()
+{
+    try {
+        clear();
+        if (_ownDirectory)
+            Base::FileInfo(_directory).deleteDirectory();
+    }
+    catch (...) {
+    }
+}
+
+void PointStore::setTileSize(float size)
+{
+    if (_numPoints > 0)
+        throw Base::RuntimeError("The tile size of a non-empty point store cannot be changed");
+    if (size <= 0.0f)
+        throw Base::ValueError("The tile size must be positive");
+    _tileSize = size;
+}
+
+void PointStore::setMemoryBudget(std::size_t bytes)
+{
+    QMutexLocker lock(&_mutex);
+    _memoryBudget = bytes;
+    if (_bufferedPoints * sizeof(value_type) > _memoryBudget / 2)
+        flush();
+    releasePages();
+}
+
+void PointStore::addPoints(const value_type* pnts, std::size_t count)
+{
+    std::vector<int> key(3), lastKey;
+    Tile* tile = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        const value_type& pnt = pnts[i];
+        key[0] = static_cast<int>(std::floor(pnt.x / _tileSize));
+        key[1] = static_cast<int>(std::floor(pnt.y / _tileSize));
+        key[2] = static_cast<int>(std::floor(pnt.z / _tileSize));
+
+        // scans are usually coherent, so most points go to the same tile as the previous one
+        if (!tile || key != lastKey) {
+            std::map<std::vector<int>, std::size_t>::iterator it = _tileIndex.find(key);
+            if (it == _tileIndex.end()) {
+                it = _tileIndex.insert(std::make_pair(key, _tiles.size())).first;
+                _tiles.emplace_back(new Tile());
+                _tiles.back()->random = static_cast<uint32_t>(it->second);
+            }
+            tile = _tiles[it->second].get();
+            lastKey = key;
+        }
+
+        tile->buffer.push_back(pnt);
+        tile->box.Add(pnt);
+
+        // reservoir sampling
+        tile->seen++;
+        if (tile->sample.size() < SampleSize) {
+            tile->sample.push_back(pnt);
+        }
+        else {
+            tile->random = tile->random * 1664525u + 1013904223u;
+            std::size_t j = tile->random % tile->seen;
+            if (j < SampleSize)
+                tile->sample[j] = pnt;
+        }
+
+        _numPoints++;
+        _bufferedPoints++;
+        if (_bufferedPoints * sizeof(value_type) > _memoryBudget / 2) {
+            flush();
+            tile = 0;
+        }
+    }
+
+    _offsetsValid = false;
+}
+
+void PointStore::flush()
+{
+    QMutexLocker lock(&_mutex);
+    for (std::vector<std::unique_ptr<Tile> >::iterator it = _tiles.begin(); it != _tiles.end(); ++it)
+        flush(**it);
+}
+
+void PointStore::flush(Tile& tile) const
+{
+    if (tile.buffer.empty())
+        return;
+
+    std::size_t index = 0;
+    for (; index < _tiles.size(); index++) {
+        if (_tiles[index].get() == &tile)
+            break;
+    }
+
+    Base::FileInfo fi(chunkFile(index));
+    Base::ofstream str(fi, std::ios::out | std::ios::binary | std::ios::app);
+    str.write(reinterpret_cast<const char*>(tile.buffer.data()),
+              static_cast<std::streamsize>(tile.buffer.size() * sizeof(value_type)));
+    if (!str)
+        throw Base::FileException("Cannot write chunk file", fi);
+
+    tile.count += tile.buffer.size();
+    _bufferedPoints -= tile.buffer.size();
+    std::vector<value_type>().swap(tile.buffer);
+
+    // a cached page doesn't cover the new points
+    for (std::list<std::pair<std::size_t, PagePtr> >::iterator it = _pages.begin(); it != _pages.end(); ++it) {
+        if (it->first == index) {
+            _mappedPoints -= it->second->size();
+            _pages.erase(it);
+            break;
+        }
+    }
+}
+
+void PointStore::clear()
+{
+    QMutexLocker lock(&_mutex);
+    _pages.clear();
+    _mappedPoints = 0;
+    for (std::size_t i = 0; i < _tiles.size(); i++) {
+        Base::FileInfo fi(chunkFile(i));
+        if (fi.exists())
+            fi.deleteFile();
+    }
+    _tiles.clear();
+    _tileIndex.clear();
+    _numPoints = 0;
+    _bufferedPoints = 0;
+    _offsets.clear();
+    _offsetsValid = false;
+}
+
+std::size_t PointStore::countPoints(std::size_t tile) const
+{
+    return _tiles[tile]->size();
+}
+
+Base::BoundBox3f PointStore::getBoundBox() const
+{
+    Base::BoundBox3f box;
+    for (std::vector<std::unique_ptr<Tile> >::const_iterator it = _tiles.begin(); it != _tiles.end(); ++it)
+        box.Add((*it)->box);
+    return box;
+}
+
+Base::BoundBox3f PointStore::getBoundBox(std::size_t tile) const
+{
+    return _tiles[tile]->box;
+}
+
+std::vector<std::size_t> PointStore::getTiles(const Base::BoundBox3f& box) const
+{
+    std::vector<std::size_t> tiles;
+    for (std::size_t i = 0; i < _tiles.size(); i++) {
+        if (_tiles[i]->box && box)
+            tiles.push_back(i);
+    }
+    return tiles;
+}
+
+std::size_t PointStore::getMemSize() const
+{
+    QMutexLocker lock(&_mutex);
+    return (_bufferedPoints + _mappedPoints) * sizeof(value_type);
+}
+
+PointStore::PagePtr PointStore::getPage(std::size_t tile) const
+{
+    QMutexLocker lock(&_mutex);
+    for (std::list<std::pair<std::size_t, PagePtr> >::iterator it = _pages.begin(); it != _pages.end(); ++it) {
+        if (it->first == tile) {
+            _pages.splice(_pages.begin(), _pages, it);
+            return _pages.front().second;
+        }
+    }
+
+    Tile& t = *_tiles[tile];
+    flush(t);
+    PagePtr page(new MappedPage(chunkFile(tile), t.count));
+    _pages.emplace_front(tile, page);
+    _mappedPoints += page->size();
+    releasePages();
+    return page;
+}
+
+void PointStore::releasePages() const
+{
+    // unmap the least recently used pages but keep at least the newest one. Pages that are
+    // still referenced elsewhere stay mapped until they are released there.
+    while (_pages.size() > 1 && _mappedPoints * sizeof(value_type) > _memoryBudget / 2) {
+        _mappedPoints -= _pages.back().second->size();
+        _pages.pop_back();
+    }
+}
+
+void PointStore::updateOffsets() const
+{
+    if (_offsetsValid)
+        return;
+    _offsets.resize(_tiles.size() + 1);
+    _offsets[0] = 0;
+    for (std::size_t i = 0; i < _tiles.size(); i++)
+        _offsets[i + 1] = _offsets[i] + _tiles[i]->size();
+    _offsetsValid = true;
+}
+
+PointStore::value_type PointStore::getPoint(std::size_t index) const
+{
+    QMutexLocker lock(&_mutex);
+    if (index >= _numPoints)
+        throw Base::IndexError("Point index out of range");
+
+    updateOffsets();
+    std::size_t tile = std::upper_bound(_offsets.begin(), _offsets.end(), index) - _offsets.begin() - 1;
+    PagePtr page = getPage(tile);
+    return (*page)[index - _offsets[tile]];
+}
+
+void PointStore::getLevelOfDetail(std::size_t maxPoints, std::vector<value_type>& pnts) const
+{
+    pnts.clear();
+    if (_numPoints == 0)
+        return;
+
+    // the share of a tile is the difference of the rounded down shares of all tiles up to
+    // and including it, so the shares add up to at most maxPoints
+    std::size_t limit = std::min(maxPoints, _numPoints);
+    std::size_t total = 0, taken = 0;
+    for (std::vector<std::unique_ptr<Tile> >::const_iterator it = _tiles.begin(); it != _tiles.end(); ++it) {
+        const Tile& tile = **it;
+        total += tile.size();
+        std::size_t share = total * limit / _numPoints;
+        std::size_t num = std::min(share - taken, tile.sample.size());
+        taken = share;
+        pnts.insert(pnts.end(), tile.sample.begin(), tile.sample.begin() + num);
+    }
+}
+
+void PointStore::getPoints(PointKernel& kernel) const
+{
+    std::vector<value_type> pnts;
+    pnts.reserve(_numPoints);
+    for (std::size_t i = 0; i < _tiles.size(); i++) {
+        PagePtr page = getPage(i);
+        pnts.insert(pnts.end(), page->data(), page->data() + page->size());
+    }
+    kernel.swap(pnts);
+}
+
+void PointStore::getPoints(const Base::BoundBox3f& box, PointKernel& kernel) const
+{
+    std::vector<value_type> pnts;
+    std::vector<std::size_t> tiles = getTiles(box);
+    for (std::vector<std::size_t>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        PagePtr page = getPage(*it);
+        if (box.IsInBox(_tiles[*it]->box)) {
+            pnts.insert(pnts.end(), page->data(), page->data() + page->size());
+        }
+        else {
+            for (std::size_t i = 0; i < page->size(); i++) {
+                if (box.IsInBox((*page)[i]))
+                    pnts.push_back((*page)[i]);
+            }
+        }
+    }
+    kernel.swap(pnts);
+}
+
+std::string PointStore::chunkFile(std::size_t tile) const
+{
+    std::stringstream str;
+    str << _directory << "/tile" << tile << ".bin";
+    return str.str();
+}
@@ -0,0 +1,192 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_POINTSTORE_H
+#define POINTS_POINTSTORE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QMutex>
+
+#include <Base/BoundBox.h>
+#include <Base/Vector3D.h>
+
+namespace Points
+{
+
+class PointKernel;
+
+/**
+ * The PointStore class keeps a point cloud that doesn't fit into memory.
+ *
+ * The space is divided into cubic tiles of a fixed edge length and each tile writes its
+ * points to its own chunk file. Points are added in blocks and are kept in memory until the
+ * buffered points exceed half of the memory budget, then all buffers are appended to the
+ * chunk files. The points of a tile are read back as a page that maps the chunk file into
+ * memory. Pages are cached and the least recently used ones are unmapped as soon as the
+ * mapped size exceeds the other half of the budget, so the working set stays bounded no
+ * matter how large the cloud is.
+ *
+ * Each tile additionally keeps a random sample of its points in memory from which a level
+ * of detail of the whole cloud can be built without touching the chunk files.
+ *
+ * Adding points is not thread-safe but reading pages and points is.
+ *
+ * The store is used by Points.readLevelOfDetail() and is available as Points.PointStore.
+ * PointKernel, PointsGrid and the view provider keep all their points in memory because
+ * their interfaces hand out contiguous arrays. To use them on a cloud that doesn't fit into
+ * memory, load a region with getPoints(box, kernel): only the tiles near the box are paged
+ * in, and the kernel can then be handed to a PointsGrid or a PointsKDTree as usual.
+ */
+class PointsExport PointStore
+{
+public:
+    typedef Base::Vector3f value_type;
+
+    /**
+     * The points of one tile. The data stays valid as long as the page is referenced,
+     * even if the store drops it from its cache meanwhile.
+     */
+    class PointsExport Page
+    {
+    public:
+        virtual ~Page() {}
+        const value_type* data() const { return _data; }
+        std::size_t size() const { return _size; }
+        const value_type& operator[] (std::size_t i) const { return _data[i]; }
+
+    protected:
+        Page() : _data(0), _size(0) {}
+        const value_type* _data;
+        std::size_t _size;
+    };
+    typedef std::shared_ptr<const Page> PagePtr;
+
+    /**
+     * Creates a store with its chunk files in \a directory. If the directory is empty
+     * a temporary directory is used that is removed with the store.
+     */
+    explicit PointStore(const std::string& directory = std::string(),
+                        std::size_t memoryBudget = 256 * 1024 * 1024);
+    /// Removes all chunk files
+    ~PointStore();
+
+    /** @name Settings */
+    //@{
+    /** Sets the edge length of the tiles. This is only possible as long as the store is empty. */
+    void setTileSize(float size);
+    float getTileSize() const
+    { return _tileSize; }
+    /** Sets the memory in bytes used for buffered and mapped points. */
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t getMemoryBudget() const
+    { return _memoryBudget; }
+    //@}
+
+    /** @name Modification */
+    //@{
+    void addPoint(const value_type& pnt)
+    { addPoints(&pnt, 1); }
+    /** Adds \a count points to the store. */
+    void addPoints(const value_type* pnts, std::size_t count);
+    void addPoints(const std::vector<value_type>& pnts)
+    { addPoints(pnts.data(), pnts.size()); }
+    /** Writes all buffered points to the chunk files. */
+    void flush();
+    /** Removes all points and chunk files. */
+    void clear();
+    //@}
+
+    /** @name Information */
+    //@{
+    /** Returns the number of points. */
+    std::size_t size() const
+    { return _numPoints; }
+    std::size_t countTiles() const
+    { return _tiles.size(); }
+    std::size_t countPoints(std::size_t tile) const;
+    Base::BoundBox3f getBoundBox() const;
+    Base::BoundBox3f getBoundBox(std::size_t tile) const;
+    /** Returns the tiles whose points are inside or near \a box. */
+    std::vector<std::size_t> getTiles(const Base::BoundBox3f& box) const;
+    /** Returns the size in bytes of the currently buffered and mapped points. The samples
+     * for the level of detail are not part of the memory budget and not counted. */
+    std::size_t getMemSize() const;
+    //@}
+
+    /** @name Access */
+    //@{
+    /** Returns the points of \a tile. The chunk file is mapped on demand. */
+    PagePtr getPage(std::size_t tile) const;
+    /** Returns the point with the global index \a index. The points are numbered tile by tile,
+     * so that walking over the indices in ascending order pages in each tile once. */
+    value_type getPoint(std::size_t index) const;
+    /** Returns up to \a maxPoints points distributed over all tiles proportional to their size.
+     * Only the in-memory samples of the tiles are used, so a tile with many points may
+     * contribute less than its share. */
+    void getLevelOfDetail(std::size_t maxPoints, std::vector<value_type>& pnts) const;
+    /** Copies all points into \a kernel. This is only meant for clouds that fit into memory. */
+    void getPoints(PointKernel& kernel) const;
+    /** Copies the points inside \a box into \a kernel. Only the tiles near the box are paged in. */
+    void getPoints(const Base::BoundBox3f& box, PointKernel& kernel) const;
+    //@}
+
+private:
+    struct Tile;
+    class MappedPage;
+
+    void flush(Tile& tile) const;
+    void releasePages() const;
+    void updateOffsets() const;
+    std::string chunkFile(std::size_t tile) const;
+
+    PointStore(const PointStore&);
+    PointStore& operator= (const PointStore&);
+
+private:
+    std::string _directory;
+    bool _ownDirectory;
+    std::size_t _memoryBudget;
+    float _tileSize;
+    std::size_t _numPoints;
+    mutable std::size_t _bufferedPoints;
+
+    std::vector<std::unique_ptr<Tile> > _tiles;
+    std::map<std::vector<int>, std::size_t> _tileIndex;
+
+    // cache of mapped pages, the most recently used first
+    mutable std::list<std::pair<std::size_t, PagePtr> > _pages;
+    mutable std::size_t _mappedPoints;
+    mutable std::vector<std::size_t> _offsets;
+    mutable bool _offsetsValid;
+    mutable QMutex _mutex;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_POINTSTORE_H
@@ -0,0 +1,199 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#include "Mod/Points/App/PointStore.h"
+#include "Mod/Points/App/Points.h"
+#include <Base/BoundBoxPy.h>
+#include <Base/VectorPy.h>
+
+// inclusion of the generated files (generated out of PointStorePy.xml)
+#include "PointStorePy.h"
+#include "PointStorePy.cpp"
+#include "PointsPy.h"
+
+using namespace Points;
+
+// returns a string which represents the object e.g. when printed in python
+std::string PointStorePy::representation(void) const
+{
+    return std::string("<PointStore object>");
+}
+
+PyObject *PointStorePy::PyMake(struct _typeobject *, PyObject *, PyObject *)  // Python wrapper
+{
+    // create a new instance of PointStorePy and the Twin object
+    return new PointStorePy(new PointStore);
+}
+
+// constructor method
+int PointStorePy::PyInit(PyObject* args, PyObject* /*kwd*/)
+{
+    unsigned long budget = 0;
+    double size = 0.0;
+    if (!PyArg_ParseTuple(args, "|kd", &budget, &size))
+        return -1;
+
+    try {
+        if (budget > 0)
+            getPointStorePtr()->setMemoryBudget(budget);
+        if (size > 0.0)
+            getPointStorePtr()->setTileSize(static_cast<float>(size));
+    }
+    catch (const Base::Exception& e) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, e.what());
+        return -1;
+    }
+
+    return 0;
+}
+
+PyObject* PointStorePy::addPoints(PyObject * args)
+{
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O!", &(PointsPy::Type), &obj))
+        return 0;
+
+    PY_TRY {
+        const PointKernel* kernel = static_cast<PointsPy*>(obj)->getPointKernelPtr();
+        getPointStorePtr()->addPoints(kernel->getBasicPoints());
+    } PY_CATCH;
+
+    Py_Return;
+}
+
+PyObject* PointStorePy::flush(PyObject * args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    PY_TRY {
+        getPointStorePtr()->flush();
+    } PY_CATCH;
+
+    Py_Return;
+}
+
+PyObject* PointStorePy::getPoint(PyObject * args)
+{
+    unsigned long index;
+    if (!PyArg_ParseTuple(args, "k", &index))
+        return 0;
+
+    PY_TRY {
+        Base::Vector3f pnt = getPointStorePtr()->getPoint(index);
+        return new Base::VectorPy(Base::Vector3d(pnt.x, pnt.y, pnt.z));
+    } PY_CATCH;
+}
+
+PyObject* PointStorePy::getLevelOfDetail(PyObject * args)
+{
+    unsigned long maxPoints;
+    if (!PyArg_ParseTuple(args, "k", &maxPoints))
+        return 0;
+
+    PY_TRY {
+        std::vector<Base::Vector3f> pnts;
+        getPointStorePtr()->getLevelOfDetail(maxPoints, pnts);
+        PointKernel* kernel = new PointKernel();
+        kernel->swap(pnts);
+        return new PointsPy(kernel);
+    } PY_CATCH;
+}
+
+PyObject* PointStorePy::toPoints(PyObject * args)
+{
+    PyObject* box = 0;
+    if (!PyArg_ParseTuple(args, "|O!", &(Base::BoundBoxPy::Type), &box))
+        return 0;
+
+    PY_TRY {
+        PointKernel* kernel = new PointKernel();
+        if (box) {
+            Base::BoundBox3d bbox = *static_cast<Base::BoundBoxPy*>(box)->getBoundBoxPtr();
+            getPointStorePtr()->getPoints(Base::BoundBox3f(float(bbox.MinX), float(bbox.MinY), float(bbox.MinZ),
+                                                           float(bbox.MaxX), float(bbox.MaxY), float(bbox.MaxZ)),
+                                          *kernel);
+        }
+        else {
+            getPointStorePtr()->getPoints(*kernel);
+        }
+        return new PointsPy(kernel);
+    } PY_CATCH;
+}
+
+Py::Long PointStorePy::getCountPoints(void) const
+{
+    return Py::Long(static_cast<unsigned long>(getPointStorePtr()->size()));
+}
+
+Py::Long PointStorePy::getCountTiles(void) const
+{
+    return Py::Long(static_cast<unsigned long>(getPointStorePtr()->countTiles()));
+}
+
+Py::Long PointStorePy::getMemSize(void) const
+{
+    return Py::Long(static_cast<unsigned long>(getPointStorePtr()->getMemSize()));
+}
+
+Py::Long PointStorePy::getMemoryBudget(void) const
+{
+    return Py::Long(static_cast<unsigned long>(getPointStorePtr()->getMemoryBudget()));
+}
+
+void PointStorePy::setMemoryBudget(Py::Long arg)
+{
+    try {
+        getPointStorePtr()->setMemoryBudget(static_cast<unsigned long>(arg));
+    }
+    catch (const Base::Exception& e) {
+        throw Py::RuntimeError(e.what());
+    }
+}
+
+Py::Float PointStorePy::getTileSize(void) const
+{
+    return Py::Float(getPointStorePtr()->getTileSize());
+}
+
+void PointStorePy::setTileSize(Py::Float arg)
+{
+    try {
+        getPointStorePtr()->setTileSize(static_cast<float>(static_cast<double>(arg)));
+    }
+    catch (const Base::Exception& e) {
+        throw Py::RuntimeError(e.what());
+    }
+}
+
+PyObject *PointStorePy::getCustomAttributes(const char* /*attr*/) const
+{
+    return 0;
+}
+
+int PointStorePy::setCustomAttributes(const char* /*attr*/, PyObject* /*obj*/)
+{
+    return 0;
+}
@@ -26,17 +26,23 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <algorithm>
+# include <cctype>
+# include <cstdlib>
+# include <cstring>
 # include <sstream>
 #endif
 
-
 #include "PointsAlgos.h"
+#include "PointStore.h"
 #include "Points.h"
 
 #include <Base/Converter.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Console.h>
+#include <Base/MappedFile.h>
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
 
@@ -48,6 +54,286 @@
 
 using namespace Points;
 
+namespace {
+// number of points read at once when streaming into a PointStore
+const std::size_t StoreBlockSize = 65536;
+
+// Maps the file \a filename into memory or throws an exception if it can't be read
+void mapFile(Base::MappedFile& file, const std::string& filename)
+{
+    if (!file.open(Base::FileInfo(filename)))
+        throw Base::FileException("File to load not existing or not readable", filename);
+}
+
+// Returns the end of the line starting at \a p, i.e. the position of the newline or \a end
+const char* lineEnd(const char* p, const char* end)
+{
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl : end;
+}
+
+bool isBlank(const char* p, const char* end)
+{
+    for (; p < end; ++p) {
+        if (!std::isspace(static_cast<unsigned char>(*p)))
+            return false;
+    }
+    return true;
+}
+
+// Splits [begin, end) into \a blocks ranges which all start at the beginning of a line
+std::vector<const char*> splitLines(const char* begin, const char* end, std::size_t blocks)
+{
+    std::vector<const char*> bounds(blocks + 1);
+    bounds[0] = begin;
+    for (std::size_t b = 1; b < blocks; b++) {
+        const char* p = std::max(begin + (end - begin) * b / blocks, bounds[b - 1]);
+        // a block that starts at the beginning of a line keeps this line
+        if (p > begin && p[-1] != '\n') {
+            p = lineEnd(p, end);
+            if (p < end)
+                ++p;
+        }
+        bounds[b] = p;
+    }
+    bounds[blocks] = end;
+    return bounds;
+}
+
+// Skips \a lines non-blank lines
+const char* skipLines(const char* p, const char* end, std::size_t lines)
+{
+    while (lines > 0 && p < end) {
+        const char* e = lineEnd(p, end);
+        if (!isBlank(p, e))
+            lines--;
+        p = (e < end) ? e + 1 : end;
+    }
+    return p;
+}
+
+/*
+ * Parses the whitespace-separated values of the non-blank lines in [begin, end) into the
+ * rows of \a data starting at \a row. Missing values are set to zero.
+ */
+void parseAsciiRows(const char* begin, const char* end, Eigen::Index row, Eigen::MatrixXd& data)
+{
+    const Eigen::Index numPoints = data.rows();
+    const Eigen::Index numFields = data.cols();
+    char token[64];
+    for (const char* p = begin; p < end && row < numPoints; ) {
+        const char* e = lineEnd(p, end);
+        if (!isBlank(p, e)) {
+            Eigen::Index col = 0;
+            for (const char* t = p; col < numFields; col++) {
+                while (t < e && std::isspace(static_cast<unsigned char>(*t)))
+                    ++t;
+                if (t == e)
+                    break;
+                const char* s = t;
+                while (t < e && !std::isspace(static_cast<unsigned char>(*t)))
+                    ++t;
+                std::size_t len = static_cast<std::size_t>(t - s);
+                if (len >= sizeof(token))
+                    throw Base::BadFormatError("Invalid number");
+                std::memcpy(token, s, len);
+                token[len] = '\0';
+                char* last;
+                data(row, col) = std::strtod(token, &last);
+                if (last != token + len)
+                    throw Base::BadFormatError("Invalid number");
+            }
+            for (; col < numFields; col++)
+                data(row, col) = 0.0;
+            ++row;
+        }
+        p = (e < end) ? e + 1 : end;
+    }
+}
+
+/*
+ * Parses the ascii data in [begin, end) line by line into \a data. The range is split into
+ * line-aligned blocks whose rows are counted first so that each block can be parsed in
+ * parallel directly into its final rows.
+ */
+void readAsciiData(const char* begin, const char* end, Eigen::MatrixXd& data)
+{
+    std::size_t blocks = Base::parallel_blocks(static_cast<std::size_t>(end - begin), 1 << 20);
+    std::vector<const char*> bounds = splitLines(begin, end, blocks);
+
+    std::vector<Eigen::Index> rows(blocks + 1, 0);
+    Base::parallel_for(blocks, [&](std::size_t b) {
+        Eigen::Index count = 0;
+        for (const char* p = bounds[b]; p < bounds[b + 1]; ) {
+            const char* e = lineEnd(p, bounds[b + 1]);
+            if (!isBlank(p, e))
+                count++;
+            p = (e < bounds[b + 1]) ? e + 1 : bounds[b + 1];
+        }
+        rows[b + 1] = count;
+    });
+    for (std::size_t b = 0; b < blocks; b++)
+        rows[b + 1] += rows[b];
+
+    Base::parallel_for(blocks, [&](std::size_t b) {
+        if (rows[b] < data.rows())
+            parseAsciiRows(bounds[b], bounds[b + 1], rows[b], data);
+    });
+
+    // the file has fewer rows than announced
+    if (rows[blocks] < data.rows())
+        data.bottomRows(data.rows() - rows[blocks]).setZero();
+}
+
+/*
+ * Describes where the values of a field are located in a binary buffer. With interleaved
+ * records the stride is the record size, with a field by field layout it's the field size.
+ */
+struct BinaryField
+{
+    char type;              // 'I' signed, 'U' unsigned, 'F' floating point
+    int size;
+    std::size_t offset;
+    std::size_t stride;
+};
+
+template <typename T>
+void decodeColumn(const char* p, std::size_t stride, Eigen::Index first, Eigen::Index last,
+                  bool swapByteOrder, double* column)
+{
+    T value;
+    char bytes[sizeof(T)];
+    p += stride * static_cast<std::size_t>(first);
+    for (Eigen::Index i = first; i < last; i++, p += stride) {
+        if (swapByteOrder) {
+            std::reverse_copy(p, p + sizeof(T), bytes);
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        else {
+            std::memcpy(&value, p, sizeof(T));
+        }
+        column[i] = static_cast<double>(value);
+    }
+}
+
+/*
+ * Decodes the binary values in place without copying the buffer. The rows are split into
+ * blocks and each block decodes all fields column by column.
+ */
+void readBinaryData(const char* base, const std::vector<BinaryField>& fields, bool swapByteOrder,
+                    Eigen::MatrixXd& data)
+{
+    const Eigen::Index numPoints = data.rows();
+    Base::parallel_for(static_cast<std::size_t>(numPoints), 65536, [&](std::size_t, std::size_t begin, std::size_t end) {
+        Eigen::Index first = static_cast<Eigen::Index>(begin);
+        Eigen::Index last = static_cast<Eigen::Index>(end);
+        for (std::size_t j = 0; j < fields.size(); j++) {
+            const BinaryField& f = fields[j];
+            const char* p = base + f.offset;
+            double* column = data.col(j).data();
+            switch (f.type * 16 + f.size) {
+            case 'I' * 16 + 1:
+                decodeColumn<int8_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'U' * 16 + 1:
+                decodeColumn<uint8_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'I' * 16 + 2:
+                decodeColumn<int16_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'U' * 16 + 2:
+                decodeColumn<uint16_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'I' * 16 + 4:
+                decodeColumn<int32_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'U' * 16 + 4:
+                decodeColumn<uint32_t>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'F' * 16 + 4:
+                decodeColumn<float>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            case 'F' * 16 + 8:
+                decodeColumn<double>(p, f.stride, first, last, swapByteOrder, column);
+                break;
+            }
+        }
+    });
+}
+
+// Sets the offsets and strides of the fields for records of all fields stored one after another
+std::size_t interleavedLayout(std::vector<BinaryField>& fields)
+{
+    std::size_t recordSize = 0;
+    for (std::vector<BinaryField>::iterator it = fields.begin(); it != fields.end(); ++it) {
+        it->offset = recordSize;
+        recordSize += it->size;
+    }
+    for (std::vector<BinaryField>::iterator it = fields.begin(); it != fields.end(); ++it)
+        it->stride = recordSize;
+    return recordSize;
+}
+
+// Sets the offsets and strides of the fields for all values of a field stored one after another
+std::size_t columnLayout(std::vector<BinaryField>& fields, std::size_t numPoints)
+{
+    std::size_t offset = 0;
+    for (std::vector<BinaryField>::iterator it = fields.begin(); it != fields.end(); ++it) {
+        it->offset = offset;
+        it->stride = it->size;
+        offset += numPoints * it->size;
+    }
+    return offset;
+}
+
+BinaryField plyField(const std::string& t, int size)
+{
+    BinaryField f;
+    f.size = size;
+    f.offset = 0;
+    f.stride = 0;
+    if ((size == 1 && (t == "char" || t == "int8")) ||
+        (size == 2 && (t == "short" || t == "int16")) ||
+        (size == 4 && (t == "int" || t == "int32")))
+        f.type = 'I';
+    else if ((size == 1 && (t == "uchar" || t == "uint8")) ||
+             (size == 2 && (t == "ushort" || t == "uint16")) ||
+             (size == 4 && (t == "uint" || t == "uint32")))
+        f.type = 'U';
+    else if ((size == 4 && (t == "float" || t == "float32")) ||
+             (size == 8 && (t == "double" || t == "float64")))
+        f.type = 'F';
+    else
+        throw Base::BadFormatError("Unexpected type");
+    return f;
+}
+
+BinaryField pcdField(const std::string& t, int size)
+{
+    BinaryField f;
+    f.size = size;
+    f.offset = 0;
+    f.stride = 0;
+    f.type = t.empty() ? 0 : t[0];
+    bool valid = false;
+    switch (size) {
+    case 1:
+    case 2:
+        valid = (f.type == 'I' || f.type == 'U');
+        break;
+    case 4:
+        valid = (f.type == 'I' || f.type == 'U' || f.type == 'F');
+        break;
+    case 8:
+        valid = (f.type == 'F');
+        break;
+    }
+    if (!valid)
+        throw Base::BadFormatError("Unexpected type");
+    return f;
+}
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -69,52 +355,91 @@ void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
     //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
     //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
 
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
-    Base::FileInfo fi(FileName);
+    // The file is split into line-aligned blocks that are parsed in parallel.
+    // Each block collects its points which are then copied to their final place.
+    Base::MappedFile file;
+    mapFile(file, FileName);
+    std::size_t blocks = Base::parallel_blocks(file.size(), 1 << 20);
+    std::vector<const char*> bounds = splitLines(file.data(), file.data() + file.size(), blocks);
+    std::vector< std::vector<Base::Vector3d> > parts(blocks);
+
+    Base::SequencerLauncher seq( "Loading points...", blocks );
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+    try {
+        Base::parallel_for(blocks, [&](std::size_t b) {
+            boost::cmatch what;
+            std::string line;
+            std::vector<Base::Vector3d>& part = parts[b];
+            for (const char* p = bounds[b]; p < bounds[b + 1]; ) {
+                const char* e = lineEnd(p, bounds[b + 1]);
+                line.assign(p, e);
+                if (boost::regex_match(line.c_str(), what, rx)) {
+                    part.emplace_back(std::atof(what[1].first),
+                                      std::atof(what[4].first),
+                                      std::atof(what[7].first));
+                }
+                p = (e < bounds[b + 1]) ? e + 1 : bounds[b + 1];
+            }
+        }, seq);
+    }
+    catch (const Base::AbortException&) {
+        throw;
+    }
+    catch (...) {
+        points.clear();
+        throw Base::BadFormatError("Reading in points failed.");
+    }
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+    std::vector<std::size_t> offsets(blocks + 1, 0);
+    for (std::size_t b = 0; b < blocks; b++)
+        offsets[b + 1] = offsets[b] + parts[b].size();
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+    points.resize(offsets[blocks]);
+    Base::parallel_for(blocks, [&](std::size_t b) {
+        std::size_t index = offsets[b];
+        for (std::vector<Base::Vector3d>::iterator it = parts[b].begin(); it != parts[b].end(); ++it)
+            points.setPoint(static_cast<int>(index++), *it);
+        std::vector<Base::Vector3d>().swap(parts[b]);
+    });
+}
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+void PointsAlgos::LoadAscii(PointStore& store, const char *FileName)
+{
+    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
+                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
+                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
+    boost::cmatch what;
 
-    // again to the beginning
+    std::vector<Base::Vector3f> block;
+    block.reserve(StoreBlockSize);
+    std::string line;
+    Base::FileInfo fi(FileName);
     Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
 
     try {
-        // read file
+        // a single pass over the file, the points go to the store block by block
         while (std::getline(file, line)) {
             if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+                block.emplace_back(static_cast<float>(std::atof(what[1].first)),
+                                   static_cast<float>(std::atof(what[4].first)),
+                                   static_cast<float>(std::atof(what[7].first)));
+                if (block.size() == StoreBlockSize) {
+                    store.addPoints(block);
+                    block.clear();
+                }
             }
         }
+
+        store.addPoints(block);
+        store.flush();
+    }
+    catch (const Base::FileException&) {
+        throw;
     }
     catch (...) {
-        points.clear();
         throw Base::BadFormatError("Reading in points failed.");
     }
-
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
 }
 
 // ----------------------------------------------------------------------------
@@ -176,6 +501,15 @@ bool Reader::hasNormals() const
     return (!normals.empty());
 }
 
+void Reader::read(const std::string& filename, PointStore& store)
+{
+    read(filename);
+    store.addPoints(points.getBasicPoints());
+    store.flush();
+    points.clear();
+    clear();
+}
+
 bool Reader::isStructured() const
 {
     return (width > 1 && height > 1);
@@ -206,6 +540,15 @@ void AscReader::read(const std::string& filename)
     points.load(filename.c_str());
 }
 
+void AscReader::read(const std::string& filename, PointStore& store)
+{
+    clear();
+    Base::FileInfo fi(filename);
+    if (!fi.isReadable())
+        throw Base::FileException("File to load not existing or not readable", filename);
+    PointsAlgos::LoadAscii(store, filename.c_str());
+}
+
 // ----------------------------------------------------------------------------
 
 namespace Points {
@@ -240,73 +583,6 @@ public:
 
 typedef boost::shared_ptr<Converter> ConverterPtr;
 
-class DataStreambuf : public std::streambuf
-{
-public:
-    explicit DataStreambuf(const std::vector<char>& data) : _buffer(data) {
-        _beg = 0;
-        _end = data.size();
-        _cur = 0;
-    }
-    ~DataStreambuf() {
-    }
-
-protected:
-    virtual int_type uflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur++]) & 0x000000ff;
-    }
-    virtual int_type underflow() {
-        if (_cur == _end)
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[_cur]) & 0x000000ff;
-    }
-    virtual int_type pbackfail(int_type ch) {
-        if (_cur == _beg || (ch != traits_type::eof() && ch != _buffer[_cur-1]))
-            return traits_type::eof();
-
-        return static_cast<DataStreambuf::int_type>(_buffer[--_cur]) & 0x000000ff;
-    }
-    virtual std::streamsize showmanyc() {
-        return _end - _cur;
-    }
-    virtual pos_type seekoff(std::streambuf::off_type off,
-        std::ios_base::seekdir way,
-        std::ios_base::openmode = 
-            std::ios::in | std::ios::out) {
-        int p_pos=-1;
-        if (way == std::ios_base::beg)
-            p_pos = _beg;
-        else if (way == std::ios_base::end)
-            p_pos = _end;
-        else if (way == std::ios_base::cur)
-            p_pos = _cur;
-
-        if (p_pos > _end)
-            return traits_type::eof();
-
-        if (((p_pos + off) > _end) || ((p_pos + off) < _beg))
-            return traits_type::eof();
-
-        _cur = p_pos+ off;
-
-        return ((p_pos+off) - _beg);
-    }
-    virtual pos_type seekpos(std::streambuf::pos_type pos,
-        std::ios_base::openmode which =
-        std::ios::in | std::ios::out) {
-        (void)which;
-        return seekoff(pos, std::ios_base::beg);
-    }
-
-private:
-    const std::vector<char>& _buffer;
-    int _beg, _end, _cur;
-};
-
 //Taken from https://github.com/PointCloudLibrary/pcl/blob/master/io/src/lzf.cpp
 unsigned int 
 lzfDecompress (const void *const in_data,  unsigned int in_len,
@@ -491,6 +767,32 @@ lzfDecompress (const void *const in_data,  unsigned int in_len,
 
   return (static_cast<unsigned int> (op - static_cast<unsigned char*> (out_data)));
 }
+
+bool findCoordinateFields(const std::vector<std::string>& fields,
+                          std::size_t& x, std::size_t& y, std::size_t& z)
+{
+    std::vector<std::string>::const_iterator ix = std::find(fields.begin(), fields.end(), "x");
+    std::vector<std::string>::const_iterator iy = std::find(fields.begin(), fields.end(), "y");
+    std::vector<std::string>::const_iterator iz = std::find(fields.begin(), fields.end(), "z");
+    if (ix == fields.end() || iy == fields.end() || iz == fields.end())
+        return false;
+    x = std::distance(fields.begin(), ix);
+    y = std::distance(fields.begin(), iy);
+    z = std::distance(fields.begin(), iz);
+    return true;
+}
+
+void addCoordinates(const Eigen::MatrixXd& data, std::size_t x, std::size_t y, std::size_t z,
+                    std::vector<Base::Vector3f>& block, PointStore& store)
+{
+    block.clear();
+    for (Eigen::Index i=0; i<data.rows(); i++) {
+        block.emplace_back(static_cast<float>(data(i,x)),
+                           static_cast<float>(data(i,y)),
+                           static_cast<float>(data(i,z)));
+    }
+    store.addPoints(block);
+}
 }
 
 PlyReader::PlyReader()
@@ -516,16 +818,25 @@ void PlyReader::read(const std::string& filename)
     std::vector<int> sizes;
     std::size_t offset = 0;
     std::size_t numPoints = readHeader(inp, format, offset, fields, types, sizes);
+    std::size_t start = static_cast<std::size_t>(inp.tellg());
+    inp.close();
 
+    // the data are parsed directly from the mapped file
+    Base::MappedFile file;
+    mapFile(file, filename);
+    const char* end = file.data() + file.size();
     Eigen::MatrixXd data(numPoints, fields.size());
     if (format == "ascii") {
-        readAscii(inp, offset, data);
-    }
-    else if (format == "binary_little_endian") {
-        readBinary(false, inp, offset, types, sizes, data);
-    }
-    else if (format == "binary_big_endian") {
-        readBinary(true, inp, offset, types, sizes, data);
+        readAsciiData(skipLines(file.data() + start, end, offset), end, data);
+    }
+    else if (format == "binary_little_endian" || format == "binary_big_endian") {
+        std::vector<BinaryField> layout;
+        for (std::size_t j=0; j<fields.size(); j++)
+            layout.push_back(plyField(types[j], sizes[j]));
+        std::size_t recordSize = interleavedLayout(layout);
+        if (start + offset + recordSize * numPoints > file.size())
+            throw Base::BadFormatError("File expects too many elements");
+        readBinaryData(file.data() + start + offset, layout, format == "binary_big_endian", data);
     }
 
     std::vector<std::string>::iterator it;
@@ -653,6 +964,51 @@ void PlyReader::read(const std::string& filename)
     }
 }
 
+void PlyReader::read(const std::string& filename, PointStore& store)
+{
+    clear();
+    points.clear();
+    this->width = 1;
+    this->height = 0;
+
+    Base::FileInfo fi(filename);
+    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+
+    std::string format;
+    std::vector<std::string> fields;
+    std::vector<std::string> types;
+    std::vector<int> sizes;
+    std::size_t offset = 0;
+    std::size_t numPoints = readHeader(inp, format, offset, fields, types, sizes);
+
+    std::size_t x, y, z;
+    if (!findCoordinateFields(fields, x, y, z))
+        return;
+
+    // the offset only applies to the first block
+    std::vector<Base::Vector3f> block;
+    for (std::size_t first = 0; first < numPoints; first += StoreBlockSize) {
+        Eigen::MatrixXd data(std::min(StoreBlockSize, numPoints - first), fields.size());
+        if (format == "ascii") {
+            readAscii(inp, offset, data);
+        }
+        else if (format == "binary_little_endian") {
+            readBinary(false, inp, offset, types, sizes, data);
+        }
+        else if (format == "binary_big_endian") {
+            readBinary(true, inp, offset, types, sizes, data);
+        }
+        else {
+            return;
+        }
+
+        offset = 0;
+        addCoordinates(data, x, y, z, block, store);
+    }
+
+    store.flush();
+}
+
 std::size_t PlyReader::readHeader(std::istream& in,
                                   std::string& format,
                                   std::size_t& offset,
@@ -828,7 +1184,7 @@ void PlyReader::readAscii(std::istream& inp, std::size_t offset, Eigen::MatrixXd
     std::size_t numPoints = data.rows();
     std::size_t numFields = data.cols();
     std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
+    while (row < numPoints && std::getline(inp, line)) {
         if (line.empty())
             continue;
 
@@ -960,27 +1316,43 @@ void PcdReader::read(const std::string& filename)
     std::vector<std::string> types;
     std::vector<int> sizes;
     std::size_t numPoints = readHeader(inp, format, fields, types, sizes);
+    std::size_t start = static_cast<std::size_t>(inp.tellg());
+    inp.close();
 
+    // the data are parsed directly from the mapped file
+    Base::MappedFile file;
+    mapFile(file, filename);
     Eigen::MatrixXd data(numPoints, fields.size());
     if (format == "ascii") {
-        readAscii(inp, data);
+        readAsciiData(file.data() + start, file.data() + file.size(), data);
     }
     else if (format == "binary") {
-        readBinary(false, inp, types, sizes, data);
+        std::vector<BinaryField> layout;
+        for (std::size_t j=0; j<fields.size(); j++)
+            layout.push_back(pcdField(types[j], sizes[j]));
+        std::size_t recordSize = interleavedLayout(layout);
+        if (start + recordSize * numPoints > file.size())
+            throw Base::BadFormatError("File expects too many elements");
+        readBinaryData(file.data() + start, layout, false, data);
     }
     else if (format == "binary_compressed") {
-        unsigned int c, u;
-        Base::InputStream str(inp);
-        str >> c >> u;
+        uint32_t c, u;
+        if (start + 2 * sizeof(uint32_t) > file.size())
+            throw Base::BadFormatError("File expects too many elements");
+        std::memcpy(&c, file.data() + start, sizeof(uint32_t));
+        std::memcpy(&u, file.data() + start + sizeof(uint32_t), sizeof(uint32_t));
+        if (start + 2 * sizeof(uint32_t) + c > file.size())
+            throw Base::BadFormatError("File expects too many elements");
 
-        std::vector<char> compressed(c);
-        inp.read(&compressed[0], c);
+        // the decompressed data are stored field by field
         std::vector<char> uncompressed(u);
-        if (lzfDecompress(&compressed[0], c, &uncompressed[0], u) == u) {
-            DataStreambuf ibuf(uncompressed);
-            std::istream istr(0);
-            istr.rdbuf(&ibuf);
-            readBinary(true, istr, types, sizes, data);
+        if (lzfDecompress(file.data() + start + 2 * sizeof(uint32_t), c, uncompressed.data(), u) == u) {
+            std::vector<BinaryField> layout;
+            for (std::size_t j=0; j<fields.size(); j++)
+                layout.push_back(pcdField(types[j], sizes[j]));
+            if (columnLayout(layout, numPoints) > uncompressed.size())
+                throw Base::BadFormatError("File expects too many elements");
+            readBinaryData(uncompressed.data(), layout, false, data);
         }
         else {
             throw Base::BadFormatError("Failed to decompress binary data");
@@ -1111,6 +1483,52 @@ void PcdReader::read(const std::string& filename)
     }
 }
 
+void PcdReader::read(const std::string& filename, PointStore& store)
+{
+    clear();
+    points.clear();
+    this->width = -1;
+    this->height = -1;
+
+    Base::FileInfo fi(filename);
+    Base::ifstream inp(fi, std::ios::in | std::ios::binary);
+
+    std::string format;
+    std::vector<std::string> fields;
+    std::vector<std::string> types;
+    std::vector<int> sizes;
+    std::size_t numPoints = readHeader(inp, format, fields, types, sizes);
+
+    // compressed data is stored field by field and must be decompressed at once
+    if (format == "binary_compressed") {
+        inp.close();
+        Reader::read(filename, store);
+        return;
+    }
+
+    std::size_t x, y, z;
+    if (!findCoordinateFields(fields, x, y, z))
+        return;
+
+    std::vector<Base::Vector3f> block;
+    for (std::size_t first = 0; first < numPoints; first += StoreBlockSize) {
+        Eigen::MatrixXd data(std::min(StoreBlockSize, numPoints - first), fields.size());
+        if (format == "ascii") {
+            readAscii(inp, data);
+        }
+        else if (format == "binary") {
+            readBinary(false, inp, types, sizes, data);
+        }
+        else {
+            return;
+        }
+
+        addCoordinates(data, x, y, z, block, store);
+    }
+
+    store.flush();
+}
+
 std::size_t PcdReader::readHeader(std::istream& in,
                                   std::string& format,
                                   std::vector<std::string>& fields,
@@ -1190,7 +1608,7 @@ void PcdReader::readAscii(std::istream& inp, Eigen::MatrixXd& data)
     std::size_t numPoints = data.rows();
     std::size_t numFields = data.cols();
     std::vector<std::string> list;
-    while (std::getline(inp, line) && row < numPoints) {
+    while (row < numPoints && std::getline(inp, line)) {
         if (line.empty())
             continue;
 
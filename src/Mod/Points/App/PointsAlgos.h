@@ -31,6 +31,8 @@
 namespace Points
 {
 
+class PointStore;
+
 /** The Points algorithms container class
  */
 class PointsExport PointsAlgos
@@ -42,6 +44,10 @@ public:
     /** Load a point cloud
      */
     static void LoadAscii(PointKernel&, const char *FileName);
+    /** Load a point cloud into a store. The file is read block-wise so that the whole
+     * cloud never needs to be in memory.
+     */
+    static void LoadAscii(PointStore&, const char *FileName);
 };
 
 class Reader
@@ -50,6 +56,11 @@ public:
     Reader();
     virtual ~Reader();
     virtual void read(const std::string& filename) = 0;
+    /** Reads the point coordinates of \a filename into \a store. The default implementation
+     * reads the whole file, readers that support it stream the points block-wise.
+     * Intensities, colors and normals are not transferred.
+     */
+    virtual void read(const std::string& filename, PointStore& store);
 
     void clear();
     const PointKernel& getPoints() const;
@@ -78,6 +89,7 @@ public:
     AscReader();
     ~AscReader();
     void read(const std::string& filename);
+    void read(const std::string& filename, PointStore& store);
 };
 
 class PlyReader : public Reader
@@ -86,6 +98,7 @@ public:
     PlyReader();
     ~PlyReader();
     void read(const std::string& filename);
+    void read(const std::string& filename, PointStore& store);
 
 private:
     std::size_t readHeader(std::istream&, std::string& format, std::size_t& offset,
@@ -104,6 +117,7 @@ public:
     PcdReader();
     ~PcdReader();
     void read(const std::string& filename);
+    void read(const std::string& filename, PointStore& store);
 
 private:
     std::size_t readHeader(std::istream&, std::string& format, std::vector<std::string>& fields,
@@ -0,0 +1,125 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2021 FreeCAD Developers
+#  LGPL
+
+"""
+Benchmarks for the points module.
+
+They are not part of the unit tests because they need large data sets.
+Run them from the FreeCAD Python console or with FreeCADCmd, e.g.
+
+    import PointsBenchmarks
+    PointsBenchmarks.benchmarkLoad("PLY", 10000000)
+
+The point clouds are created in the temp directory.
+"""
+
+import FreeCAD, Points
+import os, math, struct, sys, tempfile, time
+
+
+def peakMemory():
+    """Returns the peak resident set size of the process in MB or None if unknown"""
+    try:
+        import resource
+    except ImportError:
+        return None
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Linux reports kilobytes, macOS bytes
+    if sys.platform == "darwin":
+        return rss / (1024.0 * 1024.0)
+    return rss / 1024.0
+
+
+def report(title, count, unit, seconds):
+    """Prints the throughput and the peak memory usage of a benchmark"""
+    rate = count / seconds if seconds > 0 else float("inf")
+    msg = "{}: {} {} in {:.3f} s ({:.0f} {}/s)".format(title, count, unit, seconds, rate, unit)
+    mem = peakMemory()
+    if mem is not None:
+        msg += ", peak RSS {:.1f} MB".format(mem)
+    FreeCAD.Console.PrintMessage(msg + "\n")
+
+
+def cloud(count, block=100000):
+    """Yields blocks of points with normals on a wavy surface"""
+    size = int(math.sqrt(count)) + 1
+    pnts = []
+    for i in range(count):
+        x = float(i % size)
+        y = float(i // size)
+        pnts.append((x, y, math.sin(x * 0.1) * math.cos(y * 0.1), 0.0, 0.0, 1.0))
+        if len(pnts) == block:
+            yield pnts
+            pnts = []
+    if pnts:
+        yield pnts
+
+
+def writeCloud(name, fmt, count):
+    """Writes count points with normals as ASC, PLY (ascii), BPLY (binary), PCD (ascii) or BPCD (binary)"""
+    with open(name, "wb") as f:
+        if fmt in ("PLY", "BPLY"):
+            f.write("ply\nformat {} 1.0\nelement vertex {}\n".format(
+                "ascii" if fmt == "PLY" else "binary_little_endian", count).encode())
+            for field in ("x", "y", "z", "nx", "ny", "nz"):
+                f.write("property float {}\n".format(field).encode())
+            f.write(b"end_header\n")
+        elif fmt in ("PCD", "BPCD"):
+            f.write("VERSION .7\nFIELDS x y z normal_x normal_y normal_z\nSIZE 4 4 4 4 4 4\n"
+                    "TYPE F F F F F F\nCOUNT 1 1 1 1 1 1\nWIDTH {}\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\n"
+                    "POINTS {}\nDATA {}\n".format(count, count, "ascii" if fmt == "PCD" else "binary").encode())
+
+        for pnts in cloud(count):
+            if fmt in ("BPLY", "BPCD"):
+                f.write(b"".join(struct.pack("<6f", *p) for p in pnts))
+            elif fmt == "ASC":
+                f.write("".join("{:.4f} {:.4f} {:.4f}\n".format(*p[:3]) for p in pnts).encode())
+            else:
+                f.write("".join("{:.4f} {:.4f} {:.4f} {} {} {}\n".format(*p) for p in pnts).encode())
+
+
+def benchmarkLoad(fmt="PLY", count=1000000):
+    """Writes a synthetic point cloud in the given format (see writeCloud) and reports
+    points per second and the peak RSS of importing it."""
+    ext = {"ASC": "asc", "PLY": "ply", "BPLY": "ply", "PCD": "pcd", "BPCD": "pcd"}
+    name = tempfile.gettempdir() + os.sep + "benchmark_{}.{}".format(count, ext[fmt])
+    writeCloud(name, fmt, count)
+
+    doc = FreeCAD.newDocument()
+    start = time.time()
+    Points.insert(name, doc.Name)
+    seconds = time.time() - start
+    report("Load " + fmt, doc.Objects[-1].Points.CountPoints, "points", seconds)
+
+    FreeCAD.closeDocument(doc.Name)
+    os.remove(name)
+
+
+def benchmarkLevelOfDetail(fmt="BPLY", count=1000000, maxPoints=100000):
+    """Streams a synthetic point cloud through the out-of-core point store and
+    reports points per second of building a level of detail."""
+    ext = {"ASC": "asc", "PLY": "ply", "BPLY": "ply", "PCD": "pcd", "BPCD": "pcd"}
+    name = tempfile.gettempdir() + os.sep + "benchmark_{}.{}".format(count, ext[fmt])
+    writeCloud(name, fmt, count)
+
+    start = time.time()
+    lod = Points.readLevelOfDetail(name, maxPoints)
+    report("Level of detail " + fmt, count, "points", time.time() - start)
+
+    os.remove(name)
+    return lod
+
+
+def benchmarkNearestPoints(count=1000000, k=10):
+    """Builds a kd-tree over a synthetic point cloud and reports the throughput of
+    batched k-nearest neighbour queries for all of its points."""
+    kernel = Points.Points()
+    for pnts in cloud(count):
+        kernel.addPoints([p[:3] for p in pnts])
+
+    queries = [p[:3] for p in next(cloud(count, count))]
+    start = time.time()
+    neighbours = kernel.nearestPoints(queries, k)
+    report("Nearest {} points".format(k), len(neighbours), "queries", time.time() - start)
@@ -0,0 +1,350 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <cfloat>
+# include <cmath>
+# include <climits>
+# include <utility>
+#endif
+
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <Base/Converter.h>
+#include <Base/Parallel.h>
+
+#include "PointsKDTree.h"
+#include "Points.h"
+
+using namespace Points;
+
+namespace {
+const std::size_t LeafSize = 16;
+const int StackSize = 64;
+
+bool isValid(const Base::Vector3f& p)
+{
+    return !boost::math::isnan(p.x) && !boost::math::isnan(p.y) && !boost::math::isnan(p.z);
+}
+
+// minimum number of points of a batched query that are handled by one task
+const std::size_t QueryBlock = 256;
+}
+
+PointsKDTree::PointsKDTree(const PointKernel& kernel)
+{
+    std::vector<Base::Vector3f> pnts;
+    pnts.reserve(kernel.size());
+    for (PointKernel::const_point_iterator it = kernel.begin(); it != kernel.end(); ++it)
+        pnts.push_back(Base::convertTo<Base::Vector3f>(*it));
+    Build(pnts);
+}
+
+PointsKDTree::PointsKDTree(const std::vector<Base::Vector3f>& pnts)
+{
+    Build(pnts);
+}
+
+PointsKDTree::~PointsKDTree()
+{
+}
+
+std::size_t PointsKDTree::CountNodes(std::size_t count) const
+{
+    // the halves of a range differ by at most one point, so at each level there are at
+    // most two different sizes and the recursion only follows one of them
+    if (count <= LeafSize)
+        return 1;
+    std::size_t left = count / 2;
+    std::size_t right = count - left;
+    std::size_t nodesLeft = CountNodes(left);
+    std::size_t nodesRight = (left == right) ? nodesLeft : CountNodes(right);
+    return 1 + nodesLeft + nodesRight;
+}
+
+void PointsKDTree::Build(const std::vector<Base::Vector3f>& pnts)
+{
+    _indices.reserve(pnts.size());
+    for (std::size_t i = 0; i < pnts.size(); i++) {
+        if (isValid(pnts[i]))
+            _indices.push_back(i);
+    }
+
+    if (_indices.empty())
+        return;
+
+    _nodes.resize(CountNodes(_indices.size()));
+
+    // the upper levels are built in parallel
+    int depth = 0;
+    for (int threads = QThread::idealThreadCount(); threads > 1; threads /= 2)
+        depth++;
+    BuildNode(pnts, 0, 0, _indices.size(), depth > 0 ? depth + 1 : 0);
+
+    _points.resize(_indices.size());
+    for (std::size_t i = 0; i < _indices.size(); i++)
+        _points[i] = pnts[_indices[i]];
+}
+
+void PointsKDTree::BuildNode(const std::vector<Base::Vector3f>& pnts, std::size_t node,
+                             std::size_t first, std::size_t last, int depth)
+{
+    Node& n = _nodes[node];
+    n.bmin.Set(FLT_MAX, FLT_MAX, FLT_MAX);
+    n.bmax.Set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (std::size_t i = first; i < last; i++) {
+        const Base::Vector3f& p = pnts[_indices[i]];
+        n.bmin.Set(std::min(n.bmin.x, p.x), std::min(n.bmin.y, p.y), std::min(n.bmin.z, p.z));
+        n.bmax.Set(std::max(n.bmax.x, p.x), std::max(n.bmax.y, p.y), std::max(n.bmax.z, p.z));
+    }
+
+    std::size_t count = last - first;
+    if (count <= LeafSize) {
+        n.first = static_cast<uint32_t>(first);
+        n.count = static_cast<uint32_t>(count);
+        return;
+    }
+
+    // split at the median of the largest extent
+    Base::Vector3f ext = n.bmax - n.bmin;
+    unsigned short axis = 0;
+    if (ext.y > ext.x)
+        axis = 1;
+    if (ext.z > ext[axis])
+        axis = 2;
+
+    std::size_t mid = first + count / 2;
+    std::nth_element(_indices.begin() + first, _indices.begin() + mid, _indices.begin() + last,
+        [&pnts, axis](unsigned long a, unsigned long b) {
+            return pnts[a][axis] < pnts[b][axis];
+        });
+
+    std::size_t left = node + 1;
+    std::size_t right = left + CountNodes(mid - first);
+    n.first = static_cast<uint32_t>(right);
+    n.count = 0;
+
+    if (depth > 0) {
+        QFuture<void> future = QtConcurrent::run([this, &pnts, left, first, mid, depth]() {
+            BuildNode(pnts, left, first, mid, depth - 1);
+        });
+        BuildNode(pnts, right, mid, last, depth - 1);
+        future.waitForFinished();
+    }
+    else {
+        BuildNode(pnts, left, first, mid, 0);
+        BuildNode(pnts, right, mid, last, 0);
+    }
+}
+
+float PointsKDTree::SqrDistance(const Base::Vector3f& p, const Node& node) const
+{
+    float dx = std::max(std::max(node.bmin.x - p.x, p.x - node.bmax.x), 0.0f);
+    float dy = std::max(std::max(node.bmin.y - p.y, p.y - node.bmax.y), 0.0f);
+    float dz = std::max(std::max(node.bmin.z - p.z, p.z - node.bmax.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+unsigned long PointsKDTree::FindNearest(const Base::Vector3f& p, float& dist) const
+{
+    return FindNearest(p, FLT_MAX, dist);
+}
+
+unsigned long PointsKDTree::FindNearest(const Base::Vector3f& p, float maxDist, float& dist) const
+{
+    unsigned long index = ULONG_MAX;
+    if (_nodes.empty() || !isValid(p))
+        return index;
+
+    float best = (maxDist < FLT_MAX) ? maxDist * maxDist : FLT_MAX;
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = _nodes[stack[--top]];
+        if (SqrDistance(p, node) > best)
+            continue;
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                float d = Base::DistanceP2(p, _points[i]);
+                if (d <= best) {
+                    best = d;
+                    index = _indices[i];
+                }
+            }
+        }
+        else {
+            // visit the nearer child first
+            uint32_t left = static_cast<uint32_t>(&node - &_nodes[0]) + 1;
+            uint32_t right = node.first;
+            float dl = SqrDistance(p, _nodes[left]);
+            float dr = SqrDistance(p, _nodes[right]);
+            if (dl < dr) {
+                std::swap(left, right);
+                std::swap(dl, dr);
+            }
+            if (dl <= best)
+                stack[top++] = left;
+            if (dr <= best)
+                stack[top++] = right;
+        }
+    }
+
+    if (index != ULONG_MAX)
+        dist = std::sqrt(best);
+    return index;
+}
+
+void PointsKDTree::FindKNearest(const Base::Vector3f& p, std::size_t k,
+                                std::vector<unsigned long>& indices,
+                                std::vector<float>& distances) const
+{
+    indices.clear();
+    distances.clear();
+    if (_nodes.empty() || k == 0 || !isValid(p))
+        return;
+
+    // the k best candidates sorted by increasing squared distance
+    std::vector<std::pair<float, uint32_t> > best;
+    best.reserve(k + 1);
+    float worst = FLT_MAX;
+
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = _nodes[stack[--top]];
+        if (SqrDistance(p, node) > worst)
+            continue;
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                float d = Base::DistanceP2(p, _points[i]);
+                if (d < worst || best.size() < k) {
+                    std::pair<float, uint32_t> item(d, i);
+                    best.insert(std::upper_bound(best.begin(), best.end(), item), item);
+                    if (best.size() > k)
+                        best.pop_back();
+                    if (best.size() == k)
+                        worst = best.back().first;
+                }
+            }
+        }
+        else {
+            uint32_t left = static_cast<uint32_t>(&node - &_nodes[0]) + 1;
+            uint32_t right = node.first;
+            float dl = SqrDistance(p, _nodes[left]);
+            float dr = SqrDistance(p, _nodes[right]);
+            if (dl < dr) {
+                std::swap(left, right);
+                std::swap(dl, dr);
+            }
+            if (dl <= worst)
+                stack[top++] = left;
+            if (dr <= worst)
+                stack[top++] = right;
+        }
+    }
+
+    indices.reserve(best.size());
+    distances.reserve(best.size());
+    for (std::vector<std::pair<float, uint32_t> >::iterator it = best.begin(); it != best.end(); ++it) {
+        indices.push_back(_indices[it->second]);
+        distances.push_back(std::sqrt(it->first));
+    }
+}
+
+void PointsKDTree::FindInRange(const Base::Vector3f& p, float radius,
+                               std::vector<unsigned long>& indices) const
+{
+    indices.clear();
+    if (_nodes.empty() || !isValid(p))
+        return;
+
+    float sqrRadius = radius * radius;
+    uint32_t stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        const Node& node = _nodes[index];
+        if (SqrDistance(p, node) > sqrRadius)
+            continue;
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (Base::DistanceP2(p, _points[i]) <= sqrRadius)
+                    indices.push_back(_indices[i]);
+            }
+        }
+        else {
+            stack[top++] = node.first;
+            stack[top++] = index + 1;
+        }
+    }
+}
+
+void PointsKDTree::FindNearest(const std::vector<Base::Vector3f>& pnts,
+                               std::vector<unsigned long>& indices,
+                               std::vector<float>& distances) const
+{
+    indices.resize(pnts.size());
+    distances.resize(pnts.size());
+    Base::parallel_for(pnts.size(), QueryBlock, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            float dist = FLT_MAX;
+            indices[i] = FindNearest(pnts[i], dist);
+            distances[i] = dist;
+        }
+    });
+}
+
+void PointsKDTree::FindKNearest(const std::vector<Base::Vector3f>& pnts, std::size_t k,
+                                std::vector<unsigned long>& indices) const
+{
+    indices.assign(pnts.size() * k, ULONG_MAX);
+    Base::parallel_for(pnts.size(), QueryBlock, [&](std::size_t, std::size_t first, std::size_t last) {
+        std::vector<unsigned long> neighbours;
+        std::vector<float> distances;
+        for (std::size_t i = first; i < last; i++) {
+            FindKNearest(pnts[i], k, neighbours, distances);
+            std::copy(neighbours.begin(), neighbours.end(), indices.begin() + i * k);
+        }
+    });
+}
+
+void PointsKDTree::FindInRange(const std::vector<Base::Vector3f>& pnts, float radius,
+                               std::vector<std::vector<unsigned long> >& indices) const
+{
+    indices.clear();
+    indices.resize(pnts.size());
+    Base::parallel_for(pnts.size(), QueryBlock, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++)
+            FindInRange(pnts[i], radius, indices[i]);
+    });
+}
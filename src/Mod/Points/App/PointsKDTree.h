@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_KDTREE_H
+#define POINTS_KDTREE_H
+
+#include <cstdint>
+#include <vector>
+#include <Base/Vector3D.h>
+
+namespace Points
+{
+
+class PointKernel;
+
+/**
+ * The PointsKDTree class is a static kd-tree over a point cloud for nearest neighbour,
+ * k-nearest neighbour and radius queries.
+ *
+ * The points are reordered so that the points of a leaf are contiguous in memory and the
+ * nodes are stored in depth-first order, the left child directly follows its parent.
+ * Each node splits its points at the median of the axis with the largest extent and keeps
+ * the bounding box of its points for pruning. Points with NaN coordinates are not indexed
+ * and queries for them find nothing.
+ *
+ * All queries return the indices of the points in the original point cloud. The single
+ * queries are thread-safe, the batched queries process their points in parallel.
+ */
+class PointsExport PointsKDTree
+{
+public:
+    /// Indexes the transformed points of the kernel
+    PointsKDTree(const PointKernel&);
+    PointsKDTree(const std::vector<Base::Vector3f>&);
+    ~PointsKDTree();
+
+    /// Returns the number of indexed points
+    std::size_t Size() const
+    { return _points.size(); }
+    bool IsEmpty() const
+    { return _points.empty(); }
+
+    /** @name Single queries */
+    //@{
+    /** Returns the index of the point nearest to \a p and its distance in \a dist.
+     * If the tree is empty ULONG_MAX is returned.
+     */
+    unsigned long FindNearest(const Base::Vector3f& p, float& dist) const;
+    /** Returns the index of the point nearest to \a p that is not further away
+     * than \a maxDist. If there is no such point ULONG_MAX is returned.
+     */
+    unsigned long FindNearest(const Base::Vector3f& p, float maxDist, float& dist) const;
+    /** Searches for the \a k points nearest to \a p. The indices and distances are
+     * sorted by increasing distance.
+     */
+    void FindKNearest(const Base::Vector3f& p, std::size_t k,
+                      std::vector<unsigned long>& indices,
+                      std::vector<float>& distances) const;
+    /** Searches for all points in the sphere around \a p with \a radius.
+     * The indices are in no particular order.
+     */
+    void FindInRange(const Base::Vector3f& p, float radius,
+                     std::vector<unsigned long>& indices) const;
+    //@}
+
+    /** @name Batched queries */
+    //@{
+    /** Searches for the nearest point of each point in \a pnts. */
+    void FindNearest(const std::vector<Base::Vector3f>& pnts,
+                     std::vector<unsigned long>& indices,
+                     std::vector<float>& distances) const;
+    /** Searches for the \a k nearest points of each point in \a pnts. The neighbours of
+     * the i-th point are at the positions [i*k, (i+1)*k) of \a indices sorted by increasing
+     * distance. If the tree has less than \a k points the remaining positions are ULONG_MAX.
+     */
+    void FindKNearest(const std::vector<Base::Vector3f>& pnts, std::size_t k,
+                      std::vector<unsigned long>& indices) const;
+    /** Searches for all points in the sphere around each point in \a pnts. */
+    void FindInRange(const std::vector<Base::Vector3f>& pnts, float radius,
+                     std::vector<std::vector<unsigned long> >& indices) const;
+    //@}
+
+private:
+    struct Node
+    {
+        Base::Vector3f bmin, bmax;
+        uint32_t first;   // leaf: first point, inner node: right child
+        uint32_t count;   // leaf: number of points, inner node: 0
+    };
+
+    void Build(const std::vector<Base::Vector3f>& pnts);
+    void BuildNode(const std::vector<Base::Vector3f>& pnts, std::size_t node,
+                   std::size_t first, std::size_t last, int depth);
+    std::size_t CountNodes(std::size_t count) const;
+    float SqrDistance(const Base::Vector3f& p, const Node& node) const;
+
+    PointsKDTree(const PointsKDTree&);
+    void operator= (const PointsKDTree&);
+
+private:
+    std::vector<Base::Vector3f> _points;    /**< indexed points in leaf order */
+    std::vector<unsigned long> _indices;    /**< original index of each point */
+    std::vector<Node> _nodes;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_KDTREE_H
@@ -24,7 +24,9 @@
 #include "PreCompiled.h"
 
 #include "Mod/Points/App/Points.h"
+#include "Mod/Points/App/PointsKDTree.h"
 #include <Base/Builder3D.h>
+#include <Base/Converter.h>
 #include <Base/VectorPy.h>
 #include <Base/GeometryPyCXX.h>
 #include <boost/math/special_functions/fpclassify.hpp>
@@ -35,6 +37,29 @@
 
 using namespace Points;
 
+namespace {
+void getPointsFromSequence(PyObject* obj, std::vector<Base::Vector3f>& pnts)
+{
+    Py::Sequence list(obj);
+    union PyType_Object pyType = {&(Base::VectorPy::Type)};
+    Py::Type vType(pyType.o);
+
+    pnts.reserve(list.size());
+    for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+        if ((*it).isType(vType)) {
+            Py::Vector p(*it);
+            pnts.push_back(Base::convertTo<Base::Vector3f>(p.toVector()));
+        }
+        else {
+            Py::Tuple tuple(*it);
+            pnts.emplace_back(static_cast<float>((double)Py::Float(tuple[0])),
+                              static_cast<float>((double)Py::Float(tuple[1])),
+                              static_cast<float>((double)Py::Float(tuple[2])));
+        }
+    }
+}
+}
+
 // returns a string which represents the object e.g. when printed in python
 std::string PointsPy::representation(void) const
 {
@@ -227,6 +252,79 @@ PyObject* PointsPy::fromValid(PyObject * args)
     }
 }
 
+PyObject* PointsPy::nearestPoints(PyObject * args)
+{
+    PyObject *obj;
+    int k = 1;
+    if (!PyArg_ParseTuple(args, "O|i", &obj, &k))
+        return 0;
+
+    if (k < 1) {
+        PyErr_SetString(PyExc_ValueError, "k must be positive");
+        return 0;
+    }
+
+    std::vector<Base::Vector3f> pnts;
+    try {
+        getPointsFromSequence(obj, pnts);
+    }
+    catch (const Py::Exception&) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, "either expect\n"
+            "-- [Vector,...] \n"
+            "-- [(x,y,z),...]");
+        return 0;
+    }
+
+    PointsKDTree tree(*getPointKernelPtr());
+    std::vector<unsigned long> indices;
+    tree.FindKNearest(pnts, static_cast<std::size_t>(k), indices);
+
+    std::size_t num = std::min(static_cast<std::size_t>(k), tree.Size());
+    Py::List list;
+    for (std::size_t i = 0; i < pnts.size(); i++) {
+        Py::Tuple tuple(num);
+        for (std::size_t j = 0; j < num; j++)
+            tuple.setItem(j, Py::Long(indices[i * k + j]));
+        list.append(tuple);
+    }
+
+    return Py::new_reference_to(list);
+}
+
+PyObject* PointsPy::pointsInRadius(PyObject * args)
+{
+    PyObject *obj;
+    double radius;
+    if (!PyArg_ParseTuple(args, "Od", &obj, &radius))
+        return 0;
+
+    std::vector<Base::Vector3f> pnts;
+    try {
+        getPointsFromSequence(obj, pnts);
+    }
+    catch (const Py::Exception&) {
+        PyErr_SetString(Base::BaseExceptionFreeCADError, "either expect\n"
+            "-- [Vector,...] \n"
+            "-- [(x,y,z),...]");
+        return 0;
+    }
+
+    PointsKDTree tree(*getPointKernelPtr());
+    std::vector<std::vector<unsigned long> > indices;
+    tree.FindInRange(pnts, static_cast<float>(radius), indices);
+
+    Py::List list;
+    for (std::vector<std::vector<unsigned long> >::iterator it = indices.begin(); it != indices.end(); ++it) {
+        std::sort(it->begin(), it->end());
+        Py::Tuple tuple(it->size());
+        for (std::size_t j = 0; j < it->size(); j++)
+            tuple.setItem(j, Py::Long((*it)[j]));
+        list.append(tuple);
+    }
+
+    return Py::new_reference_to(list);
+}
+
 Py::Long PointsPy::getCountPoints(void) const
 {
     return Py::Long((long)getPointKernelPtr()->size());
@@ -0,0 +1,131 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2021 FreeCAD Developers
+#  LGPL
+
+import FreeCAD, unittest, Points
+import os, random, tempfile
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD points module
+#---------------------------------------------------------------------------
+
+
+def key(v):
+    return (v.x, v.y, v.z)
+
+
+class PointStoreTestCases(unittest.TestCase):
+    def setUp(self):
+        # random points in 4x4x4 tiles with the edge length 10
+        rnd = random.Random(0)
+        pnts = []
+        for i in range(20000):
+            pnts.append(FreeCAD.Vector(rnd.uniform(0.0, 40.0), rnd.uniform(0.0, 40.0), rnd.uniform(0.0, 40.0)))
+        self.points = Points.Points(pnts)
+        self.keys = sorted(map(key, self.points.Points))
+
+    def createStore(self, budget):
+        store = Points.PointStore(budget, 10.0)
+        store.addPoints(self.points)
+        return store
+
+    def testRoundTrip(self):
+        store = self.createStore(1000000)
+        self.assertEqual(store.CountPoints, 20000)
+        self.assertEqual(store.CountTiles, 64)
+        points = store.toPoints().Points
+        self.assertEqual(sorted(map(key, points)), self.keys)
+        for i in range(0, store.CountPoints, 997):
+            self.assertEqual(key(store.getPoint(i)), key(points[i]))
+
+    def testMemoryBudget(self):
+        # half of the budget, i.e. 1000 points, is used for buffered points and the
+        # other half for mapped tiles which have about 300 points each
+        budget = 24000
+        store = self.createStore(budget)
+        self.assertLessEqual(store.MemSize, budget)
+        for i in range(0, store.CountPoints, 50):
+            store.getPoint(i)
+            self.assertLessEqual(store.MemSize, budget)
+        self.assertEqual(sorted(map(key, store.toPoints().Points)), self.keys)
+        self.assertLessEqual(store.MemSize, budget)
+
+    def testLevelOfDetail(self):
+        store = self.createStore(1000000)
+        for count in (1, 100, 1000, 5000):
+            lod = store.getLevelOfDetail(count)
+            self.assertEqual(lod.CountPoints, count)
+        self.assertEqual(store.getLevelOfDetail(100000).CountPoints, 20000)
+
+        keys = set(self.keys)
+        for p in store.getLevelOfDetail(100).Points:
+            self.assertIn(key(p), keys)
+
+    def testRegion(self):
+        # a region of about 2x2x2 tiles pages in only a part of the cloud
+        budget = 24000
+        store = self.createStore(budget)
+        box = FreeCAD.BoundBox(5.0, 5.0, 5.0, 25.0, 25.0, 25.0)
+        region = store.toPoints(box)
+        self.assertLessEqual(store.MemSize, budget)
+        inside = [k for k in self.keys if box.isInside(FreeCAD.Vector(*k))]
+        self.assertEqual(sorted(map(key, region.Points)), inside)
+        self.assertEqual(store.toPoints(FreeCAD.BoundBox(50.0, 50.0, 50.0, 60.0, 60.0, 60.0)).CountPoints, 0)
+
+    def testReadLevelOfDetail(self):
+        name = tempfile.gettempdir() + os.sep + "points_lod.asc"
+        self.points.write(name)
+        lod = Points.readLevelOfDetail(name, 1000)
+        os.remove(name)
+        self.assertEqual(lod.CountPoints, 1000)
+
+
+class PointsKDTreeTestCases(unittest.TestCase):
+    def setUp(self):
+        rnd = random.Random(0)
+        # a uniform cloud and a flat one with duplicated points
+        cube = [FreeCAD.Vector(rnd.uniform(-5.0, 5.0), rnd.uniform(-5.0, 5.0), rnd.uniform(-5.0, 5.0))
+                for i in range(3000)]
+        plane = [FreeCAD.Vector(rnd.uniform(0.0, 10.0), rnd.uniform(0.0, 10.0), 0.0) for i in range(1500)]
+        plane += plane[:500]
+        self.clouds = [Points.Points(cube), Points.Points(plane)]
+        self.queries = [FreeCAD.Vector(rnd.uniform(-6.0, 11.0), rnd.uniform(-6.0, 11.0), rnd.uniform(-1.0, 1.0))
+                        for i in range(50)]
+
+    def distances(self, points, query):
+        # the query point has float precision like the points of the cloud
+        q = Points.Points([query]).Points[0]
+        return [(p - q).Length for p in points]
+
+    def testNearestPoints(self):
+        k = 8
+        for cloud in self.clouds:
+            points = cloud.Points
+            result = cloud.nearestPoints(self.queries, k)
+            self.assertEqual(len(result), len(self.queries))
+            for query, indices in zip(self.queries, result):
+                dist = self.distances(points, query)
+                self.assertEqual(len(indices), k)
+                self.assertEqual(len(set(indices)), k)
+                # ties may be resolved differently, so the distances are compared
+                expected = sorted(dist)[:k]
+                for index, d in zip(indices, expected):
+                    self.assertAlmostEqual(dist[index], d, 4)
+
+    def testPointsInRadius(self):
+        radius = 1.5
+        eps = 1e-4
+        for cloud in self.clouds:
+            points = cloud.Points
+            result = cloud.pointsInRadius(self.queries, radius)
+            self.assertEqual(len(result), len(self.queries))
+            for query, indices in zip(self.queries, result):
+                dist = self.distances(points, query)
+                found = set(indices)
+                self.assertEqual(len(found), len(indices))
+                inside = set(i for i, d in enumerate(dist) if d < radius - eps)
+                near = set(i for i, d in enumerate(dist) if d <= radius + eps)
+                self.assertTrue(inside.issubset(found))
+                self.assertTrue(found.issubset(near))
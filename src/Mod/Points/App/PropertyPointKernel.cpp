@@ -43,6 +43,9 @@ TYPESYSTEM_SOURCE(Points::PropertyPointKernel , App::PropertyComplexGeoData)
 
 PropertyPointKernel::PropertyPointKernel()
     : _cPoints(new PointKernel())
+    , lazyFile([this](Base::Reader &reader) {
+        _cPoints->RestoreDocFile(reader);
+    })
 {
 
 }
@@ -54,27 +57,32 @@ PropertyPointKernel::~PropertyPointKernel()
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    lazyFile.reset();
     *_cPoints = m;
     hasSetValue();
 }
 
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
+    lazyFile.read();
     return *_cPoints;
 }
 
 const Data::ComplexGeoData* PropertyPointKernel::getComplexData() const
 {
+    lazyFile.read();
     return _cPoints;
 }
 
 Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 {
+    lazyFile.read();
     return _cPoints->getBoundBox();
 }
 
 PyObject *PropertyPointKernel::getPyObject(void)
 {
+    lazyFile.read();
     PointsPy* points = new PointsPy(&*_cPoints);
     points->setConst(); // set immutable
     return points;
@@ -95,7 +103,12 @@ void PropertyPointKernel::setPyObject(PyObject *value)
 
 void PropertyPointKernel::Save (Base::Writer &writer) const
 {
-    _cPoints->Save(writer);
+    // register the property instead of the kernel, see getLazyFile()
+    if (!writer.isForceXML()) {
+        writer.Stream() << writer.ind()
+            << "<Points file=\"" << writer.addFile(writer.ObjectName.c_str(), this) << "\" "
+            << "mtrx=\"" << _cPoints->getTransform().toString() << "\"/>" << std::endl;
+    }
 }
 
 void PropertyPointKernel::Restore(Base::XMLReader &reader)
@@ -121,19 +134,26 @@ void PropertyPointKernel::Restore(Base::XMLReader &reader)
 
 void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
 {
-    // does nothing
-    (void)writer;
+    lazyFile.read();
+    _cPoints->SaveDocFile(writer);
 }
 
 void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    lazyFile.reset();
     _cPoints->RestoreDocFile(reader);
     hasSetValue();
 }
 
+Base::LazyFile* PropertyPointKernel::getLazyFile() const
+{
+    return &lazyFile;
+}
+
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    lazyFile.read();
     PropertyPointKernel* prop = new PropertyPointKernel();
     (*prop->_cPoints) = (*this->_cPoints);
     return prop;
@@ -142,18 +162,21 @@ App::Property *PropertyPointKernel::Copy(void) const
 void PropertyPointKernel::Paste(const App::Property &from)
 {
     aboutToSetValue();
+    lazyFile.reset();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
-    *(this->_cPoints) = *(prop._cPoints);
+    *(this->_cPoints) = prop.getValue();
     hasSetValue();
 }
 
 unsigned int PropertyPointKernel::getMemSize (void) const
 {
+    lazyFile.read();
     return sizeof(Base::Vector3f) * this->_cPoints->size();
 }
 
 PointKernel* PropertyPointKernel::startEditing()
 {
+    lazyFile.read();
     aboutToSetValue();
     return static_cast<PointKernel*>(_cPoints);
 }
@@ -166,6 +189,7 @@ void PropertyPointKernel::finishEditing()
 void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndices )
 {
     // We need a sorted array
+    lazyFile.read();
     std::vector<unsigned long> uSortedInds = uIndices;
     std::sort(uSortedInds.begin(), uSortedInds.end());
 
@@ -193,6 +217,7 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    lazyFile.read();
     aboutToSetValue();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
@@ -75,6 +75,7 @@ public:
     void Restore(Base::XMLReader &reader);
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    Base::LazyFile* getLazyFile() const;
     //@}
 
     /** @name Modification */
@@ -88,6 +89,7 @@ public:
 
 private:
     Base::Reference<PointKernel> _cPoints;
+    mutable Base::LazyFile lazyFile;
 };
 
 } // namespace Points
@@ -32,6 +32,7 @@
 #include <Base/Converter.h>
 #include <Base/Interpreter.h>
 #include <Base/PyObjectBase.h>
+#include <Base/Tools.h>
 #include <Base/GeometryPyCXX.h>
 
 #include <CXX/Extensions.hxx>
@@ -48,6 +49,7 @@
 #include "RegionGrowing.h"
 #include "Segmentation.h"
 #include "SampleConsensus.h"
+#include "ShapeDetection.h"
 #if defined(HAVE_PCL_FILTERS)
 #include <pcl/filters/passthrough.h>
 #include <pcl/filters/voxel_grid.h>
@@ -83,7 +85,9 @@ public:
         add_keyword_method("approxSurface",&Module::approxSurface,
             "approxSurface(Points=,UDegree=3,VDegree=3,NbUPoles=6,NbVPoles=6,Smooth=True,\n"
             "Weight=0.1,Grad=1.0,Bend=0.0,\n"
-            "Iterations=5,Correction=True,PatchFactor=1.0)"
+            "Iterations=5,Correction=True,PatchFactor=1.0,Sparse=True)\n"
+            "Sparse solves the banded normal equations with a sparse Cholesky decomposition,\n"
+            "otherwise the former dense solvers are used."
         );
 #if defined(HAVE_PCL_SURFACE)
         add_keyword_method("triangulate",&Module::triangulate,
@@ -114,11 +118,15 @@ public:
         add_keyword_method("filterVoxelGrid",&Module::filterVoxelGrid,
             "filterVoxelGrid(dim)."
         );
+#endif
         add_keyword_method("normalEstimation",&Module::normalEstimation,
-            "normalEstimation(Points,[KSearch=0, SearchRadius=0]) -> Normals\n"
+            "normalEstimation(Points,[KSearch=0, SearchRadius=0, PropagateOrientation=False, UsePCL=False]) -> Normals\n"
             "KSearch is an int and used to search the k-nearest neighbours in\n"
             "the k-d tree. Alternatively, SearchRadius (a float) can be used\n"
             "as spatial distance to determine the neighbours of a point\n"
+            "If PropagateOrientation is True the normals are oriented consistently\n"
+            "along the neighbourhood graph instead of towards the origin.\n"
+            "UsePCL selects the former implementation based on PCL if available.\n"
             "Example:\n"
             "\n"
             "import ReverseEngineering as Reen\n"
@@ -132,11 +140,39 @@ public:
             "f.ViewObject.Proxy=0\n"
             "f.ViewObject.DisplayMode=1\n"
         );
-#endif
-#if defined(HAVE_PCL_SEGMENTATION)
         add_keyword_method("regionGrowingSegmentation",&Module::regionGrowingSegmentation,
-            "regionGrowingSegmentation()."
+            "regionGrowingSegmentation(Points,[KSearch=5, Normals, Neighbours=30, Smoothness=3,\n"
+            "                          MinClusterSize=50, MaxClusterSize=1000000, UsePCL=False]) -> list of index tuples\n"
+            "Splits the points into smooth regions. If no normals are given they are\n"
+            "estimated with KSearch neighbours. Neighbouring points are in the same region\n"
+            "if the angle between their normals is below Smoothness (in degrees).\n"
+            "UsePCL selects the former implementation based on PCL if available.\n"
         );
+        add_keyword_method("detectShapes",&Module::detectShapes,
+            "detectShapes(Points,[Normals, Primitives=('Plane','Cylinder','Sphere','Cone','Torus'), KSearch=10,\n"
+            "             Epsilon=0, ClusterEpsilon=0, NormalThreshold=25, MinSupport=0, Probability=0.01]) -> list of dicts\n"
+            "Detects primitive shapes in a points or mesh object with the efficient RANSAC method.\n"
+            "If no normals are given they are estimated with KSearch neighbours for points and\n"
+            "are the vertex normals for meshes. Epsilon is the maximum distance of a point to its\n"
+            "shape (default 1% of the bounding box diagonal), ClusterEpsilon the maximum distance\n"
+            "of neighbouring points of a shape, NormalThreshold the maximum deviation of the normals\n"
+            "in degrees and MinSupport the minimum number of points (default 1% of all points).\n"
+            "Each dict has the Type, the Parameters in the local coordinate system and the indices\n"
+            "of the Points. Segment holds these points as a points object that can be shown with\n"
+            "Points.show(). For meshes Facets holds the connected facet regions of the shape.\n"
+            "The parameters are: Plane: base, normal; Cylinder: base, axis, radius;\n"
+            "Sphere: center, radius; Cone: apex, axis, half angle in radians;\n"
+            "Torus: center, axis, major radius, minor radius\n"
+        );
+        add_keyword_method("marchingCubes",&Module::marchingCubes,
+            "marchingCubes(Points,[KSearch=10, Normals, CellSize=0, BlockSize=16]) -> Mesh\n"
+            "Reconstructs a surface from a point cloud with marching cubes over a sparse signed\n"
+            "distance volume. The volume is split into blocks of BlockSize cubes which are processed\n"
+            "in parallel. CellSize is the edge length of the cubes, by default twice the mean\n"
+            "distance between neighbouring points. If no normals are given they are estimated with\n"
+            "KSearch neighbours and oriented consistently. The facets point to the side of the normals.\n"
+        );
+#if defined(HAVE_PCL_SEGMENTATION)
         add_keyword_method("featureSegmentation",&Module::featureSegmentation,
             "featureSegmentation()."
         );
@@ -171,15 +207,17 @@ private:
         int iteration = 5;
         PyObject* correction = Py_True;
         double factor = 1.0;
+        PyObject* sparse = Py_True;
 
         static char* kwds_approx[] = {"Points", "UDegree", "VDegree", "NbUPoles", "NbVPoles",
                                       "Smooth", "Weight", "Grad", "Bend", "Curv",
-                                      "Iterations", "Correction", "PatchFactor","UVDirs", NULL};
-        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O|iiiiO!ddddiO!dO!",kwds_approx,
+                                      "Iterations", "Correction", "PatchFactor","UVDirs",
+                                      "Sparse", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O|iiiiO!ddddiO!dO!O!",kwds_approx,
                                         &o,&uDegree,&vDegree,&uPoles,&vPoles,
                                         &PyBool_Type,&smooth,&weight,&grad,&bend,&curv,
                                         &iteration,&PyBool_Type,&correction,&factor,
-                                        &PyTuple_Type,&uvdirs))
+                                        &PyTuple_Type,&uvdirs,&PyBool_Type,&sparse))
             throw Py::Exception();
 
         int uOrder = uDegree + 1;
@@ -251,6 +289,7 @@ private:
                 pc.SetUV(u, v);
             }
             pc.EnableSmoothing(PyObject_IsTrue(smooth) ? true : false, weight, grad, bend, curv);
+            pc.EnableSparseSolver(PyObject_IsTrue(sparse) ? true : false);
             hSurf = pc.CreateSurface(clPoints, iteration, PyObject_IsTrue(correction) ? true : false, factor);
             if (!hSurf.IsNull()) {
                 return Py::asObject(new Part::BSplineSurfacePy(new Part::GeomBSplineSurface(hSurf)));
@@ -630,17 +669,20 @@ Mesh.show(m)
         return Py::asObject(new Points::PointsPy(points_sample));
     }
 #endif
-#if defined(HAVE_PCL_FILTERS)
     Py::Object normalEstimation(const Py::Tuple& args, const Py::Dict& kwds)
     {
         PyObject *pts;
         int ksearch=0;
         double searchRadius=0;
+        PyObject *propagate = Py_False;
+        PyObject *usePCL = Py_False;
 
-        static char* kwds_normals[] = {"Points", "KSearch", "SearchRadius", NULL};
-        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!|id", kwds_normals,
+        static char* kwds_normals[] = {"Points", "KSearch", "SearchRadius", "PropagateOrientation", "UsePCL", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!|idO!O!", kwds_normals,
                                         &(Points::PointsPy::Type), &pts,
-                                        &ksearch, &searchRadius))
+                                        &ksearch, &searchRadius,
+                                        &PyBool_Type, &propagate,
+                                        &PyBool_Type, &usePCL))
             throw Py::Exception();
 
         Points::PointKernel* points = static_cast<Points::PointsPy*>(pts)->getPointKernelPtr();
@@ -649,7 +691,22 @@ Mesh.show(m)
         NormalEstimation estimate(*points);
         estimate.setKSearch(ksearch);
         estimate.setSearchRadius(searchRadius);
-        estimate.perform(normals);
+        estimate.setPropagateOrientation(PyObject_IsTrue(propagate) ? true : false);
+        try {
+            if (PyObject_IsTrue(usePCL)) {
+#if defined(HAVE_PCL_FILTERS)
+                estimate.performPCL(normals);
+#else
+                throw Py::RuntimeError("ReverseEngineering is built without PCL");
+#endif
+            }
+            else {
+                estimate.perform(normals);
+            }
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
+        }
 
         Py::List list;
         for (std::vector<Base::Vector3d>::iterator it = normals.begin(); it != normals.end(); ++it) {
@@ -658,36 +715,70 @@ Mesh.show(m)
 
         return list;
     }
-#endif
-#if defined(HAVE_PCL_SEGMENTATION)
     Py::Object regionGrowingSegmentation(const Py::Tuple& args, const Py::Dict& kwds)
     {
         PyObject *pts;
         PyObject *vec = 0;
         int ksearch=5;
-
-        static char* kwds_segment[] = {"Points", "KSearch", "Normals", NULL};
-        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!|iO", kwds_segment,
+        int neighbours=30;
+        double smoothness=3.0;
+        int minSize=50;
+        int maxSize=1000000;
+        PyObject *usePCL = Py_False;
+
+        static char* kwds_segment[] = {"Points", "KSearch", "Normals", "Neighbours", "Smoothness",
+                                       "MinClusterSize", "MaxClusterSize", "UsePCL", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!|iOidiiO!", kwds_segment,
                                         &(Points::PointsPy::Type), &pts,
-                                        &ksearch, &vec))
+                                        &ksearch, &vec, &neighbours, &smoothness,
+                                        &minSize, &maxSize, &PyBool_Type, &usePCL))
             throw Py::Exception();
 
         Points::PointKernel* points = static_cast<Points::PointsPy*>(pts)->getPointKernelPtr();
 
         std::list<std::vector<int> > clusters;
         RegionGrowing segm(*points, clusters);
+        segm.setNumberOfNeighbours(neighbours);
+        segm.setSmoothnessThreshold(Base::toRadians<double>(smoothness));
+        segm.setClusterSize(static_cast<std::size_t>(std::max(minSize, 0)),
+                            static_cast<std::size_t>(std::max(maxSize, 0)));
+
+        std::vector<Base::Vector3f> normals;
         if (vec) {
             Py::Sequence list(vec);
-            std::vector<Base::Vector3f> normals;
             normals.reserve(list.size());
             for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
                 Base::Vector3d v = Py::Vector(*it).toVector();
                 normals.push_back(Base::convertTo<Base::Vector3f>(v));
             }
-            segm.perform(normals);
         }
-        else {
-            segm.perform(ksearch);
+
+        try {
+            if (PyObject_IsTrue(usePCL)) {
+#if defined(HAVE_PCL_SEGMENTATION)
+                // both implementations get the same normals
+                if (!vec) {
+                    std::vector<Base::Vector3d> normalsd;
+                    NormalEstimation estimate(*points);
+                    estimate.setKSearch(ksearch);
+                    estimate.perform(normalsd);
+                    for (std::vector<Base::Vector3d>::iterator it = normalsd.begin(); it != normalsd.end(); ++it)
+                        normals.push_back(Base::convertTo<Base::Vector3f>(*it));
+                }
+                segm.performPCL(normals);
+#else
+                throw Py::RuntimeError("ReverseEngineering is built without PCL");
+#endif
+            }
+            else if (vec) {
+                segm.perform(normals);
+            }
+            else {
+                segm.perform(ksearch);
+            }
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
         }
 
         Py::List lists;
@@ -701,6 +792,192 @@ Mesh.show(m)
 
         return lists;
     }
+    Py::Object detectShapes(const Py::Tuple& args, const Py::Dict& kwds)
+    {
+        PyObject *obj;
+        PyObject *vec = 0;
+        PyObject *types = 0;
+        int ksearch=10;
+        double epsilon=0.0;
+        double clusterEpsilon=0.0;
+        double normalThreshold=25.0;
+        int minSupport=0;
+        double probability=0.01;
+
+        static char* kwds_detect[] = {"Points", "Normals", "Primitives", "KSearch", "Epsilon",
+                                      "ClusterEpsilon", "NormalThreshold", "MinSupport",
+                                      "Probability", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O|OOidddid", kwds_detect,
+                                        &obj, &vec, &types, &ksearch, &epsilon, &clusterEpsilon,
+                                        &normalThreshold, &minSupport, &probability))
+            throw Py::Exception();
+
+        std::vector<ShapeDetection::Primitive> primitives;
+        if (types) {
+            Py::Sequence list(types);
+            for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                std::string name = static_cast<std::string>(Py::String(*it));
+                if (name == "Plane")
+                    primitives.push_back(ShapeDetection::Plane);
+                else if (name == "Cylinder")
+                    primitives.push_back(ShapeDetection::Cylinder);
+                else if (name == "Sphere")
+                    primitives.push_back(ShapeDetection::Sphere);
+                else if (name == "Cone")
+                    primitives.push_back(ShapeDetection::Cone);
+                else if (name == "Torus")
+                    primitives.push_back(ShapeDetection::Torus);
+                else
+                    throw Py::ValueError("Unknown primitive: " + name);
+            }
+        }
+
+        std::vector<Base::Vector3f> normals;
+        if (vec) {
+            Py::Sequence list(vec);
+            normals.reserve(list.size());
+            for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                Base::Vector3d v = Py::Vector(*it).toVector();
+                normals.push_back(Base::convertTo<Base::Vector3f>(v));
+            }
+        }
+
+        const MeshCore::MeshKernel* kernel = 0;
+        std::vector<Base::Vector3f> points;
+        Base::Matrix4D transform;
+        try {
+            if (PyObject_TypeCheck(obj, &(Points::PointsPy::Type))) {
+                const Points::PointKernel* pts = static_cast<Points::PointsPy*>(obj)->getPointKernelPtr();
+                points = pts->getBasicPoints();
+                transform = pts->getTransform();
+                if (!vec) {
+                    std::vector<Base::Vector3d> normalsd;
+                    NormalEstimation estimate(*pts);
+                    estimate.setKSearch(ksearch);
+                    estimate.perform(normalsd);
+                    normals.reserve(normalsd.size());
+                    for (std::vector<Base::Vector3d>::iterator it = normalsd.begin(); it != normalsd.end(); ++it)
+                        normals.push_back(Base::convertTo<Base::Vector3f>(*it));
+                }
+            }
+            else if (PyObject_TypeCheck(obj, &(Mesh::MeshPy::Type))) {
+                const Mesh::MeshObject* mesh = static_cast<Mesh::MeshPy*>(obj)->getMeshObjectPtr();
+                kernel = &mesh->getKernel();
+                transform = mesh->getTransform();
+                const MeshCore::MeshPointArray& pts = kernel->GetPoints();
+                points.insert(points.end(), pts.begin(), pts.end());
+                if (!vec)
+                    normals = kernel->CalcVertexNormals();
+            }
+            else {
+                throw Py::TypeError("Points or Mesh object expected");
+            }
+
+            ShapeDetection detector(points, normals);
+            if (!primitives.empty())
+                detector.setPrimitives(primitives);
+            detector.setEpsilon(epsilon);
+            detector.setClusterEpsilon(clusterEpsilon);
+            detector.setNormalThreshold(Base::toRadians<double>(normalThreshold));
+            detector.setMinSupport(static_cast<std::size_t>(std::max(minSupport, 0)));
+            detector.setProbability(probability);
+
+            std::vector<ShapeDetection::Shape> shapes;
+            detector.perform(shapes);
+
+            Py::List list;
+            for (std::size_t i = 0; i < shapes.size(); i++) {
+                const ShapeDetection::Shape& shape = shapes[i];
+                Py::Dict dict;
+                dict.setItem(Py::String("Type"), Py::String(ShapeDetection::getTypeName(shape.type)));
+                Py::Tuple parameters(shape.parameters.size());
+                for (std::size_t j = 0; j < shape.parameters.size(); j++)
+                    parameters.setItem(j, Py::Float(shape.parameters[j]));
+                dict.setItem(Py::String("Parameters"), parameters);
+                Py::Tuple indices(shape.points.size());
+                for (std::size_t j = 0; j < shape.points.size(); j++)
+                    indices.setItem(j, Py::Long(static_cast<unsigned long>(shape.points[j])));
+                dict.setItem(Py::String("Points"), indices);
+
+                // the inliers in the same coordinate system as the input
+                Points::PointKernel* segment = new Points::PointKernel();
+                segment->setTransform(transform);
+                std::vector<Base::Vector3f>& inliers = segment->getBasicPoints();
+                inliers.reserve(shape.points.size());
+                for (std::size_t j = 0; j < shape.points.size(); j++)
+                    inliers.push_back(points[shape.points[j]]);
+                dict.setItem(Py::String("Segment"), Py::asObject(new Points::PointsPy(segment)));
+
+                // the connected facet regions of the shape on a mesh
+                if (kernel) {
+                    std::vector<MeshCore::MeshSurfaceSegmentPtr> segm;
+                    segm.emplace_back(std::make_shared<ShapeSurfaceSegment>
+                        (*kernel, detector.getLabels(), static_cast<int>(i), shape.type, 1));
+                    MeshCore::MeshSegmentAlgorithm finder(*kernel);
+                    finder.FindSegments(segm);
+
+                    Py::List facets;
+                    const std::vector<MeshCore::MeshSegment>& data = segm.front()->GetSegments();
+                    for (std::vector<MeshCore::MeshSegment>::const_iterator it = data.begin(); it != data.end(); ++it) {
+                        Py::Tuple ary(it->size());
+                        for (std::size_t j = 0; j < it->size(); j++)
+                            ary.setItem(j, Py::Long((*it)[j]));
+                        facets.append(ary);
+                    }
+                    dict.setItem(Py::String("Facets"), facets);
+                }
+
+                list.append(dict);
+            }
+
+            return list;
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
+        }
+    }
+    Py::Object marchingCubes(const Py::Tuple& args, const Py::Dict& kwds)
+    {
+        PyObject *pts;
+        PyObject *vec = 0;
+        int ksearch=10;
+        double cellSize=0.0;
+        int blockSize=16;
+
+        static char* kwds_cubes[] = {"Points", "KSearch", "Normals", "CellSize", "BlockSize", NULL};
+        if (!PyArg_ParseTupleAndKeywords(args.ptr(), kwds.ptr(), "O!|iOdi", kwds_cubes,
+                                        &(Points::PointsPy::Type), &pts,
+                                        &ksearch, &vec, &cellSize, &blockSize))
+            throw Py::Exception();
+
+        Points::PointKernel* points = static_cast<Points::PointsPy*>(pts)->getPointKernelPtr();
+
+        std::unique_ptr<Mesh::MeshObject> mesh(new Mesh::MeshObject());
+        TiledMarchingCubes cubes(*points, *mesh);
+        cubes.setCellSize(cellSize);
+        cubes.setBlockSize(blockSize);
+        try {
+            if (vec) {
+                Py::Sequence list(vec);
+                std::vector<Base::Vector3f> normals;
+                normals.reserve(list.size());
+                for (Py::Sequence::iterator it = list.begin(); it != list.end(); ++it) {
+                    Base::Vector3d v = Py::Vector(*it).toVector();
+                    normals.push_back(Base::convertTo<Base::Vector3f>(v));
+                }
+                cubes.perform(normals);
+            }
+            else {
+                cubes.perform(ksearch);
+            }
+        }
+        catch (const Base::Exception& e) {
+            throw Py::RuntimeError(e.what());
+        }
+
+        return Py::asObject(new Mesh::MeshPy(mesh.release()));
+    }
+#if defined(HAVE_PCL_SEGMENTATION)
     Py::Object featureSegmentation(const Py::Tuple& args, const Py::Dict& kwds)
     {
         PyObject *pts;
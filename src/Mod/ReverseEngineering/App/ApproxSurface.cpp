@@ -26,14 +26,22 @@
 #include <math_Householder.hxx>
 #include <Geom_BSplineSurface.hxx>
 #include <Precision.hxx>
+#include <Standard_Version.hxx>
+#include <algorithm>
+#include <functional>
 
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QThread>
 #include <QtConcurrentMap>
 #include <boost_bind_bind.hpp>
+#include <Eigen/SparseCholesky>
 
 #include <Mod/Mesh/App/Core/Approximation.h>
+#include <Base/Console.h>
+#include <Base/Parallel.h>
 #include <Base/Sequencer.h>
+#include <Base/TimeInfo.h>
 #include <Base/Tools2D.h>
 #include <Base/Tools.h>
 
@@ -776,6 +784,7 @@ BSplineParameterCorrection::BSplineParameterCorrection(unsigned usUOrder, unsign
                     0,usUCtrlpoints*usVCtrlpoints-1)
   , _clThirdMatrix (0,usUCtrlpoints*usVCtrlpoints-1,
                     0,usUCtrlpoints*usVCtrlpoints-1)
+  , _bSparseSolver(true)
 {
     Init();
 }
@@ -866,14 +875,24 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
 
     Base::SequencerLauncher seq("Calc surface...", iIter*_pvcPoints->Length());
 
+    struct Correction {
+        double fMaxDiff, fMaxScalar;
+    };
+
+    std::size_t count = static_cast<std::size_t>(_pvcPoints->Length());
+    Correction init = {0.0, 1.0};
+    std::vector<Correction> blocks(Base::parallel_blocks(count, 256), init);
+
     do {
         fMaxScalar = 1.0;
         fMaxDiff   = 0.0;
+        Base::TimeInfo start;
 
         Handle(Geom_BSplineSurface) pclBSplineSurf = new Geom_BSplineSurface(_vCtrlPntsOfSurf,
                                                     _vUKnots, _vVKnots, _vUMults, _vVMults, _usUOrder-1, _usVOrder-1);
 
-        for (int ii=_pvcPoints->Lower();ii <=_pvcPoints->Upper();ii++) {
+        auto correct = [&](Correction& block, int ii)
+        {
             double fDeltaU, fDeltaV, fU, fV;
             const gp_Pnt& pnt = (*_pvcPoints)(ii);
             gp_Vec P(pnt.X(), pnt.Y(), pnt.Z());
@@ -891,8 +910,8 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
             //Pruefe, ob X = P
             if (!(X.IsEqual(P,0.001,0.001))) {
                 ErrorVec.Normalize();
-                if (fabs(clNormal*ErrorVec) < fMaxScalar)
-                    fMaxScalar = fabs(clNormal*ErrorVec);
+                if (fabs(clNormal*ErrorVec) < block.fMaxScalar)
+                    block.fMaxScalar = fabs(clNormal*ErrorVec);
             }
 
             fDeltaU =  ( (P-X) * Xu ) / ( (P-X)*Xuu - Xu*Xu );
@@ -909,11 +928,30 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
                 fV <= 1.0 && fV >= 0.0) {
                 uvValue.SetX(fU);
                 uvValue.SetY(fV);
-                fMaxDiff = std::max<double>(fabs(fDeltaU), fMaxDiff);
-                fMaxDiff = std::max<double>(fabs(fDeltaV), fMaxDiff);
+                block.fMaxDiff = std::max<double>(fabs(fDeltaU), block.fMaxDiff);
+                block.fMaxDiff = std::max<double>(fabs(fDeltaV), block.fMaxDiff);
             }
+        };
+
+        auto correctBlock = [&](std::size_t b, std::size_t first, std::size_t last) {
+            blocks[b] = init;
+            for (std::size_t j = first; j < last; j++)
+                correct(blocks[b], _pvcPoints->Lower() + static_cast<int>(j));
+            seq.advance(last - first);
+        };
+
+#if OCC_VERSION_HEX >= 0x070100
+        Base::parallel_for(count, 256, correctBlock);
+#else
+        // older versions cache the evaluated span in the surface, the other blocks keep their
+        // initial values
+        correctBlock(0, 0, count);
+#endif
+        seq.update();
 
-            seq.next();
+        for (std::vector<Correction>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            fMaxScalar = std::min<double>(it->fMaxScalar, fMaxScalar);
+            fMaxDiff = std::max<double>(it->fMaxDiff, fMaxDiff);
         }
 
         if (_bSmoothing) {
@@ -924,6 +962,8 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
             SolveWithoutSmoothing();
         }
 
+        Base::Console().Log("Parameter correction %d: %.3f s, max. correction %g\n",
+                            i+1, Base::TimeInfo::diffTimeF(start), fMaxDiff);
         i++;
     }
     while(i<iIter && fMaxDiff > Precision::Confusion() && fMaxScalar < 0.99);
@@ -931,6 +971,9 @@ void BSplineParameterCorrection::DoParameterCorrection(int iIter)
 
 bool BSplineParameterCorrection::SolveWithoutSmoothing()
 {
+    if (_bSparseSolver)
+        return SolveSparse(0.0);
+
     unsigned ulSize = _pvcPoints->Length();
     unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
     math_Matrix M  (0, ulSize-1, 0, ulDim-1);
@@ -1028,6 +1071,9 @@ private:
 
 bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
 {
+    if (_bSparseSolver)
+        return SolveSparse(fWeight);
+
     unsigned ulSize = _pvcPoints->Length();
     unsigned ulDim  = _usUCtrlpoints*_usVCtrlpoints;
     math_Matrix M  (0, ulSize-1, 0, ulDim-1);
@@ -1146,6 +1192,142 @@ bool BSplineParameterCorrection::SolveWithSmoothing(double fWeight)
     return true;
 }
 
+bool BSplineParameterCorrection::SolveSparse(double fWeight)
+{
+    int iUOrder = static_cast<int>(_usUOrder);
+    int iVOrder = static_cast<int>(_usVOrder);
+    int iVCtrl  = static_cast<int>(_usVCtrlpoints);
+    int iUCtrl  = static_cast<int>(_usUCtrlpoints);
+    int iDim    = iUCtrl*iVCtrl;
+
+    // Each point has at most iUOrder*iVOrder non-zero basis functions, so the row of a control
+    // point (j,k) in M^T*M only has entries for (j+du,k+dv) with |du|<iUOrder and |dv|<iVOrder.
+    // Every thread sums up these bands and the right-hand sides of its points.
+    int iUBand  = 2*iUOrder-1;
+    int iVBand  = 2*iVOrder-1;
+    int iBand   = iUBand*iVBand;
+
+    struct Assembly {
+        std::vector<double> band;
+        std::vector<double> rhs;
+    };
+
+    // each block has its own copy of the bands, so there is only one block per thread
+    std::size_t count = static_cast<std::size_t>(_pvcPoints->Length());
+    std::size_t minBlock = std::max<std::size_t>(256, count / std::max(1, QThread::idealThreadCount()));
+    std::vector<Assembly> blocks(Base::parallel_blocks(count, minBlock));
+
+    double fUFirst = _vUKnots(_vUKnots.Lower()), fULast = _vUKnots(_vUKnots.Upper());
+    double fVFirst = _vVKnots(_vVKnots.Lower()), fVLast = _vVKnots(_vVKnots.Upper());
+
+    Base::parallel_for(count, minBlock, [&](std::size_t b, std::size_t first, std::size_t last) {
+        Assembly& block = blocks[b];
+        block.band.assign(iDim*iBand, 0.0);
+        block.rhs.assign(3*iDim, 0.0);
+        TColStd_Array1OfReal basisU(0, iUOrder-1);
+        TColStd_Array1OfReal basisV(0, iVOrder-1);
+        std::vector<double> values(iUOrder*iVOrder);
+        for (int ii=_pvcPoints->Lower()+static_cast<int>(first); ii<_pvcPoints->Lower()+static_cast<int>(last); ii++) {
+            const gp_Pnt2d& uvValue = (*_pvcUVParam)(ii);
+            double fU = uvValue.X();
+            double fV = uvValue.Y();
+            // outside of the knot vectors all basis functions vanish
+            if (!(fU >= fUFirst && fU <= fULast && fV >= fVFirst && fV <= fVLast))
+                continue;
+
+            int iUFirst = _clUSpline.FindSpan(fU) - iUOrder + 1;
+            int iVFirst = _clVSpline.FindSpan(fV) - iVOrder + 1;
+            _clUSpline.AllBasisFunctions(fU, basisU);
+            _clVSpline.AllBasisFunctions(fV, basisV);
+            for (int r=0; r<iUOrder; r++) {
+                for (int s=0; s<iVOrder; s++)
+                    values[r*iVOrder+s] = basisU(r) * basisV(s);
+            }
+
+            const gp_Pnt& pnt = (*_pvcPoints)(ii);
+            for (int r=0; r<iUOrder; r++) {
+                for (int s=0; s<iVOrder; s++) {
+                    double value = values[r*iVOrder+s];
+                    if (value == 0.0)
+                        continue;
+                    int row = (iUFirst+r)*iVCtrl + iVFirst+s;
+                    block.rhs[3*row  ] += value * pnt.X();
+                    block.rhs[3*row+1] += value * pnt.Y();
+                    block.rhs[3*row+2] += value * pnt.Z();
+
+                    double* band = &block.band[row*iBand];
+                    for (int r2=0; r2<iUOrder; r2++) {
+                        for (int s2=0; s2<iVOrder; s2++) {
+                            int offset = (r2-r+iUOrder-1)*iVBand + (s2-s+iVOrder-1);
+                            band[offset] += value * values[r2*iVOrder+s2];
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    for (std::size_t b = 1; b < blocks.size(); b++) {
+        std::transform(blocks[0].band.begin(), blocks[0].band.end(), blocks[b].band.begin(),
+                       blocks[0].band.begin(), std::plus<double>());
+        std::transform(blocks[0].rhs.begin(), blocks[0].rhs.end(), blocks[b].rhs.begin(),
+                       blocks[0].rhs.begin(), std::plus<double>());
+    }
+
+    std::vector<Eigen::Triplet<double> > triplets;
+    triplets.reserve(iDim*iBand);
+    const std::vector<double>& band = blocks[0].band;
+    for (int row=0; row<iDim; row++) {
+        int j = row / iVCtrl;
+        int k = row % iVCtrl;
+        for (int du=1-iUOrder; du<iUOrder; du++) {
+            for (int dv=1-iVOrder; dv<iVOrder; dv++) {
+                double value = band[row*iBand + (du+iUOrder-1)*iVBand + dv+iVOrder-1];
+                if (value != 0.0)
+                    triplets.push_back(Eigen::Triplet<double>(row, (j+du)*iVCtrl + k+dv, value));
+            }
+        }
+    }
+
+    // the smoothing terms have the same local support, zero entries are skipped
+    if (fWeight != 0.0) {
+        for (int m=0; m<iDim; m++) {
+            for (int n=0; n<iDim; n++) {
+                double value = _clSmoothMatrix(m,n);
+                if (value != 0.0)
+                    triplets.push_back(Eigen::Triplet<double>(m, n, fWeight*value));
+            }
+        }
+    }
+
+    Eigen::SparseMatrix<double> MTM(iDim, iDim);
+    MTM.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> > Mb(blocks[0].rhs.data(), iDim, 3);
+
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > solver(MTM);
+    if (solver.info() != Eigen::Success)
+        return false;
+    Eigen::Matrix<double, Eigen::Dynamic, 3> X = solver.solve(Mb);
+    // a singular system, e.g. control points without any data, isn't always detected
+    if (solver.info() != Eigen::Success || !X.allFinite())
+        return false;
+
+    int ulIdx=0;
+    for (unsigned j=0;j<_usUCtrlpoints;j++) {
+        for (unsigned k=0;k<_usVCtrlpoints;k++) {
+            _vCtrlPntsOfSurf(j,k) = gp_Pnt(X(ulIdx,0),X(ulIdx,1),X(ulIdx,2));
+            ulIdx++;
+        }
+    }
+
+    return true;
+}
+
+void BSplineParameterCorrection::EnableSparseSolver(bool bSparse)
+{
+    _bSparseSolver = bSparse;
+}
+
 void BSplineParameterCorrection::CalcSmoothingTerms(bool bRecalc, double fFirst, double fSecond, double fThird)
 {
     if (bRecalc) {
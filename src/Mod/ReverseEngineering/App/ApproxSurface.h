@@ -400,7 +400,20 @@ protected:
      */
     virtual bool SolveWithSmoothing(double fWeight);
 
+    /**
+     * Solves the normal equations of the least-squares problem with a sparse Cholesky
+     * decomposition. A point only influences the control points of its knot span, so the
+     * system is banded and is assembled in parallel over the points. If \a fWeight is not
+     * zero the smoothing terms are added.
+     */
+    virtual bool SolveSparse(double fWeight);
+
 public:
+    /**
+     * Use the sparse normal equations (default) or the former dense solvers
+     */
+    void EnableSparseSolver(bool bSparse=true);
+
     /**
      * Setzen des Knotenvektors
      */
@@ -483,6 +496,7 @@ protected:
     math_Matrix            _clFirstMatrix;    //! Matrix der 1. Glaettungsfunktionale
     math_Matrix            _clSecondMatrix;   //! Matrix der 2. Glaettungsfunktionale
     math_Matrix            _clThirdMatrix;    //! Matrix der 3. Glaettungsfunktionale
+    bool                   _bSparseSolver;    //! Solve the sparse normal equations
 };
 
 } // namespace Reen
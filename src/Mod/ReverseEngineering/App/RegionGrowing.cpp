@@ -23,9 +23,20 @@
 
 #include "PreCompiled.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <map>
+
 #include "RegionGrowing.h"
+#include "Segmentation.h"
 #include <Mod/Points/App/Points.h>
+#include <Mod/Points/App/PointsKDTree.h>
+#include <Base/Converter.h>
 #include <Base/Exception.h>
+#include <Base/Parallel.h>
+#include <Base/Tools.h>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 #if defined(HAVE_PCL_FILTERS)
@@ -38,66 +49,146 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/segmentation/region_growing.h>
 #include <pcl/filters/extract_indices.h>
+#endif
 
 using namespace std;
 using namespace Reen;
-using pcl::PointXYZ;
-using pcl::PointNormal;
-using pcl::PointCloud;
+
+namespace {
+/*
+ * A union-find structure that can be modified from several threads at once. A root is
+ * always linked to a root with a lower index so that no cycles can occur, and the link
+ * only succeeds if the root hasn't been linked by another thread in the meantime.
+ */
+class ConcurrentUnionFind
+{
+public:
+    explicit ConcurrentUnionFind(std::size_t size)
+      : parent(size)
+    {
+        for (std::size_t i = 0; i < size; i++)
+            parent[i].store(i, std::memory_order_relaxed);
+    }
+    std::size_t find(std::size_t x)
+    {
+        for (;;) {
+            std::size_t p = parent[x].load();
+            if (p == x)
+                return x;
+            // path halving
+            std::size_t gp = parent[p].load();
+            if (p != gp)
+                parent[x].compare_exchange_weak(p, gp);
+            x = gp;
+        }
+    }
+    void unite(std::size_t a, std::size_t b)
+    {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            std::size_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b))
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<std::size_t> > parent;
+};
+}
 
 RegionGrowing::RegionGrowing(const Points::PointKernel& pts, std::list<std::vector<int> >& clusters)
   : myPoints(pts)
   , myClusters(clusters)
+  , minClusterSize(50)
+  , maxClusterSize(1000000)
+  , numberOfNeighbours(30)
+  , smoothnessThreshold(Base::toRadians<double>(3.0))
 {
 }
 
 void RegionGrowing::perform(int ksearch)
 {
-    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
-    cloud->reserve(myPoints.size());
-    for (Points::PointKernel::const_iterator it = myPoints.begin(); it != myPoints.end(); ++it) {
-        if (!boost::math::isnan(it->x) && !boost::math::isnan(it->y) && !boost::math::isnan(it->z))
-            cloud->push_back(pcl::PointXYZ(it->x, it->y, it->z));
-    }
+    // the normals are estimated with the native kd-tree instead of a copy of the cloud
+    std::vector<Base::Vector3d> normals;
+    NormalEstimation estimate(myPoints);
+    estimate.setKSearch(ksearch);
+    estimate.perform(normals);
+
+    std::vector<Base::Vector3f> normalsf;
+    normalsf.reserve(normals.size());
+    for (std::vector<Base::Vector3d>::iterator it = normals.begin(); it != normals.end(); ++it)
+        normalsf.push_back(Base::convertTo<Base::Vector3f>(*it));
+    perform(normalsf);
+}
 
-    //normal estimation
-    pcl::search::Search<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
-    pcl::PointCloud <pcl::Normal>::Ptr normals (new pcl::PointCloud <pcl::Normal>);
-    pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> normal_estimator;
-    normal_estimator.setSearchMethod (tree);
-    normal_estimator.setInputCloud (cloud);
-    normal_estimator.setKSearch (ksearch);
-    normal_estimator.compute (*normals);
-
-    // pass through
-    pcl::IndicesPtr indices (new std::vector <int>);
-    pcl::PassThrough<pcl::PointXYZ> pass;
-    pass.setInputCloud (cloud);
-    pass.setFilterFieldName ("z");
-    pass.setFilterLimits (0.0, 1.0);
-    pass.filter (*indices);
+void RegionGrowing::perform(const std::vector<Base::Vector3f>& myNormals)
+{
+    if (myPoints.size() != myNormals.size())
+        throw Base::RuntimeError("Number of points doesn't match with number of normals");
 
-    pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> reg;
-    reg.setMinClusterSize (50);
-    reg.setMaxClusterSize (1000000);
-    reg.setSearchMethod (tree);
-    reg.setNumberOfNeighbours (30);
-    reg.setInputCloud (cloud);
-    //reg.setIndices (indices);
-    reg.setInputNormals (normals);
-    reg.setSmoothnessThreshold (3.0 / 180.0 * M_PI);
-    reg.setCurvatureThreshold (1.0);
+    // points with NaN coordinates are not indexed and thus never become neighbours
+    const std::vector<Base::Vector3f>& points = myPoints.getBasicPoints();
+    Points::PointsKDTree tree(points);
+
+    // normals are compared regardless of their orientation
+    std::size_t count = points.size();
+    std::size_t k = static_cast<std::size_t>(std::max(numberOfNeighbours, 1));
+    float cosThreshold = static_cast<float>(std::cos(smoothnessThreshold));
+    ConcurrentUnionFind regions(count);
+
+    Base::parallel_for(count, 256, [&](std::size_t, std::size_t first, std::size_t last) {
+        std::vector<unsigned long> neighbours;
+        std::vector<float> distances;
+        for (std::size_t i = first; i < last; i++) {
+            const Base::Vector3f& ni = myNormals[i];
+            float li = ni.Length();
+            if (boost::math::isnan(li) || li == 0.0f)
+                continue;
+            tree.FindKNearest(points[i], k, neighbours, distances);
+            for (std::vector<unsigned long>::iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+                const Base::Vector3f& nj = myNormals[*it];
+                float lj = nj.Length();
+                if (*it == i || boost::math::isnan(lj) || lj == 0.0f)
+                    continue;
+                if (std::fabs(ni * nj) >= cosThreshold * li * lj)
+                    regions.unite(i, *it);
+            }
+        }
+    });
+
+    // collect the regions ordered by their lowest point index
+    std::vector<std::size_t> sizes(count, 0);
+    std::vector<std::size_t> roots(count);
+    for (std::size_t i = 0; i < count; i++) {
+        roots[i] = regions.find(i);
+        sizes[roots[i]]++;
+    }
 
-    std::vector <pcl::PointIndices> clusters;
-    reg.extract (clusters);
+    std::map<std::size_t, std::vector<int> > clusters;
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t size = sizes[roots[i]];
+        if (size >= minClusterSize && size <= maxClusterSize) {
+            std::vector<int>& cluster = clusters[roots[i]];
+            if (cluster.empty())
+                cluster.reserve(size);
+            cluster.push_back(static_cast<int>(i));
+        }
+    }
 
-    for (std::vector<pcl::PointIndices>::iterator it = clusters.begin (); it != clusters.end (); ++it) {
+    for (std::map<std::size_t, std::vector<int> >::iterator it = clusters.begin(); it != clusters.end(); ++it) {
         myClusters.push_back(std::vector<int>());
-        myClusters.back().swap(it->indices);
+        myClusters.back().swap(it->second);
     }
 }
 
-void RegionGrowing::perform(const std::vector<Base::Vector3f>& myNormals)
+#if defined(HAVE_PCL_SEGMENTATION)
+void RegionGrowing::performPCL(const std::vector<Base::Vector3f>& myNormals)
 {
     if (myPoints.size() != myNormals.size())
         throw Base::RuntimeError("Number of points doesn't match with number of normals");
@@ -121,23 +212,14 @@ void RegionGrowing::perform(const std::vector<Base::Vector3f>& myNormals)
     pcl::search::Search<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
     tree->setInputCloud (cloud);
 
-    // pass through
-    pcl::IndicesPtr indices (new std::vector <int>);
-    pcl::PassThrough<pcl::PointXYZ> pass;
-    pass.setInputCloud (cloud);
-    pass.setFilterFieldName ("z");
-    pass.setFilterLimits (0.0, 1.0);
-    pass.filter (*indices);
-
     pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> reg;
-    reg.setMinClusterSize (50);
-    reg.setMaxClusterSize (1000000);
+    reg.setMinClusterSize (static_cast<int>(minClusterSize));
+    reg.setMaxClusterSize (static_cast<int>(maxClusterSize));
     reg.setSearchMethod (tree);
-    reg.setNumberOfNeighbours (30);
+    reg.setNumberOfNeighbours (numberOfNeighbours);
     reg.setInputCloud (cloud);
-    //reg.setIndices (indices);
     reg.setInputNormals (normals);
-    reg.setSmoothnessThreshold (3.0 / 180.0 * M_PI);
+    reg.setSmoothnessThreshold (smoothnessThreshold);
     reg.setCurvatureThreshold (1.0);
 
     std::vector <pcl::PointIndices> clusters;
@@ -148,6 +230,4 @@ void RegionGrowing::perform(const std::vector<Base::Vector3f>& myNormals)
         myClusters.back().swap(it->indices);
     }
 }
-
 #endif // HAVE_PCL_SEGMENTATION
-
@@ -32,10 +32,27 @@ namespace Points {class PointKernel;}
 
 namespace Reen {
 
+/**
+ * Splits a point cloud into smooth regions. Two points are in the same region if one is among
+ * the nearest neighbours of the other and the angle between their normals is below the
+ * smoothness threshold. The regions are the connected components of this relation and are
+ * merged with a concurrent union-find structure while the neighbours are searched in parallel.
+ */
 class RegionGrowing
 {
 public:
     RegionGrowing(const Points::PointKernel&, std::list<std::vector<int> >&);
+    /** \brief Set the minimum and maximum number of points of a region.
+      * Smaller and larger regions are not reported.
+      */
+    void setClusterSize(std::size_t minSize, std::size_t maxSize)
+    { minClusterSize = minSize; maxClusterSize = maxSize; }
+    /** \brief Set the number of nearest neighbours that are checked for each point. */
+    void setNumberOfNeighbours(int k)
+    { numberOfNeighbours = k; }
+    /** \brief Set the maximum angle in radians between the normals of neighbouring points. */
+    void setSmoothnessThreshold(double angle)
+    { smoothnessThreshold = angle; }
     /** \brief Set the number of k nearest neighbors to use for the normal estimation.
       * \param[in] k the number of k-nearest neighbors
       */
@@ -44,10 +61,21 @@ public:
       * \param[in] normals the normals to the given points.
       */
     void perform(const std::vector<Base::Vector3f>& normals);
+#if defined(HAVE_PCL_SEGMENTATION)
+    /** \brief Does the same as perform() with pcl::RegionGrowing.
+      * The points are copied to a PCL point cloud. This is the former implementation and is
+      * kept to compare the results and the performance with perform().
+      */
+    void performPCL(const std::vector<Base::Vector3f>& normals);
+#endif
 
 private:
     const Points::PointKernel& myPoints;
     std::list<std::vector<int> >& myClusters;
+    std::size_t minClusterSize;
+    std::size_t maxClusterSize;
+    int numberOfNeighbours;
+    double smoothnessThreshold;
 };
 
 } // namespace Reen
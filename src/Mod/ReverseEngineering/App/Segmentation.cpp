@@ -23,14 +23,27 @@
 
 #include "PreCompiled.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <Eigen/Eigenvalues>
+
 #include "Segmentation.h"
 #include <Mod/Points/App/Points.h>
+#include <Mod/Points/App/PointsKDTree.h>
+#include <Base/Converter.h>
 #include <Base/Exception.h>
+#include <Base/Parallel.h>
+#include <boost/math/special_functions/fpclassify.hpp>
 
 #if defined(HAVE_PCL_FILTERS)
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/passthrough.h>
 #include <pcl/features/normal_3d.h>
+#include <pcl/search/kdtree.h>
 #endif
 
 #if defined(HAVE_PCL_SAMPLE_CONSENSUS)
@@ -159,15 +172,90 @@ void Segmentation::perform(int ksearch)
 
 // ----------------------------------------------------------------------------
 
-#if defined (HAVE_PCL_FILTERS)
 NormalEstimation::NormalEstimation(const Points::PointKernel& pts)
   : myPoints(pts)
   , kSearch(0)
   , searchRadius(0)
+  , propagateOrientation(false)
 {
 }
 
 void NormalEstimation::perform(std::vector<Base::Vector3d>& normals)
+{
+    if (kSearch <= 0 && searchRadius <= 0)
+        throw Base::ValueError("Either the number of neighbours or the search radius must be set");
+
+    std::vector<Base::Vector3f> points;
+    points.reserve(myPoints.size());
+    for (Points::PointKernel::const_point_iterator it = myPoints.begin(); it != myPoints.end(); ++it)
+        points.push_back(Base::convertTo<Base::Vector3f>(*it));
+
+    Points::PointsKDTree tree(points);
+
+    // the points are processed in blocks of consecutive points
+    std::size_t count = points.size();
+    normals.resize(count);
+    Base::parallel_for(count, 256, [&](std::size_t, std::size_t first, std::size_t last) {
+        std::vector<unsigned long> neighbours;
+        std::vector<float> distances;
+        for (std::size_t i = first; i < last; i++) {
+            const Base::Vector3f& p = points[i];
+            if (kSearch > 0)
+                tree.FindKNearest(p, static_cast<std::size_t>(kSearch), neighbours, distances);
+            else
+                tree.FindInRange(p, static_cast<float>(searchRadius), neighbours);
+            normals[i] = fitNormal(points, neighbours, p);
+        }
+    });
+
+    if (propagateOrientation)
+        orientNormals(points, tree, normals);
+}
+
+void NormalEstimation::orientNormals(const std::vector<Base::Vector3f>& points,
+                                     const Points::PointsKDTree& tree,
+                                     std::vector<Base::Vector3d>& normals) const
+{
+    // the neighbour graph is searched in parallel, the spanning tree is built serially
+    std::size_t k = kSearch > 0 ? static_cast<std::size_t>(kSearch) : 8;
+    std::vector<unsigned long> neighbours;
+    tree.FindKNearest(points, k, neighbours);
+
+    // an edge is given by its weight, its target and its source point
+    typedef std::pair<double, std::pair<std::size_t, std::size_t> > Edge;
+    std::priority_queue<Edge, std::vector<Edge>, std::greater<Edge> > front;
+    std::vector<bool> visited(points.size(), false);
+
+    for (std::size_t seed = 0; seed < points.size(); seed++) {
+        if (visited[seed] || boost::math::isnan(normals[seed].x))
+            continue;
+
+        // Prim's algorithm: the seed keeps its orientation towards the viewpoint and each
+        // point reached over the cheapest edge is flipped to agree with its predecessor
+        front.push(Edge(0.0, std::make_pair(seed, seed)));
+        while (!front.empty()) {
+            std::size_t i = front.top().second.first;
+            std::size_t from = front.top().second.second;
+            front.pop();
+            if (visited[i])
+                continue;
+            visited[i] = true;
+            if (normals[from] * normals[i] < 0.0)
+                normals[i] = -normals[i];
+
+            const Base::Vector3d& ni = normals[i];
+            for (std::size_t n = i * k; n < (i + 1) * k; n++) {
+                unsigned long j = neighbours[n];
+                if (j == ULONG_MAX || visited[j] || boost::math::isnan(normals[j].x))
+                    continue;
+                front.push(Edge(1.0 - std::fabs(ni * normals[j]), std::make_pair(j, i)));
+            }
+        }
+    }
+}
+
+#if defined(HAVE_PCL_FILTERS)
+void NormalEstimation::performPCL(std::vector<Base::Vector3d>& normals)
 {
     // Copy the points
     pcl::PointCloud<PointXYZ>::Ptr cloud (new pcl::PointCloud<PointXYZ>);
@@ -175,37 +263,58 @@ void NormalEstimation::perform(std::vector<Base::Vector3d>& normals)
     for (Points::PointKernel::const_iterator it = myPoints.begin(); it != myPoints.end(); ++it) {
         cloud->push_back(pcl::PointXYZ(it->x, it->y, it->z));
     }
-
     cloud->width = int (cloud->points.size ());
     cloud->height = 1;
 
-#if 0
-    // Build a passthrough filter to remove spurious NaNs
-    pcl::PointCloud<PointXYZ>::Ptr cloud_filtered (new pcl::PointCloud<PointXYZ>);
-    pcl::PassThrough<PointXYZ> pass;
-    pass.setInputCloud (cloud);
-    pass.setFilterFieldName ("z");
-    pass.setFilterLimits (0, 1.5);
-    pass.filter (*cloud_filtered);
-#endif
-
     // Estimate point normals
     pcl::PointCloud<pcl::Normal>::Ptr cloud_normals (new pcl::PointCloud<pcl::Normal>);
     pcl::search::KdTree<PointXYZ>::Ptr tree (new pcl::search::KdTree<PointXYZ> ());
     pcl::NormalEstimation<PointXYZ, pcl::Normal> ne;
     ne.setSearchMethod (tree);
-    //ne.setInputCloud (cloud_filtered);
     ne.setInputCloud (cloud);
     if (kSearch > 0)
         ne.setKSearch (kSearch);
     if (searchRadius > 0)
         ne.setRadiusSearch (searchRadius);
     ne.compute (*cloud_normals);
-
+    normals.clear();
     normals.reserve(cloud_normals->size());
     for (pcl::PointCloud<pcl::Normal>::const_iterator it = cloud_normals->begin(); it != cloud_normals->end(); ++it) {
         normals.push_back(Base::Vector3d(it->normal_x, it->normal_y, it->normal_z));
     }
 }
+#endif
 
-#endif // HAVE_PCL_FILTERS
+Base::Vector3d NormalEstimation::fitNormal(const std::vector<Base::Vector3f>& points,
+                                           const std::vector<unsigned long>& neighbours,
+                                           const Base::Vector3f& point) const
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    if (neighbours.size() < 3)
+        return Base::Vector3d(nan, nan, nan);
+
+    // the normal is the eigenvector of the smallest eigenvalue of the covariance matrix
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+    for (std::vector<unsigned long>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+        const Base::Vector3f& v = points[*it];
+        mean += Eigen::Vector3d(v.x, v.y, v.z);
+    }
+    mean /= static_cast<double>(neighbours.size());
+
+    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+    for (std::vector<unsigned long>::const_iterator it = neighbours.begin(); it != neighbours.end(); ++it) {
+        const Base::Vector3f& v = points[*it];
+        Eigen::Vector3d d = Eigen::Vector3d(v.x, v.y, v.z) - mean;
+        covariance += d * d.transpose();
+    }
+
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(covariance);
+    Eigen::Vector3d n = solver.eigenvectors().col(0);
+
+    // like PCL flip the normal towards the viewpoint at the origin
+    Base::Vector3d normal(n.x(), n.y(), n.z());
+    Base::Vector3d toViewpoint(-point.x, -point.y, -point.z);
+    if (normal * toViewpoint < 0.0)
+        normal = -normal;
+    return normal;
+}
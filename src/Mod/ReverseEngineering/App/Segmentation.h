@@ -28,7 +28,7 @@
 #include <vector>
 #include <list>
 
-namespace Points {class PointKernel;}
+namespace Points {class PointKernel; class PointsKDTree;}
 
 namespace Reen {
 
@@ -66,15 +66,47 @@ public:
         searchRadius = radius;
     }
 
+    /** \brief Propagate a consistent orientation over the estimated normals.
+      * By default each normal is flipped towards the viewpoint at the origin. With propagation
+      * only one normal per connected part of the point cloud is oriented that way and the
+      * orientation is passed on along a minimum spanning tree of the k-nearest neighbour graph,
+      * preferring neighbours with nearly parallel normals.
+      * \param[in] on true to propagate the orientation
+      */
+    inline void
+    setPropagateOrientation (bool on)
+    {
+        propagateOrientation = on;
+    }
+
     /** \brief Perform the normal estimation.
+      * The neighbours of each point are searched with a kd-tree and the normal is the direction
+      * of least variance of its neighbours. Points with less than three neighbours get a NaN normal.
       * \param[out] the estimated normals
       */
     void perform(std::vector<Base::Vector3d>& normals);
+#if defined(HAVE_PCL_FILTERS)
+    /** \brief Perform the normal estimation with PCL.
+      * The points are copied to a PCL point cloud. This is the former implementation and is
+      * kept to compare the results and the performance with perform().
+      * \param[out] the estimated normals
+      */
+    void performPCL(std::vector<Base::Vector3d>& normals);
+#endif
+
+private:
+    Base::Vector3d fitNormal(const std::vector<Base::Vector3f>& points,
+                             const std::vector<unsigned long>& neighbours,
+                             const Base::Vector3f& point) const;
+    void orientNormals(const std::vector<Base::Vector3f>& points,
+                       const Points::PointsKDTree& tree,
+                       std::vector<Base::Vector3d>& normals) const;
 
 private:
     const Points::PointKernel& myPoints;
     int kSearch;
     double searchRadius;
+    bool propagateOrientation;
 };
 
 } // namespace Reen
@@ -0,0 +1,931 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <Eigen/LU>
+#include <Eigen/SVD>
+
+#include "ShapeDetection.h"
+#include <Mod/Mesh/App/Core/Approximation.h>
+#include <Mod/Mesh/App/Core/Definitions.h>
+#include <Mod/Mesh/App/Core/MeshKernel.h>
+#include <Mod/Points/App/PointsKDTree.h>
+#include <Base/BoundBox.h>
+#include <Base/Converter.h>
+#include <Base/Exception.h>
+#include <Base/Parallel.h>
+#include <Base/Tools.h>
+#include <boost/math/special_functions/fpclassify.hpp>
+
+using namespace Reen;
+
+namespace {
+
+const int OctreeDepth = 10;         // levels of the octree used for the localized sampling
+const std::size_t FirstSubset = 512; // points of the smallest subset to score the candidates
+const std::size_t SubsetFactor = 4;  // growth of the subsets
+const std::size_t SamplesPerRound = 64;
+
+/*
+ * A shape hypothesis with its score on the evaluated part of the remaining points.
+ */
+struct Candidate
+{
+    ShapeDetection::Primitive type;
+    Base::Vector3d origin;  // plane base, point on cylinder axis, sphere/torus center, cone apex
+    Base::Vector3d axis;    // plane normal, cylinder/cone/torus axis
+    double radius;          // cylinder/sphere radius, cone half angle, torus major radius
+    double minorRadius;     // torus minor radius
+    double sinAngle, cosAngle;
+    int level;              // octree level of the sample
+    std::size_t evaluated;  // size of the evaluated prefix of the remaining points
+    std::size_t hits;       // inliers in the evaluated prefix
+
+    Candidate(ShapeDetection::Primitive t, int l)
+      : type(t), radius(0), minorRadius(0), sinAngle(0), cosAngle(1)
+      , level(l), evaluated(0), hits(0)
+    {
+    }
+
+    /// Computes the distance of \a p to the shape and the shape normal next to it
+    bool distance(const Base::Vector3d& p, double& dist, Base::Vector3d& normal) const
+    {
+        Base::Vector3d v = p - origin;
+        switch (type) {
+        case ShapeDetection::Plane:
+            dist = std::fabs(v * axis);
+            normal = axis;
+            return true;
+        case ShapeDetection::Sphere:
+        {
+            double len = v.Length();
+            if (len == 0.0)
+                return false;
+            dist = std::fabs(len - radius);
+            normal = v / len;
+            return true;
+        }
+        case ShapeDetection::Cylinder:
+        {
+            Base::Vector3d r = v - axis * (v * axis);
+            double len = r.Length();
+            if (len == 0.0)
+                return false;
+            dist = std::fabs(len - radius);
+            normal = r / len;
+            return true;
+        }
+        case ShapeDetection::Cone:
+        {
+            // in the half plane through the axis the cone is a ray from the apex
+            double h = v * axis;
+            Base::Vector3d r = v - axis * h;
+            double len = r.Length();
+            if (len == 0.0)
+                return false;
+            r /= len;
+            if (len * sinAngle + h * cosAngle < 0.0) {
+                dist = v.Length();
+                normal = v / dist;
+            }
+            else {
+                dist = std::fabs(len * cosAngle - h * sinAngle);
+                normal = r * cosAngle - axis * sinAngle;
+            }
+            return true;
+        }
+        case ShapeDetection::Torus:
+        {
+            double h = v * axis;
+            Base::Vector3d r = v - axis * h;
+            double len = r.Length();
+            if (len == 0.0)
+                return false;
+            Base::Vector3d q = r * ((len - radius) / len) + axis * h;
+            double qlen = q.Length();
+            if (qlen == 0.0)
+                return false;
+            dist = std::fabs(qlen - minorRadius);
+            normal = q / qlen;
+            return true;
+        }
+        }
+        return false;
+    }
+
+    bool isInlier(const Base::Vector3d& p, const Base::Vector3d& n, double eps, double cosMin) const
+    {
+        double dist;
+        Base::Vector3d normal;
+        if (!distance(p, dist, normal))
+            return false;
+        return dist <= eps && std::fabs(normal * n) >= cosMin;
+    }
+
+    double estimate(std::size_t count) const
+    {
+        return evaluated > 0 ? static_cast<double>(hits) * count / evaluated : 0.0;
+    }
+    // rough confidence interval of the estimated score
+    double lowerBound(std::size_t count) const
+    {
+        if (evaluated >= count)
+            return static_cast<double>(hits);
+        return std::max(0.0, estimate(count) - 2.0 * std::sqrt(hits + 1.0) * count / evaluated);
+    }
+    double upperBound(std::size_t count) const
+    {
+        if (evaluated >= count)
+            return static_cast<double>(hits);
+        return estimate(count) + 2.0 * std::sqrt(hits + 1.0) * count / evaluated;
+    }
+};
+
+// Closest points of the lines p0+s*n0 and p1+t*n1, returns their midpoint
+bool intersectLines(const Base::Vector3d& p0, const Base::Vector3d& n0,
+                    const Base::Vector3d& p1, const Base::Vector3d& n1,
+                    Base::Vector3d& center)
+{
+    Base::Vector3d w = p0 - p1;
+    double b = n0 * n1;
+    double d = n0 * w;
+    double e = n1 * w;
+    double denom = 1.0 - b * b;
+    if (denom < 1e-6)
+        return false;
+    double s = (b * e - d) / denom;
+    double t = (e - b * d) / denom;
+    center = ((p0 + n0 * s) + (p1 + n1 * t)) * 0.5;
+    return true;
+}
+
+/*
+ * A point cloud sorted by the Morton codes of its points. The points of an octree cell
+ * are a contiguous range of the sorted order.
+ */
+class MortonOrder
+{
+public:
+    MortonOrder(const std::vector<Base::Vector3f>& points, const std::vector<char>& valid)
+    {
+        Base::BoundBox3d box;
+        for (std::size_t i = 0; i < points.size(); i++) {
+            if (valid[i])
+                box.Add(Base::convertTo<Base::Vector3d>(points[i]));
+        }
+        double len = std::max(std::max(box.LengthX(), box.LengthY()), box.LengthZ());
+        double scale = len > 0.0 ? ((1 << OctreeDepth) - 1) / len : 0.0;
+
+        std::vector<std::pair<uint32_t, unsigned long> > keys;
+        keys.reserve(points.size());
+        for (std::size_t i = 0; i < points.size(); i++) {
+            if (!valid[i])
+                continue;
+            uint32_t x = static_cast<uint32_t>((points[i].x - box.MinX) * scale);
+            uint32_t y = static_cast<uint32_t>((points[i].y - box.MinY) * scale);
+            uint32_t z = static_cast<uint32_t>((points[i].z - box.MinZ) * scale);
+            keys.push_back(std::make_pair(spread(x) | (spread(y) << 1) | (spread(z) << 2), i));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        codes.reserve(keys.size());
+        order.reserve(keys.size());
+        position.assign(points.size(), 0);
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            codes.push_back(keys[i].first);
+            order.push_back(keys[i].second);
+            position[keys[i].second] = i;
+        }
+    }
+
+    /// The range of the sorted points in the cell of the given level containing \a index
+    std::pair<std::size_t, std::size_t> cell(unsigned long index, int level) const
+    {
+        int shift = 3 * (OctreeDepth - level);
+        uint32_t prefix = codes[position[index]] >> shift;
+        std::vector<uint32_t>::const_iterator first = std::lower_bound(codes.begin(), codes.end(), prefix << shift);
+        std::vector<uint32_t>::const_iterator last = std::lower_bound(first, codes.end(), (prefix + 1) << shift);
+        return std::make_pair(first - codes.begin(), last - codes.begin());
+    }
+
+    unsigned long operator[] (std::size_t i) const
+    {
+        return order[i];
+    }
+
+private:
+    static uint32_t spread(uint32_t v)
+    {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v <<  8)) & 0x0300f00f;
+        v = (v | (v <<  4)) & 0x030c30c3;
+        v = (v | (v <<  2)) & 0x09249249;
+        return v;
+    }
+
+    std::vector<uint32_t> codes;
+    std::vector<unsigned long> order;
+    std::vector<std::size_t> position;
+};
+
+class Detector
+{
+public:
+    Detector(const std::vector<Base::Vector3f>& points, const std::vector<Base::Vector3d>& normals,
+             const std::vector<ShapeDetection::Primitive>& types, double eps, double cosMin)
+      : points(points), normals(normals), types(types), eps(eps), cosMin(cosMin)
+    {
+    }
+
+    bool createCandidates(const std::vector<unsigned long>& sample, int level,
+                          std::vector<Candidate>& candidates) const
+    {
+        std::size_t before = candidates.size();
+        for (std::vector<ShapeDetection::Primitive>::const_iterator it = types.begin(); it != types.end(); ++it) {
+            switch (*it) {
+            case ShapeDetection::Plane:
+                createPlane(sample, level, candidates);
+                break;
+            case ShapeDetection::Sphere:
+                createSphere(sample, level, candidates);
+                break;
+            case ShapeDetection::Cylinder:
+                createCylinder(sample, level, candidates);
+                break;
+            case ShapeDetection::Cone:
+                createCone(sample, level, candidates);
+                break;
+            case ShapeDetection::Torus:
+                createTorus(sample, level, candidates);
+                break;
+            }
+        }
+        return candidates.size() > before;
+    }
+
+    bool isInlier(const Candidate& c, unsigned long index) const
+    {
+        return c.isInlier(point(index), normals[index], eps, cosMin);
+    }
+
+    /// Keeps the candidate if all points of the sample are inliers
+    void verify(Candidate& c, const std::vector<unsigned long>& sample, std::size_t count,
+                std::vector<Candidate>& candidates) const
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            if (!isInlier(c, sample[i]))
+                return;
+        }
+        candidates.push_back(c);
+    }
+
+    void createPlane(const std::vector<unsigned long>& s, int level, std::vector<Candidate>& candidates) const
+    {
+        Base::Vector3d p0 = point(s[0]);
+        Base::Vector3d normal = (point(s[1]) - p0) % (point(s[2]) - p0);
+        if (normal.Length() == 0.0)
+            return;
+        Candidate c(ShapeDetection::Plane, level);
+        c.origin = p0;
+        c.axis = normal.Normalize();
+        verify(c, s, 3, candidates);
+    }
+
+    void createSphere(const std::vector<unsigned long>& s, int level, std::vector<Candidate>& candidates) const
+    {
+        Base::Vector3d p0 = point(s[0]), p1 = point(s[1]);
+        Candidate c(ShapeDetection::Sphere, level);
+        if (!intersectLines(p0, normals[s[0]], p1, normals[s[1]], c.origin))
+            return;
+        c.radius = (Base::Distance(p0, c.origin) + Base::Distance(p1, c.origin)) * 0.5;
+        verify(c, s, 3, candidates);
+    }
+
+    void createCylinder(const std::vector<unsigned long>& s, int level, std::vector<Candidate>& candidates) const
+    {
+        Base::Vector3d axis = normals[s[0]] % normals[s[1]];
+        if (axis.Length() < 1e-3)
+            return;
+        axis.Normalize();
+
+        // both normals are perpendicular to the axis, so intersect them in the plane through p0
+        Base::Vector3d p0 = point(s[0]), p1 = point(s[1]);
+        p1 -= axis * ((p1 - p0) * axis);
+        Candidate c(ShapeDetection::Cylinder, level);
+        if (!intersectLines(p0, normals[s[0]], p1, normals[s[1]], c.origin))
+            return;
+        c.axis = axis;
+        c.radius = (Base::Distance(p0, c.origin) + Base::Distance(p1, c.origin)) * 0.5;
+        verify(c, s, 3, candidates);
+    }
+
+    void createCone(const std::vector<unsigned long>& s, int level, std::vector<Candidate>& candidates) const
+    {
+        // the apex is the intersection of the tangent planes
+        Eigen::Matrix3d A;
+        Eigen::Vector3d b;
+        for (int i = 0; i < 3; i++) {
+            const Base::Vector3d& n = normals[s[i]];
+            A.row(i) << n.x, n.y, n.z;
+            b(i) = n * point(s[i]);
+        }
+        if (std::fabs(A.determinant()) < 1e-6)
+            return;
+        Eigen::Vector3d x = A.partialPivLu().solve(b);
+
+        Candidate c(ShapeDetection::Cone, level);
+        c.origin.Set(x(0), x(1), x(2));
+
+        // the directions from the apex to the points have the same angle to the axis
+        Base::Vector3d d[3];
+        for (int i = 0; i < 3; i++) {
+            d[i] = point(s[i]) - c.origin;
+            if (d[i].Length() == 0.0)
+                return;
+            d[i].Normalize();
+        }
+        Base::Vector3d axis = (d[1] - d[0]) % (d[2] - d[0]);
+        if (axis.Length() == 0.0)
+            return;
+        axis.Normalize();
+        if (axis * (d[0] + d[1] + d[2]) < 0.0)
+            axis = -axis;
+
+        double angle = 0.0;
+        for (int i = 0; i < 3; i++)
+            angle += std::acos(std::max(-1.0, std::min(1.0, d[i] * axis)));
+        angle /= 3.0;
+        // nearly flat or nearly cylindrical cones are better described by the other types
+        if (angle < Base::toRadians(2.0) || angle > Base::toRadians(88.0))
+            return;
+
+        c.axis = axis;
+        c.radius = angle;
+        c.sinAngle = std::sin(angle);
+        c.cosAngle = std::cos(angle);
+        verify(c, s, 3, candidates);
+    }
+
+    void createTorus(const std::vector<unsigned long>& s, int level, std::vector<Candidate>& candidates) const
+    {
+        // All normal lines of a torus meet its axis. A line with direction a and moment m meets
+        // the line through p with direction n if a*(p x n) + m*n = 0, which is linear in (a,m).
+        // The Pluecker condition a*m = 0 then selects up to two lines in the null space.
+        Base::Vector3d base = point(s[0]);
+        Eigen::Matrix<double, 4, 6> A;
+        for (int i = 0; i < 4; i++) {
+            Base::Vector3d p = point(s[i]) - base;
+            const Base::Vector3d& n = normals[s[i]];
+            Base::Vector3d pn = p % n;
+            A.row(i) << pn.x, pn.y, pn.z, n.x, n.y, n.z;
+        }
+        Eigen::JacobiSVD<Eigen::Matrix<double, 4, 6> > svd(A, Eigen::ComputeFullV);
+        Eigen::Matrix<double, 6, 1> v1 = svd.matrixV().col(4);
+        Eigen::Matrix<double, 6, 1> v2 = svd.matrixV().col(5);
+
+        double c2 = v2.head<3>().dot(v2.tail<3>());
+        double c1 = v1.head<3>().dot(v2.tail<3>()) + v2.head<3>().dot(v1.tail<3>());
+        double c0 = v1.head<3>().dot(v1.tail<3>());
+        std::vector<Eigen::Matrix<double, 6, 1> > lines;
+        if (std::fabs(c2) < 1e-12) {
+            if (std::fabs(c1) > 1e-12)
+                lines.push_back(v1 - (c0 / c1) * v2);
+        }
+        else {
+            double disc = c1 * c1 - 4.0 * c2 * c0;
+            if (disc < 0.0)
+                return;
+            disc = std::sqrt(disc);
+            lines.push_back(v1 + ((-c1 + disc) / (2.0 * c2)) * v2);
+            lines.push_back(v1 + ((-c1 - disc) / (2.0 * c2)) * v2);
+        }
+
+        for (std::vector<Eigen::Matrix<double, 6, 1> >::iterator it = lines.begin(); it != lines.end(); ++it) {
+            Base::Vector3d axis((*it)(0), (*it)(1), (*it)(2));
+            Base::Vector3d moment((*it)(3), (*it)(4), (*it)(5));
+            double len = axis.Length();
+            if (len < 1e-9)
+                continue;
+            axis /= len;
+            moment /= len;
+            Base::Vector3d onAxis = base + (axis % moment);
+
+            // in the half plane through the axis the points lie on the minor circle
+            Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
+            Eigen::Vector2d r = Eigen::Vector2d::Zero();
+            Eigen::Vector2d q[4];
+            bool valid = true;
+            for (int i = 0; i < 4 && valid; i++) {
+                Base::Vector3d v = point(s[i]) - onAxis;
+                double h = v * axis;
+                Base::Vector3d radial = v - axis * h;
+                double rho = radial.Length();
+                if (rho == 0.0) {
+                    valid = false;
+                    break;
+                }
+                radial /= rho;
+                Eigen::Vector2d n(normals[s[i]] * radial, normals[s[i]] * axis);
+                if (n.norm() < 0.5) {
+                    valid = false;
+                    break;
+                }
+                n.normalize();
+                q[i] = Eigen::Vector2d(rho, h);
+                Eigen::Matrix2d P = Eigen::Matrix2d::Identity() - n * n.transpose();
+                M += P;
+                r += P * q[i];
+            }
+            if (!valid || std::fabs(M.determinant()) < 1e-6)
+                continue;
+
+            Eigen::Vector2d center = M.partialPivLu().solve(r);
+            double minor = 0.0;
+            for (int i = 0; i < 4; i++)
+                minor += (q[i] - center).norm();
+            minor /= 4.0;
+            if (center(0) <= 0.0 || minor <= 0.0)
+                continue;
+
+            Candidate c(ShapeDetection::Torus, level);
+            c.origin = onAxis + axis * center(1);
+            c.axis = axis;
+            c.radius = center(0);
+            c.minorRadius = minor;
+            verify(c, s, 4, candidates);
+        }
+    }
+
+    Base::Vector3d point(unsigned long index) const
+    {
+        return Base::convertTo<Base::Vector3d>(points[index]);
+    }
+
+private:
+    const std::vector<Base::Vector3f>& points;
+    const std::vector<Base::Vector3d>& normals;
+    const std::vector<ShapeDetection::Primitive>& types;
+    double eps;
+    double cosMin;
+};
+
+} // namespace
+
+ShapeDetection::ShapeDetection(const std::vector<Base::Vector3f>& points,
+                               const std::vector<Base::Vector3f>& normals)
+  : myPoints(points)
+  , myNormals(normals)
+  , epsilon(0.0)
+  , clusterEpsilon(0.0)
+  , normalThreshold(Base::toRadians(25.0))
+  , probability(0.01)
+  , minSupport(0)
+{
+    if (myPoints.size() != myNormals.size())
+        throw Base::RuntimeError("Number of points doesn't match with number of normals");
+    primitives.push_back(Plane);
+    primitives.push_back(Cylinder);
+    primitives.push_back(Sphere);
+    primitives.push_back(Cone);
+    primitives.push_back(Torus);
+}
+
+const char* ShapeDetection::getTypeName(Primitive type)
+{
+    switch (type) {
+    case Plane:
+        return "Plane";
+    case Cylinder:
+        return "Cylinder";
+    case Sphere:
+        return "Sphere";
+    case Cone:
+        return "Cone";
+    case Torus:
+        return "Torus";
+    }
+    return "";
+}
+
+void ShapeDetection::perform(std::vector<Shape>& shapes)
+{
+    std::size_t count = myPoints.size();
+    labels.assign(count, -1);
+    if (count == 0 || primitives.empty())
+        return;
+
+    // points without a valid normal are ignored
+    std::vector<Base::Vector3d> normals(count);
+    std::vector<char> valid(count, 0);
+    Base::BoundBox3d box;
+    for (std::size_t i = 0; i < count; i++) {
+        const Base::Vector3f& p = myPoints[i];
+        Base::Vector3d n = Base::convertTo<Base::Vector3d>(myNormals[i]);
+        double len = n.Length();
+        if (boost::math::isnan(p.x) || boost::math::isnan(p.y) || boost::math::isnan(p.z) ||
+            boost::math::isnan(len) || len == 0.0)
+            continue;
+        normals[i] = n / len;
+        valid[i] = 1;
+        box.Add(Base::convertTo<Base::Vector3d>(p));
+    }
+
+    std::vector<unsigned long> remaining;
+    for (std::size_t i = 0; i < count; i++) {
+        if (valid[i])
+            remaining.push_back(i);
+    }
+    if (remaining.empty())
+        return;
+
+    double eps = epsilon > 0.0 ? epsilon : 0.01 * box.CalcDiagonalLength();
+    double cosMin = std::cos(normalThreshold);
+    std::size_t support = minSupport > 0 ? minSupport : std::max<std::size_t>(10, remaining.size() / 100);
+
+    Points::PointsKDTree tree(myPoints);
+    double clusterEps = clusterEpsilon;
+    if (clusterEps <= 0.0) {
+        // mean distance of neighbouring points
+        std::vector<unsigned long> neighbours;
+        std::vector<float> distances;
+        double sum = 0.0;
+        std::size_t num = 0;
+        std::size_t step = std::max<std::size_t>(1, remaining.size() / 1000);
+        for (std::size_t i = 0; i < remaining.size(); i += step) {
+            tree.FindKNearest(myPoints[remaining[i]], 2, neighbours, distances);
+            if (distances.size() == 2) {
+                sum += distances[1];
+                num++;
+            }
+        }
+        clusterEps = num > 0 ? 4.0 * sum / num : eps;
+    }
+
+    Detector detector(myPoints, normals, primitives, eps, cosMin);
+    MortonOrder octree(myPoints, valid);
+    std::vector<char> used(count, 0);
+    for (std::size_t i = 0; i < count; i++)
+        used[i] = valid[i] ? 0 : 1;
+
+    std::mt19937 rng(0);
+    std::shuffle(remaining.begin(), remaining.end(), rng);
+
+    bool torus = std::find(primitives.begin(), primitives.end(), Torus) != primitives.end();
+    std::size_t sampleSize = torus ? 4 : 3;
+    std::vector<double> levelScore(OctreeDepth + 1, 1.0);
+    levelScore[0] = 0.0;
+
+    // probability that a shape with n points hasn't been sampled yet with the drawn samples
+    std::size_t drawn = 0;
+    auto missed = [&](double n) {
+        double p = n / (static_cast<double>(remaining.size()) * OctreeDepth * (1 << (sampleSize - 1)));
+        return std::pow(1.0 - std::min(1.0, p), static_cast<double>(drawn));
+    };
+
+    // scores each candidate on its next subset, parallel over candidates and blocks of points
+    auto refine = [&](std::vector<Candidate*>& cands) {
+        Base::parallel_for(cands.size(), [&](std::size_t c) {
+            Candidate& cand = *cands[c];
+            std::size_t first = cand.evaluated;
+            std::size_t last = std::min(remaining.size(), first == 0 ? FirstSubset : first * SubsetFactor);
+            std::vector<std::size_t> hits(Base::parallel_blocks(last - first, 4096), 0);
+            Base::parallel_for(last - first, 4096, [&](std::size_t block, std::size_t begin, std::size_t end) {
+                for (std::size_t i = first + begin; i < first + end; i++) {
+                    if (detector.isInlier(cand, remaining[i]))
+                        hits[block]++;
+                }
+            });
+            cand.hits += std::accumulate(hits.begin(), hits.end(), std::size_t(0));
+            cand.evaluated = std::max(cand.evaluated, last);
+        });
+    };
+
+    // all inliers of a candidate among the remaining points
+    auto inliers = [&](const Candidate& c, std::vector<unsigned long>& indices) {
+        std::vector<std::vector<unsigned long> > parts(Base::parallel_blocks(remaining.size(), 4096));
+        Base::parallel_for(remaining.size(), 4096, [&](std::size_t block, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++) {
+                if (detector.isInlier(c, remaining[i]))
+                    parts[block].push_back(remaining[i]);
+            }
+        });
+        indices.clear();
+        for (std::vector<std::vector<unsigned long> >::iterator it = parts.begin(); it != parts.end(); ++it)
+            indices.insert(indices.end(), it->begin(), it->end());
+    };
+
+    std::vector<Candidate> pool;
+    std::vector<unsigned long> sample(sampleSize);
+    int failures = 0;
+    while (remaining.size() >= support) {
+        // draw new candidates from localized samples
+        std::vector<Candidate> batch;
+        std::size_t drawnBefore = drawn;
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        double scoreSum = std::accumulate(levelScore.begin(), levelScore.end(), 0.0);
+        for (std::size_t k = 0; k < SamplesPerRound; k++) {
+            sample[0] = remaining[rng() % remaining.size()];
+
+            // prefer the octree levels that have led to shapes before
+            int level = OctreeDepth;
+            double pick = uniform(rng);
+            for (int l = 1; l <= OctreeDepth; l++) {
+                double p = 0.9 * levelScore[l] / scoreSum + 0.1 / OctreeDepth;
+                if (pick < p) {
+                    level = l;
+                    break;
+                }
+                pick -= p;
+            }
+
+            std::pair<std::size_t, std::size_t> cell = octree.cell(sample[0], level);
+            while (cell.second - cell.first < 4 * sampleSize && level > 1)
+                cell = octree.cell(sample[0], --level);
+
+            bool ok = true;
+            for (std::size_t j = 1; j < sampleSize && ok; j++) {
+                ok = false;
+                for (int attempt = 0; attempt < 20; attempt++) {
+                    unsigned long index = octree[cell.first + rng() % (cell.second - cell.first)];
+                    if (!used[index] && std::find(sample.begin(), sample.begin() + j, index) == sample.begin() + j) {
+                        sample[j] = index;
+                        ok = true;
+                        break;
+                    }
+                }
+            }
+            if (!ok)
+                continue;
+
+            drawn++;
+            detector.createCandidates(sample, level, batch);
+        }
+
+        // the remaining points are too scattered to draw samples
+        if (drawn == drawnBefore)
+            break;
+
+        std::vector<Candidate*> unscored;
+        for (std::vector<Candidate>::iterator it = batch.begin(); it != batch.end(); ++it)
+            unscored.push_back(&*it);
+        refine(unscored);
+        for (std::vector<Candidate>::iterator it = batch.begin(); it != batch.end(); ++it) {
+            if (it->upperBound(remaining.size()) >= support)
+                pool.push_back(*it);
+        }
+
+        // Refine the candidate with the best estimate until its score is exact. Many candidates
+        // describe the same shape with nearly the same score, refining all of them as well would
+        // be expensive and hardly changes the result.
+        std::size_t best = 0;
+        for (;;) {
+            best = pool.size();
+            for (std::size_t i = 0; i < pool.size(); i++) {
+                if (best == pool.size() || pool[i].estimate(remaining.size()) > pool[best].estimate(remaining.size()))
+                    best = i;
+            }
+            if (best == pool.size() || pool[best].evaluated >= remaining.size())
+                break;
+
+            std::vector<Candidate*> next(1, &pool[best]);
+            refine(next);
+        }
+
+        // forget candidates that can't become the best one
+        if (best < pool.size()) {
+            Candidate winner = pool[best];
+            double lower = winner.lowerBound(remaining.size());
+            std::vector<Candidate> kept;
+            for (std::vector<Candidate>::iterator it = pool.begin(); it != pool.end(); ++it) {
+                double upper = it->upperBound(remaining.size());
+                if (upper >= lower && upper >= support)
+                    kept.push_back(*it);
+            }
+            pool.swap(kept);
+            best = pool.size();
+            for (std::size_t i = 0; i < pool.size(); i++) {
+                if (best == pool.size() || pool[i].estimate(remaining.size()) > pool[best].estimate(remaining.size()))
+                    best = i;
+            }
+        }
+
+        if (best == pool.size() || pool[best].hits < support) {
+            if (missed(static_cast<double>(support)) < probability)
+                break;
+            continue;
+        }
+        if (missed(static_cast<double>(pool[best].hits)) >= probability)
+            continue;
+
+        // extract the best candidate
+        Candidate winner = pool[best];
+        pool.erase(pool.begin() + best);
+
+        std::vector<unsigned long> indices;
+        inliers(winner, indices);
+
+        // least-squares refinement of the simple types
+        if (winner.type == Plane || winner.type == Sphere || winner.type == Cylinder) {
+            std::vector<Base::Vector3f> pts;
+            std::size_t step = std::max<std::size_t>(1, indices.size() / 20000);
+            for (std::size_t i = 0; i < indices.size(); i += step)
+                pts.push_back(myPoints[indices[i]]);
+
+            Candidate fitted = winner;
+            bool ok = false;
+            if (winner.type == Plane) {
+                MeshCore::PlaneFit fit;
+                fit.AddPoints(pts);
+                if (fit.Fit() < FLOAT_MAX) {
+                    fitted.origin = Base::convertTo<Base::Vector3d>(fit.GetBase());
+                    fitted.axis = Base::convertTo<Base::Vector3d>(fit.GetNormal());
+                    ok = true;
+                }
+            }
+            else if (winner.type == Sphere) {
+                MeshCore::SphereFit fit;
+                fit.AddPoints(pts);
+                if (fit.Fit() < FLOAT_MAX) {
+                    fitted.origin = Base::convertTo<Base::Vector3d>(fit.GetCenter());
+                    fitted.radius = fit.GetRadius();
+                    ok = true;
+                }
+            }
+            else {
+                MeshCore::CylinderFit fit;
+                fit.AddPoints(pts);
+                fit.SetInitialValues(Base::convertTo<Base::Vector3f>(winner.origin),
+                                     Base::convertTo<Base::Vector3f>(winner.axis));
+                if (fit.Fit() < FLOAT_MAX) {
+                    fitted.origin = Base::convertTo<Base::Vector3d>(fit.GetBase());
+                    fitted.axis = Base::convertTo<Base::Vector3d>(fit.GetAxis());
+                    fitted.radius = fit.GetRadius();
+                    ok = fitted.axis.Length() > 0.0;
+                    if (ok)
+                        fitted.axis.Normalize();
+                }
+            }
+
+            if (ok) {
+                std::vector<unsigned long> refined;
+                inliers(fitted, refined);
+                if (refined.size() >= indices.size()) {
+                    winner = fitted;
+                    indices.swap(refined);
+                }
+            }
+        }
+
+        // keep the largest connected part of the inliers
+        if (!indices.empty()) {
+            std::vector<Base::Vector3f> pts;
+            pts.reserve(indices.size());
+            for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it)
+                pts.push_back(myPoints[*it]);
+            Points::PointsKDTree part(pts);
+            const std::size_t k = 8;
+            std::vector<unsigned long> neighbours;
+            part.FindKNearest(pts, k, neighbours);
+
+            std::vector<std::size_t> parent(pts.size());
+            std::iota(parent.begin(), parent.end(), 0);
+            auto find = [&parent](std::size_t i) {
+                while (parent[i] != i) {
+                    parent[i] = parent[parent[i]];
+                    i = parent[i];
+                }
+                return i;
+            };
+            float maxDist = static_cast<float>(clusterEps);
+            for (std::size_t i = 0; i < pts.size(); i++) {
+                for (std::size_t j = i * k; j < (i + 1) * k; j++) {
+                    unsigned long n = neighbours[j];
+                    if (n == ULONG_MAX || Base::Distance(pts[i], pts[n]) > maxDist)
+                        continue;
+                    std::size_t a = find(i), b = find(n);
+                    if (a != b)
+                        parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+
+            std::vector<std::size_t> sizes(pts.size(), 0);
+            std::size_t largest = 0;
+            for (std::size_t i = 0; i < pts.size(); i++) {
+                std::size_t root = find(i);
+                if (++sizes[root] > sizes[largest])
+                    largest = root;
+            }
+
+            std::vector<unsigned long> component;
+            component.reserve(sizes[largest]);
+            for (std::size_t i = 0; i < pts.size(); i++) {
+                if (find(i) == largest)
+                    component.push_back(indices[i]);
+            }
+            indices.swap(component);
+        }
+
+        // Inliers on several disconnected parts of a shape produce a lot of
+        // similar candidates that all fail here, so give up after a while.
+        if (indices.size() < support) {
+            if (++failures > 50)
+                break;
+            continue;
+        }
+        failures = 0;
+
+        Shape shape;
+        shape.type = winner.type;
+        Base::Vector3d o = winner.origin, a = winner.axis;
+        switch (winner.type) {
+        case Plane:
+            shape.parameters = {o.x, o.y, o.z, a.x, a.y, a.z};
+            break;
+        case Sphere:
+            shape.parameters = {o.x, o.y, o.z, winner.radius};
+            break;
+        case Cylinder:
+        case Cone:
+            shape.parameters = {o.x, o.y, o.z, a.x, a.y, a.z, winner.radius};
+            break;
+        case Torus:
+            shape.parameters = {o.x, o.y, o.z, a.x, a.y, a.z, winner.radius, winner.minorRadius};
+            break;
+        }
+        std::sort(indices.begin(), indices.end());
+        int label = static_cast<int>(shapes.size());
+        for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
+            used[*it] = 1;
+            labels[*it] = label;
+        }
+        shape.points.swap(indices);
+        levelScore[winner.level] += static_cast<double>(shape.points.size()) / count * OctreeDepth;
+        shapes.push_back(shape);
+
+        // continue with the remaining points, the candidates must be scored again
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&used](unsigned long i) {
+            return used[i] != 0;
+        }), remaining.end());
+        pool.clear();
+        drawn = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+ShapeSurfaceSegment::ShapeSurfaceSegment(const MeshCore::MeshKernel& kernel, const std::vector<int>& labels,
+                                         int shape, ShapeDetection::Primitive type, unsigned long minFacets)
+  : MeshCore::MeshSurfaceSegment(minFacets)
+  , kernel(kernel)
+  , labels(labels)
+  , shape(shape)
+  , type(type)
+{
+}
+
+bool ShapeSurfaceSegment::TestFacet (const MeshCore::MeshFacet &rclFacet) const
+{
+    for (int i=0; i<3; i++) {
+        if (labels[rclFacet._aulPoints[i]] != shape)
+            return false;
+    }
+
+    return true;
+}
+
+bool ShapeSurfaceSegment::TestInitialFacet(unsigned long index) const
+{
+    return TestFacet(kernel.GetFacets()[index]);
+}
+
+const char* ShapeSurfaceSegment::GetType() const
+{
+    return ShapeDetection::getTypeName(type);
+}
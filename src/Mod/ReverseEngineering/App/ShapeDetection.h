@@ -0,0 +1,153 @@
+/***************************************************************************
+ *   Copyright (c) 2021 FreeCAD Developers                                 *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef REEN_SHAPEDETECTION_H
+#define REEN_SHAPEDETECTION_H
+
+#include <Base/Vector3D.h>
+#include <Mod/Mesh/App/Core/Segmentation.h>
+#include <vector>
+
+namespace MeshCore {class MeshKernel;}
+
+namespace Reen {
+
+/**
+ * Detects planes, cylinders, spheres, cones and tori in an oriented point cloud with the
+ * efficient RANSAC method of Schnabel, Wahl and Klein (2007).
+ *
+ * The candidates are created from minimal sets of points with normals. The first point is
+ * drawn from all remaining points, the others from a cell of an octree around it, which makes
+ * it likely that all of them belong to the same shape. The candidates are scored in parallel on
+ * growing random subsets of the remaining points, so that bad candidates are rejected after a
+ * few hundred points. The best candidate is extracted as soon as the probability that a
+ * larger shape has been overlooked drops below the given probability. Its inliers are reduced
+ * to the largest connected part, planes, spheres and cylinders are refined with a least-squares
+ * fit, and the search continues on the remaining points.
+ */
+class ShapeDetection
+{
+public:
+    enum Primitive
+    {
+        Plane,
+        Cylinder,
+        Sphere,
+        Cone,
+        Torus
+    };
+
+    /** A detected shape.
+     * The parameters are:
+     * \li Plane: base point, normal
+     * \li Cylinder: point on the axis, axis, radius
+     * \li Sphere: center, radius
+     * \li Cone: apex, axis pointing into the cone, half opening angle in radians
+     * \li Torus: center, axis, major radius, minor radius
+     */
+    struct Shape
+    {
+        Primitive type;
+        std::vector<double> parameters;
+        std::vector<unsigned long> points;
+    };
+
+    /// The normals must have the same size as the points but need not be normalized
+    ShapeDetection(const std::vector<Base::Vector3f>& points,
+                   const std::vector<Base::Vector3f>& normals);
+
+    /** \brief Set the primitives to search for, by default all of them. */
+    void setPrimitives(const std::vector<Primitive>& types)
+    { primitives = types; }
+    /** \brief Set the maximum distance of an inlier to the shape.
+      * If zero 1% of the diagonal of the bounding box is used.
+      */
+    void setEpsilon(double eps)
+    { epsilon = eps; }
+    /** \brief Set the maximum distance of neighbouring points of a shape.
+      * The inliers that are not connected to the largest part of the shape are rejected.
+      * If zero four times the mean distance between neighbouring points is used.
+      */
+    void setClusterEpsilon(double eps)
+    { clusterEpsilon = eps; }
+    /** \brief Set the maximum angle in radians between the normal of a point and the shape. */
+    void setNormalThreshold(double angle)
+    { normalThreshold = angle; }
+    /** \brief Set the minimum number of points of a shape.
+      * If zero 1% of the points are used.
+      */
+    void setMinSupport(std::size_t num)
+    { minSupport = num; }
+    /** \brief Set the probability to overlook the largest remaining shape. */
+    void setProbability(double prob)
+    { probability = prob; }
+
+    /** \brief Detects the shapes ordered by the time of extraction, which is
+      * roughly by decreasing size.
+      */
+    void perform(std::vector<Shape>& shapes);
+    /** \brief Returns the index of the shape of each point or -1 if the point
+      * doesn't belong to any shape. It's only valid after perform().
+      */
+    const std::vector<int>& getLabels() const
+    { return labels; }
+
+    static const char* getTypeName(Primitive);
+
+private:
+    const std::vector<Base::Vector3f>& myPoints;
+    std::vector<Base::Vector3f> myNormals;
+    std::vector<Primitive> primitives;
+    std::vector<int> labels;
+    double epsilon;
+    double clusterEpsilon;
+    double normalThreshold;
+    double probability;
+    std::size_t minSupport;
+};
+
+/**
+ * Adapts the points of a detected shape on the vertices of a mesh to MeshSegmentAlgorithm.
+ * A facet belongs to the segment if all its corner points belong to the shape, so that
+ * FindSegments() collects the connected facet regions of the shape.
+ */
+class ShapeSurfaceSegment : public MeshCore::MeshSurfaceSegment
+{
+public:
+    /// \a labels are the labels of the mesh points returned by ShapeDetection::getLabels()
+    ShapeSurfaceSegment(const MeshCore::MeshKernel&, const std::vector<int>& labels,
+                        int shape, ShapeDetection::Primitive type, unsigned long minFacets);
+    bool TestFacet (const MeshCore::MeshFacet &rclFacet) const;
+    bool TestInitialFacet(unsigned long) const;
+    const char* GetType() const;
+
+private:
+    const MeshCore::MeshKernel& kernel;
+    const std::vector<int>& labels;
+    int shape;
+    ShapeDetection::Primitive type;
+};
+
+} // namespace Reen
+
+#endif // REEN_SHAPEDETECTION_H
@@ -23,13 +23,28 @@
 
 #include "PreCompiled.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <QtConcurrentMap>
+
 #include "SurfaceTriangulation.h"
+#include "Segmentation.h"
 #include <Mod/Points/App/Points.h>
+#include <Mod/Points/App/PointsKDTree.h>
 #include <Mod/Mesh/App/Mesh.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
 #include <Mod/Mesh/App/Core/Elements.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
+#include <Base/BoundBox.h>
+#include <Base/Console.h>
+#include <Base/Converter.h>
 #include <Base/Exception.h>
+#include <Base/Sequencer.h>
+#include <Base/TimeInfo.h>
 
 // http://svn.pointclouds.org/pcl/tags/pcl-1.5.1/test/
 #if defined(HAVE_PCL_SURFACE)
@@ -765,3 +780,428 @@ void MeshConversion::convert(const pcl::PolygonMesh& pclMesh, Mesh::MeshObject&
 
 #endif // HAVE_PCL_SURFACE
 
+// ----------------------------------------------------------------------------
+
+using namespace Reen;
+
+namespace {
+
+const int Dilation = 2;         // cubes around a point whose corners are evaluated
+const int Neighbours = 8;       // points that contribute to the distance of a corner
+const float MaxDistance = 3.0f; // of the nearest point in cell sizes
+const float MaxOffset = 2.0f;   // of a corner from the normal of the nearest point in cell sizes
+
+/*
+ * The marching cubes table. The corners of a cube are numbered by their coordinates
+ * (x | y << 1 | z << 2) and the edges by their axis and lower corner. The table is built from
+ * the sign changes on the faces: a face is walked counter-clockwise seen from outside and each
+ * edge where it enters the inside is connected to the next edge where it leaves it again. The
+ * segments form closed loops which are split into triangles whose normals point to the outside.
+ * As the segments only depend on the corners of a face the surface has no holes between
+ * neighbouring cubes.
+ */
+struct CubeTable
+{
+    int edgeCorner[12];
+    int edgeAxis[12];
+    int numTriangles[256];
+    int triangles[256][30];
+
+    CubeTable()
+    {
+        int edgeOf[8][8];
+        int edge = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            for (int corner = 0; corner < 8; corner++) {
+                if (corner & (1 << axis))
+                    continue;
+                int other = corner | (1 << axis);
+                edgeCorner[edge] = corner;
+                edgeAxis[edge] = axis;
+                edgeOf[corner][other] = edgeOf[other][corner] = edge;
+                edge++;
+            }
+        }
+
+        static const int faces[6][4] = {
+            {2, 0, 4, 6}, {1, 3, 7, 5}, // x = 0, x = 1
+            {0, 1, 5, 4}, {3, 2, 6, 7}, // y = 0, y = 1
+            {0, 2, 3, 1}, {4, 5, 7, 6}  // z = 0, z = 1
+        };
+
+        for (int inside = 0; inside < 256; inside++) {
+            int next[12];
+            std::fill(next, next + 12, -1);
+            for (int f = 0; f < 6; f++) {
+                int cross[4];
+                bool enter[4];
+                int num = 0;
+                for (int i = 0; i < 4; i++) {
+                    int c0 = faces[f][i];
+                    int c1 = faces[f][(i + 1) % 4];
+                    bool in0 = (inside >> c0) & 1;
+                    bool in1 = (inside >> c1) & 1;
+                    if (in0 != in1) {
+                        cross[num] = edgeOf[c0][c1];
+                        enter[num] = in1;
+                        num++;
+                    }
+                }
+                for (int i = 0; i < num; i++) {
+                    if (enter[i])
+                        next[cross[i]] = cross[(i + 1) % num];
+                }
+            }
+
+            bool used[12] = {false};
+            numTriangles[inside] = 0;
+            for (int start = 0; start < 12; start++) {
+                if (next[start] < 0 || used[start])
+                    continue;
+                int loop[12];
+                int len = 0;
+                for (int e = start; !used[e]; e = next[e]) {
+                    used[e] = true;
+                    loop[len++] = e;
+                }
+                for (int i = 1; i + 1 < len; i++) {
+                    int* tria = triangles[inside] + 3 * numTriangles[inside]++;
+                    tria[0] = loop[0];
+                    tria[1] = loop[i];
+                    tria[2] = loop[i + 1];
+                }
+            }
+        }
+    }
+};
+
+const CubeTable& cubeTable()
+{
+    static const CubeTable table;
+    return table;
+}
+
+/*
+ * A block of cubes with the points next to it and its part of the surface. The vertices on
+ * the faces of the block are also created by the neighbouring blocks and are welded by the key
+ * of their grid edge.
+ */
+struct Block
+{
+    int x, y, z;
+    std::size_t first, last;
+    std::vector<Base::Vector3f> vertices;
+    std::vector<std::pair<uint32_t, uint64_t> > seam;
+    std::vector<uint32_t> triangles;
+};
+
+const int MaxCells = 1 << 20; // corners along an axis that fit into an edge key
+
+inline uint64_t edgeKey(int x, int y, int z, int axis)
+{
+    return (uint64_t(x) << 42) | (uint64_t(y) << 22) | (uint64_t(z) << 2) | uint64_t(axis);
+}
+
+inline uint64_t blockKey(int x, int y, int z)
+{
+    return (uint64_t(x) << 42) | (uint64_t(y) << 21) | uint64_t(z);
+}
+
+}
+
+TiledMarchingCubes::TiledMarchingCubes(const Points::PointKernel& pts, Mesh::MeshObject& mesh)
+  : myPoints(pts)
+  , myMesh(mesh)
+  , cellSize(0)
+  , blockSize(16)
+{
+}
+
+void TiledMarchingCubes::perform(int ksearch)
+{
+    std::vector<Base::Vector3d> normals;
+    NormalEstimation estimate(myPoints);
+    estimate.setKSearch(ksearch);
+    estimate.setPropagateOrientation(true);
+    estimate.perform(normals);
+
+    std::vector<Base::Vector3f> fnormals;
+    fnormals.reserve(normals.size());
+    for (std::vector<Base::Vector3d>::iterator it = normals.begin(); it != normals.end(); ++it)
+        fnormals.push_back(Base::convertTo<Base::Vector3f>(*it));
+    perform(fnormals);
+}
+
+void TiledMarchingCubes::perform(const std::vector<Base::Vector3f>& normals)
+{
+    if (myPoints.size() != normals.size())
+        throw Base::RuntimeError("Number of points doesn't match with number of normals");
+    if (blockSize < 1)
+        throw Base::ValueError("Block size must be positive");
+
+    Base::TimeInfo start;
+
+    // points with a valid normal
+    std::vector<Base::Vector3f> points;
+    std::vector<Base::Vector3f> units;
+    const std::vector<Base::Vector3f>& basic = myPoints.getBasicPoints();
+    Base::BoundBox3f box;
+    for (std::size_t i = 0; i < basic.size(); i++) {
+        const Base::Vector3f& p = basic[i];
+        Base::Vector3f n = normals[i];
+        float len = n.Length();
+        if (std::isnan(p.x) || std::isnan(p.y) || std::isnan(p.z) || !(len > 0.0f))
+            continue;
+        points.push_back(p);
+        units.push_back(n / len);
+        box.Add(p);
+    }
+    if (points.size() < 3)
+        throw Base::RuntimeError("Too few points with normals");
+
+    Points::PointsKDTree tree(points);
+
+    float size = static_cast<float>(cellSize);
+    if (size <= 0.0f) {
+        std::size_t step = std::max<std::size_t>(1, points.size() / 1000);
+        std::vector<unsigned long> indices;
+        std::vector<float> distances;
+        double sum = 0.0;
+        std::size_t num = 0;
+        for (std::size_t i = 0; i < points.size(); i += step) {
+            tree.FindKNearest(points[i], 2, indices, distances);
+            if (distances.size() == 2) {
+                sum += distances[1];
+                num++;
+            }
+        }
+        size = num > 0 ? static_cast<float>(2.0 * sum / num) : 0.0f;
+    }
+    if (!(size > 0.0f))
+        throw Base::ValueError("Cell size must be positive");
+
+    // the grid starts so far before the points that all corner coordinates are positive
+    const int B = blockSize;
+    const float margin = (Dilation + 1) * size;
+    const Base::Vector3f origin(box.MinX - margin, box.MinY - margin, box.MinZ - margin);
+    if ((box.LengthX() + 2 * margin) / size >= MaxCells - B ||
+        (box.LengthY() + 2 * margin) / size >= MaxCells - B ||
+        (box.LengthZ() + 2 * margin) / size >= MaxCells - B)
+        throw Base::ValueError("Cell size is too small for the extent of the points");
+
+    auto cellOf = [&](const Base::Vector3f& p, int c[3]) {
+        c[0] = static_cast<int>((p.x - origin.x) / size);
+        c[1] = static_cast<int>((p.y - origin.y) / size);
+        c[2] = static_cast<int>((p.z - origin.z) / size);
+    };
+
+    // assign the points to all blocks with corners next to them
+    std::vector<std::pair<uint64_t, uint32_t> > assigned;
+    assigned.reserve(2 * points.size());
+    for (std::size_t i = 0; i < points.size(); i++) {
+        int c[3], lo[3], hi[3];
+        cellOf(points[i], c);
+        for (int d = 0; d < 3; d++) {
+            lo[d] = (c[d] - Dilation - 1) / B;
+            hi[d] = (c[d] + 1 + Dilation) / B;
+        }
+        for (int x = lo[0]; x <= hi[0]; x++) {
+            for (int y = lo[1]; y <= hi[1]; y++) {
+                for (int z = lo[2]; z <= hi[2]; z++)
+                    assigned.push_back(std::make_pair(blockKey(x, y, z), static_cast<uint32_t>(i)));
+            }
+        }
+    }
+    std::sort(assigned.begin(), assigned.end());
+
+    std::vector<Block> blocks;
+    for (std::size_t i = 0; i < assigned.size(); ) {
+        std::size_t j = i;
+        while (j < assigned.size() && assigned[j].first == assigned[i].first)
+            j++;
+        uint64_t key = assigned[i].first;
+        Block block;
+        block.x = static_cast<int>(key >> 42);
+        block.y = static_cast<int>((key >> 21) & 0x1fffff);
+        block.z = static_cast<int>(key & 0x1fffff);
+        block.first = i;
+        block.last = j;
+        blocks.push_back(block);
+        i = j;
+    }
+
+    Base::SequencerLauncher seq("Reconstruct surface...", blocks.size());
+    const CubeTable& table = cubeTable();
+    const float maxDistance = MaxDistance * size;
+    const float maxOffset = MaxOffset * size;
+    const float NaN = std::numeric_limits<float>::quiet_NaN();
+
+    auto distance = [&](const Base::Vector3f& pos, std::vector<unsigned long>& indices,
+                        std::vector<float>& distances) {
+        tree.FindKNearest(pos, Neighbours, indices, distances);
+        if (distances.empty() || distances[0] > maxDistance)
+            return NaN;
+        Base::Vector3f d = pos - points[indices[0]];
+        float height = d * units[indices[0]];
+        if (d.Sqr() - height * height > maxOffset * maxOffset)
+            return NaN;
+
+        double sum = 0.0, weights = 0.0;
+        for (std::size_t k = 0; k < indices.size() && distances[k] <= maxDistance; k++) {
+            double w = std::exp(-double(distances[k] * distances[k]) / (size * size));
+            sum += w * ((pos - points[indices[k]]) * units[indices[k]]);
+            weights += w;
+        }
+        return static_cast<float>(sum / weights);
+    };
+
+    QtConcurrent::blockingMap(blocks, [&](Block& block) {
+        const int n = B + 1;
+        const int gx = block.x * B, gy = block.y * B, gz = block.z * B;
+        auto corner = [n](int x, int y, int z) {
+            return (z * n + y) * n + x;
+        };
+
+        // evaluate the corners next to the points
+        std::vector<char> marked(n * n * n, 0);
+        for (std::size_t i = block.first; i < block.last; i++) {
+            int c[3];
+            cellOf(points[assigned[i].second], c);
+            int x0 = std::max(0, c[0] - gx - Dilation), x1 = std::min(B, c[0] - gx + 1 + Dilation);
+            int y0 = std::max(0, c[1] - gy - Dilation), y1 = std::min(B, c[1] - gy + 1 + Dilation);
+            int z0 = std::max(0, c[2] - gz - Dilation), z1 = std::min(B, c[2] - gz + 1 + Dilation);
+            for (int z = z0; z <= z1; z++) {
+                for (int y = y0; y <= y1; y++) {
+                    for (int x = x0; x <= x1; x++)
+                        marked[corner(x, y, z)] = 1;
+                }
+            }
+        }
+
+        std::vector<float> values(n * n * n, NaN);
+        std::vector<unsigned long> indices;
+        std::vector<float> distances;
+        for (int z = 0; z < n; z++) {
+            for (int y = 0; y < n; y++) {
+                for (int x = 0; x < n; x++) {
+                    int c = corner(x, y, z);
+                    if (marked[c]) {
+                        Base::Vector3f pos(origin.x + (gx + x) * size,
+                                           origin.y + (gy + y) * size,
+                                           origin.z + (gz + z) * size);
+                        values[c] = distance(pos, indices, distances);
+                    }
+                }
+            }
+        }
+
+        // march the cubes with all corners defined
+        std::vector<int32_t> vertexOf(3 * n * n * n, -1);
+        auto vertex = [&](int x, int y, int z, int axis) {
+            int c = corner(x, y, z);
+            int32_t& index = vertexOf[3 * c + axis];
+            if (index < 0) {
+                int o = axis == 0 ? corner(x + 1, y, z) : axis == 1 ? corner(x, y + 1, z) : corner(x, y, z + 1);
+                float t = values[c] / (values[c] - values[o]);
+                float p[3] = {float(gx + x), float(gy + y), float(gz + z)};
+                p[axis] += t;
+                index = static_cast<int32_t>(block.vertices.size());
+                block.vertices.emplace_back(origin.x + p[0] * size,
+                                            origin.y + p[1] * size,
+                                            origin.z + p[2] * size);
+                int local[3] = {x, y, z};
+                for (int d = 0; d < 3; d++) {
+                    if (d != axis && (local[d] == 0 || local[d] == B)) {
+                        block.seam.push_back(std::make_pair(static_cast<uint32_t>(index),
+                                             edgeKey(gx + x, gy + y, gz + z, axis)));
+                        break;
+                    }
+                }
+            }
+            return static_cast<uint32_t>(index);
+        };
+
+        for (int z = 0; z < B; z++) {
+            for (int y = 0; y < B; y++) {
+                for (int x = 0; x < B; x++) {
+                    int inside = 0;
+                    bool defined = true;
+                    for (int i = 0; i < 8 && defined; i++) {
+                        float v = values[corner(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1))];
+                        if (std::isnan(v))
+                            defined = false;
+                        else if (v < 0.0f)
+                            inside |= 1 << i;
+                    }
+                    if (!defined || inside == 0 || inside == 255)
+                        continue;
+
+                    const int* tria = table.triangles[inside];
+                    for (int i = 0; i < 3 * table.numTriangles[inside]; i++) {
+                        int e = tria[i];
+                        int c = table.edgeCorner[e];
+                        block.triangles.push_back(vertex(x + (c & 1), y + ((c >> 1) & 1),
+                                                         z + ((c >> 2) & 1), table.edgeAxis[e]));
+                    }
+                }
+            }
+        }
+
+        seq.advance();
+    });
+    seq.update();
+
+    double marchTime = Base::TimeInfo::diffTimeF(start);
+
+    // weld the seams in the order of the blocks
+    std::size_t numVertices = 0, numTriangles = 0;
+    for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        numVertices += it->vertices.size();
+        numTriangles += it->triangles.size() / 3;
+    }
+
+    MeshCore::MeshPointArray meshPoints;
+    MeshCore::MeshFacetArray meshFacets;
+    meshPoints.reserve(numVertices);
+    meshFacets.reserve(numTriangles);
+
+    std::unordered_map<uint64_t, unsigned long> welded;
+    std::vector<unsigned long> index;
+    for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        index.assign(it->vertices.size(), ULONG_MAX);
+        for (std::vector<std::pair<uint32_t, uint64_t> >::iterator jt = it->seam.begin(); jt != it->seam.end(); ++jt) {
+            std::unordered_map<uint64_t, unsigned long>::iterator kt = welded.find(jt->second);
+            if (kt != welded.end())
+                index[jt->first] = kt->second;
+        }
+        for (std::size_t i = 0; i < it->vertices.size(); i++) {
+            if (index[i] == ULONG_MAX) {
+                index[i] = meshPoints.size();
+                meshPoints.push_back(it->vertices[i]);
+            }
+        }
+        for (std::vector<std::pair<uint32_t, uint64_t> >::iterator jt = it->seam.begin(); jt != it->seam.end(); ++jt)
+            welded.insert(std::make_pair(jt->second, index[jt->first]));
+
+        for (std::size_t i = 0; i < it->triangles.size(); i += 3) {
+            MeshCore::MeshFacet face;
+            face._aulPoints[0] = index[it->triangles[i]];
+            face._aulPoints[1] = index[it->triangles[i + 1]];
+            face._aulPoints[2] = index[it->triangles[i + 2]];
+            meshFacets.push_back(face);
+        }
+
+        // release the block
+        std::vector<Base::Vector3f>().swap(it->vertices);
+        std::vector<std::pair<uint32_t, uint64_t> >().swap(it->seam);
+        std::vector<uint32_t>().swap(it->triangles);
+    }
+
+    MeshCore::MeshKernel kernel;
+    kernel.Adopt(meshPoints, meshFacets, true);
+    myMesh.swap(kernel);
+
+    Base::Console().Log("Marching cubes: %lu blocks of cell size %g in %.3f s, welded in %.3f s\n",
+                        static_cast<unsigned long>(blocks.size()), size,
+                        marchTime, Base::TimeInfo::diffTimeF(start) - marchTime);
+}
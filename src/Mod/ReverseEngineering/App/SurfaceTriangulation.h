@@ -187,6 +187,48 @@ private:
     Mesh::MeshObject& myMesh;
 };
 
+/**
+ * Reconstructs a surface from an oriented point cloud with marching cubes without PCL.
+ *
+ * The signed distance of a grid corner is the weighted mean of its distances to the tangent
+ * planes of the nearest points (Hoppe et al.). It is only evaluated next to the points, and
+ * corners whose nearest point is too far away or doesn't project near them are undefined, so
+ * the surface ends at the border of open scans. The grid is split into blocks of cubes which
+ * are processed in parallel, and only the blocks next to points are visited. The vertices on
+ * the faces of a block are identified by their grid edge and welded with the vertices of the
+ * neighbouring blocks, so the memory of a block is released as soon as it is merged into the
+ * mesh and the memory usage grows with the surface and not with the volume.
+ *
+ * The facets are oriented so that their normals point to the side of the point normals.
+ */
+class TiledMarchingCubes
+{
+public:
+    TiledMarchingCubes(const Points::PointKernel&, Mesh::MeshObject&);
+    /** \brief Set the edge length of the cubes.
+      * If zero twice the mean distance between neighbouring points is used.
+      */
+    void setCellSize(double size)
+    { cellSize = size; }
+    /** \brief Set the number of cubes along each edge of a block. */
+    void setBlockSize(int size)
+    { blockSize = size; }
+    /** \brief Estimate the normals with the k nearest neighbours and orient them consistently.
+      * \param[in] k the number of k-nearest neighbors
+      */
+    void perform(int ksearch=10);
+    /** \brief Pass the normals to the points given in the constructor.
+      * \param[in] normals the normals to the given points.
+      */
+    void perform(const std::vector<Base::Vector3f>& normals);
+
+private:
+    const Points::PointKernel& myPoints;
+    Mesh::MeshObject& myMesh;
+    double cellSize;
+    int blockSize;
+};
+
 } // namespace Reen
 
 #endif // REEN_SURFACETRIANGULATION_H
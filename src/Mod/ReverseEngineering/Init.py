@@ -22,3 +22,5 @@
 # *                                                                         *
 # ***************************************************************************/
 # FreeCAD init script of the ReverseEngineering module
+
+FreeCAD.__unit_test__ += [ "ReverseEngineeringTestsApp" ]
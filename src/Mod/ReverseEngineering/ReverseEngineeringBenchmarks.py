@@ -0,0 +1,196 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2021 FreeCAD Developers
+#  LGPL
+
+"""
+Benchmarks for the reverse engineering module.
+
+They compare the native implementations with the former ones based on PCL,
+which are only available if the module is built with PCL, and the sparse
+surface fitting with the former dense one. Run them from the
+FreeCAD Python console or with FreeCADCmd, e.g.
+
+    import ReverseEngineeringBenchmarks
+    ReverseEngineeringBenchmarks.benchmarkNormals(1000000)
+    ReverseEngineeringBenchmarks.benchmarkApproxSurface(500000)
+    ReverseEngineeringBenchmarks.benchmarkMarchingCubes(1000000)
+"""
+
+import FreeCAD, Points
+import ReverseEngineering as Reen
+import math, random, time
+
+
+def report(title, count, seconds):
+    """Prints the throughput of a benchmark"""
+    rate = count / seconds if seconds > 0 else float("inf")
+    FreeCAD.Console.PrintMessage("{}: {} points in {:.3f} s ({:.0f} points/s)\n".format(
+        title, count, seconds, rate))
+
+
+def boxCloud(count, seed=0):
+    """Returns count points sampled on three faces of a box, which makes three smooth regions"""
+    rnd = random.Random(seed)
+    pnts = []
+    for i in range(count):
+        u = rnd.uniform(0.0, 10.0)
+        v = rnd.uniform(0.0, 10.0)
+        face = i % 3
+        if face == 0:
+            pnts.append(FreeCAD.Vector(u, v, 0.0))
+        elif face == 1:
+            pnts.append(FreeCAD.Vector(0.0, u, v + 0.2))
+        else:
+            pnts.append(FreeCAD.Vector(u + 0.2, 0.0, v + 0.2))
+    return Points.Points(pnts)
+
+
+def timed(func, *args, **kwds):
+    start = time.time()
+    result = func(*args, **kwds)
+    return result, time.time() - start
+
+
+def benchmarkNormals(count=200000, k=10):
+    """Estimates the normals natively and with PCL and reports the time and the
+    largest angle between the results in degrees."""
+    pts = boxCloud(count)
+    native, seconds = timed(Reen.normalEstimation, pts, KSearch=k)
+    report("Native normals", count, seconds)
+    try:
+        pcl, seconds = timed(Reen.normalEstimation, pts, KSearch=k, UsePCL=True)
+    except RuntimeError as e:
+        FreeCAD.Console.PrintMessage("PCL normals: {}\n".format(e))
+        return
+
+    report("PCL normals", count, seconds)
+    deviation = 0.0
+    for a, b in zip(native, pcl):
+        if math.isnan(a.x) or math.isnan(b.x):
+            continue
+        dot = min(1.0, abs(a.dot(b)) / (a.Length * b.Length))
+        deviation = max(deviation, math.degrees(math.acos(dot)))
+    FreeCAD.Console.PrintMessage("Largest deviation: {:.4f} degrees\n".format(deviation))
+
+
+def benchmarkRegionGrowing(count=200000, k=10):
+    """Segments a cloud into smooth regions natively and with PCL and reports the
+    time and the sizes of the regions."""
+    pts = boxCloud(count)
+    normals = Reen.normalEstimation(pts, KSearch=k)
+    native, seconds = timed(Reen.regionGrowingSegmentation, pts, Normals=normals)
+    report("Native region growing", count, seconds)
+    FreeCAD.Console.PrintMessage("Regions: {}\n".format(sorted(len(r) for r in native)))
+    try:
+        pcl, seconds = timed(Reen.regionGrowingSegmentation, pts, Normals=normals, UsePCL=True)
+    except RuntimeError as e:
+        FreeCAD.Console.PrintMessage("PCL region growing: {}\n".format(e))
+        return
+
+    report("PCL region growing", count, seconds)
+    FreeCAD.Console.PrintMessage("Regions: {}\n".format(sorted(len(r) for r in pcl)))
+
+
+def benchmarkApproxSurface(count=200000, poles=10, iterations=5):
+    """Fits a B-spline surface to a wavy point cloud with the dense and the sparse
+    least-squares solvers and reports the time and the largest pole deviation.
+    The time of each parameter correction is written to the log."""
+    rnd = random.Random(0)
+    pnts = []
+    for i in range(count):
+        u = rnd.uniform(0.0, 10.0)
+        v = rnd.uniform(0.0, 10.0)
+        pnts.append(FreeCAD.Vector(u, v, math.sin(u * 0.5) * math.cos(v * 0.5)))
+
+    results = []
+    for sparse in (False, True):
+        surf, seconds = timed(Reen.approxSurface, pnts, NbUPoles=poles, NbVPoles=poles,
+                              Iterations=iterations, Sparse=sparse)
+        report("{} B-spline fit".format("Sparse" if sparse else "Dense"), count, seconds)
+        results.append(surf.getPoles())
+
+    deviation = 0.0
+    for row1, row2 in zip(*results):
+        for p1, p2 in zip(row1, row2):
+            deviation = max(deviation, (p1 - p2).Length)
+    FreeCAD.Console.PrintMessage("Largest pole deviation: {:.6f}\n".format(deviation))
+
+
+def primitiveCloud(count, seed=0):
+    """Returns count points with normals on a plane, a sphere, a cylinder, a cone and a torus"""
+    rnd = random.Random(seed)
+    pnts = []
+    nors = []
+    angle = math.radians(30.0)
+    for i in range(count):
+        t = rnd.uniform(0.0, 2.0 * math.pi)
+        s = rnd.uniform(0.0, 2.0 * math.pi)
+        shape = i % 5
+        if shape == 0:
+            p = FreeCAD.Vector(rnd.uniform(0.0, 10.0), rnd.uniform(0.0, 10.0), 0.0)
+            n = FreeCAD.Vector(0.0, 0.0, 1.0)
+        elif shape == 1:
+            z = rnd.uniform(-1.0, 1.0)
+            n = FreeCAD.Vector(math.sqrt(1.0 - z * z) * math.cos(t), math.sqrt(1.0 - z * z) * math.sin(t), z)
+            p = FreeCAD.Vector(5.0, 5.0, 5.0) + n * 2.0
+        elif shape == 2:
+            n = FreeCAD.Vector(0.0, math.cos(t), math.sin(t))
+            p = FreeCAD.Vector(rnd.uniform(0.0, 10.0), 20.0, 5.0) + n * 1.5
+        elif shape == 3:
+            h = rnd.uniform(1.0, 6.0)
+            r = FreeCAD.Vector(math.cos(t), math.sin(t), 0.0)
+            p = FreeCAD.Vector(20.0, 0.0, h) + r * (h * math.tan(angle))
+            n = r * math.cos(angle) - FreeCAD.Vector(0.0, 0.0, math.sin(angle))
+        else:
+            r = FreeCAD.Vector(math.cos(t), math.sin(t), 0.0)
+            n = r * math.cos(s) + FreeCAD.Vector(0.0, 0.0, math.sin(s))
+            p = FreeCAD.Vector(20.0, 20.0, 0.0) + r * 3.0 + n
+        pnts.append(p)
+        nors.append(n)
+    return Points.Points(pnts), nors
+
+
+def benchmarkShapeDetection(count=500000, epsilon=0.05):
+    """Detects the five primitive types in a synthetic cloud and reports the
+    time and the detected shapes."""
+    pts, normals = primitiveCloud(count)
+    shapes, seconds = timed(Reen.detectShapes, pts, Normals=normals, Epsilon=epsilon)
+    report("Shape detection", count, seconds)
+    for shape in shapes:
+        FreeCAD.Console.PrintMessage("{}: {} points, {}\n".format(
+            shape["Type"], len(shape["Points"]),
+            ", ".join("{:.3f}".format(v) for v in shape["Parameters"])))
+
+
+def sphereCloud(count, radius=10.0, seed=0):
+    """Returns count points with normals on a sphere"""
+    rnd = random.Random(seed)
+    pnts = []
+    nors = []
+    for i in range(count):
+        z = rnd.uniform(-1.0, 1.0)
+        t = rnd.uniform(0.0, 2.0 * math.pi)
+        n = FreeCAD.Vector(math.sqrt(1.0 - z * z) * math.cos(t), math.sqrt(1.0 - z * z) * math.sin(t), z)
+        pnts.append(n * radius)
+        nors.append(n)
+    return Points.Points(pnts), nors
+
+
+def benchmarkMarchingCubes(count=1000000, blockSize=16):
+    """Reconstructs a sphere with the tiled marching cubes and, if available, with
+    PCL and reports the time, the size and the volume of the meshes."""
+    radius = 10.0
+    pts, normals = sphereCloud(count, radius)
+    FreeCAD.Console.PrintMessage("Sphere volume: {:.3f}\n".format(4.0 / 3.0 * math.pi * radius ** 3))
+    mesh, seconds = timed(Reen.marchingCubes, pts, Normals=normals, BlockSize=blockSize)
+    report("Tiled marching cubes", count, seconds)
+    FreeCAD.Console.PrintMessage("{} facets, closed: {}, volume: {:.3f}\n".format(
+        mesh.CountFacets, mesh.isSolid(), mesh.Volume))
+    if not hasattr(Reen, "marchingCubesHoppe"):
+        return
+
+    mesh, seconds = timed(Reen.marchingCubesHoppe, pts, Normals=normals)
+    report("PCL marching cubes", count, seconds)
+    FreeCAD.Console.PrintMessage("{} facets, closed: {}, volume: {:.3f}\n".format(
+        mesh.CountFacets, mesh.isSolid(), mesh.Volume))
@@ -0,0 +1,147 @@
+# -*- coding: utf-8 -*-
+
+#  Copyright (c) 2021 FreeCAD Developers
+#  LGPL
+
+import FreeCAD, unittest, Points
+import ReverseEngineering as Reen
+import math, random
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD reverse engineering module
+#---------------------------------------------------------------------------
+
+
+class ApproxSurfaceTestCases(unittest.TestCase):
+    def setUp(self):
+        # a wavy height field over a square
+        rnd = random.Random(0)
+        self.points = []
+        for i in range(5000):
+            u = rnd.uniform(0.0, 10.0)
+            v = rnd.uniform(0.0, 10.0)
+            self.points.append(FreeCAD.Vector(u, v, math.sin(u * 0.5) * math.cos(v * 0.5)))
+
+    def comparePoles(self, smooth):
+        dense = Reen.approxSurface(self.points, NbUPoles=8, NbVPoles=8, Iterations=3,
+                                   Smooth=smooth, Sparse=False)
+        sparse = Reen.approxSurface(self.points, NbUPoles=8, NbVPoles=8, Iterations=3,
+                                    Smooth=smooth, Sparse=True)
+        self.assertEqual(dense.NbUPoles, sparse.NbUPoles)
+        self.assertEqual(dense.NbVPoles, sparse.NbVPoles)
+        for row1, row2 in zip(dense.getPoles(), sparse.getPoles()):
+            for p1, p2 in zip(row1, row2):
+                self.assertAlmostEqual((p1 - p2).Length, 0.0, places=5)
+
+    def testSparseWithoutSmoothing(self):
+        self.comparePoles(False)
+
+    def testSparseWithSmoothing(self):
+        self.comparePoles(True)
+
+
+class ShapeDetectionTestCases(unittest.TestCase):
+    def setUp(self):
+        # a plane, a sphere and a cylinder that don't touch each other
+        rnd = random.Random(0)
+        self.count = 3000
+        pnts = []
+        self.normals = []
+        for i in range(self.count):
+            pnts.append(FreeCAD.Vector(rnd.uniform(0.0, 10.0), rnd.uniform(0.0, 10.0), 0.0))
+            self.normals.append(FreeCAD.Vector(0.0, 0.0, 1.0))
+        for i in range(self.count):
+            z = rnd.uniform(-1.0, 1.0)
+            t = rnd.uniform(0.0, 2.0 * math.pi)
+            n = FreeCAD.Vector(math.sqrt(1.0 - z * z) * math.cos(t), math.sqrt(1.0 - z * z) * math.sin(t), z)
+            pnts.append(FreeCAD.Vector(5.0, 5.0, 5.0) + n * 2.0)
+            self.normals.append(n)
+        for i in range(self.count):
+            t = rnd.uniform(0.0, 2.0 * math.pi)
+            n = FreeCAD.Vector(0.0, math.cos(t), math.sin(t))
+            pnts.append(FreeCAD.Vector(rnd.uniform(0.0, 10.0), 20.0, 5.0) + n * 1.5)
+            self.normals.append(n)
+        self.points = Points.Points(pnts)
+
+    def detect(self):
+        shapes = Reen.detectShapes(self.points, Normals=self.normals, Epsilon=0.05,
+                                   Primitives=("Plane", "Sphere", "Cylinder"))
+        return dict((shape["Type"], shape) for shape in shapes)
+
+    def checkInliers(self, shape, index):
+        # all inliers belong to the generating primitive and only a few are missing
+        points = shape["Points"]
+        self.assertGreater(len(points), 0.95 * self.count)
+        for i in points:
+            self.assertEqual(i // self.count, index)
+
+    def testPlane(self):
+        plane = self.detect()["Plane"]
+        self.checkInliers(plane, 0)
+        base = FreeCAD.Vector(*plane["Parameters"][0:3])
+        normal = FreeCAD.Vector(*plane["Parameters"][3:6])
+        self.assertAlmostEqual(abs(normal.z), 1.0, places=4)
+        self.assertAlmostEqual(base.z, 0.0, places=4)
+
+    def testSphere(self):
+        sphere = self.detect()["Sphere"]
+        self.checkInliers(sphere, 1)
+        center = FreeCAD.Vector(*sphere["Parameters"][0:3])
+        self.assertAlmostEqual((center - FreeCAD.Vector(5.0, 5.0, 5.0)).Length, 0.0, places=3)
+        self.assertAlmostEqual(sphere["Parameters"][3], 2.0, places=3)
+
+    def testCylinder(self):
+        cylinder = self.detect()["Cylinder"]
+        self.checkInliers(cylinder, 2)
+        base = FreeCAD.Vector(*cylinder["Parameters"][0:3])
+        axis = FreeCAD.Vector(*cylinder["Parameters"][3:6])
+        self.assertAlmostEqual(abs(axis.x) / axis.Length, 1.0, places=4)
+        self.assertAlmostEqual(base.y, 20.0, places=3)
+        self.assertAlmostEqual(base.z, 5.0, places=3)
+        self.assertAlmostEqual(cylinder["Parameters"][6], 1.5, places=3)
+
+    def testSegments(self):
+        # the segments are points objects with the inliers of the shapes
+        for shape in self.detect().values():
+            segment = shape["Segment"]
+            self.assertEqual(segment.CountPoints, len(shape["Points"]))
+            self.assertEqual(segment.Points, self.points.fromSegment(shape["Points"]).Points)
+
+
+class MarchingCubesTestCases(unittest.TestCase):
+    def setUp(self):
+        # points with outward normals on a sphere
+        rnd = random.Random(0)
+        self.radius = 10.0
+        pnts = []
+        self.normals = []
+        for i in range(20000):
+            z = rnd.uniform(-1.0, 1.0)
+            t = rnd.uniform(0.0, 2.0 * math.pi)
+            n = FreeCAD.Vector(math.sqrt(1.0 - z * z) * math.cos(t), math.sqrt(1.0 - z * z) * math.sin(t), z)
+            pnts.append(n * self.radius)
+            self.normals.append(n)
+        self.points = Points.Points(pnts)
+
+    def testSphere(self):
+        mesh = Reen.marchingCubes(self.points, Normals=self.normals)
+        self.assertTrue(mesh.isSolid())
+        self.assertFalse(mesh.hasNonManifolds())
+        self.assertFalse(mesh.hasNonUniformOrientedFacets())
+        self.assertEqual(mesh.countComponents(), 1)
+
+        # the vertices lie on the sphere up to a fraction of the cell size
+        for p in mesh.Points:
+            self.assertAlmostEqual(p.Vector.Length, self.radius, delta=0.05 * self.radius)
+        volume = 4.0 / 3.0 * math.pi * self.radius ** 3
+        self.assertAlmostEqual(mesh.Volume, volume, delta=0.05 * volume)
+
+    def testBlockSize(self):
+        # the tiling must not leave seams between the blocks
+        mesh1 = Reen.marchingCubes(self.points, Normals=self.normals, BlockSize=4)
+        mesh2 = Reen.marchingCubes(self.points, Normals=self.normals, BlockSize=64)
+        self.assertTrue(mesh1.isSolid())
+        self.assertFalse(mesh1.hasNonManifolds())
+        self.assertEqual(mesh1.CountFacets, mesh2.CountFacets)
+        self.assertAlmostEqual(mesh1.Volume, mesh2.Volume, delta=1e-6 * mesh2.Volume)
@@ -22,7 +22,8 @@
 #***************************************************************************/
 
 import FreeCAD, os, unittest, tempfile
-import math
+import math, struct, zipfile
+from xml.etree import ElementTree
 
 #---------------------------------------------------------------------------
 # define the functions to test the FreeCAD Document code
@@ -519,6 +520,155 @@ class DocumentSaveRestoreCases(unittest.TestCase):
     #closing doc
     FreeCAD.closeDocument("SaveRestoreTests")
 
+class DocumentParallelFileCases(unittest.TestCase):
+  """Saves and restores meshes, shapes and points, which are stored as files of
+  their own, with the parallel, incremental and lazy file handling of the document"""
+  def setUp(self):
+    import Mesh, Part, Points
+    self.Doc = FreeCAD.newDocument("ParallelFileTests")
+    self.Param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Document")
+    self.Values = {}
+    self.Files = []
+    for i in range(4):
+      mesh = self.Doc.addObject("Mesh::Feature", "Mesh")
+      mesh.Mesh = Mesh.createSphere(1.0 + i, 50)
+      mesh.Placement.Base = FreeCAD.Vector(i, 0, 0)
+      shape = self.Doc.addObject("Part::Feature", "Shape")
+      shape.Shape = Part.makeBox(2.0 + i, 2.0, 2.0).cut(Part.makeCylinder(0.5, 2.0))
+      shape.Placement.Base = FreeCAD.Vector(0, i, 0)
+      points = self.Doc.addObject("Points::Feature", "Points")
+      points.Points = Points.Points([FreeCAD.Vector(i, 0.01 * j, math.sin(0.01 * j)) for j in range(1000)])
+    curvature = self.Doc.addObject("Mesh::Curvature", "Curvature")
+    curvature.Source = self.Doc.Mesh
+    self.Doc.recompute()
+    self.Contents = self.contents()
+
+  def contents(self):
+    result = []
+    for obj in self.Doc.Objects:
+      if obj.isDerivedFrom("Mesh::Feature"):
+        result.append((obj.Name, obj.Placement, obj.Mesh.Topology))
+      elif obj.isDerivedFrom("Mesh::Curvature"):
+        result.append((obj.Name, obj.CurvInfo))
+      elif obj.isDerivedFrom("Part::Feature"):
+        shape = obj.Shape
+        result.append((obj.Name, obj.Placement, shape.ShapeType, len(shape.Faces), len(shape.Edges),
+                       round(shape.Volume, 6), round(shape.Area, 6)))
+      elif obj.isDerivedFrom("Points::Feature"):
+        result.append((obj.Name, obj.Placement, obj.Points.Points))
+    return result
+
+  def setParameter(self, name, value):
+    if name not in self.Values:
+      self.Values[name] = self.Param.GetBool(name, False)
+    self.Param.SetBool(name, value)
+
+  def fileName(self, name):
+    fileName = os.path.join(tempfile.gettempdir(), name + ".FCStd")
+    self.Files.append(fileName)
+    return fileName
+
+  def reopen(self, fileName):
+    FreeCAD.closeDocument(self.Doc.Name)
+    self.Doc = FreeCAD.openDocument(fileName)
+
+  def archiveEntry(self, archive, objName, propName):
+    """Returns the zip entry of the file of a property and its raw compressed data"""
+    root = ElementTree.fromstring(archive.read("Document.xml"))
+    prop = root.find("ObjectData/Object[@name='%s']/Properties/Property[@name='%s']" % (objName, propName))
+    info = archive.getinfo(prop.find("*[@file]").get("file"))
+    with open(archive.filename, "rb") as f:
+      f.seek(info.header_offset)
+      header = f.read(30)
+      nameLength, extraLength = struct.unpack("<HH", header[26:30])
+      f.seek(info.header_offset + 30 + nameLength + extraLength)
+      return info, f.read(info.compress_size)
+
+  def testSaveAndRestore(self):
+    fileName = self.fileName("SaveAndRestore")
+    self.Doc.saveAs(fileName)
+    self.reopen(fileName)
+    self.assertEqual(self.contents(), self.Contents)
+
+  def testParallelSave(self):
+    fileName = self.fileName("ParallelSave")
+    self.setParameter("ParallelSave", True)
+    self.Doc.saveAs(fileName)
+    self.reopen(fileName)
+    self.assertEqual(self.contents(), self.Contents)
+
+  def testParallelRestore(self):
+    fileName = self.fileName("ParallelRestore")
+    self.Doc.saveAs(fileName)
+    self.setParameter("ParallelRestore", True)
+    self.reopen(fileName)
+    self.assertEqual(self.contents(), self.Contents)
+
+  def testIncrementalSave(self):
+    import Mesh
+    fileName1 = self.fileName("IncrementalSave1")
+    fileName2 = self.fileName("IncrementalSave2")
+    self.Doc.saveAs(fileName1)
+    self.Doc.Mesh.Mesh = Mesh.createBox(1.0, 2.0, 3.0)
+    self.Contents = self.contents()
+
+    self.setParameter("IncrementalSave", True)
+    self.Doc.saveAs(fileName2)
+
+    # the unchanged files are copied as they are and only the changed mesh is written again
+    archive1 = zipfile.ZipFile(fileName1)
+    archive2 = zipfile.ZipFile(fileName2)
+    try:
+      for objName, propName in (("Mesh", "Mesh"), ("Mesh001", "Mesh"), ("Curvature", "CurvInfo"),
+                                ("Shape", "Shape"), ("Points", "Points")):
+        info1, data1 = self.archiveEntry(archive1, objName, propName)
+        info2, data2 = self.archiveEntry(archive2, objName, propName)
+        if objName == "Mesh":
+          self.assertNotEqual(info1.CRC, info2.CRC)
+        else:
+          self.assertEqual(info1.CRC, info2.CRC, objName)
+          self.assertEqual(info1.compress_size, info2.compress_size, objName)
+          self.assertEqual(data1, data2, objName)
+    finally:
+      archive1.close()
+      archive2.close()
+
+    self.reopen(fileName2)
+    self.assertEqual(self.contents(), self.Contents)
+
+  def testLazyRestore(self):
+    fileName1 = self.fileName("LazyRestore1")
+    fileName2 = self.fileName("LazyRestore2")
+    self.Doc.saveAs(fileName1)
+    self.setParameter("LazyRestore", True)
+    self.reopen(fileName1)
+
+    # the files that haven't been read yet are copied and then read from the new file
+    self.assertEqual(self.Doc.Mesh.Mesh.Topology, self.Contents[0][2])
+    self.Doc.saveAs(fileName2)
+    os.remove(fileName1)
+    self.assertEqual(self.contents(), self.Contents)
+
+  def testLazyRestoreChangedFile(self):
+    fileName = self.fileName("LazyRestoreChanged")
+    self.Doc.saveAs(fileName)
+    self.setParameter("LazyRestore", True)
+    self.reopen(fileName)
+
+    # the pending files cannot be read from a file that has been changed meanwhile
+    with open(fileName, "ab") as f:
+      f.write(b"\0" * 100)
+    with self.assertRaises(Exception):
+      self.Doc.Mesh001.Mesh.Topology
+
+  def tearDown(self):
+    FreeCAD.closeDocument(self.Doc.Name)
+    for name, value in self.Values.items():
+      self.Param.SetBool(name, value)
+    for fileName in self.Files:
+      if os.path.exists(fileName):
+        os.remove(fileName)
+
 class DocumentRecomputeCases(unittest.TestCase):
   def setUp(self):
     self.Doc = FreeCAD.newDocument("RecomputeTests")
@@ -56,6 +56,12 @@ void ZipOutputStream::putNextEntry(const std::string& entryName) {
 }
 
 
+void ZipOutputStream::putCompressedEntry( const ZipCDirEntry &entry, 
+                                          const char *data, uint32 size ) {
+  ozf->putCompressedEntry( entry, data, size ) ;
+}
+
+
 void ZipOutputStream::setComment( const std::string &comment ) {
   ozf->setComment( comment ) ;
 }
@@ -54,6 +54,11 @@ public:
   */
   void putNextEntry(const std::string& entryName);
 
+  /** Writes a complete entry whose data has already been compressed.
+      @see ZipOutputStreambuf::putCompressedEntry() */
+  void putCompressedEntry( const ZipCDirEntry &entry, const char *data, 
+                           uint32 size ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const std::string& comment ) ;
 